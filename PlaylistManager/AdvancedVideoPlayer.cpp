@@ -3,17 +3,28 @@
 #include <QStandardPaths>
 #include <QDir>
 #include <QSizePolicy>
+#include <QStyle>
+#include <QScreen>
+#include "Tracer.h"
 
 AdvancedVideoPlayer::AdvancedVideoPlayer(QWidget *parent)
     : QMainWindow(parent)
-    , m_mediaPlayer(nullptr)
+    , m_engine(nullptr)
+    , m_keyframeIndexer(nullptr)
+    , m_scrubPreview(nullptr)
+    , m_thumbnailGenerator(nullptr)
+    , m_performanceOverlay(nullptr)
+    , m_controlServer(nullptr)
+#ifdef PLAYER_MPRIS
+    , m_mprisService(nullptr)
+#endif
     , m_videoWidget(nullptr)
-    , m_audioOutput(nullptr)
     , m_isFullScreen(false)
     , m_playlistVisible(true)
     , m_isMuted(false)
     , m_sliderPressed(false)
     , m_volume(50)
+    , m_scrubTarget(-1)
 {
     setWindowTitle("Qt6高级视频播放器");
     setMinimumSize(1000, 700);
@@ -27,16 +38,24 @@ AdvancedVideoPlayer::AdvancedVideoPlayer(QWidget *parent)
     applyStyles();
 
     // 创建定时器
-    m_progressTimer = new QTimer(this);
-    connect(m_progressTimer, &QTimer::timeout, this, &AdvancedVideoPlayer::updateProgress);
-    m_progressTimer->start(100);
+    // 进度只由位置通知驱动：暂停、停止时没有通知，不会被唤醒
+    m_progressThrottle = new ProgressThrottle(this);
+    connect(m_progressThrottle, &ProgressThrottle::progressChanged, this, &AdvancedVideoPlayer::updateProgress);
 
     m_fullscreenHideTimer = new QTimer(this);
     m_fullscreenHideTimer->setSingleShot(true);
     connect(m_fullscreenHideTimer, &QTimer::timeout, this, &AdvancedVideoPlayer::hideControlsInFullscreen);
 
+    m_scrubTimer = new QTimer(this);
+    m_scrubTimer->setSingleShot(true);
+    m_scrubTimer->setInterval(50);
+    connect(m_scrubTimer, &QTimer::timeout, this, &AdvancedVideoPlayer::onScrubTimeout);
+
     loadSettings();
     updateButtonStates();
+#ifdef PLAYER_MPRIS
+    setupMpris();
+#endif
 }
 
 AdvancedVideoPlayer::~AdvancedVideoPlayer()
@@ -44,6 +63,64 @@ AdvancedVideoPlayer::~AdvancedVideoPlayer()
     saveSettings();
 }
 
+bool AdvancedVideoPlayer::startControlServer(const QString &name, QString *errorString)
+{
+    if (!m_controlServer) {
+        m_controlServer = new ControlServer(m_engine, m_playlistWidget->controller(), this);
+        connect(m_controlServer, &ControlServer::playRequested, this, &AdvancedVideoPlayer::play);
+        connect(m_controlServer, &ControlServer::pauseRequested, this, &AdvancedVideoPlayer::pause);
+        connect(m_controlServer, &ControlServer::stopRequested, this, &AdvancedVideoPlayer::stop);
+        connect(m_controlServer, &ControlServer::nextRequested, this, &AdvancedVideoPlayer::next);
+        connect(m_controlServer, &ControlServer::previousRequested, this, &AdvancedVideoPlayer::previous);
+    }
+
+    if (m_controlServer->isListening()) {
+        m_controlServer->close();
+    }
+    return m_controlServer->listen(name, errorString);
+}
+
+#ifdef PLAYER_MPRIS
+void AdvancedVideoPlayer::setupMpris()
+{
+    m_mprisService = new MprisService(m_engine, m_playlistWidget->controller(), this);
+    connect(m_mprisService, &MprisService::playRequested, this, &AdvancedVideoPlayer::play);
+    connect(m_mprisService, &MprisService::pauseRequested, this, &AdvancedVideoPlayer::pause);
+    connect(m_mprisService, &MprisService::stopRequested, this, &AdvancedVideoPlayer::stop);
+    connect(m_mprisService, &MprisService::nextRequested, this, &AdvancedVideoPlayer::next);
+    connect(m_mprisService, &MprisService::previousRequested, this, &AdvancedVideoPlayer::previous);
+    connect(m_mprisService, &MprisService::volumeRequested, this, [this](double volume) {
+        m_volumeSlider->setValue(qRound(volume * 100));
+    });
+    connect(m_mprisService, &MprisService::rateRequested, this, [this](double rate) {
+        // 速度只能取下拉框中的值，选最接近的一项
+        static const QList<qreal> speeds = {0.5, 0.75, 1.0, 1.25, 1.5, 2.0};
+        int nearest = 0;
+        for (int i = 1; i < speeds.size(); ++i) {
+            if (qAbs(speeds[i] - rate) < qAbs(speeds[nearest] - rate)) {
+                nearest = i;
+            }
+        }
+        m_speedComboBox->setCurrentIndex(nearest);
+    });
+    connect(m_mprisService, &MprisService::raiseRequested, this, [this]() {
+        show();
+        raise();
+        activateWindow();
+    });
+    connect(m_mprisService, &MprisService::quitRequested, this, &AdvancedVideoPlayer::close);
+
+    m_mprisService->setVolume(m_volume / 100.0);
+    m_mprisService->setRate(m_engine->playbackRate());
+
+    // 没有会话总线（如无桌面环境）时只是没有媒体键控制，不影响播放
+    QString error;
+    if (!m_mprisService->registerOn(QDBusConnection::sessionBus(), &error)) {
+        qWarning() << "MPRIS unavailable:" << error;
+    }
+}
+#endif
+
 void AdvancedVideoPlayer::setupUI()
 {
     m_centralWidget = new QWidget();
@@ -184,12 +261,14 @@ void AdvancedVideoPlayer::setupControlPanel()
 
 void AdvancedVideoPlayer::setupMediaPlayer()
 {
-    m_mediaPlayer = new QMediaPlayer(this);
-    m_audioOutput = new QAudioOutput(this);
-
-    m_audioOutput->setVolume(m_volume / 100.0);
-    m_mediaPlayer->setAudioOutput(m_audioOutput);
-    m_mediaPlayer->setVideoOutput(m_videoWidget);
+    m_engine = new PlaybackEngine(this);
+    m_engine->setVolume(m_volume / 100.0);
+    m_engine->setVideoSink(m_videoWidget->videoSink());
+
+    m_keyframeIndexer = new KeyframeIndexer(this);
+    m_scrubPreview = new ScrubPreview(m_keyframeIndexer, this);
+    m_thumbnailGenerator = new ThumbnailSpriteGenerator(m_keyframeIndexer, this);
+    m_performanceOverlay = new PerformanceOverlay(m_engine, m_videoWidget);
 }
 
 void AdvancedVideoPlayer::setupMenus()
@@ -199,16 +278,20 @@ void AdvancedVideoPlayer::setupMenus()
 
     fileMenu->addAction("打开文件(&O)", this, &AdvancedVideoPlayer::openFile, QKeySequence::Open);
     fileMenu->addAction("打开文件夹(&D)", this, &AdvancedVideoPlayer::openFolder, QKeySequence("Ctrl+D"));
+    fileMenu->addAction("停止扫描文件夹(&T)", this, [this]() {
+        m_playlistWidget->cancelFolderScan();
+    });
     fileMenu->addSeparator();
     fileMenu->addAction("导入播放列表(&I)", this, &AdvancedVideoPlayer::importPlaylist);
     fileMenu->addAction("导出播放列表(&E)", this, &AdvancedVideoPlayer::exportPlaylist);
+    fileMenu->addAction("导出性能跟踪(&R)...", this, &AdvancedVideoPlayer::exportTrace);
     fileMenu->addSeparator();
     fileMenu->addAction("退出(&X)", this, &QWidget::close, QKeySequence::Quit);
 
     // 播放菜单
     QMenu *playMenu = menuBar()->addMenu("播放(&P)");
     playMenu->addAction("播放/暂停(&P)", this, [this]() {
-        if (m_mediaPlayer->playbackState() == QMediaPlayer::PlayingState) {
+        if (m_engine->playbackState() == QMediaPlayer::PlayingState) {
             pause();
         } else {
             play();
@@ -218,6 +301,21 @@ void AdvancedVideoPlayer::setupMenus()
     playMenu->addSeparator();
     playMenu->addAction("上一个(&R)", this, &AdvancedVideoPlayer::previous, QKeySequence("Ctrl+Left"));
     playMenu->addAction("下一个(&N)", this, &AdvancedVideoPlayer::next, QKeySequence("Ctrl+Right"));
+    playMenu->addSeparator();
+
+    // 淡入淡出（只对前后两项都是音频文件时生效）
+    QMenu *crossfadeMenu = playMenu->addMenu("淡入淡出(&C)");
+    m_crossfadeGroup = new QActionGroup(this);
+    static const QList<int> crossfadeSeconds = {0, 2, 5, 8, 12};
+    for (int seconds : crossfadeSeconds) {
+        QAction *action = crossfadeMenu->addAction(seconds == 0 ? QString("关闭") : QString("%1 秒").arg(seconds));
+        action->setCheckable(true);
+        action->setData(seconds * 1000);
+        m_crossfadeGroup->addAction(action);
+    }
+    connect(m_crossfadeGroup, &QActionGroup::triggered, this, [this](QAction *action) {
+        m_engine->setCrossfadeDuration(action->data().toInt());
+    });
 
     // 视图菜单
     QMenu *viewMenu = menuBar()->addMenu("视图(&V)");
@@ -228,6 +326,9 @@ void AdvancedVideoPlayer::setupMenus()
     playlistAction->setCheckable(true);
     playlistAction->setChecked(m_playlistVisible);
 
+    m_performanceAction = viewMenu->addAction("性能信息(&I)", this, &AdvancedVideoPlayer::onPerformanceOverlayToggled);
+    m_performanceAction->setCheckable(true);
+
     // 帮助菜单
     QMenu *helpMenu = menuBar()->addMenu("帮助(&H)");
     helpMenu->addAction("关于(&A)", this, &AdvancedVideoPlayer::showAbout);
@@ -236,16 +337,24 @@ void AdvancedVideoPlayer::setupMenus()
 void AdvancedVideoPlayer::setupStatusBar()
 {
     statusBar()->showMessage("就绪");
+
+    // 元数据缓存命中统计（常驻，不被临时消息覆盖）
+    m_cacheStatsLabel = new QLabel();
+    m_cacheStatsLabel->setStyleSheet("color: #aaa;");
+    statusBar()->addPermanentWidget(m_cacheStatsLabel);
+    onMetadataCacheStatsChanged(m_playlistWidget->metadataCache().hits(),
+                                m_playlistWidget->metadataCache().misses());
 }
 
 void AdvancedVideoPlayer::setupConnections()
 {
     // 媒体播放器连接
-    connect(m_mediaPlayer, &QMediaPlayer::playbackStateChanged, this, &AdvancedVideoPlayer::onMediaStateChanged);
-    connect(m_mediaPlayer, &QMediaPlayer::mediaStatusChanged, this, &AdvancedVideoPlayer::onMediaStatusChanged);
-    connect(m_mediaPlayer, &QMediaPlayer::positionChanged, this, &AdvancedVideoPlayer::onPositionChanged);
-    connect(m_mediaPlayer, &QMediaPlayer::durationChanged, this, &AdvancedVideoPlayer::onDurationChanged);
-    connect(m_mediaPlayer, &QMediaPlayer::errorOccurred, this, &AdvancedVideoPlayer::onMediaError);
+    connect(m_engine, &PlaybackEngine::playbackStateChanged, this, &AdvancedVideoPlayer::onMediaStateChanged);
+    connect(m_engine, &PlaybackEngine::mediaStatusChanged, this, &AdvancedVideoPlayer::onMediaStatusChanged);
+    connect(m_engine, &PlaybackEngine::positionChanged, this, &AdvancedVideoPlayer::onPositionChanged);
+    connect(m_engine, &PlaybackEngine::durationChanged, this, &AdvancedVideoPlayer::onDurationChanged);
+    connect(m_engine, &PlaybackEngine::errorOccurred, this, &AdvancedVideoPlayer::onMediaError);
+    connect(m_engine, &PlaybackEngine::crossfadeRequested, this, &AdvancedVideoPlayer::next);
 
     // 控制按钮连接
     connect(m_openButton, &QPushButton::clicked, this, &AdvancedVideoPlayer::openFile);
@@ -262,6 +371,10 @@ void AdvancedVideoPlayer::setupConnections()
     connect(m_positionSlider, &QSlider::sliderPressed, this, &AdvancedVideoPlayer::onPositionSliderPressed);
     connect(m_positionSlider, &QSlider::sliderReleased, this, &AdvancedVideoPlayer::onPositionSliderReleased);
     connect(m_positionSlider, &QSlider::sliderMoved, this, &AdvancedVideoPlayer::onPositionSliderMoved);
+
+    // 悬停缩略图
+    m_positionSlider->setMouseTracking(true);
+    m_positionSlider->installEventFilter(this);
     connect(m_volumeSlider, &QSlider::valueChanged, this, &AdvancedVideoPlayer::onVolumeChanged);
 
     // 速度控制连接
@@ -274,6 +387,9 @@ void AdvancedVideoPlayer::setupConnections()
     connect(m_playlistWidget, &PlaylistWidget::requestPlay, this, &AdvancedVideoPlayer::onPlayRequested);
     connect(m_playlistWidget, &PlaylistWidget::requestNext, this, &AdvancedVideoPlayer::onNextRequested);
     connect(m_playlistWidget, &PlaylistWidget::requestPrevious, this, &AdvancedVideoPlayer::onPreviousRequested);
+    connect(m_playlistWidget, &PlaylistWidget::metadataCacheStatsChanged, this, &AdvancedVideoPlayer::onMetadataCacheStatsChanged);
+    connect(m_playlistWidget, &PlaylistWidget::folderScanProgress, this, &AdvancedVideoPlayer::onFolderScanProgress);
+    connect(m_playlistWidget, &PlaylistWidget::folderScanFinished, this, &AdvancedVideoPlayer::onFolderScanFinished);
 
     // 快捷键管理器
     m_shortcutManager = new ShortcutManager(this);
@@ -339,7 +455,7 @@ void AdvancedVideoPlayer::applyStyles()
 // 播放控制实现
 void AdvancedVideoPlayer::play()
 {
-    if (m_mediaPlayer->source().isEmpty()) {
+    if (m_engine->source().isEmpty()) {
         if (m_playlistWidget->getMediaCount() > 0) {
             m_playlistWidget->setCurrentIndex(0);
             return;
@@ -349,7 +465,7 @@ void AdvancedVideoPlayer::play()
         }
     }
 
-    m_mediaPlayer->play();
+    m_engine->play();
 
     if (m_isFullScreen) {
         m_fullscreenHideTimer->start(3000); // 3秒后隐藏控制面板
@@ -358,13 +474,13 @@ void AdvancedVideoPlayer::play()
 
 void AdvancedVideoPlayer::pause()
 {
-    m_mediaPlayer->pause();
+    m_engine->pause();
     m_fullscreenHideTimer->stop();
 }
 
 void AdvancedVideoPlayer::stop()
 {
-    m_mediaPlayer->stop();
+    m_engine->stop();
     m_fullscreenHideTimer->stop();
 }
 
@@ -404,29 +520,26 @@ void AdvancedVideoPlayer::openFolder()
     if (!folderPath.isEmpty()) {
         QSettings().setValue("lastOpenDir", folderPath);
 
-        QDir directory(folderPath);
-        QStringList formats = m_playlistWidget->getSupportedFormats();
-        QStringList filters;
-        for (const QString &format : formats) {
-            filters << QString("*.%1").arg(format);
-        }
-
-        QFileInfoList files = directory.entryInfoList(filters, QDir::Files, QDir::Name);
+        // 递归扫描在后台进行，结果分批加入播放列表，完成时在 onFolderScanFinished 中提示
+        m_playlistWidget->addFolders(QStringList() << folderPath);
+        statusBar()->showMessage("正在扫描文件夹...");
+    }
+}
 
-        QStringList filePaths;
-        for (const QFileInfo &fileInfo : files) {
-            filePaths.append(fileInfo.absoluteFilePath());
-        }
+void AdvancedVideoPlayer::onFolderScanProgress(int directories, int files)
+{
+    statusBar()->showMessage(QString("正在扫描: %1 个文件夹，找到 %2 个文件").arg(directories).arg(files));
+}
 
-        if (!filePaths.isEmpty()) {
-            m_playlistWidget->addMediaList(filePaths);
-            if (m_playlistWidget->currentIndex() == -1) {
-                m_playlistWidget->setCurrentIndex(0);
-            }
-            showNotification(QString("从文件夹添加了 %1 个文件").arg(filePaths.size()));
-        } else {
-            showNotification("文件夹中未找到支持的媒体文件");
-        }
+void AdvancedVideoPlayer::onFolderScanFinished(int files, bool cancelled)
+{
+    statusBar()->clearMessage();
+    if (cancelled) {
+        showNotification(QString("已停止扫描，找到 %1 个文件").arg(files));
+    } else if (files > 0) {
+        showNotification(QString("从文件夹添加了 %1 个文件").arg(files));
+    } else {
+        showNotification("文件夹中未找到支持的媒体文件");
     }
 }
 
@@ -454,6 +567,9 @@ void AdvancedVideoPlayer::onMediaStateChanged(QMediaPlayer::PlaybackState state)
 {
     updateButtonStates();
 
+    // 播放时缩略图放慢生成，不与播放争抢解码
+    m_thumbnailGenerator->setThrottled(state == QMediaPlayer::PlayingState);
+
     switch (state) {
     case QMediaPlayer::PlayingState:
         statusBar()->showMessage("正在播放");
@@ -469,6 +585,7 @@ void AdvancedVideoPlayer::onMediaStateChanged(QMediaPlayer::PlaybackState state)
 
 void AdvancedVideoPlayer::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
 {
+    PLAYER_TRACE_SCOPE_ARG("AdvancedVideoPlayer::onMediaStatusChanged", "status", status);
     switch (status) {
     case QMediaPlayer::LoadingMedia:
         statusBar()->showMessage("加载中...");
@@ -478,12 +595,14 @@ void AdvancedVideoPlayer::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
         statusBar()->showMessage("媒体已加载");
         m_bufferProgress->hide();
         updateMediaInfo();
+        requestThumbnails();
         break;
     case QMediaPlayer::BufferingMedia:
         m_bufferProgress->show();
         break;
     case QMediaPlayer::BufferedMedia:
         m_bufferProgress->hide();
+        requestThumbnails();  // 切换到预加载的项目时不会再经过 LoadedMedia
         break;
     case QMediaPlayer::EndOfMedia:
         next(); // 自动播放下一个
@@ -499,16 +618,16 @@ void AdvancedVideoPlayer::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
 
 void AdvancedVideoPlayer::onPositionChanged(qint64 position)
 {
-    if (!m_sliderPressed) {
-        m_positionSlider->setValue(position);
-    }
-    updateTimeLabels(position, m_mediaPlayer->duration());
+    // 最小化时不刷新，恢复窗口时补一次；同一刷新间隔内的多次通知只刷新一次界面
+    m_progressThrottle->setInterval(progressInterval());
+    m_progressThrottle->setSuspended(isMinimized() || !isVisible());
+    m_progressThrottle->post(position);
 }
 
 void AdvancedVideoPlayer::onDurationChanged(qint64 duration)
 {
     m_positionSlider->setRange(0, duration);
-    updateTimeLabels(m_mediaPlayer->position(), duration);
+    updateTimeLabels(m_engine->position(), duration);
 }
 
 void AdvancedVideoPlayer::onMediaError(QMediaPlayer::Error error, const QString &errorString)
@@ -540,8 +659,13 @@ void AdvancedVideoPlayer::onMediaError(QMediaPlayer::Error error, const QString
 void AdvancedVideoPlayer::onVolumeChanged(int volume)
 {
     m_volume = volume;
-    m_audioOutput->setVolume(volume / 100.0);
+    m_engine->setVolume(volume / 100.0);
     updateVolumeDisplay();
+#ifdef PLAYER_MPRIS
+    if (m_mprisService) {
+        m_mprisService->setVolume(volume / 100.0);
+    }
+#endif
 
     if (volume > 0 && m_isMuted) {
         m_isMuted = false;
@@ -556,34 +680,101 @@ void AdvancedVideoPlayer::onPositionSliderPressed()
 
 void AdvancedVideoPlayer::onPositionSliderReleased()
 {
+    PLAYER_TRACE_SCOPE("AdvancedVideoPlayer::onPositionSliderReleased");
     m_sliderPressed = false;
-    m_mediaPlayer->setPosition(m_positionSlider->value());
+
+    // 松开时精确跳转
+    m_scrubTimer->stop();
+    m_scrubTarget = -1;
+    m_engine->setPosition(m_positionSlider->value());
+
+    if (m_scrubPreview->isVisible()) {
+        m_scrubPreview->hidePreview();
+        if (m_scrubPreview->deliveredCount() > 0) {
+            statusBar()->showMessage(QString("拖动预览: %1 帧/秒，最大延迟 %2 ms")
+                                         .arg(m_scrubPreview->framesPerSecond(), 0, 'f', 1)
+                                         .arg(m_scrubPreview->worstLatency()), 3000);
+        }
+    }
 }
 
 void AdvancedVideoPlayer::onPositionSliderMoved(int position)
 {
-    if (m_sliderPressed) {
-        updateTimeLabels(position, m_mediaPlayer->duration());
+    if (!m_sliderPressed) {
+        return;
+    }
+    updateTimeLabels(position, m_engine->duration());
+
+    if (m_engine->hasVideo()) {
+        QString filePath = m_engine->source().toLocalFile();
+        const ThumbnailSprite *sprite = m_thumbnailGenerator->sprite(filePath);
+        int x = QStyle::sliderPositionFromValue(m_positionSlider->minimum(), m_positionSlider->maximum(),
+                                                position, m_positionSlider->width());
+        m_scrubPreview->showAt(filePath, position, formatTime(position),
+                               m_positionSlider->mapToGlobal(QPoint(x, 0)),
+                               sprite ? sprite->tileAt(position) : QImage());
+    }
+
+    // 有关键帧索引时拖动中跳到最近的关键帧，不必从关键帧解码到任意位置；
+    // 没有索引的文件仍只在松开时跳转
+    const KeyframeIndex *index = m_keyframeIndexer->index(m_engine->source().toLocalFile());
+    if (!index || index->isEmpty()) {
+        return;
+    }
+
+    m_scrubTarget = index->nearest(position);
+    if (!m_scrubTimer->isActive()) {
+        scrubSeek();
+        m_scrubTimer->start();
+    }
+}
+
+void AdvancedVideoPlayer::onScrubTimeout()
+{
+    // 间隔内最后一次拖动的位置
+    if (m_scrubTarget >= 0) {
+        scrubSeek();
+        m_scrubTimer->start();
     }
 }
 
+void AdvancedVideoPlayer::scrubSeek()
+{
+    PLAYER_TRACE_SCOPE_ARG("AdvancedVideoPlayer::scrubSeek", "position", m_scrubTarget);
+    if (m_scrubTarget >= 0) {
+        m_engine->setPosition(m_scrubTarget);
+        m_scrubTarget = -1;
+    }
+}
+
+qint64 AdvancedVideoPlayer::snapToKeyframe(qint64 position) const
+{
+    const KeyframeIndex *index = m_keyframeIndexer->index(m_engine->source().toLocalFile());
+    return index ? index->nearest(position) : position;
+}
+
 void AdvancedVideoPlayer::onSpeedChanged(int index)
 {
     static const QList<qreal> speeds = {0.5, 0.75, 1.0, 1.25, 1.5, 2.0};
     if (index >= 0 && index < speeds.size()) {
-        m_mediaPlayer->setPlaybackRate(speeds[index]);
+        m_engine->setPlaybackRate(speeds[index]);
+#ifdef PLAYER_MPRIS
+        if (m_mprisService) {
+            m_mprisService->setRate(speeds[index]);
+        }
+#endif
     }
 }
 
 void AdvancedVideoPlayer::onMuteToggled()
 {
     if (m_isMuted) {
-        m_audioOutput->setMuted(false);
+        m_engine->setMuted(false);
         m_volumeSlider->setValue(m_volume);
         m_muteButton->setText("🔊");
         m_isMuted = false;
     } else {
-        m_audioOutput->setMuted(true);
+        m_engine->setMuted(true);
         m_muteButton->setText("🔇");
         m_isMuted = true;
     }
@@ -605,12 +796,19 @@ void AdvancedVideoPlayer::onFullScreenToggled()
         statusBar()->hide();
         m_isFullScreen = true;
         m_fullscreenButton->setText("窗口");
-        if (m_mediaPlayer->playbackState() == QMediaPlayer::PlayingState) {
+        if (m_engine->playbackState() == QMediaPlayer::PlayingState) {
             m_fullscreenHideTimer->start(3000);
         }
     }
 }
 
+void AdvancedVideoPlayer::onPerformanceOverlayToggled()
+{
+    bool enabled = !m_performanceOverlay->isOverlayEnabled();
+    m_performanceOverlay->setOverlayEnabled(enabled);
+    m_performanceAction->setChecked(enabled);
+}
+
 void AdvancedVideoPlayer::onPlaylistToggled()
 {
     m_playlistVisible = !m_playlistVisible;
@@ -621,13 +819,17 @@ void AdvancedVideoPlayer::onPlaylistToggled()
 // 播放列表事件
 void AdvancedVideoPlayer::onMediaSelected(int index)
 {
+    PLAYER_TRACE_SCOPE_ARG("AdvancedVideoPlayer::onMediaSelected", "index", index);
     if (index >= 0) {
         MediaInfo info = m_playlistWidget->getMediaAt(index);
         QUrl mediaUrl = QUrl::fromLocalFile(info.filePath);
-        m_mediaPlayer->setSource(mediaUrl);
+        m_engine->setSource(mediaUrl);
+        m_keyframeIndexer->request(info.filePath);
+        m_thumbnailGenerator->cancel();
         updateMediaInfo();
+        preloadNext();
     } else {
-        m_mediaPlayer->setSource(QUrl());
+        m_engine->setSource(QUrl());
         updateMediaInfo();
     }
 }
@@ -636,11 +838,19 @@ void AdvancedVideoPlayer::onPlayModeChanged(PlaylistWidget::PlayMode mode)
 {
     static const QStringList modeNames = {"顺序播放", "列表循环", "随机播放", "单曲循环"};
     showNotification(QString("播放模式: %1").arg(modeNames[static_cast<int>(mode)]));
+    preloadNext();
 }
 
 void AdvancedVideoPlayer::onPlaylistChanged()
 {
+    PLAYER_TRACE_SCOPE("AdvancedVideoPlayer::onPlaylistChanged");
     updateButtonStates();
+    preloadNext();
+}
+
+void AdvancedVideoPlayer::onMetadataCacheStatsChanged(int hits, int misses)
+{
+    m_cacheStatsLabel->setText(QString("元数据缓存: 命中 %1 / 未命中 %2").arg(hits).arg(misses));
 }
 
 void AdvancedVideoPlayer::onPlayRequested()
@@ -663,7 +873,7 @@ void AdvancedVideoPlayer::onShortcutTriggered(PlayerAction action)
 {
     switch (action) {
     case PlayerAction::PlayPause:
-        if (m_mediaPlayer->playbackState() == QMediaPlayer::PlayingState) {
+        if (m_engine->playbackState() == QMediaPlayer::PlayingState) {
             pause();
         } else {
             play();
@@ -680,15 +890,15 @@ void AdvancedVideoPlayer::onShortcutTriggered(PlayerAction action)
         break;
     case PlayerAction::SeekForward:
     {
-        qint64 pos = m_mediaPlayer->position();
-        m_mediaPlayer->setPosition(qMin(pos + 10000, m_mediaPlayer->duration()));
+        qint64 pos = m_engine->position();
+        m_engine->setPosition(qMin(pos + 10000, m_engine->duration()));
         showNotification("快进 10 秒", 1000);
     }
     break;
     case PlayerAction::SeekBackward:
     {
-        qint64 pos = m_mediaPlayer->position();
-        m_mediaPlayer->setPosition(qMax(pos - 10000, 0LL));
+        qint64 pos = m_engine->position();
+        m_engine->setPosition(qMax(pos - 10000, 0LL));
         showNotification("快退 10 秒", 1000);
     }
     break;
@@ -707,6 +917,9 @@ void AdvancedVideoPlayer::onShortcutTriggered(PlayerAction action)
     case PlayerAction::ShowPlaylist:
         onPlaylistToggled();
         break;
+    case PlayerAction::TogglePerformanceOverlay:
+        onPerformanceOverlayToggled();
+        break;
     case PlayerAction::OpenFile:
         openFile();
         break;
@@ -732,13 +945,22 @@ void AdvancedVideoPlayer::onShortcutTriggered(PlayerAction action)
 }
 
 // 定时器事件
-void AdvancedVideoPlayer::updateProgress()
+void AdvancedVideoPlayer::updateProgress(qint64 position)
 {
-    if (!m_sliderPressed && m_mediaPlayer->duration() > 0) {
-        m_positionSlider->setValue(m_mediaPlayer->position());
+    // 拖动时滑块和时间标签跟随鼠标
+    if (!m_sliderPressed) {
+        m_positionSlider->setValue(position);
+        updateTimeLabels(position, m_engine->duration());
     }
 }
 
+int AdvancedVideoPlayer::progressInterval() const
+{
+    QScreen *currentScreen = screen();
+    qreal refreshRate = currentScreen ? currentScreen->refreshRate() : 60.0;
+    return qMax(1, qRound(1000.0 / qMax<qreal>(1.0, refreshRate)));
+}
+
 void AdvancedVideoPlayer::hideControlsInFullscreen()
 {
     if (m_isFullScreen) {
@@ -769,7 +991,7 @@ void AdvancedVideoPlayer::showAbout()
 void AdvancedVideoPlayer::exportPlaylist()
 {
     QString fileName = QFileDialog::getSaveFileName(this, "导出播放列表", "",
-                                                    "M3U播放列表 (*.m3u);;PLS播放列表 (*.pls)");
+                                                    "M3U播放列表 (*.m3u);;PLS播放列表 (*.pls);;JSON播放列表 (*.json)");
 
     if (!fileName.isEmpty()) {
         QString format = QFileInfo(fileName).suffix().toLower();
@@ -778,10 +1000,31 @@ void AdvancedVideoPlayer::exportPlaylist()
     }
 }
 
+void AdvancedVideoPlayer::exportTrace()
+{
+    if (!Tracer::isEnabled()) {
+        QMessageBox::information(this, "导出性能跟踪", "此版本编译时未启用跟踪（PLAYER_TRACING）。");
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(this, "导出性能跟踪", "trace.json",
+                                                    "Chrome 跟踪文件 (*.json)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QString error;
+    if (Tracer::exportChromeTrace(fileName, &error)) {
+        showNotification("性能跟踪已导出，可在 chrome://tracing 或 Perfetto 中打开");
+    } else {
+        QMessageBox::warning(this, "导出性能跟踪", "无法写入文件: " + error);
+    }
+}
+
 void AdvancedVideoPlayer::importPlaylist()
 {
     QString fileName = QFileDialog::getOpenFileName(this, "导入播放列表", "",
-                                                    "播放列表文件 (*.m3u *.pls);;所有文件 (*.*)");
+                                                    "播放列表文件 (*.m3u *.m3u8 *.pls *.json);;所有文件 (*.*)");
 
     if (!fileName.isEmpty()) {
         m_playlistWidget->importPlaylist(fileName);
@@ -797,10 +1040,11 @@ void AdvancedVideoPlayer::keyPressEvent(QKeyEvent *event)
         int percentage = (event->key() - Qt::Key_0) * 10;
         if (percentage == 0) percentage = 100;
 
-        qint64 duration = m_mediaPlayer->duration();
+        qint64 duration = m_engine->duration();
         if (duration > 0) {
-            qint64 position = (duration * percentage) / 100;
-            m_mediaPlayer->setPosition(position);
+            // 按百分比跳转本身是近似位置，落在关键帧上可以立即显示
+            qint64 position = snapToKeyframe((duration * percentage) / 100);
+            m_engine->setPosition(position);
             showNotification(QString("跳转到 %1%").arg(percentage), 1000);
         }
         return;
@@ -815,6 +1059,35 @@ void AdvancedVideoPlayer::keyPressEvent(QKeyEvent *event)
     QMainWindow::keyPressEvent(event);
 }
 
+bool AdvancedVideoPlayer::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_positionSlider && !m_sliderPressed) {
+        if (event->type() == QEvent::MouseMove) {
+            // 悬停时显示拼图中的缩略图，不解码
+            const ThumbnailSprite *sprite = m_thumbnailGenerator->sprite(m_engine->source().toLocalFile());
+            if (sprite) {
+                int x = static_cast<QMouseEvent *>(event)->position().toPoint().x();
+                qint64 position = QStyle::sliderValueFromPosition(m_positionSlider->minimum(), m_positionSlider->maximum(),
+                                                                  x, m_positionSlider->width());
+                m_scrubPreview->showThumbnail(sprite->tileAt(position), formatTime(position),
+                                              m_positionSlider->mapToGlobal(QPoint(x, 0)));
+            }
+        } else if (event->type() == QEvent::Leave) {
+            m_scrubPreview->hidePreview();
+        }
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void AdvancedVideoPlayer::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::WindowStateChange) {
+        // 最小化期间只记下位置，恢复时补送最后一个
+        m_progressThrottle->setSuspended(isMinimized());
+    }
+    QMainWindow::changeEvent(event);
+}
+
 void AdvancedVideoPlayer::mouseDoubleClickEvent(QMouseEvent *event)
 {
     if (event->button() == Qt::LeftButton) {
@@ -832,7 +1105,7 @@ void AdvancedVideoPlayer::closeEvent(QCloseEvent *event)
 // 辅助方法
 void AdvancedVideoPlayer::updateButtonStates()
 {
-    QMediaPlayer::PlaybackState state = m_mediaPlayer->playbackState();
+    QMediaPlayer::PlaybackState state = m_engine->playbackState();
 
     m_playButton->setEnabled(state != QMediaPlayer::PlayingState);
     m_pauseButton->setEnabled(state == QMediaPlayer::PlayingState);
@@ -869,6 +1142,26 @@ void AdvancedVideoPlayer::updateMediaInfo()
     }
 }
 
+void AdvancedVideoPlayer::preloadNext()
+{
+    PLAYER_TRACE_SCOPE("AdvancedVideoPlayer::preloadNext");
+    // 下一项随当前项、播放模式和列表内容变化，每次变化后重新预加载
+    int current = m_playlistWidget->currentIndex();
+    int nextIndex = m_playlistWidget->getNextIndex();
+    if (current >= 0 && nextIndex >= 0 && nextIndex != current) {
+        m_engine->preload(QUrl::fromLocalFile(m_playlistWidget->getMediaAt(nextIndex).filePath));
+    } else {
+        m_engine->clearPreload();
+    }
+}
+
+void AdvancedVideoPlayer::requestThumbnails()
+{
+    if (m_engine->hasVideo() && m_engine->duration() > 0) {
+        m_thumbnailGenerator->generate(m_engine->source().toLocalFile(), m_engine->duration());
+    }
+}
+
 void AdvancedVideoPlayer::saveSettings()
 {
     QSettings settings;
@@ -876,6 +1169,7 @@ void AdvancedVideoPlayer::saveSettings()
     settings.setValue("geometry", saveGeometry());
     settings.setValue("windowState", saveState());
     settings.setValue("volume", m_volume);
+    settings.setValue("crossfade", m_engine->crossfadeDuration());
     settings.setValue("playlistVisible", m_playlistVisible);
     settings.setValue("splitterState", m_mainSplitter->saveState());
     settings.endGroup();
@@ -890,9 +1184,19 @@ void AdvancedVideoPlayer::loadSettings()
 
     m_volume = settings.value("volume", 50).toInt();
     m_volumeSlider->setValue(m_volume);
-    m_audioOutput->setVolume(m_volume / 100.0);
+    m_engine->setVolume(m_volume / 100.0);
     updateVolumeDisplay();
 
+    int crossfade = settings.value("crossfade", 0).toInt();
+    m_engine->setCrossfadeDuration(crossfade);
+    for (QAction *action : m_crossfadeGroup->actions()) {
+        action->setChecked(action->data().toInt() == crossfade);
+    }
+    if (!m_crossfadeGroup->checkedAction()) {
+        m_engine->setCrossfadeDuration(0);
+        m_crossfadeGroup->actions().first()->setChecked(true);
+    }
+
     m_playlistVisible = settings.value("playlistVisible", true).toBool();
     m_playlistWidget->setVisible(m_playlistVisible);
     m_playlistButton->setText(m_playlistVisible ? "隐藏" : "列表");
@@ -24,9 +24,20 @@
 #include <QMenuBar>
 #include <QStatusBar>
 #include <QApplication>
+#include <QActionGroup>
 
 #include "PlaylistWidget.h"
 #include "ShortcutManager.h"
+#include "PlaybackEngine.h"
+#include "ProgressThrottle.h"
+#include "KeyframeIndex.h"
+#include "ScrubPreview.h"
+#include "ThumbnailSprite.h"
+#include "PerformanceOverlay.h"
+#include "ControlServer.h"
+#ifdef PLAYER_MPRIS
+#include "MprisService.h"
+#endif
 
 class AdvancedVideoPlayer : public QMainWindow
 {
@@ -36,10 +47,16 @@ public:
     AdvancedVideoPlayer(QWidget *parent = nullptr);
     ~AdvancedVideoPlayer();
 
+    // 在本机控制接口上监听，供脚本遥控播放（见 ControlServer）
+    bool startControlServer(const QString &name = ControlServer::defaultServerName(),
+                            QString *errorString = nullptr);
+
 protected:
     void keyPressEvent(QKeyEvent *event) override;
     void mouseDoubleClickEvent(QMouseEvent *event) override;
     void closeEvent(QCloseEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void changeEvent(QEvent *event) override;
     void setupControlPanel();
 private slots:
     // 播放控制
@@ -63,10 +80,12 @@ private slots:
     void onPositionSliderPressed();
     void onPositionSliderReleased();
     void onPositionSliderMoved(int position);
+    void onScrubTimeout();
     void onSpeedChanged(int index);
     void onMuteToggled();
     void onFullScreenToggled();
     void onPlaylistToggled();
+    void onPerformanceOverlayToggled();
 
     // 播放列表事件
     void onMediaSelected(int index);
@@ -75,24 +94,35 @@ private slots:
     void onPlayRequested();
     void onNextRequested();
     void onPreviousRequested();
+    void onMetadataCacheStatsChanged(int hits, int misses);
+    void onFolderScanProgress(int directories, int files);
+    void onFolderScanFinished(int files, bool cancelled);
 
     // 快捷键事件
     void onShortcutTriggered(PlayerAction action);
 
     // 定时器事件
-    void updateProgress();
+    void updateProgress(qint64 position);
     void hideControlsInFullscreen();
 
     // 菜单事件
     void showAbout();
     void exportPlaylist();
     void importPlaylist();
+    void exportTrace();
 
 private:
     // 核心组件
-    QMediaPlayer *m_mediaPlayer;
+    PlaybackEngine *m_engine;         // 双播放器，提前打开下一项
+    KeyframeIndexer *m_keyframeIndexer;
+    ScrubPreview *m_scrubPreview;     // 拖动进度条时的预览画面
+    ThumbnailSpriteGenerator *m_thumbnailGenerator;
+    PerformanceOverlay *m_performanceOverlay;   // 视频画面上的性能信息
+    ControlServer *m_controlServer;   // 按需创建
+#ifdef PLAYER_MPRIS
+    MprisService *m_mprisService;     // 桌面媒体控制（MPRIS）
+#endif
     QVideoWidget *m_videoWidget;
-    QAudioOutput *m_audioOutput;
     PlaylistWidget *m_playlistWidget;
     ShortcutManager *m_shortcutManager;
     // UI组件
@@ -120,8 +150,11 @@ private:
     QLabel *m_totalTimeLabel;
     QLabel *m_volumeLabel;
     QLabel *m_mediaInfoLabel;
+    QLabel *m_cacheStatsLabel;
 
     QProgressBar *m_bufferProgress;
+    QActionGroup *m_crossfadeGroup;
+    QAction *m_performanceAction;
 
     // 状态变量
     bool m_isFullScreen;
@@ -131,8 +164,12 @@ private:
     int m_volume;
 
     // 定时器
-    QTimer *m_progressTimer;
     QTimer *m_fullscreenHideTimer;
+    QTimer *m_scrubTimer;             // 拖动时限制跳转频率
+    qint64 m_scrubTarget;             // 等待跳转的关键帧位置，-1 表示没有
+
+    // 进度更新：位置通知合并到屏幕刷新间隔
+    ProgressThrottle *m_progressThrottle;
 
     // 私有方法
     void setupUI();
@@ -144,11 +181,19 @@ private:
 
     void updateButtonStates();
     void updateTimeLabels(qint64 current, qint64 total);
+    int progressInterval() const;
     void updateVolumeDisplay();
     void updateMediaInfo();
+    void preloadNext();
+    void requestThumbnails();
+    void scrubSeek();
+    qint64 snapToKeyframe(qint64 position) const;
 
     void saveSettings();
     void loadSettings();
+#ifdef PLAYER_MPRIS
+    void setupMpris();
+#endif
 
     QString formatTime(qint64 milliseconds) const;
     void showNotification(const QString &message, int duration = 2000);
@@ -0,0 +1,188 @@
+// PerformanceOverlay.cpp
+#include "PerformanceOverlay.h"
+#include <QPainter>
+#include <QFontDatabase>
+#include <QFile>
+#include <QElapsedTimer>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+namespace {
+const int kRefreshInterval = 500;           // 2 Hz
+const qint64 kMaxFrameGap = 1000000;        // 显示时间戳相差超过1秒视为跳转，不计丢帧（微秒）
+const int kPadding = 6;
+}
+
+PerformanceOverlay::PerformanceOverlay(PlaybackEngine *engine, QWidget *parent)
+    : QWidget(parent)
+    , m_engine(engine)
+    , m_refreshTimer(new QTimer(this))
+    , m_enabled(false)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    hide();
+
+    m_refreshTimer->setInterval(kRefreshInterval);
+    connect(m_refreshTimer, &QTimer::timeout, this, &PerformanceOverlay::refresh);
+    resetStats();
+}
+
+void PerformanceOverlay::setOverlayEnabled(bool enabled)
+{
+    if (m_enabled == enabled) {
+        return;
+    }
+    m_enabled = enabled;
+    m_engine->setFrameStatsEnabled(enabled);
+
+    if (enabled) {
+        // 丢弃关闭期间残留的样本
+        FrameSample sample;
+        while (m_engine->frameStats()->pop(&sample)) {
+        }
+        m_engine->frameStats()->takeOverflow();
+        m_engine->frameStats()->takeCost();
+        resetStats();
+        refresh();
+        m_refreshTimer->start();
+        show();
+        raise();
+    } else {
+        m_refreshTimer->stop();
+        hide();
+    }
+}
+
+void PerformanceOverlay::resetStats()
+{
+    m_lastRefreshNs = m_engine->clockNsecs();
+    m_lastArrivalNs = -1;
+    m_lastStartTime = -1;
+    m_totalDropped = 0;
+    m_costNs = 0;
+}
+
+void PerformanceOverlay::refresh()
+{
+    QElapsedTimer cost;
+    cost.start();
+
+    qint64 now = m_engine->clockNsecs();
+    qint64 window = qMax<qint64>(1, now - m_lastRefreshNs);
+    m_lastRefreshNs = now;
+
+    // 取出本周期的所有帧
+    int frames = 0;
+    int dropped = 0;
+    qint64 maxInterval = 0;
+    float frameRate = 0;
+    FrameSample sample;
+    while (m_engine->frameStats()->pop(&sample)) {
+        ++frames;
+        if (sample.frameRate > 0) {
+            frameRate = sample.frameRate;
+        }
+        if (m_lastArrivalNs >= 0) {
+            maxInterval = qMax(maxInterval, sample.arrivalNs - m_lastArrivalNs);
+        }
+        // 显示时间戳的跳跃超过一帧半即有帧未送达
+        if (m_lastStartTime >= 0 && sample.startTime >= 0 && frameRate > 0) {
+            qint64 delta = sample.startTime - m_lastStartTime;
+            qint64 expected = qint64(1000000 / frameRate);
+            if (delta > expected * 3 / 2 && delta < kMaxFrameGap) {
+                dropped += int((delta + expected / 2) / expected) - 1;
+            }
+        }
+        m_lastArrivalNs = sample.arrivalNs;
+        m_lastStartTime = sample.startTime;
+    }
+    m_totalDropped += dropped;
+    quint32 overflow = m_engine->frameStats()->takeOverflow();
+
+    // 面板开销：上次刷新本身、其后的绘制，以及播放线程中逐帧记录的耗时
+    qint64 overlayCost = m_costNs + m_engine->frameStats()->takeCost();
+    m_costNs = 0;
+
+    // 音画偏差：播放位置（音频时钟）与最后一帧按播放速度推算到此刻的时间戳之差
+    QString drift = "—";
+    if (m_lastStartTime >= 0 && m_lastArrivalNs >= 0 &&
+        m_engine->playbackState() == QMediaPlayer::PlayingState) {
+        qreal sinceFrame = (now - m_lastArrivalNs) / 1e6 * m_engine->playbackRate();
+        qreal expected = m_lastStartTime / 1000.0 + sinceFrame;
+        drift = QString("%1 ms").arg(m_engine->position() - expected, 0, 'f', 0);
+    }
+
+    qint64 rss = residentSetSize();
+    m_lines.clear();
+    m_lines << QString("帧率     %1 fps（标称 %2）").arg(frames * 1e9 / window, 0, 'f', 1)
+                                                      .arg(frameRate > 0 ? QString::number(frameRate, 'f', 2) : "—");
+    m_lines << QString("丢帧     %1（本周期 %2）").arg(m_totalDropped).arg(dropped);
+    m_lines << QString("帧间隔   最大 %1 ms").arg(maxInterval / 1e6, 0, 'f', 1);
+    m_lines << QString("缓冲     %1%").arg(qRound(m_engine->bufferProgress() * 100));
+    m_lines << QString("速度     %1x").arg(m_engine->playbackRate(), 0, 'f', 2);
+    m_lines << QString("音画偏差 %1").arg(drift);
+    m_lines << QString("内存     %1").arg(rss >= 0 ? QString("%1 MB").arg(rss / (1024.0 * 1024.0), 0, 'f', 1) : "—");
+    m_lines << QString("面板耗时 %1%").arg(overlayCost * 100.0 / window, 0, 'f', 3);
+    if (overflow > 0) {
+        m_lines << QString("统计溢出 %1").arg(overflow);
+    }
+
+    QFontMetrics metrics(font());
+    int width = 0;
+    for (const QString &line : m_lines) {
+        width = qMax(width, metrics.horizontalAdvance(line));
+    }
+    resize(width + 2 * kPadding, m_lines.size() * metrics.lineSpacing() + 2 * kPadding);
+    move(8, 8);
+    update();
+
+    m_costNs += cost.nsecsElapsed();
+}
+
+void PerformanceOverlay::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QElapsedTimer cost;
+    cost.start();
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(0, 0, 0, 160));
+    painter.setPen(QColor(0, 255, 128));
+
+    QFontMetrics metrics(font());
+    int y = kPadding + metrics.ascent();
+    for (const QString &line : m_lines) {
+        painter.drawText(kPadding, y, line);
+        y += metrics.lineSpacing();
+    }
+    painter.end();
+
+    m_costNs += cost.nsecsElapsed();
+}
+
+qint64 PerformanceOverlay::residentSetSize()
+{
+#if defined(Q_OS_LINUX)
+    // /proc/self/statm 的第二列是常驻页数
+    QFile file("/proc/self/statm");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    QList<QByteArray> fields = file.readAll().split(' ');
+    return fields.size() > 1 ? fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE) : -1;
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.WorkingSetSize);
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
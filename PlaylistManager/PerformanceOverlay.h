@@ -0,0 +1,48 @@
+// PerformanceOverlay.h
+#ifndef PERFORMANCEOVERLAY_H
+#define PERFORMANCEOVERLAY_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QStringList>
+
+#include "PlaybackEngine.h"
+
+// 视频画面上的性能信息面板
+// 每秒两次读取播放引擎的逐帧统计环形缓冲，显示帧率、丢帧、帧到达延迟、
+// 缓冲进度、播放速度、音画偏差和进程内存。隐藏时停止定时器并关闭统计，
+// 播放引擎不再记录任何数据。
+class PerformanceOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PerformanceOverlay(PlaybackEngine *engine, QWidget *parent = nullptr);
+
+    void setOverlayEnabled(bool enabled);
+    bool isOverlayEnabled() const { return m_enabled; }
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private slots:
+    void refresh();
+
+private:
+    PlaybackEngine *m_engine;
+    QTimer *m_refreshTimer;
+    QStringList m_lines;
+    bool m_enabled;
+
+    // 跨刷新周期保留的状态
+    qint64 m_lastRefreshNs;
+    qint64 m_lastArrivalNs;
+    qint64 m_lastStartTime;
+    qint64 m_totalDropped;
+    qint64 m_costNs;            // 面板自身的耗时：上次刷新以来的刷新和绘制，逐帧记录另计在环形缓冲中
+
+    void resetStats();
+    static qint64 residentSetSize();
+};
+
+#endif // PERFORMANCEOVERLAY_H
@@ -0,0 +1,88 @@
+// PlaylistItemDelegate.cpp
+#include "PlaylistItemDelegate.h"
+#include "PlaylistModel.h"
+#include <QPainter>
+#include <QApplication>
+
+namespace {
+const int kPadding = 4;
+const QColor kPlaceholderColor(40, 40, 40);
+const QColor kFavoriteColor(255, 190, 0);
+const QColor kCurrentColor(100, 149, 237, 50);
+const QColor kMissingColor(128, 128, 128);
+}
+
+PlaylistItemDelegate::PlaylistItemDelegate(RowThumbnailCache *thumbnails, QObject *parent)
+    : QStyledItemDelegate(parent)
+    , m_thumbnails(thumbnails)
+{
+}
+
+void PlaylistItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    QString text = opt.text;
+
+    // 当前播放项加粗并加底色，文件不存在的项显示为灰色
+    if (index.data(PlaylistModel::IsCurrentRole).toBool()) {
+        opt.backgroundBrush = kCurrentColor;
+        opt.font.setBold(true);
+        opt.fontMetrics = QFontMetrics(opt.font);
+    }
+    bool missing = index.data(PlaylistModel::MissingRole).toBool();
+
+    // 背景、选中和焦点框仍交给样式绘制
+    opt.text.clear();
+    opt.icon = QIcon();
+    const QWidget *widget = opt.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+    painter->save();
+
+    QRect contentRect = opt.rect.adjusted(kPadding, 0, -kPadding, 0);
+    QSize thumbSize = m_thumbnails->thumbnailSize();
+    QRect thumbRect(contentRect.left(), contentRect.top() + (contentRect.height() - thumbSize.height()) / 2,
+                    thumbSize.width(), thumbSize.height());
+
+    if (index.data(PlaylistModel::HasVideoRole).toBool()) {
+        QString filePath = index.data(PlaylistModel::FilePathRole).toString();
+        QImage image = m_thumbnails->thumbnail(filePath);
+        painter->fillRect(thumbRect, kPlaceholderColor);
+        if (image.isNull()) {
+            m_thumbnails->request(filePath, index.data(PlaylistModel::DurationRole).toLongLong());
+        } else {
+            QRect target(QPoint(0, 0), image.size().scaled(thumbSize, Qt::KeepAspectRatio));
+            target.moveCenter(thumbRect.center());
+            painter->drawImage(target, image);
+        }
+    }
+
+    QRect textRect = contentRect.adjusted(thumbSize.width() + kPadding, 0, 0, 0);
+    QPalette::ColorGroup group = (opt.state & QStyle::State_Enabled) ? QPalette::Normal : QPalette::Disabled;
+    QColor textColor = (opt.state & QStyle::State_Selected)
+        ? opt.palette.color(group, QPalette::HighlightedText)
+        : (missing ? kMissingColor : opt.palette.color(group, QPalette::Text));
+
+    painter->setFont(opt.font);
+    if (index.data(PlaylistModel::FavoriteRole).toBool()) {
+        QString star = QString::fromUtf8("★");
+        painter->setPen(kFavoriteColor);
+        painter->drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter, star);
+        textRect.setLeft(textRect.left() + opt.fontMetrics.horizontalAdvance(star) + kPadding);
+    }
+
+    painter->setPen(textColor);
+    QString elided = opt.fontMetrics.elidedText(text, Qt::ElideRight, textRect.width());
+    painter->drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter, elided);
+
+    painter->restore();
+}
+
+QSize PlaylistItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QSize size = QStyledItemDelegate::sizeHint(option, index);
+    size.setHeight(qMax(size.height(), m_thumbnails->thumbnailSize().height() + 2 * kPadding));
+    return size;
+}
@@ -0,0 +1,26 @@
+// PlaylistItemDelegate.h
+#ifndef PLAYLISTITEMDELEGATE_H
+#define PLAYLISTITEMDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+#include "RowThumbnailCache.h"
+
+// 播放列表行绘制：缩略图 + 收藏标记 + 名称
+// 只有视图实际绘制的行才会请求缩略图，因此生成范围自然限制在可见区域；
+// 绘制本身只查内存缓存，未生成时画占位框，不阻塞滚动。
+class PlaylistItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit PlaylistItemDelegate(RowThumbnailCache *thumbnails, QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+private:
+    RowThumbnailCache *m_thumbnails;
+};
+
+#endif // PLAYLISTITEMDELEGATE_H
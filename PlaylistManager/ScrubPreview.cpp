@@ -0,0 +1,118 @@
+// ScrubPreview.cpp
+#include "ScrubPreview.h"
+#include <QPainter>
+
+namespace {
+const QSize kPreviewSize(240, 135);
+const int kTextHeight = 20;
+const int kMargin = 2;
+}
+
+ScrubPreview::ScrubPreview(KeyframeIndexer *keyframeIndexer, QWidget *parent)
+    : QWidget(parent, Qt::ToolTip | Qt::FramelessWindowHint)
+    , m_grabber(new FrameGrabber(kPreviewSize, this))
+    , m_keyframeIndexer(keyframeIndexer)
+    , m_lastRequested(-1)
+    , m_dragging(false)
+    , m_dragDuration(0)
+{
+    setAttribute(Qt::WA_ShowWithoutActivating);
+    setFixedSize(kPreviewSize.width() + 2 * kMargin, kPreviewSize.height() + kTextHeight + 2 * kMargin);
+
+    connect(m_grabber, &FrameGrabber::frameReady, this, &ScrubPreview::onFrameReady);
+}
+
+void ScrubPreview::showAt(const QString &filePath, qint64 position, const QString &timeText, const QPoint &anchor,
+                          const QImage &placeholder)
+{
+    if (!m_dragging) {
+        // 新的一次拖动
+        m_dragging = true;
+        m_grabber->resetStats();
+        m_dragTimer.start();
+        m_lastRequested = -1;
+        if (filePath != m_filePath) {
+            m_image = QImage();
+        }
+    }
+    m_filePath = filePath;
+    m_timeText = timeText;
+
+    // 对齐到关键帧：只需解码一帧，且相邻的拖动位置会落到同一帧上
+    const KeyframeIndex *index = m_keyframeIndexer->index(filePath);
+    qint64 target = index ? index->nearest(position) : position;
+    if (target != m_lastRequested) {
+        m_lastRequested = target;
+        m_grabber->request(filePath, target);
+        if (!placeholder.isNull()) {
+            m_image = placeholder;
+        }
+    }
+
+    placeAt(anchor);
+}
+
+void ScrubPreview::showThumbnail(const QImage &thumbnail, const QString &timeText, const QPoint &anchor)
+{
+    if (m_dragging) {
+        return;
+    }
+
+    m_image = thumbnail;
+    m_timeText = timeText;
+    placeAt(anchor);
+}
+
+void ScrubPreview::hidePreview()
+{
+    if (m_dragging) {
+        m_dragging = false;
+        m_dragDuration = m_dragTimer.elapsed();
+        m_grabber->cancel();
+    }
+    hide();
+}
+
+void ScrubPreview::placeAt(const QPoint &anchor)
+{
+    move(anchor.x() - width() / 2, anchor.y() - height() - 6);
+    if (!isVisible()) {
+        show();
+    }
+    update();
+}
+
+qreal ScrubPreview::framesPerSecond() const
+{
+    return m_dragDuration > 0 ? m_grabber->deliveredCount() * 1000.0 / m_dragDuration : 0.0;
+}
+
+void ScrubPreview::onFrameReady(const QString &filePath, qint64 position, const QImage &image)
+{
+    Q_UNUSED(position);
+    if (filePath != m_filePath || !m_dragging) {
+        return;
+    }
+
+    m_image = image;
+    update();
+}
+
+void ScrubPreview::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(20, 20, 20));
+
+    QRect imageRect(kMargin, kMargin, kPreviewSize.width(), kPreviewSize.height());
+    if (!m_image.isNull()) {
+        QSize size = m_image.size().scaled(imageRect.size(), Qt::KeepAspectRatio);
+        QRect target(QPoint(0, 0), size);
+        target.moveCenter(imageRect.center());
+        painter.drawImage(target, m_image);
+    }
+
+    painter.setPen(Qt::white);
+    painter.drawText(QRect(0, imageRect.bottom() + 1, width(), kTextHeight), Qt::AlignCenter, m_timeText);
+}
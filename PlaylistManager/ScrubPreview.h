@@ -0,0 +1,55 @@
+// ScrubPreview.h
+#ifndef SCRUBPREVIEW_H
+#define SCRUBPREVIEW_H
+
+#include <QWidget>
+#include <QImage>
+#include <QElapsedTimer>
+
+#include "FrameGrabber.h"
+#include "KeyframeIndex.h"
+
+// 进度条上方的预览画面
+// 拖动时由独立的 FrameGrabber 解码，请求位置对齐到关键帧，只需解码一帧；
+// 拖动过快时旧请求被丢弃，画面始终跟随最新位置。已有缩略图拼图时先显示
+// 拼图中的一格，解码完成后替换。鼠标悬停时只显示拼图中的缩略图。
+class ScrubPreview : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ScrubPreview(KeyframeIndexer *keyframeIndexer, QWidget *parent = nullptr);
+
+    // anchor 为滑块位置的全局坐标，预览显示在它上方
+    void showAt(const QString &filePath, qint64 position, const QString &timeText, const QPoint &anchor,
+                const QImage &placeholder = QImage());
+    void showThumbnail(const QImage &thumbnail, const QString &timeText, const QPoint &anchor);
+    void hidePreview();
+
+    // 最近一次拖动的统计
+    qreal framesPerSecond() const;
+    qint64 worstLatency() const { return m_grabber->worstLatency(); }
+    int deliveredCount() const { return m_grabber->deliveredCount(); }
+    int droppedCount() const { return m_grabber->droppedCount(); }
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private slots:
+    void onFrameReady(const QString &filePath, qint64 position, const QImage &image);
+
+private:
+    FrameGrabber *m_grabber;
+    KeyframeIndexer *m_keyframeIndexer;
+    QString m_filePath;
+    QString m_timeText;
+    QImage m_image;
+    qint64 m_lastRequested;
+    bool m_dragging;
+    QElapsedTimer m_dragTimer;
+    qint64 m_dragDuration;
+
+    void placeAt(const QPoint &anchor);
+};
+
+#endif // SCRUBPREVIEW_H
@@ -25,6 +25,7 @@ void ShortcutManager::setupDefaultShortcuts()
     // 视图控制
     createShortcut(PlayerAction::FullScreen, QKeySequence(Qt::Key_F11));
     createShortcut(PlayerAction::ShowPlaylist, QKeySequence(Qt::Key_L));
+    createShortcut(PlayerAction::TogglePerformanceOverlay, QKeySequence(Qt::CTRL | Qt::Key_I));
 
     // 文件操作
     createShortcut(PlayerAction::OpenFile, QKeySequence::Open);
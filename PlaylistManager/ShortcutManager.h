@@ -27,6 +27,7 @@ enum class PlayerAction {
     // 视图控制
     FullScreen,
     ShowPlaylist,
+    TogglePerformanceOverlay,
 
     // 文件操作
     OpenFile,
@@ -0,0 +1,1063 @@
+// PlayerBenchmark.cpp
+#include "PlayerBenchmark.h"
+#include "PlaylistController.h"
+#include "PlaylistFilterModel.h"
+#include "PlaylistFile.h"
+#include "ThumbnailSprite.h"
+#include "KeyframeIndex.h"
+#include "CrossfadeMixer.h"
+#include "PlaylistModel.h"
+#include "FrameGrabber.h"
+#include "PerformanceOverlay.h"
+#include "TestMedia.h"
+#include "MetadataExtractor.h"
+#include <QCoreApplication>
+#include <QApplication>
+#include <QListView>
+#include <QListWidget>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+#include <QFile>
+#include <QDir>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QMediaPlayer>
+#include <QtMath>
+#include <algorithm>
+#include <vector>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+const int kOutputTimeout = 10000;           // 等待输出的最长时间（毫秒）
+const int kPreloadTimeout = 5000;
+const qint64 kSeekTolerance = 500;          // 输出位置与跳转目标相差不超过该值即视为完成（毫秒）
+const int kClipCount = 4;
+const int kClipSeconds = 8;
+const int kVideoCount = 2;
+const int kVideoSeconds = 120;
+const int kVideoGopSize = 250;              // 长 GOP：10秒一个关键帧（25 fps）
+const int kVideoTimeout = 300000;           // 生成一段视频的最长时间（毫秒）
+const int kThumbnailTimeout = 120000;
+const int kSeekTargets = 8;                 // 每段长 GOP 视频每轮跳转的次数
+const QSize kPreviewSize(240, 135);         // 与拖动预览相同
+const int kScrubSteps = 120;                // 每轮拖动经过的位置数
+const int kScrubInterval = 16;              // 拖动时相邻两次请求的间隔（毫秒），约一帧
+const int kScrubTimeout = 30000;
+const int kOverlayMsecs = 5000;             // 面板打开和关闭时各播放的时长
+const int kVisibleRows = 50;                // 映射打开后读取的条目数，相当于一屏
+const int kMixSeconds = 10;                 // 每轮混合的音频长度
+const int kMixChunkFrames = 1024;           // 与音频输出每次拉取的长度相当
+const int kStartupEntries = 50000;          // 启动测试的快照规模
+const int kStartupStatDelay = 50;           // 启动测试中每次 stat 额外的延迟（微秒），模拟网络存储
+const int kValidationTimeout = 120000;
+const int kMemoryEntries = 100000;          // 列表内存对比的条目数
+const int kMetadataFiles = 200;             // 每轮提取元数据的文件数，片段循环使用
+const int kMetadataTimeout = 120000;
+const QStringList kVideoSuffixes = {"mp4", "mov", "m4v", "mkv", "webm", "avi"};
+
+double percentile(const QList<double> &sorted, double p)
+{
+    if (sorted.isEmpty()) {
+        return 0.0;
+    }
+    int index = qBound(0, int(qCeil(p * sorted.size())) - 1, int(sorted.size()) - 1);
+    return sorted.at(index);
+}
+}
+
+PlayerBenchmark::PlayerBenchmark(const Options &options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+{
+}
+
+int PlayerBenchmark::run()
+{
+    if (!m_workDir.isValid()) {
+        qWarning("Benchmark: cannot create temporary directory");
+        return 1;
+    }
+
+    // 设置、播放列表、缓存全部隔离到临时位置
+    QStandardPaths::setTestModeEnabled(true);
+    QSettings::setDefaultFormat(QSettings::IniFormat);
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_workDir.filePath("settings"));
+    resetStorage();
+
+    int largest = 0;
+    for (int scale : m_options.scales) {
+        largest = qMax(largest, scale);
+    }
+    QStringList files = createPlaylistFiles(largest);
+    for (int scale : m_options.scales) {
+        qInfo("Benchmark: playlist with %d items", scale);
+        benchmarkPlaylist(scale, files.mid(0, scale));
+    }
+
+    qInfo("Benchmark: startup with %d entries on slow storage", kStartupEntries);
+    benchmarkStartup(files.size() >= kStartupEntries ? files.mid(0, kStartupEntries)
+                                                     : createPlaylistFiles(kStartupEntries));
+
+    qInfo("Benchmark: playlist memory with %d entries", kMemoryEntries);
+    benchmarkPlaylistMemory(kMemoryEntries);
+
+    for (int scale : m_options.fileScales) {
+        qInfo("Benchmark: playlist file with %d entries", scale);
+        benchmarkPlaylistFile(scale);
+    }
+
+    qInfo("Benchmark: crossfade mixing");
+    benchmarkCrossfadeMix();
+
+    if (m_options.playback) {
+        QStringList clips = findOrGenerateClips();
+        if (clips.size() >= 2) {
+            qInfo("Benchmark: playback with %d clips", int(clips.size()));
+            benchmarkPlayback(clips);
+        } else {
+            qWarning("Benchmark: need at least two clips for playback measurements");
+        }
+
+        QStringList videos = findOrGenerateVideos();
+        if (!clips.isEmpty() || !videos.isEmpty()) {
+            qInfo("Benchmark: metadata extraction with %d files", kMetadataFiles);
+            benchmarkMetadata(clips + videos);
+        }
+        if (!videos.isEmpty()) {
+            qInfo("Benchmark: seeking in %d long-GOP videos", int(videos.size()));
+            benchmarkSeek(videos);
+            qInfo("Benchmark: performance overlay cost with %d videos", int(videos.size()));
+            benchmarkOverlay(videos);
+            qInfo("Benchmark: scrub preview with %d videos", int(videos.size()));
+            benchmarkScrubPreview(videos);
+            qInfo("Benchmark: thumbnails with %d videos", int(videos.size()));
+            benchmarkThumbnails(videos);
+        } else {
+            qWarning("Benchmark: no video clips (use --media or install ffmpeg), skipping seek and thumbnails");
+        }
+    }
+    resetStorage();
+
+    QJsonObject root;
+    root["benchmark"] = QCoreApplication::applicationName();
+    root["version"] = 1;
+    root["applicationVersion"] = QCoreApplication::applicationVersion();
+    root["qtVersion"] = QString::fromLatin1(qVersion());
+    root["platform"] = QApplication::platformName();
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["results"] = m_results;
+
+    QSaveFile output(m_options.outputFile);
+    if (!output.open(QIODevice::WriteOnly)) {
+        qWarning("Benchmark: cannot write %s", qPrintable(m_options.outputFile));
+        return 1;
+    }
+    output.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    return output.commit() ? 0 : 1;
+}
+
+void PlayerBenchmark::benchmarkPlaylist(int scale, const QStringList &files)
+{
+    const QStringList keywords = {"clip", "Artist 7", QString("clip_%1").arg(scale / 2, 6, 10, QChar('0')), "不存在"};
+    QList<double> add, search, shuffle, save, load;
+    int loadFailures = 0;
+
+    for (int i = 0; i < m_options.iterations; ++i) {
+        resetStorage();
+        {
+            // 直接使用播放列表控制器，不创建列表视图
+            PlaylistController playlist;
+            PlaylistFilterModel filter;
+            filter.setPlaylistModel(playlist.model());
+            add.append(timeIt([&]() { playlist.addMediaList(files); }));
+
+            for (const QString &keyword : keywords) {
+                search.append(timeIt([&]() { filter.setSearchKeyword(keyword); }));
+                filter.setSearchKeyword(QString());
+            }
+
+            playlist.setPlayMode(PlaySequencer::Sequential);
+            shuffle.append(timeIt([&]() { playlist.setPlayMode(PlaySequencer::Random); }));
+            playlist.setPlayMode(PlaySequencer::Sequential);
+
+            save.append(timeIt([&]() {
+                playlist.save();
+                playlist.waitForPendingWrites();
+            }));
+        }
+        QCoreApplication::processEvents();
+
+        // 从快照和操作日志加载
+        int loaded = 0;
+        load.append(timeIt([&]() {
+            PlaylistController playlist;
+            playlist.load();
+            loaded = playlist.count();
+        }));
+        if (loaded != files.size()) {
+            ++loadFailures;
+        }
+        QCoreApplication::processEvents();
+    }
+
+    addResult("playlist.add", scale, add);
+    addResult("playlist.search", scale, search);
+    addResult("playlist.shuffle", scale, shuffle);
+    addResult("playlist.save", scale, save);
+    addResult("playlist.load", scale, load, loadFailures);
+}
+
+void PlayerBenchmark::benchmarkStartup(const QStringList &files)
+{
+    // 从快照启动，每个文件的 stat 都被拖慢：load() 返回后列表即可显示，
+    // 文件校验在后台完成。两个时间分开报告，校验不应计入 load()
+    resetStorage();
+    {
+        PlaylistController playlist;
+        playlist.addMediaList(files);
+        playlist.save();
+        playlist.waitForPendingWrites();
+    }
+    QCoreApplication::processEvents();
+
+    QList<double> load, validated;
+    int failures = 0;
+    FileValidatorWorker::setStatDelay(kStartupStatDelay);
+
+    for (int i = 0; i < m_options.iterations; ++i) {
+        PlaylistController playlist;
+        QEventLoop loop;
+        bool finished = false;
+        connect(&playlist, &PlaylistController::validationFinished, &loop, [&]() {
+            finished = true;
+            loop.quit();
+        });
+        QTimer::singleShot(kValidationTimeout, &loop, &QEventLoop::quit);
+
+        QElapsedTimer timer;
+        timer.start();
+        playlist.load();
+        double loaded = timer.nsecsElapsed() / 1e6;
+        int count = playlist.count();
+        if (!finished) {
+            loop.exec();
+        }
+        double done = timer.nsecsElapsed() / 1e6;
+
+        if (count != files.size() || !finished) {
+            ++failures;
+            continue;
+        }
+        load.append(loaded);
+        validated.append(done);
+    }
+
+    FileValidatorWorker::setStatDelay(0);
+    addResult("startup.load", files.size(), load, failures);
+    addResult("startup.validated", files.size(), validated, failures);
+}
+
+void PlayerBenchmark::benchmarkPlaylistMemory(int scale)
+{
+    // 同样的条目分别放进 PlaylistModel + QListView 和旧实现的 QListWidget
+    // （MediaInfo 列表之外每项再分配一个带显示文本和提示的 QListWidgetItem），
+    // 比较常驻内存的增量。条目在各自的作用域内生成，字符串不与另一方共享
+    QList<double> modelView, listWidget;
+    int failures = 0;
+
+    // populate 在列表仍存在时返回常驻内存
+    auto measure = [&](QList<double> &samples, const std::function<qint64()> &populate) {
+        trimHeap();
+        qint64 before = residentSetSize();
+        qint64 after = populate();
+        trimHeap();
+        if (before < 0 || after < 0) {
+            ++failures;
+            return;
+        }
+        samples.append((after - before) / (1024.0 * 1024.0));
+    };
+
+    for (int i = 0; i < m_options.iterations; ++i) {
+        measure(modelView, [&]() {
+            PlaylistModel model;
+            QListView view;
+            view.setUniformItemSizes(true);
+            view.setModel(&model);
+            view.resize(400, 600);
+            model.appendMedia(syntheticItems(scale));
+            view.show();
+            QCoreApplication::processEvents();
+            return residentSetSize();
+        });
+
+        measure(listWidget, [&]() {
+            QList<MediaInfo> mediaList;
+            QListWidget widget;
+            widget.resize(400, 600);
+            for (const MediaInfo &info : syntheticItems(scale)) {
+                mediaList.append(info);
+                QListWidgetItem *item = new QListWidgetItem(info.displayName());
+                item->setToolTip(info.filePath);
+                widget.addItem(item);
+            }
+            widget.show();
+            QCoreApplication::processEvents();
+            return residentSetSize();
+        });
+    }
+
+    addResult("memory.modelView", scale, modelView, failures, "MB");
+    addResult("memory.listWidget", scale, listWidget, failures, "MB");
+}
+
+void PlayerBenchmark::benchmarkPlaylistFile(int scale)
+{
+    // 直接读写 PlaylistFile，不经过操作日志；条目是合成的，不需要真实文件
+    const QList<MediaInfo> items = syntheticItems(scale);
+
+    const QString fileName = m_workDir.filePath(QString("playlist_%1.vpl").arg(scale));
+    QList<double> save, load, open;
+    int saveFailures = 0;
+    int loadFailures = 0;
+    int openFailures = 0;
+    for (int i = 0; i < m_options.iterations; ++i) {
+        bool saved = false;
+        save.append(timeIt([&]() { saved = PlaylistFile::save(fileName, items); }));
+        if (!saved) {
+            ++saveFailures;
+            continue;
+        }
+
+        // 整体加载：解码全部条目
+        int loaded = 0;
+        load.append(timeIt([&]() { loaded = PlaylistFile::load(fileName).size(); }));
+        if (loaded != scale) {
+            ++loadFailures;
+        }
+
+        // 映射打开，只解码一屏条目
+        bool opened = false;
+        open.append(timeIt([&]() {
+            PlaylistFileReader reader;
+            opened = reader.open(fileName) && reader.count() == scale;
+            for (int row = 0; opened && row < qMin(kVisibleRows, scale); ++row) {
+                opened = !reader.at(row).filePath.isEmpty();
+            }
+        }));
+        if (!opened) {
+            ++openFailures;
+        }
+    }
+    QFile::remove(fileName);
+
+    addResult("playlistFile.save", scale, save, saveFailures);
+    addResult("playlistFile.load", scale, load, loadFailures);
+    addResult("playlistFile.open", scale, open, openFailures);
+}
+
+void PlayerBenchmark::benchmarkCrossfadeMix()
+{
+    // 与输出时一样分块混合 48kHz 立体声，结果为每秒音频的混合耗时
+    QAudioFormat format = CrossfadeMixer::mixFormat();
+    const int channels = format.channelCount();
+    const qint64 frames = qint64(kMixSeconds) * format.sampleRate();
+    std::vector<float> out(kMixChunkFrames * channels);
+    std::vector<float> in(kMixChunkFrames * channels);
+    std::vector<float> mixed(kMixChunkFrames * channels);
+    for (int i = 0; i < kMixChunkFrames * channels; ++i) {
+        out[i] = float(qSin(i * 0.01));
+        in[i] = float(qCos(i * 0.013));
+    }
+
+    QList<double> cost;
+    for (int i = 0; i < m_options.iterations; ++i) {
+        double elapsed = timeIt([&]() {
+            for (qint64 frame = 0; frame < frames; frame += kMixChunkFrames) {
+                CrossfadeMixer::mix(out.data(), in.data(), mixed.data(), kMixChunkFrames, channels, frame, frames);
+            }
+        });
+        cost.append(elapsed / kMixSeconds);
+    }
+    addResult("crossfade.mixCostPerSecond", 1, cost);
+}
+
+void PlayerBenchmark::benchmarkMetadata(const QStringList &files)
+{
+    // 与播放器一样经有界队列提交，队列满时等 capacityAvailable() 再继续；结果为每秒提取的文件数
+    QList<double> throughput;
+    int failures = 0;
+
+    for (int i = 0; i < m_options.iterations; ++i) {
+        MetadataExtractor extractor;
+        QEventLoop loop;
+        quint64 nextId = 1;
+        int received = 0;
+        int invalid = 0;
+
+        auto submit = [&]() {
+            while (nextId <= quint64(kMetadataFiles) &&
+                   extractor.enqueue(nextId, files.at(int((nextId - 1) % files.size())))) {
+                ++nextId;
+            }
+        };
+        connect(&extractor, &MetadataExtractor::capacityAvailable, &loop, submit);
+        connect(&extractor, &MetadataExtractor::metadataReady, &loop, [&](const QList<MediaMetadata> &batch) {
+            for (const MediaMetadata &metadata : batch) {
+                if (!metadata.valid) {
+                    ++invalid;
+                }
+            }
+            received += batch.size();
+            if (received >= kMetadataFiles) {
+                loop.quit();
+            }
+        });
+        QTimer::singleShot(kMetadataTimeout, &loop, &QEventLoop::quit);
+
+        QElapsedTimer timer;
+        timer.start();
+        submit();
+        loop.exec();
+        double wall = timer.nsecsElapsed() / 1e9;
+
+        if (received < kMetadataFiles || invalid > 0 || wall <= 0) {
+            qWarning("Benchmark: metadata for %d of %d files (%d invalid)", received, kMetadataFiles, invalid);
+            ++failures;
+            continue;
+        }
+        throughput.append(received / wall);
+    }
+
+    addResult("metadata.throughput", kMetadataFiles, throughput, failures, "files/s");
+}
+
+void PlayerBenchmark::benchmarkPlayback(const QStringList &clips)
+{
+    // 引擎只需要一个 QVideoSink，不必创建窗口部件
+    QVideoSink videoSink;
+    PlaybackEngine engine;
+    engine.setVolume(0.0f);
+    engine.setVideoSink(&videoSink);
+    QVideoSink *sink = &videoSink;
+
+    QList<double> open, seek, preloadedSwitch, coldSwitch;
+    int openFailures = 0;
+    int seekFailures = 0;
+    int preloadedFailures = 0;
+    int coldFailures = 0;
+    auto anyOutput = [](qint64) { return true; };
+    auto collect = [](QList<double> &samples, int &failures, double elapsed) {
+        if (elapsed >= 0) {
+            samples.append(elapsed);
+        } else {
+            ++failures;
+        }
+    };
+
+    for (int i = 0; i < m_options.iterations; ++i) {
+        QUrl first = QUrl::fromLocalFile(clips.at(i % clips.size()));
+        QUrl second = QUrl::fromLocalFile(clips.at((i + 1) % clips.size()));
+        QUrl third = QUrl::fromLocalFile(clips.at((i + 2) % clips.size()));
+
+        // 打开到第一次输出
+        double elapsed = measureOutput(&engine, sink, [&]() {
+            engine.setSource(first);
+            engine.play();
+        }, anyOutput);
+        collect(open, openFailures, elapsed);
+
+        // 跳转到中间位置
+        qint64 target = qMax<qint64>(1000, engine.duration() / 2);
+        elapsed = measureOutput(&engine, sink, [&]() { engine.setPosition(target); },
+                                [target](qint64 position) { return qAbs(position - target) <= kSeekTolerance; });
+        collect(seek, seekFailures, elapsed);
+
+        // 切换到已预加载的下一项
+        engine.preload(second);
+        QElapsedTimer wait;
+        wait.start();
+        while (!engine.isPreloaded(second) && wait.elapsed() < kPreloadTimeout) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        }
+        elapsed = measureOutput(&engine, sink, [&]() {
+            engine.setSource(second);
+            engine.play();
+        }, anyOutput);
+        collect(preloadedSwitch, preloadedFailures, elapsed);
+
+        // 切换到未预加载的项
+        engine.clearPreload();
+        elapsed = measureOutput(&engine, sink, [&]() {
+            engine.setSource(third);
+            engine.play();
+        }, anyOutput);
+        collect(coldSwitch, coldFailures, elapsed);
+
+        engine.stop();
+        QCoreApplication::processEvents();
+    }
+
+    addResult("playback.openToFirstOutput", 1, open, openFailures);
+    addResult("playback.seek", 1, seek, seekFailures);
+    addResult("playback.switchPreloaded", 1, preloadedSwitch, preloadedFailures);
+    addResult("playback.switchCold", 1, coldSwitch, coldFailures);
+}
+
+void PlayerBenchmark::benchmarkSeek(const QStringList &videos)
+{
+    // 长 GOP 视频中，跳到任意位置要从前一个关键帧解码到目标；跳到关键帧只需解码一帧。
+    // 两者之差就是关键帧对齐省下的时间，关键帧时间不准时对齐后的跳转反而更慢
+    QVideoSink videoSink;
+    PlaybackEngine engine;
+    engine.setVolume(0.0f);
+    engine.setVideoSink(&videoSink);
+    QVideoSink *sink = &videoSink;
+
+    QList<double> arbitrary, keyframe;
+    int arbitraryFailures = 0;
+    int keyframeFailures = 0;
+
+    for (int i = 0; i < m_options.iterations; ++i) {
+        const QString video = videos.at(i % videos.size());
+        KeyframeIndex index = KeyframeIndex::build(video);
+        if (index.isEmpty() || index.allKeyframes()) {
+            qWarning("Benchmark: no keyframe index for %s", qPrintable(video));
+            ++keyframeFailures;
+            continue;
+        }
+
+        if (measureOutput(&engine, sink, [&]() {
+                engine.setSource(QUrl::fromLocalFile(video));
+                engine.play();
+            }, [](qint64) { return true; }) < 0) {
+            ++arbitraryFailures;
+            ++keyframeFailures;
+            continue;
+        }
+        engine.pause();
+
+        qint64 duration = engine.duration();
+        for (int j = 0; j < kSeekTargets; ++j) {
+            // 目标均匀分布在整段视频中，并错开关键帧
+            qint64 target = duration * (2 * j + 1) / (2 * kSeekTargets) + 3700 * (i + 1);
+            target = qBound<qint64>(0, target, duration - 1000);
+
+            double elapsed = measureOutput(&engine, sink, [&]() { engine.setPosition(target); },
+                                           [target](qint64 position) {
+                                               return qAbs(position - target) <= kSeekTolerance;
+                                           });
+            if (elapsed >= 0) {
+                arbitrary.append(elapsed);
+            } else {
+                ++arbitraryFailures;
+            }
+
+            qint64 snapped = index.nearest(target);
+            elapsed = measureOutput(&engine, sink, [&]() { engine.setPosition(snapped); },
+                                    [snapped](qint64 position) {
+                                        return qAbs(position - snapped) <= kSeekTolerance;
+                                    });
+            if (elapsed >= 0) {
+                keyframe.append(elapsed);
+            } else {
+                ++keyframeFailures;
+            }
+        }
+
+        engine.stop();
+        QCoreApplication::processEvents();
+    }
+
+    addResult("seek.longGop.arbitrary", 1, arbitrary, arbitraryFailures);
+    addResult("seek.longGop.keyframe", 1, keyframe, keyframeFailures);
+}
+
+void PlayerBenchmark::benchmarkOverlay(const QStringList &videos)
+{
+    // 播放同一段视频，性能信息面板关闭和打开时各测一段时间，比较进程每秒消耗的 CPU 时间。
+    // 两者之差是面板（逐帧记录、刷新和绘制）的实际开销，可与面板上显示的耗时对照
+    QWidget host;
+    host.resize(1280, 720);
+    QVideoSink videoSink;
+    PlaybackEngine engine;
+    engine.setVolume(0.0f);
+    engine.setVideoSink(&videoSink);
+    PerformanceOverlay overlay(&engine, &host);
+    host.show();
+
+    QList<double> off, on, overhead;
+    int failures = 0;
+
+    auto cpuPerSecond = [&](bool enabled) {
+        overlay.setOverlayEnabled(enabled);
+        QEventLoop loop;
+        QTimer::singleShot(kOverlayMsecs, &loop, &QEventLoop::quit);
+        QElapsedTimer timer;
+        double cpuStart = processCpuTime();
+        timer.start();
+        loop.exec();
+        double cpu = processCpuTime() - cpuStart;
+        overlay.setOverlayEnabled(false);
+        return cpu / (timer.nsecsElapsed() / 1e9);
+    };
+
+    for (int i = 0; i < m_options.iterations; ++i) {
+        const QString video = videos.at(i % videos.size());
+        if (measureOutput(&engine, &videoSink, [&]() {
+                engine.setSource(QUrl::fromLocalFile(video));
+                engine.play();
+            }, [](qint64) { return true; }) < 0) {
+            ++failures;
+            continue;
+        }
+
+        // 交替先后顺序，抵消播放开始后负载的变化
+        double withoutOverlay = 0;
+        double withOverlay = 0;
+        if (i % 2 == 0) {
+            withoutOverlay = cpuPerSecond(false);
+            withOverlay = cpuPerSecond(true);
+        } else {
+            withOverlay = cpuPerSecond(true);
+            withoutOverlay = cpuPerSecond(false);
+        }
+        bool playing = engine.playbackState() == QMediaPlayer::PlayingState;
+        engine.stop();
+        QCoreApplication::processEvents();
+
+        if (!playing) {
+            ++failures;
+            continue;
+        }
+        off.append(withoutOverlay);
+        on.append(withOverlay);
+        overhead.append(withOverlay - withoutOverlay);
+    }
+
+    addResult("overlay.cpuOff", 1, off, failures, "cpu-ms/s");
+    addResult("overlay.cpuOn", 1, on, failures, "cpu-ms/s");
+    addResult("overlay.cpuOverhead", 1, overhead, failures, "cpu-ms/s");
+}
+
+void PlayerBenchmark::benchmarkScrubPreview(const QStringList &videos)
+{
+    // 模拟拖动进度条：每帧请求一个新位置，与拖动预览一样对齐到关键帧，相同位置不重复请求。
+    // FrameGrabber 只保留最新的请求，报告拖动期间每秒显示的预览帧数和请求到显示的最大延迟
+    QList<double> fps, latency;
+    int failures = 0;
+
+    for (int i = 0; i < m_options.iterations; ++i) {
+        const QString video = videos.at(i % videos.size());
+        KeyframeIndex index = KeyframeIndex::build(video);
+        qint64 duration = mediaDuration(video);
+        if (duration <= 0) {
+            ++failures;
+            continue;
+        }
+
+        FrameGrabber grabber(kPreviewSize);
+        QEventLoop loop;
+        qint64 lastRequested = -1;
+        qint64 lastDelivered = -1;
+        int step = 0;
+        bool finished = false;
+        bool failed = false;
+
+        // 拖动结束（或打开）后，最后请求的位置显示出来即完成
+        auto settle = [&]() {
+            if ((step == 0 || step >= kScrubSteps) && lastDelivered == lastRequested) {
+                finished = true;
+                loop.quit();
+            }
+        };
+        connect(&grabber, &FrameGrabber::frameReady, &loop, [&](const QString &, qint64 position, const QImage &) {
+            lastDelivered = position;
+            settle();
+        });
+        connect(&grabber, &FrameGrabber::failed, &loop, [&](const QString &, qint64 position) {
+            if (position == lastRequested) {
+                failed = true;
+                loop.quit();
+            }
+        });
+
+        // 先打开文件，打开的耗时不计入拖动
+        QTimer::singleShot(kScrubTimeout, &loop, &QEventLoop::quit);
+        lastRequested = 0;
+        grabber.request(video, lastRequested);
+        loop.exec();
+        if (!finished || failed) {
+            ++failures;
+            continue;
+        }
+
+        finished = false;
+        grabber.resetStats();
+        QTimer ticker;
+        ticker.setInterval(kScrubInterval);
+        connect(&ticker, &QTimer::timeout, &loop, [&]() {
+            ++step;
+            qint64 position = duration * step / (kScrubSteps + 1);
+            qint64 target = index.isEmpty() ? position : index.nearest(position);
+            if (target != lastRequested) {
+                lastRequested = target;
+                grabber.request(video, target);
+            }
+            if (step >= kScrubSteps) {
+                ticker.stop();
+                settle();
+            }
+        });
+        QTimer::singleShot(kScrubTimeout, &loop, &QEventLoop::quit);
+
+        QElapsedTimer timer;
+        timer.start();
+        ticker.start();
+        loop.exec();
+        double wall = timer.nsecsElapsed() / 1e9;
+
+        if (!finished || failed || wall <= 0) {
+            ++failures;
+            continue;
+        }
+        fps.append(grabber.deliveredCount() / wall);
+        latency.append(grabber.worstLatency());
+    }
+
+    addResult("scrub.previewFps", 1, fps, failures, "fps");
+    addResult("scrub.maxLatency", 1, latency, failures);
+}
+
+void PlayerBenchmark::benchmarkThumbnails(const QStringList &videos)
+{
+    // 缩略图在暂停时全速生成；每秒生成的格数，以及每 CPU 秒（即每个核）生成的格数
+    QList<double> perSecond, perCpuSecond;
+    int failures = 0;
+
+    for (int i = 0; i < m_options.iterations; ++i) {
+        const QString video = videos.at(i % videos.size());
+        qint64 duration = mediaDuration(video);
+        if (duration <= 0) {
+            ++failures;
+            continue;
+        }
+
+        // 清空磁盘缓存，每次都实际解码
+        resetStorage();
+        KeyframeIndexer indexer;
+        ThumbnailSpriteGenerator generator(&indexer);
+
+        // 与播放器一样先建好关键帧索引，每格只需解码一帧
+        QEventLoop indexLoop;
+        connect(&indexer, &KeyframeIndexer::indexReady, &indexLoop, &QEventLoop::quit);
+        QTimer::singleShot(kPreloadTimeout, &indexLoop, &QEventLoop::quit);
+        indexer.request(video);
+        indexLoop.exec();
+
+        QEventLoop loop;
+        bool generated = false;
+        connect(&generator, &ThumbnailSpriteGenerator::spriteReady, &loop, [&](const QString &, bool fromCache) {
+            generated = !fromCache;
+            loop.quit();
+        });
+        QTimer::singleShot(kThumbnailTimeout, &loop, &QEventLoop::quit);
+
+        QElapsedTimer timer;
+        double cpuStart = processCpuTime();
+        timer.start();
+        generator.generate(video, duration);
+        loop.exec();
+        double wall = timer.nsecsElapsed() / 1e9;
+        double cpu = (processCpuTime() - cpuStart) / 1000.0;
+
+        const ThumbnailSprite *sprite = generator.sprite(video);
+        if (!generated || !sprite || wall <= 0 || cpu <= 0) {
+            ++failures;
+            continue;
+        }
+        perSecond.append(sprite->count() / wall);
+        perCpuSecond.append(sprite->count() / cpu);
+    }
+
+    addResult("thumbnails.perSecond", 1, perSecond, failures, "tiles/s");
+    addResult("thumbnails.perCpuSecond", 1, perCpuSecond, failures, "tiles/cpu-s");
+}
+
+QStringList PlayerBenchmark::createPlaylistFiles(int count)
+{
+    // 空文件即可：添加时只检查存在和扩展名，标题和艺术家从文件名解析
+    QDir dir(m_workDir.filePath("media"));
+    dir.mkpath(".");
+    QStringList files;
+    files.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QString fileName = dir.filePath(QString("clip_%1 Artist %2 - Title %3.mp3")
+                                            .arg(i, 6, 10, QChar('0')).arg(i % 100).arg(i));
+        QFile file(fileName);
+        if (file.open(QIODevice::WriteOnly)) {
+            files.append(fileName);
+        }
+    }
+    return files;
+}
+
+QStringList PlayerBenchmark::findOrGenerateClips()
+{
+    QStringList clips;
+    if (!m_options.mediaDir.isEmpty()) {
+        QDir dir(m_options.mediaDir);
+        for (const QString &name : dir.entryList(QDir::Files, QDir::Name)) {
+            clips.append(dir.filePath(name));
+        }
+        return clips;
+    }
+
+    // 没有指定片段时生成几段不同频率的正弦波
+    QDir dir(m_workDir.filePath("clips"));
+    dir.mkpath(".");
+    for (int i = 0; i < kClipCount; ++i) {
+        QString fileName = dir.filePath(QString("tone_%1.wav").arg(i));
+        if (TestMedia::writeSineWave(fileName, kClipSeconds * 1000, 220 * (i + 1))) {
+            clips.append(fileName);
+        }
+    }
+    return clips;
+}
+
+QStringList PlayerBenchmark::findOrGenerateVideos()
+{
+    QStringList videos;
+    if (!m_options.mediaDir.isEmpty()) {
+        QDir dir(m_options.mediaDir);
+        for (const QString &name : dir.entryList(QDir::Files, QDir::Name)) {
+            if (kVideoSuffixes.contains(QFileInfo(name).suffix().toLower())) {
+                videos.append(dir.filePath(name));
+            }
+        }
+        return videos;
+    }
+
+    QDir dir(m_workDir.filePath("videos"));
+    dir.mkpath(".");
+    for (int i = 0; i < kVideoCount; ++i) {
+        QString fileName = dir.filePath(QString("gop_%1.mp4").arg(i));
+        if (QFileInfo::exists(fileName) || writeVideo(fileName, kVideoSeconds, kVideoGopSize)) {
+            videos.append(fileName);
+        }
+    }
+    return videos;
+}
+
+bool PlayerBenchmark::writeVideo(const QString &fileName, int seconds, int gopSize)
+{
+    // 树中没有视频编码器，借用 ffmpeg；带 B 帧，容器中会有 ctts 和编辑列表
+    QString ffmpeg = QStandardPaths::findExecutable("ffmpeg");
+    if (ffmpeg.isEmpty()) {
+        return false;
+    }
+
+    for (const QStringList &codec : {QStringList() << "-c:v" << "libx264" << "-preset" << "veryfast",
+                                     QStringList() << "-c:v" << "mpeg4" << "-q:v" << "5"}) {
+        QStringList arguments;
+        arguments << "-v" << "error" << "-y"
+                  << "-f" << "lavfi" << "-i" << "testsrc2=size=1280x720:rate=25"
+                  << "-t" << QString::number(seconds)
+                  << codec
+                  << "-g" << QString::number(gopSize) << "-bf" << "2" << "-pix_fmt" << "yuv420p"
+                  << fileName;
+
+        QProcess process;
+        process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        process.start(ffmpeg, arguments);
+        if (process.waitForFinished(kVideoTimeout) && process.exitStatus() == QProcess::NormalExit &&
+            process.exitCode() == 0) {
+            return true;
+        }
+        process.kill();
+        process.waitForFinished();
+    }
+    QFile::remove(fileName);
+    return false;
+}
+
+qint64 PlayerBenchmark::mediaDuration(const QString &fileName)
+{
+    QMediaPlayer player;
+    QEventLoop loop;
+    connect(&player, &QMediaPlayer::mediaStatusChanged, &loop, [&](QMediaPlayer::MediaStatus status) {
+        if (status == QMediaPlayer::LoadedMedia || status == QMediaPlayer::InvalidMedia) {
+            loop.quit();
+        }
+    });
+    connect(&player, &QMediaPlayer::errorOccurred, &loop, &QEventLoop::quit);
+    QTimer::singleShot(kOutputTimeout, &loop, &QEventLoop::quit);
+    player.setSource(QUrl::fromLocalFile(fileName));
+    if (player.mediaStatus() != QMediaPlayer::LoadedMedia) {
+        loop.exec();
+    }
+    return player.duration();
+}
+
+double PlayerBenchmark::processCpuTime()
+{
+    // 进程所有线程（包括解码线程）累计的 CPU 时间，毫秒
+#ifdef Q_OS_WIN
+    FILETIME creation, exitTime, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user)) {
+        return 0;
+    }
+    auto ticks = [](const FILETIME &time) {
+        return (quint64(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return (ticks(kernel) + ticks(user)) / 1e4;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+#endif
+}
+
+qint64 PlayerBenchmark::residentSetSize()
+{
+    // 与性能信息面板的读法相同，字节
+#if defined(Q_OS_LINUX)
+    QFile file("/proc/self/statm");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    QList<QByteArray> fields = file.readAll().split(' ');
+    return fields.size() > 1 ? fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE) : -1;
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.WorkingSetSize);
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+void PlayerBenchmark::trimHeap()
+{
+    // 把已释放的堆内存还给系统，否则后一项会复用前一项留下的空间，增量偏小
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+}
+
+QList<MediaInfo> PlayerBenchmark::syntheticItems(int count)
+{
+    QList<MediaInfo> items;
+    items.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        MediaInfo info;
+        info.filePath = QString("/media/library/Artist %1/Album %2/clip_%3.mp3")
+                            .arg(i % 100).arg(i % 500).arg(i, 7, 10, QChar('0'));
+        info.title = QString("Title %1").arg(i);
+        info.artist = QString("Artist %1").arg(i % 100);
+        info.album = QString("Album %1").arg(i % 500);
+        info.codec = "mp3";
+        info.duration = 180000 + i % 60000;
+        info.metadataLoaded = true;
+        items.append(info);
+    }
+    return items;
+}
+
+void PlayerBenchmark::resetStorage()
+{
+    // 测试模式下的路径只属于基准测试
+    QSettings().clear();
+    QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).removeRecursively();
+    QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).removeRecursively();
+}
+
+void PlayerBenchmark::addResult(const QString &name, int scale, const QList<double> &samples, int failures,
+                                const QString &unit)
+{
+    QList<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0;
+    for (double value : sorted) {
+        total += value;
+    }
+
+    QJsonObject result;
+    result["name"] = name;
+    result["scale"] = scale;
+    result["unit"] = unit;
+    result["samples"] = int(sorted.size());
+    result["failures"] = failures;
+    result["min"] = sorted.isEmpty() ? 0.0 : sorted.first();
+    result["median"] = percentile(sorted, 0.5);
+    result["mean"] = sorted.isEmpty() ? 0.0 : total / sorted.size();
+    result["p95"] = percentile(sorted, 0.95);
+    result["max"] = sorted.isEmpty() ? 0.0 : sorted.last();
+    m_results.append(result);
+}
+
+double PlayerBenchmark::measureOutput(PlaybackEngine *engine, QVideoSink *sink, const std::function<void()> &action,
+                                      const std::function<bool(qint64)> &accept)
+{
+    QEventLoop loop;
+    QElapsedTimer timer;
+    double elapsed = -1;
+    auto finish = [&](bool ok) {
+        if (loop.isRunning()) {
+            elapsed = ok ? timer.nsecsElapsed() / 1e6 : -1;
+            loop.quit();
+        }
+    };
+
+    // 有视频时以帧为准，纯音频以播放位置为准
+    QObject context;
+    connect(sink, &QVideoSink::videoFrameChanged, &context, [&](const QVideoFrame &frame) {
+        if (frame.isValid() && accept(frame.startTime() / 1000)) {
+            finish(true);
+        }
+    });
+    connect(engine, &PlaybackEngine::positionChanged, &context, [&](qint64 position) {
+        if (position > 0 && !engine->hasVideo() && accept(position)) {
+            finish(true);
+        }
+    });
+    connect(engine, &PlaybackEngine::errorOccurred, &context, [&]() { finish(false); });
+    QTimer::singleShot(kOutputTimeout, &context, [&]() { finish(false); });
+
+    // 动作在事件循环开始后执行，同步送出的输出也能被捕获
+    QTimer::singleShot(0, &context, [&]() {
+        timer.start();
+        action();
+    });
+    loop.exec();
+    return elapsed;
+}
+
+double PlayerBenchmark::timeIt(const std::function<void()> &action)
+{
+    QElapsedTimer timer;
+    timer.start();
+    action();
+    return timer.nsecsElapsed() / 1e6;
+}
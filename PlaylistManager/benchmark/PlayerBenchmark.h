@@ -0,0 +1,86 @@
+// PlayerBenchmark.h
+#ifndef PLAYERBENCHMARK_H
+#define PLAYERBENCHMARK_H
+
+#include <QObject>
+#include <QTemporaryDir>
+#include <QJsonArray>
+#include <QStringList>
+#include <QVideoSink>
+#include <functional>
+
+#include "PlaybackEngine.h"
+#include "MediaInfo.h"
+
+// 无界面基准测试（PlayerBenchmark result.json）
+// 在 QT_QPA_PLATFORM=offscreen 下运行，测量：
+// - 播放列表的添加、搜索、保存、加载、随机排序在不同规模下的耗时；
+// - 慢速存储上从快照启动时 load() 返回和后台校验完成的时间；
+// - 10 万条目时 PlaylistModel + QListView 与旧的 QListWidget 的内存占用；
+// - 二进制播放列表文件的保存、整体加载和映射打开的耗时；
+// - 交叉淡入淡出每秒音频的混合耗时，元数据提取线程池每秒处理的文件数；
+// - 播放引擎打开到第一次输出、跳转、切换曲目的延迟；
+// - 播放视频时性能信息面板打开和关闭的进程 CPU 时间；
+// - 长 GOP 视频中跳到任意位置和跳到关键帧的延迟，拖动预览的帧率和最大延迟，
+//   以及进度条缩略图的生成速度。视频片段取自 --media 目录，没有时用 ffmpeg 生成。
+// 设置、播放列表和缓存都放在临时目录中，不影响正常使用的数据。结果写成 JSON，
+// 便于比较不同构建之间的差异。
+class PlayerBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        QString outputFile;
+        QList<int> scales;          // 播放列表规模
+        QList<int> fileScales;      // 播放列表文件读写的规模
+        int iterations;
+        QString mediaDir;           // 用于播放测试的片段，为空时生成 WAV 片段
+        bool playback;              // 是否运行播放引擎的测试
+
+        Options() : iterations(3), playback(true) {}
+    };
+
+    explicit PlayerBenchmark(const Options &options, QObject *parent = nullptr);
+
+    // 返回进程退出码
+    int run();
+
+private:
+    Options m_options;
+    QTemporaryDir m_workDir;
+    QJsonArray m_results;
+
+    void benchmarkPlaylist(int scale, const QStringList &files);
+    void benchmarkStartup(const QStringList &files);
+    void benchmarkPlaylistMemory(int scale);
+    void benchmarkPlaylistFile(int scale);
+    void benchmarkCrossfadeMix();
+    void benchmarkMetadata(const QStringList &files);
+    void benchmarkPlayback(const QStringList &clips);
+    void benchmarkSeek(const QStringList &videos);
+    void benchmarkOverlay(const QStringList &videos);
+    void benchmarkScrubPreview(const QStringList &videos);
+    void benchmarkThumbnails(const QStringList &videos);
+
+    QStringList createPlaylistFiles(int count);
+    QStringList findOrGenerateClips();
+    QStringList findOrGenerateVideos();
+    static bool writeVideo(const QString &fileName, int seconds, int gopSize);
+    static qint64 mediaDuration(const QString &fileName);
+    static double processCpuTime();
+    static qint64 residentSetSize();
+    static void trimHeap();
+    static QList<MediaInfo> syntheticItems(int count);
+
+    void resetStorage();
+    void addResult(const QString &name, int scale, const QList<double> &samples, int failures = 0,
+                   const QString &unit = "ms");
+
+    // 执行 action 后等待播放引擎输出满足 accept 的帧或位置，返回耗时（毫秒），超时返回 -1
+    static double measureOutput(PlaybackEngine *engine, QVideoSink *sink, const std::function<void()> &action,
+                                const std::function<bool(qint64)> &accept);
+    static double timeIt(const std::function<void()> &action);
+};
+
+#endif // PLAYERBENCHMARK_H
@@ -0,0 +1,57 @@
+// main.cpp
+#include <QApplication>
+#include <QCommandLineParser>
+#include "PlayerBenchmark.h"
+
+int main(int argc, char *argv[])
+{
+    // 在无显示器的机器上运行，视频帧和列表控件都不需要窗口系统
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    app.setApplicationName("PlayerBenchmark");
+    app.setApplicationVersion("1.0");
+    app.setOrganizationName("Qt6教程");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("播放列表和播放引擎的基准测试，结果写成 JSON。");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("output", "结果文件（JSON）。");
+    QCommandLineOption scalesOption("scales", "播放列表规模，逗号分隔（默认 1000,10000,50000）。", "list",
+                                    "1000,10000,50000");
+    QCommandLineOption fileScalesOption("file-scales", "播放列表文件读写的规模，逗号分隔（默认 10000,100000,1000000）。",
+                                        "list", "10000,100000,1000000");
+    QCommandLineOption iterationsOption("iterations", "每项重复次数（默认 3）。", "n", "3");
+    QCommandLineOption mediaOption("media", "播放测试使用的片段目录，省略时生成 WAV 片段。", "dir");
+    QCommandLineOption noPlaybackOption("no-playback", "跳过播放测试（没有多媒体后端的机器）。");
+    parser.addOption(scalesOption);
+    parser.addOption(fileScalesOption);
+    parser.addOption(iterationsOption);
+    parser.addOption(mediaOption);
+    parser.addOption(noPlaybackOption);
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(2);
+    }
+
+    PlayerBenchmark::Options options;
+    options.outputFile = parser.positionalArguments().constFirst();
+    for (const QString &scale : parser.value(scalesOption).split(',', Qt::SkipEmptyParts)) {
+        if (scale.toInt() > 0) {
+            options.scales.append(scale.toInt());
+        }
+    }
+    for (const QString &scale : parser.value(fileScalesOption).split(',', Qt::SkipEmptyParts)) {
+        if (scale.toInt() > 0) {
+            options.fileScales.append(scale.toInt());
+        }
+    }
+    options.iterations = qMax(1, parser.value(iterationsOption).toInt());
+    options.mediaDir = parser.value(mediaOption);
+    options.playback = !parser.isSet(noPlaybackOption);
+    return PlayerBenchmark(options).run();
+}
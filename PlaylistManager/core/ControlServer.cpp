@@ -0,0 +1,343 @@
+// ControlServer.cpp
+#include "ControlServer.h"
+#include <QFileInfo>
+#include <algorithm>
+
+namespace {
+const int kDefaultEventInterval = 50;   // 默认事件合并间隔（毫秒）
+const int kMaxEventInterval = 10000;
+const int kMaxLineLength = 64 * 1024;   // 超长的请求行视为协议错误并断开
+}
+
+ControlServer::ControlServer(PlaybackEngine *engine, PlaylistController *playlist, QObject *parent)
+    : QObject(parent)
+    , m_engine(engine)
+    , m_playlist(playlist)
+    , m_server(new QLocalServer(this))
+    , m_flushTimer(new QTimer(this))
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setTimerType(Qt::PreciseTimer);
+    m_clock.start();
+
+    connect(m_server, &QLocalServer::newConnection, this, &ControlServer::onNewConnection);
+    connect(m_flushTimer, &QTimer::timeout, this, &ControlServer::flushEvents);
+
+    connect(m_engine, &PlaybackEngine::playbackStateChanged, this, &ControlServer::onPlaybackStateChanged);
+    connect(m_engine, &PlaybackEngine::positionChanged, this, &ControlServer::onPositionChanged);
+    connect(m_engine, &PlaybackEngine::errorOccurred, this, &ControlServer::onError);
+    connect(m_playlist, &PlaylistController::mediaSelected, this, &ControlServer::onMediaSelected);
+}
+
+ControlServer::~ControlServer()
+{
+    close();
+}
+
+QString ControlServer::defaultServerName()
+{
+    // 按用户区分，同一台机器上的多个用户互不干扰
+    QString user = qEnvironmentVariable("USER", qEnvironmentVariable("USERNAME"));
+    return user.isEmpty() ? QString("PlaylistManager-control") : QString("PlaylistManager-control-%1").arg(user);
+}
+
+bool ControlServer::listen(const QString &name, QString *errorString)
+{
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    if (m_server->listen(name)) {
+        return true;
+    }
+
+    // 上次异常退出留下的套接字文件
+    if (m_server->serverError() == QAbstractSocket::AddressInUseError) {
+        QLocalServer::removeServer(name);
+        if (m_server->listen(name)) {
+            return true;
+        }
+    }
+
+    if (errorString) {
+        *errorString = m_server->errorString();
+    }
+    return false;
+}
+
+void ControlServer::close()
+{
+    m_server->close();
+    const QList<QLocalSocket *> sockets = m_clients.keys();
+    for (QLocalSocket *socket : sockets) {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+    m_clients.clear();
+    m_flushTimer->stop();
+}
+
+void ControlServer::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        m_clients.insert(socket, Client());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() {
+            readRequests(socket);
+        });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            m_clients.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void ControlServer::readRequests(QLocalSocket *socket)
+{
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end()) {
+        return;
+    }
+
+    // 这次读到的全部请求处理完后，应答合并为一次写入
+    QByteArray replies;
+    while (socket->canReadLine()) {
+        QByteArray line = socket->readLine().trimmed();
+        if (!line.isEmpty()) {
+            replies += handleRequest(it.value(), line);
+            // 处理请求时可能发出信号，连接列表可能已变化
+            it = m_clients.find(socket);
+            if (it == m_clients.end()) {
+                return;
+            }
+        }
+    }
+
+    if (socket->bytesAvailable() > kMaxLineLength) {
+        socket->abort();
+        return;
+    }
+
+    if (!replies.isEmpty()) {
+        socket->write(replies);
+    }
+}
+
+QByteArray ControlServer::handleRequest(Client &client, const QByteArray &line)
+{
+    int idEnd = line.indexOf(' ');
+    QByteArray id = idEnd < 0 ? line : line.left(idEnd);
+    QByteArray rest = idEnd < 0 ? QByteArray() : line.mid(idEnd + 1).trimmed();
+    int commandEnd = rest.indexOf(' ');
+    QByteArray command = commandEnd < 0 ? rest : rest.left(commandEnd);
+    QByteArray argument = commandEnd < 0 ? QByteArray() : rest.mid(commandEnd + 1).trimmed();
+
+    auto ok = [&id](const QByteArray &result = QByteArray()) {
+        return result.isEmpty() ? id + " ok\n" : id + " ok " + result + "\n";
+    };
+    auto error = [&id](QByteArray reason) {
+        return id + " error " + reason.replace('\n', ' ') + "\n";
+    };
+
+    if (command == "ping") {
+        return ok();
+    } else if (command == "play") {
+        emit playRequested();
+        return ok();
+    } else if (command == "pause") {
+        emit pauseRequested();
+        return ok();
+    } else if (command == "stop") {
+        emit stopRequested();
+        return ok();
+    } else if (command == "toggle") {
+        if (m_engine->playbackState() == QMediaPlayer::PlayingState) {
+            emit pauseRequested();
+        } else {
+            emit playRequested();
+        }
+        return ok();
+    } else if (command == "next") {
+        emit nextRequested();
+        return ok(QByteArray::number(m_playlist->currentIndex()));
+    } else if (command == "previous") {
+        emit previousRequested();
+        return ok(QByteArray::number(m_playlist->currentIndex()));
+    } else if (command == "seek") {
+        bool valid = false;
+        qint64 position = argument.toLongLong(&valid);
+        if (!valid || position < 0) {
+            return error("invalid position");
+        }
+        if (m_engine->source().isEmpty()) {
+            return error("no media");
+        }
+        m_engine->setPosition(position);
+        return ok();
+    } else if (command == "load") {
+        QString fileName = QString::fromUtf8(argument);
+        if (fileName.isEmpty() || !QFileInfo::exists(fileName)) {
+            return error("no such file");
+        }
+        // 替换当前列表；第一批加入时自动选中第一项
+        m_playlist->beginUpdate();
+        m_playlist->clear();
+        QString errorString;
+        int imported = m_playlist->importPlaylist(fileName, &errorString);
+        m_playlist->endUpdate();
+        if (imported < 0) {
+            return error(errorString.toUtf8());
+        }
+        return ok(QByteArray::number(imported));
+    } else if (command == "state") {
+        return ok(stateReply());
+    } else if (command == "subscribe") {
+        int interval = kDefaultEventInterval;
+        if (!argument.isEmpty()) {
+            bool valid = false;
+            interval = argument.toInt(&valid);
+            if (!valid || interval < 0 || interval > kMaxEventInterval) {
+                return error("invalid interval");
+            }
+        }
+        client.subscribed = true;
+        client.interval = interval;
+        // 订阅后先收到一次完整状态
+        client.events += "! state " + stateName(m_engine->playbackState()) + "\n";
+        client.positionPending = true;
+        scheduleFlush();
+        return ok();
+    } else if (command == "unsubscribe") {
+        client.subscribed = false;
+        client.events.clear();
+        client.positionPending = false;
+        return ok();
+    }
+
+    return error(command.isEmpty() ? QByteArray("missing command") : "unknown command " + command);
+}
+
+QByteArray ControlServer::stateReply() const
+{
+    // 路径可能包含空格，放在最后
+    QByteArray reply = "state=" + stateName(m_engine->playbackState());
+    reply += " position=" + QByteArray::number(m_engine->position());
+    reply += " duration=" + QByteArray::number(m_engine->duration());
+    reply += " index=" + QByteArray::number(m_playlist->currentIndex());
+    reply += " count=" + QByteArray::number(m_playlist->count());
+    reply += " mode=" + QByteArray::number(static_cast<int>(m_playlist->playMode()));
+    reply += " path=" + m_playlist->currentMedia().filePath.toUtf8();
+    return reply;
+}
+
+void ControlServer::onPlaybackStateChanged(QMediaPlayer::PlaybackState state)
+{
+    postEvent("! state " + stateName(state) + "\n");
+}
+
+void ControlServer::onPositionChanged(qint64 position)
+{
+    Q_UNUSED(position);
+    bool any = false;
+    for (Client &client : m_clients) {
+        if (client.subscribed) {
+            client.positionPending = true;
+            any = true;
+        }
+    }
+    if (any) {
+        scheduleFlush();
+    }
+}
+
+void ControlServer::onMediaSelected(int index)
+{
+    QByteArray path = m_playlist->mediaAt(index).filePath.toUtf8();
+    postEvent("! media " + QByteArray::number(index) + " " + path + "\n");
+}
+
+void ControlServer::onError(QMediaPlayer::Error error, const QString &errorString)
+{
+    Q_UNUSED(error);
+    postEvent("! error " + errorString.toUtf8().replace('\n', ' ') + "\n");
+}
+
+void ControlServer::postEvent(const QByteArray &event)
+{
+    bool any = false;
+    for (Client &client : m_clients) {
+        if (client.subscribed) {
+            client.events += event;
+            any = true;
+        }
+    }
+    if (any) {
+        scheduleFlush();
+    }
+}
+
+void ControlServer::scheduleFlush()
+{
+    // 回到事件循环后再写出：同一轮中产生的事件合并为一次写入，
+    // 也保证订阅时的初始事件排在应答之后。定时器只在空闲或新的到期时间
+    // 更早时重设，间隔内频繁的位置变化不会反复唤醒 flushEvents()
+    qint64 now = m_clock.elapsed();
+    qint64 nextDue = -1;
+    for (const Client &client : std::as_const(m_clients)) {
+        if (!client.subscribed || (client.events.isEmpty() && !client.positionPending)) {
+            continue;
+        }
+        qint64 due = qMax(now, client.lastFlush + client.interval);
+        nextDue = nextDue < 0 ? due : qMin(nextDue, due);
+    }
+    if (nextDue < 0) {
+        return;
+    }
+
+    int delay = int(nextDue - now);
+    if (!m_flushTimer->isActive() || delay < m_flushTimer->remainingTime()) {
+        m_flushTimer->start(delay);
+    }
+}
+
+void ControlServer::flushEvents()
+{
+    // 到了间隔的连接立即写出；其余的按最早到期的时间再检查一次
+    qint64 now = m_clock.elapsed();
+    qint64 nextDue = -1;
+
+    for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+        Client &client = it.value();
+        if (!client.subscribed || (client.events.isEmpty() && !client.positionPending)) {
+            continue;
+        }
+
+        qint64 due = client.lastFlush + client.interval;
+        if (due > now) {
+            nextDue = nextDue < 0 ? due : qMin(nextDue, due);
+            continue;
+        }
+
+        if (client.positionPending) {
+            client.events += "! position " + QByteArray::number(m_engine->position()) + " "
+                             + QByteArray::number(m_engine->duration()) + "\n";
+            client.positionPending = false;
+        }
+        it.key()->write(client.events);
+        client.events.clear();
+        client.lastFlush = now;
+    }
+
+    if (nextDue >= 0) {
+        m_flushTimer->start(int(nextDue - now));
+    }
+}
+
+QByteArray ControlServer::stateName(QMediaPlayer::PlaybackState state)
+{
+    switch (state) {
+    case QMediaPlayer::PlayingState:
+        return "playing";
+    case QMediaPlayer::PausedState:
+        return "paused";
+    default:
+        return "stopped";
+    }
+}
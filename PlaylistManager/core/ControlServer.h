@@ -0,0 +1,85 @@
+// ControlServer.h
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QHash>
+#include <QTimer>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+#include "PlaybackEngine.h"
+#include "PlaylistController.h"
+
+// 本机控制接口（QLocalServer，按行的文本协议）
+//
+// 请求：  <id> <命令> [参数]        例如 "7 seek 12000"
+// 应答：  <id> ok [结果]  或  <id> error <原因>
+// 事件：  ! <事件> [参数]           只发给已订阅的连接
+//
+// 命令：ping、play、pause、stop、toggle、next、previous、seek <毫秒>、
+//       load <播放列表文件>、state、subscribe [间隔毫秒]、unsubscribe
+// 事件：state <playing|paused|stopped>、position <毫秒> <时长>、media <行号> <路径>、
+//       error <原因>
+//
+// 一次读到的多条请求逐条处理，应答合并为一次写入；事件先放进每个连接的缓冲区，
+// 按订阅间隔合并写出，同一间隔内的多次位置变化只保留最后一次。
+class ControlServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    ControlServer(PlaybackEngine *engine, PlaylistController *playlist, QObject *parent = nullptr);
+    ~ControlServer();
+
+    static QString defaultServerName();
+    bool listen(const QString &name = defaultServerName(), QString *errorString = nullptr);
+    void close();
+    bool isListening() const { return m_server->isListening(); }
+    QString serverName() const { return m_server->serverName(); }
+
+signals:
+    // 播放控制交给播放器处理，与界面上的按钮行为一致
+    void playRequested();
+    void pauseRequested();
+    void stopRequested();
+    void nextRequested();
+    void previousRequested();
+
+private slots:
+    void onNewConnection();
+    void onPlaybackStateChanged(QMediaPlayer::PlaybackState state);
+    void onPositionChanged(qint64 position);
+    void onMediaSelected(int index);
+    void onError(QMediaPlayer::Error error, const QString &errorString);
+    void flushEvents();
+
+private:
+    struct Client {
+        QByteArray events;      // 等待写出的事件
+        bool subscribed;
+        bool positionPending;   // 位置事件在写出时才生成，只保留最新值
+        int interval;           // 事件合并间隔（毫秒）
+        qint64 lastFlush;       // 上次写出事件的时间
+
+        Client() : subscribed(false), positionPending(false), interval(0), lastFlush(0) {}
+    };
+
+    PlaybackEngine *m_engine;
+    PlaylistController *m_playlist;
+    QLocalServer *m_server;
+    QHash<QLocalSocket *, Client> m_clients;
+    QTimer *m_flushTimer;
+    QElapsedTimer m_clock;
+
+    void readRequests(QLocalSocket *socket);
+    QByteArray handleRequest(Client &client, const QByteArray &line);
+    QByteArray stateReply() const;
+    void postEvent(const QByteArray &event);
+    void scheduleFlush();
+    static QByteArray stateName(QMediaPlayer::PlaybackState state);
+};
+
+#endif // CONTROLSERVER_H
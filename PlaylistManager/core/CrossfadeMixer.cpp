@@ -0,0 +1,380 @@
+// CrossfadeMixer.cpp
+#include "CrossfadeMixer.h"
+#include <QIODevice>
+#include <QtMath>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define CROSSFADE_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CROSSFADE_NEON
+#endif
+
+namespace {
+const int kSampleRate = 48000;
+const int kChannels = 2;
+const int kBlockFrames = 256;               // 每块先算增益再整块混合
+const int kMaxChannels = 8;
+const qint64 kStartLeadMsecs = 500;         // 开始时下一项至少已解码的长度
+
+// dst[i] = out[i] * gainOut[i] + in[i] * gainIn[i]
+void mixSamples(const float *out, const float *in, const float *gainOut, const float *gainIn, float *dst,
+                int count)
+{
+    int i = 0;
+#if defined(CROSSFADE_SSE)
+    for (; i + 4 <= count; i += 4) {
+        __m128 o = _mm_mul_ps(_mm_loadu_ps(out + i), _mm_loadu_ps(gainOut + i));
+        __m128 n = _mm_mul_ps(_mm_loadu_ps(in + i), _mm_loadu_ps(gainIn + i));
+        _mm_storeu_ps(dst + i, _mm_add_ps(o, n));
+    }
+#elif defined(CROSSFADE_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t o = vmulq_f32(vld1q_f32(out + i), vld1q_f32(gainOut + i));
+        float32x4_t n = vmulq_f32(vld1q_f32(in + i), vld1q_f32(gainIn + i));
+        vst1q_f32(dst + i, vaddq_f32(o, n));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = out[i] * gainOut[i] + in[i] * gainIn[i];
+    }
+}
+}
+
+// 拉模式的输出设备：音频输出需要数据时现场混合
+class MixDevice : public QIODevice
+{
+public:
+    explicit MixDevice(CrossfadeMixer *mixer) : QIODevice(mixer), m_mixer(mixer) {}
+
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override { return m_mixer->readMixed(data, maxSize); }
+    qint64 writeData(const char *data, qint64 maxSize) override
+    {
+        Q_UNUSED(data);
+        Q_UNUSED(maxSize);
+        return -1;
+    }
+
+private:
+    CrossfadeMixer *m_mixer;
+};
+
+CrossfadeMixer::CrossfadeMixer(QObject *parent)
+    : QObject(parent)
+    , m_sink(nullptr)
+    , m_device(nullptr)
+    , m_volume(1.0f)
+    , m_startFrame(0)
+    , m_rampFrames(1)
+    , m_position(0)
+    , m_drained(false)
+{
+    setupSource(m_outgoing);
+    setupSource(m_incoming);
+}
+
+CrossfadeMixer::~CrossfadeMixer()
+{
+    stop();
+}
+
+CrossfadeMixer::Gain CrossfadeMixer::gain(qreal progress)
+{
+    // 等功率曲线：两路增益的平方和为 1，过渡中点的响度不会下陷
+    qreal t = qBound(0.0, progress, 1.0);
+    Gain gain;
+    gain.in = float(qSin(t * M_PI_2));
+    gain.out = float(qCos(t * M_PI_2));
+    return gain;
+}
+
+void CrossfadeMixer::mix(const float *out, const float *in, float *dst, int frames, int channels,
+                         qint64 startFrame, qint64 rampFrames)
+{
+    Q_ASSERT(channels > 0 && channels <= kMaxChannels);
+
+    // 增益按帧计算并展开到每个采样，混合部分是连续的乘加，整块向量化
+    float gainOut[kBlockFrames * kMaxChannels];
+    float gainIn[kBlockFrames * kMaxChannels];
+    for (int done = 0; done < frames; done += kBlockFrames) {
+        int count = qMin(kBlockFrames, frames - done);
+        for (int k = 0; k < count; ++k) {
+            qint64 frame = startFrame + done + k;
+            Gain g = gain(rampFrames > 0 ? qreal(frame) / rampFrames : 1.0);
+            for (int c = 0; c < channels; ++c) {
+                gainOut[k * channels + c] = g.out;
+                gainIn[k * channels + c] = g.in;
+            }
+        }
+        int offset = done * channels;
+        mixSamples(out + offset, in + offset, gainOut, gainIn, dst + offset, count * channels);
+    }
+}
+
+QAudioFormat CrossfadeMixer::mixFormat()
+{
+    QAudioFormat format;
+    format.setSampleRate(kSampleRate);
+    format.setChannelCount(kChannels);
+    format.setSampleFormat(QAudioFormat::Float);
+    return format;
+}
+
+void CrossfadeMixer::prepare(const QUrl &outgoing, qint64 keepFrom, const QUrl &incoming, int durationMs)
+{
+    if (isActive()) {
+        return;
+    }
+    if (m_outgoing.url != outgoing) {
+        openSource(m_outgoing, outgoing, msecsToFrames(qMax<qint64>(0, keepFrom)), -1);
+    }
+    if (m_incoming.url != incoming) {
+        openSource(m_incoming, incoming, 0, msecsToFrames(durationMs));
+    }
+}
+
+bool CrossfadeMixer::isPrepared(const QUrl &outgoing, const QUrl &incoming) const
+{
+    return !outgoing.isEmpty() && m_outgoing.url == outgoing && m_incoming.url == incoming;
+}
+
+bool CrossfadeMixer::canStart(qint64 from) const
+{
+    if (m_outgoing.url.isEmpty() || m_outgoing.failed || m_incoming.failed) {
+        return false;
+    }
+
+    // 上一项要解码过淡出点，下一项开头要有一段余量，之后解码比播放快
+    qint64 frame = msecsToFrames(from);
+    qint64 lead = msecsToFrames(kStartLeadMsecs);
+    bool outgoingReady = m_outgoing.keepFrom <= frame && (m_outgoing.done || m_outgoing.decodedFrames > frame + lead);
+    bool incomingReady = m_incoming.done || m_incoming.decodedFrames >= lead;
+    return outgoingReady && incomingReady;
+}
+
+void CrossfadeMixer::start(qint64 from, int durationMs)
+{
+    if (m_sink) {
+        disconnect(m_sink, nullptr, this, nullptr);
+        m_sink->stop();
+        m_sink->deleteLater();
+        m_device->deleteLater();
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_startFrame = msecsToFrames(from);
+        m_rampFrames = qMax<qint64>(1, msecsToFrames(durationMs));
+        m_position = 0;
+        m_drained = false;
+    }
+
+    m_device = new MixDevice(this);
+    m_device->open(QIODevice::ReadOnly);
+    m_sink = new QAudioSink(mixFormat(), this);
+    m_sink->setVolume(m_volume);
+    connect(m_sink, &QAudioSink::stateChanged, this, &CrossfadeMixer::onSinkStateChanged);
+    m_sink->start(m_device);
+}
+
+void CrossfadeMixer::stop()
+{
+    if (m_sink) {
+        // 可能在输出的状态通知中调用，延后删除
+        disconnect(m_sink, nullptr, this, nullptr);
+        m_sink->stop();
+        m_sink->deleteLater();
+        m_device->deleteLater();
+        m_sink = nullptr;
+        m_device = nullptr;
+    }
+    resetSource(m_outgoing);
+    resetSource(m_incoming);
+}
+
+void CrossfadeMixer::suspend()
+{
+    if (m_sink) {
+        m_sink->suspend();
+    }
+}
+
+void CrossfadeMixer::resume()
+{
+    if (m_sink) {
+        m_sink->resume();
+    }
+}
+
+void CrossfadeMixer::setVolume(float volume)
+{
+    m_volume = volume;
+    if (m_sink) {
+        m_sink->setVolume(volume);
+    }
+}
+
+void CrossfadeMixer::setupSource(Source &source)
+{
+    source.decoder = new QAudioDecoder(this);
+    source.decoder->setAudioFormat(mixFormat());
+    source.firstFrame = 0;
+    source.decodedFrames = 0;
+    source.keepFrom = 0;
+    source.keepUntil = -1;
+    source.done = false;
+    source.failed = false;
+
+    Source *target = &source;
+    connect(source.decoder, &QAudioDecoder::bufferReady, this, [this, target]() {
+        onBufferReady(*target);
+    });
+    connect(source.decoder, &QAudioDecoder::finished, this, [target]() {
+        target->done = true;
+    });
+    connect(source.decoder, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error), this,
+            [target](QAudioDecoder::Error error) {
+        qWarning("CrossfadeMixer: cannot decode %s (error %d)", qPrintable(target->url.toString()), int(error));
+        target->failed = true;
+        target->done = true;
+    });
+}
+
+void CrossfadeMixer::openSource(Source &source, const QUrl &url, qint64 keepFrom, qint64 keepUntil)
+{
+    resetSource(source);
+    source.url = url;
+    source.keepFrom = keepFrom;
+    source.keepUntil = keepUntil;
+    if (url.isEmpty()) {
+        return;
+    }
+    source.decoder->setSource(url);
+    source.decoder->start();
+}
+
+void CrossfadeMixer::resetSource(Source &source)
+{
+    source.decoder->stop();
+    QMutexLocker locker(&m_mutex);
+    source.url.clear();
+    source.samples.clear();
+    source.samples.shrink_to_fit();
+    source.firstFrame = 0;
+    source.decodedFrames = 0;
+    source.done = false;
+    source.failed = false;
+}
+
+void CrossfadeMixer::onBufferReady(Source &source)
+{
+    QAudioBuffer buffer = source.decoder->read();
+    if (!buffer.isValid() || source.done) {
+        return;
+    }
+
+    QAudioFormat format = buffer.format();
+    if (format.sampleRate() != kSampleRate || format.channelCount() <= 0) {
+        // 解码后端不能转换采样率，不做淡入淡出
+        qWarning("CrossfadeMixer: unsupported sample rate %d", format.sampleRate());
+        source.decoder->stop();
+        source.failed = true;
+        source.done = true;
+        return;
+    }
+
+    // 只保留 [keepFrom, keepUntil) 的帧，统一成交错立体声浮点
+    qint64 frames = buffer.frameCount();
+    qint64 begin = qMax(source.decodedFrames, source.keepFrom);
+    qint64 end = source.decodedFrames + frames;
+    if (source.keepUntil >= 0) {
+        end = qMin(end, source.keepUntil);
+    }
+    if (end > begin) {
+        int channels = format.channelCount();
+        int bytes = format.bytesPerSample();
+        const char *data = buffer.constData<char>();
+
+        QMutexLocker locker(&m_mutex);
+        if (source.samples.empty()) {
+            source.firstFrame = begin;
+        }
+        size_t offset = source.samples.size();
+        source.samples.resize(offset + size_t(end - begin) * kChannels);
+        float *dst = source.samples.data() + offset;
+        for (qint64 frame = begin; frame < end; ++frame) {
+            const char *sample = data + (frame - source.decodedFrames) * channels * bytes;
+            for (int c = 0; c < kChannels; ++c) {
+                *dst++ = format.normalizedSampleValue(sample + qMin(c, channels - 1) * bytes);
+            }
+        }
+    }
+
+    source.decodedFrames += frames;
+    if (source.keepUntil >= 0 && source.decodedFrames >= source.keepUntil) {
+        source.decoder->stop();
+        source.done = true;
+    }
+}
+
+void CrossfadeMixer::onSinkStateChanged(QAudio::State state)
+{
+    // 淡入淡出的最后一块已经送出并播放完，或者输出出错
+    bool drained = false;
+    if (state == QAudio::IdleState) {
+        QMutexLocker locker(&m_mutex);
+        drained = m_drained;
+    }
+    bool failed = state == QAudio::StoppedState && m_sink && m_sink->error() != QAudio::NoError;
+    if (drained || failed) {
+        stop();
+        emit finished();
+    }
+}
+
+qint64 CrossfadeMixer::readMixed(char *data, qint64 maxSize)
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 frames = qMin<qint64>(maxSize / qint64(sizeof(float) * kChannels), m_rampFrames - m_position);
+    if (frames <= 0) {
+        m_drained = m_position >= m_rampFrames;
+        return 0;
+    }
+
+    size_t samples = size_t(frames) * kChannels;
+    if (m_mixBlock.size() < samples) {
+        m_outBlock.resize(samples);
+        m_inBlock.resize(samples);
+        m_mixBlock.resize(samples);
+    }
+    copyFrames(m_outgoing, m_startFrame + m_position, m_outBlock.data(), frames);
+    copyFrames(m_incoming, m_position, m_inBlock.data(), frames);
+    mix(m_outBlock.data(), m_inBlock.data(), m_mixBlock.data(), int(frames), kChannels, m_position, m_rampFrames);
+    std::memcpy(data, m_mixBlock.data(), samples * sizeof(float));
+
+    m_position += frames;
+    return qint64(samples * sizeof(float));
+}
+
+void CrossfadeMixer::copyFrames(const Source &source, qint64 frame, float *dst, qint64 frames)
+{
+    // 还没解码到或已超出曲目结尾的部分补零
+    std::memset(dst, 0, size_t(frames) * kChannels * sizeof(float));
+    qint64 available = qint64(source.samples.size() / kChannels);
+    qint64 begin = qMax(frame, source.firstFrame);
+    qint64 end = qMin(frame + frames, source.firstFrame + available);
+    if (end > begin) {
+        std::memcpy(dst + (begin - frame) * kChannels, source.samples.data() + (begin - source.firstFrame) * kChannels,
+                    size_t(end - begin) * kChannels * sizeof(float));
+    }
+}
+
+qint64 CrossfadeMixer::msecsToFrames(qint64 msecs)
+{
+    return msecs * kSampleRate / 1000;
+}
@@ -0,0 +1,103 @@
+// CrossfadeMixer.h
+#ifndef CROSSFADEMIXER_H
+#define CROSSFADEMIXER_H
+
+#include <QObject>
+#include <QAudioDecoder>
+#include <QAudioBuffer>
+#include <QAudioFormat>
+#include <QAudioSink>
+#include <QMutex>
+#include <QUrl>
+#include <vector>
+
+class QIODevice;
+
+// 交叉淡入淡出混音
+// 两个 QAudioDecoder 同时解码上一项的结尾和下一项的开头，统一转换成 48kHz 立体声的
+// 交错浮点 PCM。淡入淡出期间按帧计算等功率增益（精确到采样），两路在 mix() 中
+// 以 SIMD 逐块混合，经 QAudioSink（拉模式）输出。
+// QAudioDecoder 不能跳转，上一项要在淡出开始前提前解码，只保留淡出点附近之后的部分。
+class CrossfadeMixer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Gain {
+        float in;       // 新项目
+        float out;      // 上一项
+    };
+    // 淡入淡出进度 progress（0~1，超出时截断）处两路的增益，平方和恒为 1
+    static Gain gain(qreal progress);
+
+    // 混合 frames 帧交错排列的 PCM：第 k 帧的增益取 gain((startFrame + k) / rampFrames)，
+    // 分块调用的结果与一次调用相同
+    static void mix(const float *out, const float *in, float *dst, int frames, int channels,
+                    qint64 startFrame, qint64 rampFrames);
+
+    // 混音和输出使用的格式
+    static QAudioFormat mixFormat();
+
+    explicit CrossfadeMixer(QObject *parent = nullptr);
+    ~CrossfadeMixer();
+
+    // 开始提前解码：上一项丢弃 keepFrom（毫秒）之前的部分，下一项解码开头 durationMs；
+    // 与已在准备的两项相同时不做任何事
+    void prepare(const QUrl &outgoing, qint64 keepFrom, const QUrl &incoming, int durationMs);
+    bool isPrepared(const QUrl &outgoing, const QUrl &incoming) const;
+    // 上一项已解码到 from（毫秒）之后，可以从这里开始淡出
+    bool canStart(qint64 from) const;
+
+    // 从上一项的 from 处开始输出 durationMs 的淡入淡出，结束后发出 finished()
+    void start(qint64 from, int durationMs);
+    // 停止输出并丢弃已解码的数据
+    void stop();
+    void suspend();
+    void resume();
+    void setVolume(float volume);
+    bool isActive() const { return m_sink != nullptr; }
+
+signals:
+    void finished();
+
+private:
+    friend class MixDevice;
+
+    struct Source {
+        QAudioDecoder *decoder;
+        QUrl url;
+        std::vector<float> samples;     // 交错立体声
+        qint64 firstFrame;              // samples 第一帧在曲目中的帧号
+        qint64 decodedFrames;           // 已解码的总帧数
+        qint64 keepFrom;                // 此帧之前的数据丢弃
+        qint64 keepUntil;               // 解码到此帧后停止，-1 表示到结尾
+        bool done;
+        bool failed;
+    };
+
+    Source m_outgoing;
+    Source m_incoming;
+    mutable QMutex m_mutex;             // 样本由解码器在 GUI 线程写入，由音频输出读取
+
+    QAudioSink *m_sink;
+    QIODevice *m_device;
+    float m_volume;
+    qint64 m_startFrame;                // 上一项中开始淡出的帧
+    qint64 m_rampFrames;
+    qint64 m_position;                  // 已输出的帧数
+    bool m_drained;
+    std::vector<float> m_outBlock;
+    std::vector<float> m_inBlock;
+    std::vector<float> m_mixBlock;
+
+    void setupSource(Source &source);
+    void openSource(Source &source, const QUrl &url, qint64 keepFrom, qint64 keepUntil);
+    void resetSource(Source &source);
+    void onBufferReady(Source &source);
+    void onSinkStateChanged(QAudio::State state);
+    qint64 readMixed(char *data, qint64 maxSize);
+    static void copyFrames(const Source &source, qint64 frame, float *dst, qint64 frames);
+    static qint64 msecsToFrames(qint64 msecs);
+};
+
+#endif // CROSSFADEMIXER_H
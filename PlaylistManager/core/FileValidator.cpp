@@ -0,0 +1,131 @@
+// FileValidator.cpp
+#include "FileValidator.h"
+#include <QFileInfo>
+#include <QDateTime>
+#include <QAtomicInt>
+
+namespace {
+const int kChunkSize = 32;   // 每批文件数，越小优先级调整越及时
+
+QAtomicInt statDelay;        // 微秒，0 表示不等待
+}
+
+void FileValidatorWorker::setStatDelay(int microseconds)
+{
+    statDelay.storeRelaxed(qMax(0, microseconds));
+}
+
+void FileValidatorWorker::check(const QList<FileStatus> &chunk)
+{
+    QList<FileStatus> results = chunk;
+    const int delay = statDelay.loadRelaxed();
+    for (FileStatus &status : results) {
+        if (delay > 0) {
+            QThread::usleep(delay);
+        }
+        QFileInfo fileInfo(status.filePath);
+        status.exists = fileInfo.exists();
+        if (status.exists) {
+            status.fileSize = fileInfo.size();
+            status.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+        }
+    }
+    emit checked(results);
+}
+
+FileValidator::FileValidator(QObject *parent)
+    : QObject(parent)
+    , m_thread(new QThread(this))
+    , m_worker(new FileValidatorWorker())
+    , m_busy(false)
+{
+    qRegisterMetaType<FileStatus>();
+    qRegisterMetaType<QList<FileStatus>>();
+
+    m_thread->setObjectName("FileValidator");
+    m_worker->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_worker, &FileValidatorWorker::checked, this, &FileValidator::onChecked);
+    m_thread->start(QThread::LowPriority);
+}
+
+FileValidator::~FileValidator()
+{
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void FileValidator::enqueue(quint64 id, const QString &filePath)
+{
+    if (id == 0 || m_pending.contains(id)) {
+        return;
+    }
+
+    m_pending.insert(id, filePath);
+    m_queue.enqueue(id);
+    dispatch();
+}
+
+void FileValidator::prioritize(const QList<quint64> &ids)
+{
+    m_urgent.clear();
+    for (quint64 id : ids) {
+        if (m_pending.contains(id)) {
+            m_urgent.enqueue(id);
+        }
+    }
+}
+
+void FileValidator::cancel(quint64 id)
+{
+    // 队列中的ID在出队时按 m_pending 过滤
+    m_pending.remove(id);
+}
+
+void FileValidator::cancelAll()
+{
+    m_pending.clear();
+    m_queue.clear();
+    m_urgent.clear();
+}
+
+void FileValidator::onChecked(const QList<FileStatus> &results)
+{
+    m_busy = false;
+    emit validated(results);
+    dispatch();
+}
+
+void FileValidator::dispatch()
+{
+    if (m_busy || m_pending.isEmpty()) {
+        return;
+    }
+
+    QList<FileStatus> chunk;
+    chunk.reserve(kChunkSize);
+
+    while (chunk.size() < kChunkSize && (!m_urgent.isEmpty() || !m_queue.isEmpty())) {
+        quint64 id = !m_urgent.isEmpty() ? m_urgent.dequeue() : m_queue.dequeue();
+        auto it = m_pending.find(id);
+        if (it == m_pending.end()) {
+            continue;  // 已取消或已作为优先项处理
+        }
+
+        FileStatus status;
+        status.id = id;
+        status.filePath = it.value();
+        chunk.append(status);
+        m_pending.erase(it);
+    }
+
+    if (chunk.isEmpty()) {
+        return;
+    }
+
+    m_busy = true;
+    FileValidatorWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, chunk]() {
+        worker->check(chunk);
+    }, Qt::QueuedConnection);
+}
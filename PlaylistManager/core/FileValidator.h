@@ -0,0 +1,78 @@
+// FileValidator.h
+#ifndef FILEVALIDATOR_H
+#define FILEVALIDATOR_H
+
+#include <QObject>
+#include <QThread>
+#include <QQueue>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QMetaType>
+
+// 单个文件的校验结果
+struct FileStatus {
+    quint64 id;
+    QString filePath;
+    bool exists;
+    qint64 fileSize;
+    qint64 lastModified;
+
+    FileStatus() : id(0), exists(false), fileSize(-1), lastModified(0) {}
+};
+
+Q_DECLARE_METATYPE(FileStatus)
+
+// 工作线程中逐个 stat 文件
+class FileValidatorWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 每个文件 stat 之前额外等待的时间（微秒），基准测试用来模拟慢速的网络存储
+    static void setStatDelay(int microseconds);
+
+public slots:
+    void check(const QList<FileStatus> &chunk);
+
+signals:
+    void checked(const QList<FileStatus> &results);
+};
+
+// 后台文件校验
+// 启动时不再同步检查每个文件是否存在，而是在工作线程中分小批 stat。
+// 同一时间只有一批在处理，prioritize() 提交的项（可见行、即将播放的项）
+// 会在下一批中优先处理，网络存储上也能很快得到屏幕上条目的状态。
+class FileValidator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileValidator(QObject *parent = nullptr);
+    ~FileValidator();
+
+    void enqueue(quint64 id, const QString &filePath);
+    // 用新的优先列表替换旧的（只保留最近一次视图/播放顺序）
+    void prioritize(const QList<quint64> &ids);
+    void cancel(quint64 id);
+    void cancelAll();
+
+    bool isIdle() const { return m_pending.isEmpty() && !m_busy; }
+    int pendingCount() const { return m_pending.size(); }
+
+signals:
+    void validated(const QList<FileStatus> &results);
+
+private:
+    QThread *m_thread;
+    FileValidatorWorker *m_worker;
+    QHash<quint64, QString> m_pending;   // 尚未提交的项
+    QQueue<quint64> m_queue;             // 默认顺序
+    QQueue<quint64> m_urgent;            // 优先处理
+    bool m_busy;
+
+    void onChecked(const QList<FileStatus> &results);
+    void dispatch();
+};
+
+#endif // FILEVALIDATOR_H
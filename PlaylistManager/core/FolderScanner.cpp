@@ -0,0 +1,373 @@
+// FolderScanner.cpp
+#include "FolderScanner.h"
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QFile>
+#include <QDateTime>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QPair>
+#include <QHash>
+#include <algorithm>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace {
+const int kCollectInterval = 30;    // 汇总结果的间隔（毫秒）
+const int kFrameBudget = 8;         // 每次汇总最多占用GUI线程的时间（毫秒）
+const int kChunkSize = 500;
+
+// 一次 stat 同时取大小、修改时间和 (设备, inode)；符号链接取目标的
+bool statFile(const QString &path, ScannedFile *file, FolderScanner::NodeKey *key)
+{
+#ifdef Q_OS_UNIX
+    struct stat st;
+    if (::stat(QFile::encodeName(path).constData(), &st) != 0) {
+        return false;
+    }
+#ifdef Q_OS_DARWIN
+    const struct timespec &mtime = st.st_mtimespec;
+#else
+    const struct timespec &mtime = st.st_mtim;
+#endif
+    file->fileSize = qint64(st.st_size);
+    // 与 QFileInfo::lastModified() 的毫秒精度一致，元数据缓存的键不变
+    file->lastModified = qint64(mtime.tv_sec) * 1000 + mtime.tv_nsec / 1000000;
+    *key = FolderScanner::NodeKey(quint64(st.st_dev), quint64(st.st_ino));
+    return true;
+#else
+    QFileInfo info(path);
+    if (!info.exists() || !FolderScanner::nodeKey(path, key)) {
+        return false;
+    }
+    file->fileSize = info.size();
+    file->lastModified = info.lastModified().toMSecsSinceEpoch();
+    return true;
+#endif
+}
+}
+
+bool FolderScanner::nodeKey(const QString &path, NodeKey *key)
+{
+#ifdef Q_OS_UNIX
+    struct stat st;
+    if (::stat(QFile::encodeName(path).constData(), &st) != 0) {
+        return false;
+    }
+    *key = NodeKey(quint64(st.st_dev), quint64(st.st_ino));
+    return true;
+#else
+    // 没有 inode 的平台按规范路径区分
+    QString canonical = QFileInfo(path).canonicalFilePath();
+    if (canonical.isEmpty()) {
+        return false;
+    }
+    *key = NodeKey(qHash(canonical, 0), qHash(canonical, 0x9e3779b9));
+    return true;
+#endif
+}
+
+// 目录树中的一个目录。由扫描它的任务填写，done 之后只由GUI线程读取
+struct FolderScanner::DirNode {
+    QString path;
+    bool done;                                  // 已扫描，或因重复、取消而跳过
+    QList<ScannedFile> files;                   // 按文件名排序
+    QList<NodeKey> fileKeys;                    // files 中每个文件的 (设备, inode)
+    std::vector<std::unique_ptr<DirNode>> children;     // 按路径排序
+
+    explicit DirNode(const QString &dirPath) : path(dirPath), done(false) {}
+};
+
+struct FolderScanner::ScanState {
+    QSet<QString> extensions;
+    QAtomicInt active;          // 尚未完成的目录任务数
+    QAtomicInt cancelled;
+    QAtomicInt directories;
+    QAtomicInt files;
+
+    QMutex mutex;               // 保护以下成员和各节点的 done、files、children
+    std::vector<std::unique_ptr<DirNode>> roots;
+    QStringList canonicalRoots; // 以 / 结尾
+    QSet<NodeKey> seenDirectories;
+    QSet<NodeKey> seenFiles;    // 只在GUI线程按先序检查，结果与调度无关
+    // 先序输出的游标：每项为 (节点, 下一个要进入的子目录)
+    QList<QPair<DirNode *, size_t>> cursor;
+    size_t nextRoot = 0;
+
+    bool insideRoots(const QString &canonicalPath)
+    {
+        QMutexLocker locker(&mutex);
+        for (const QString &root : std::as_const(canonicalRoots)) {
+            if (canonicalPath.startsWith(root) || canonicalPath + '/' == root) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+FolderScanner::FolderScanner(const QStringList &extensions, QObject *parent)
+    : QObject(parent)
+    , m_collectTimer(new QTimer(this))
+    , m_backlogPos(0)
+{
+    for (const QString &extension : extensions) {
+        m_extensions.insert(extension.toLower());
+    }
+
+    // 网络存储上目录读取以等待I/O为主，线程数可以多于核心数
+    m_pool.setMaxThreadCount(qBound(2, QThread::idealThreadCount() * 2, 16));
+
+    m_collectTimer->setInterval(kCollectInterval);
+    connect(m_collectTimer, &QTimer::timeout, this, &FolderScanner::collect);
+}
+
+FolderScanner::~FolderScanner()
+{
+    if (m_state) {
+        m_state->cancelled.storeRelaxed(1);
+    }
+    m_pool.waitForDone();
+}
+
+void FolderScanner::scan(const QStringList &folders)
+{
+    if (folders.isEmpty()) {
+        return;
+    }
+
+    if (!m_state) {
+        m_state = std::make_shared<ScanState>();
+        m_state->extensions = m_extensions;
+        m_collectTimer->start();
+    }
+
+    std::shared_ptr<ScanState> state = m_state;
+    QThreadPool *pool = &m_pool;
+    for (const QString &folder : folders) {
+        QFileInfo info(folder);
+        QString canonical = info.canonicalFilePath();
+        DirNode *node = nullptr;
+        {
+            QMutexLocker locker(&state->mutex);
+            if (!canonical.isEmpty()) {
+                state->canonicalRoots.append(canonical.endsWith('/') ? canonical : canonical + '/');
+            }
+            state->roots.push_back(std::make_unique<DirNode>(info.absoluteFilePath()));
+            node = state->roots.back().get();
+        }
+        state->active.ref();
+        pool->start([state, pool, node]() {
+            scanDirectory(state, pool, node);
+        });
+    }
+}
+
+void FolderScanner::cancel()
+{
+    if (!m_state) {
+        return;
+    }
+
+    // 已提交的任务检查到取消标记后立即退出，它们只持有旧的状态对象
+    m_state->cancelled.storeRelaxed(1);
+    int files = m_state->files.loadRelaxed();
+    m_state.reset();
+    m_backlog.clear();
+    m_backlogPos = 0;
+    m_collectTimer->stop();
+
+    emit finished(files, true);
+}
+
+void FolderScanner::collect()
+{
+    if (!m_state) {
+        m_collectTimer->stop();
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_state->mutex);
+        if (m_backlogPos >= m_backlog.size()) {
+            m_backlog.clear();
+            m_backlogPos = 0;
+        }
+        takeReady(m_state.get(), &m_backlog);
+    }
+
+    // 分块发出，每次不超过一帧的一半时间，剩余的留到下一次
+    QElapsedTimer elapsed;
+    elapsed.start();
+    while (m_backlogPos < m_backlog.size() && elapsed.elapsed() < kFrameBudget) {
+        int count = qMin(kChunkSize, int(m_backlog.size()) - m_backlogPos);
+        QList<ScannedFile> chunk = m_backlog.mid(m_backlogPos, count);
+        m_backlogPos += count;
+        emit filesFound(chunk);
+
+        if (!m_state) {
+            return;  // 接收方在处理过程中取消了扫描
+        }
+    }
+
+    emit progress(m_state->directories.loadRelaxed(), m_state->files.loadRelaxed());
+
+    if (m_state->active.loadAcquire() == 0 && m_backlogPos >= m_backlog.size()) {
+        // 最后几个目录可能在上次加锁之后才扫完
+        QMutexLocker locker(&m_state->mutex);
+        m_backlog.clear();
+        m_backlogPos = 0;
+        takeReady(m_state.get(), &m_backlog);
+        if (!m_backlog.isEmpty()) {
+            return;
+        }
+        locker.unlock();
+
+        int files = m_state->files.loadRelaxed();
+        m_state.reset();
+        m_backlog.clear();
+        m_backlogPos = 0;
+        m_collectTimer->stop();
+        emit finished(files, false);
+    }
+}
+
+void FolderScanner::takeReady(ScanState *state, QList<ScannedFile> *files)
+{
+    // 调用方持有 state->mutex。沿先序前进，遇到尚未扫完的目录就停下
+    auto take = [state, files](DirNode *node) {
+        for (int i = 0; i < node->files.size(); ++i) {
+            // 同一文件的多个路径（硬链接、指向范围外的符号链接）只保留先序中第一次出现的
+            const NodeKey &key = node->fileKeys.at(i);
+            if (state->seenFiles.contains(key)) {
+                continue;
+            }
+            state->seenFiles.insert(key);
+            files->append(node->files.at(i));
+        }
+        node->files.clear();
+        node->fileKeys.clear();
+        state->cursor.append(qMakePair(node, size_t(0)));
+    };
+
+    for (;;) {
+        if (state->cursor.isEmpty()) {
+            if (state->nextRoot >= state->roots.size() || !state->roots[state->nextRoot]->done) {
+                return;
+            }
+            take(state->roots[state->nextRoot++].get());
+            continue;
+        }
+
+        QPair<DirNode *, size_t> &top = state->cursor.last();
+        if (top.second >= top.first->children.size()) {
+            // 整棵子树已发出，释放子目录节点
+            top.first->children.clear();
+            state->cursor.removeLast();
+            continue;
+        }
+        DirNode *child = top.first->children[top.second].get();
+        if (!child->done) {
+            return;
+        }
+        ++top.second;
+        take(child);
+    }
+}
+
+void FolderScanner::scanDirectory(const std::shared_ptr<ScanState> &state, QThreadPool *pool, DirNode *node)
+{
+    struct Candidate {
+        NodeKey key;
+        ScannedFile file;
+    };
+
+    NodeKey dirKey;
+    bool claimed = false;
+    if (!state->cancelled.loadRelaxed() && nodeKey(node->path, &dirKey)) {
+        // 目录去重：同一目录经不同链接到达时只扫描一次，链接成环时不会死循环
+        QMutexLocker locker(&state->mutex);
+        if (!state->seenDirectories.contains(dirKey)) {
+            state->seenDirectories.insert(dirKey);
+            claimed = true;
+        }
+    }
+
+    QStringList subdirectories;
+    QList<Candidate> candidates;
+    if (claimed) {
+        QDirIterator it(node->path, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+        while (it.hasNext() && !state->cancelled.loadRelaxed()) {
+            it.next();
+            QFileInfo info = it.fileInfo();
+            bool link = info.isSymLink();
+            bool dir = info.isDir();
+            if (!dir && !state->extensions.contains(info.suffix().toLower())) {
+                continue;
+            }
+
+            // 指向扫描范围内的链接跳过，经真实路径会扫到；悬空链接也跳过
+            if (link) {
+                QString target = info.canonicalFilePath();
+                if (target.isEmpty() || state->insideRoots(target)) {
+                    continue;
+                }
+            }
+
+            if (dir) {
+                subdirectories.append(info.absoluteFilePath());
+                continue;
+            }
+
+            // 每个文件一次 stat，大小、修改时间和 inode 一起取到
+            Candidate candidate;
+            candidate.file.filePath = info.absoluteFilePath();
+            if (!statFile(candidate.file.filePath, &candidate.file, &candidate.key)) {
+                continue;
+            }
+            candidates.append(candidate);
+        }
+
+        // 目录内按文件名排序，子目录按路径排序，发出顺序与读取顺序无关
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+            return a.file.filePath < b.file.filePath;
+        });
+        std::sort(subdirectories.begin(), subdirectories.end());
+    }
+
+    // 子节点在 done 之前建好；之后 node->children 可能被GUI线程释放，只用这里记下的指针
+    QList<DirNode *> children;
+    {
+        QMutexLocker locker(&state->mutex);
+        for (const Candidate &candidate : std::as_const(candidates)) {
+            node->files.append(candidate.file);
+            node->fileKeys.append(candidate.key);
+        }
+        if (!state->cancelled.loadRelaxed()) {
+            for (const QString &subdirectory : std::as_const(subdirectories)) {
+                node->children.push_back(std::make_unique<DirNode>(subdirectory));
+                children.append(node->children.back().get());
+            }
+        }
+        node->done = true;
+    }
+    if (claimed) {
+        state->files.fetchAndAddRelaxed(int(candidates.size()));
+        state->directories.fetchAndAddRelaxed(1);
+    }
+
+    // 先增加计数再提交，保证计数不会在扫描途中降到0
+    for (DirNode *child : std::as_const(children)) {
+        state->active.ref();
+        pool->start([state, pool, child]() {
+            scanDirectory(state, pool, child);
+        });
+    }
+
+    state->active.deref();
+}
@@ -0,0 +1,70 @@
+// FolderScanner.h
+#ifndef FOLDERSCANNER_H
+#define FOLDERSCANNER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+#include <QStringList>
+#include <QSet>
+#include <QPair>
+#include <memory>
+
+// 扫描到的文件
+struct ScannedFile {
+    QString filePath;
+    qint64 fileSize;
+    qint64 lastModified;
+
+    ScannedFile() : fileSize(-1), lastModified(0) {}
+};
+
+// 并行递归文件夹扫描
+// 每个目录是线程池中的一个任务，子目录作为新任务提交，多个目录同时读取。
+// 结果汇总在共享状态中，由GUI线程定时取走并分块发出，界面不会一次收到
+// 整棵目录树。发出的顺序与线程调度无关：按目录树的先序（目录内先文件后
+// 子目录，都按名称排序），前面的目录扫完之前后面的结果先留着。
+// 目录按 (设备, inode) 去重，避免目录链接成环；文件在取大小和修改时间的同一次
+// stat 中得到 (设备, inode)，硬链接和指向范围外的符号链接按它去重。指向扫描范围内
+// 的符号链接直接跳过（经真实路径会扫到）。
+class FolderScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FolderScanner(const QStringList &extensions, QObject *parent = nullptr);
+    ~FolderScanner();
+
+    // 文件在文件系统中的唯一标识 (设备, inode)，同一文件的不同路径（符号链接、硬链接）得到相同的键
+    typedef QPair<quint64, quint64> NodeKey;
+    static bool nodeKey(const QString &path, NodeKey *key);
+
+    // 扫描进行中再次调用时，新目录并入当前扫描
+    void scan(const QStringList &folders);
+    void cancel();
+    bool isScanning() const { return m_state != nullptr; }
+
+signals:
+    void filesFound(const QList<ScannedFile> &files);
+    void progress(int directories, int files);
+    void finished(int files, bool cancelled);
+
+private slots:
+    void collect();
+
+private:
+    struct DirNode;
+    struct ScanState;
+
+    QSet<QString> m_extensions;
+    QThreadPool m_pool;
+    QTimer *m_collectTimer;
+    std::shared_ptr<ScanState> m_state;
+    QList<ScannedFile> m_backlog;     // 已取出但尚未发出的结果
+    int m_backlogPos;
+
+    static void scanDirectory(const std::shared_ptr<ScanState> &state, QThreadPool *pool, DirNode *node);
+    static void takeReady(ScanState *state, QList<ScannedFile> *files);
+};
+
+#endif // FOLDERSCANNER_H
@@ -0,0 +1,269 @@
+// FrameGrabber.cpp
+#include "FrameGrabber.h"
+
+namespace {
+const int kRequestTimeout = 3000;       // 单个请求最长等待时间（毫秒）
+const qint64 kFrameTolerance = 5000;    // 帧时间与请求位置相差超过该值时视为上一次跳转的帧（毫秒）
+}
+
+FrameDecoder::FrameDecoder(QObject *parent)
+    : QObject(parent)
+    , m_player(nullptr)
+    , m_sink(nullptr)
+    , m_generation(0)
+{
+}
+
+void FrameDecoder::ensurePlayer()
+{
+    if (m_player) {
+        return;
+    }
+
+    // 不设置音频输出，只解码视频
+    m_player = new QMediaPlayer(this);
+    m_sink = new QVideoSink(this);
+    m_player->setVideoOutput(m_sink);
+    connect(m_player, &QMediaPlayer::mediaStatusChanged, this, &FrameDecoder::mediaStatusChanged);
+    connect(m_player, &QMediaPlayer::errorOccurred, this, &FrameDecoder::errorOccurred);
+    // 帧在本线程中按到达顺序打上标记：seek() 之前排队的帧仍带着旧的 generation
+    connect(m_sink, &QVideoSink::videoFrameChanged, this, [this](const QVideoFrame &frame) {
+        emit frameDecoded(frame, m_generation);
+    });
+}
+
+void FrameDecoder::open(const QUrl &source, quint64 generation)
+{
+    ensurePlayer();
+    m_generation = generation;
+    m_player->setSource(source);
+}
+
+void FrameDecoder::seek(qint64 position, quint64 generation)
+{
+    ensurePlayer();
+    m_generation = generation;
+    m_player->setPosition(position);
+    if (m_player->playbackState() != QMediaPlayer::PausedState) {
+        m_player->pause();
+    }
+}
+
+FrameGrabber::FrameGrabber(const QSize &maxSize, QObject *parent)
+    : QObject(parent)
+    , m_thread(new QThread(this))
+    , m_decoder(new FrameDecoder())
+    , m_timeoutTimer(new QTimer(this))
+    , m_maxSize(maxSize)
+    , m_busy(false)
+    , m_hasPending(false)
+    , m_waitingFrame(false)
+    , m_generation(0)
+    , m_lastFramePosition(-1)
+    , m_delivered(0)
+    , m_dropped(0)
+    , m_worstLatency(0)
+    , m_totalLatency(0)
+{
+    m_clock.start();
+    m_pool.setMaxThreadCount(1);
+    m_pool.setThreadPriority(QThread::LowPriority);
+
+    // 拖动预览和缩略图让位于正在进行的播放
+    m_thread->setObjectName("FrameGrabber");
+    m_decoder->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_decoder, &QObject::deleteLater);
+    connect(m_decoder, &FrameDecoder::mediaStatusChanged, this, &FrameGrabber::onMediaStatusChanged);
+    connect(m_decoder, &FrameDecoder::errorOccurred, this, [this]() {
+        if (m_busy) {
+            failCurrent();
+        }
+    });
+    connect(m_decoder, &FrameDecoder::frameDecoded, this, &FrameGrabber::onVideoFrameChanged);
+    m_thread->start(QThread::LowPriority);
+
+    m_timeoutTimer->setSingleShot(true);
+    m_timeoutTimer->setInterval(kRequestTimeout);
+    connect(m_timeoutTimer, &QTimer::timeout, this, &FrameGrabber::onTimeout);
+}
+
+FrameGrabber::~FrameGrabber()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+
+    // 解码器随线程结束在工作线程中删除，播放器一并释放
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void FrameGrabber::request(const QString &filePath, qint64 position)
+{
+    Request request;
+    request.filePath = filePath;
+    request.position = qMax<qint64>(0, position);
+    request.requestedAt = m_clock.elapsed();
+    request.generation = m_generation;
+
+    if (m_busy) {
+        if (m_hasPending) {
+            ++m_dropped;
+        }
+        m_pending = request;
+        m_hasPending = true;
+        return;
+    }
+    start(request);
+}
+
+void FrameGrabber::cancel()
+{
+    ++m_generation;
+    m_hasPending = false;
+
+    // 放弃正在截取的请求，下一个请求不必等它的跳转完成
+    if (m_busy) {
+        m_timeoutTimer->stop();
+        m_waitingFrame = false;
+        m_busy = false;
+    }
+}
+
+void FrameGrabber::resetStats()
+{
+    m_delivered = 0;
+    m_dropped = 0;
+    m_worstLatency = 0;
+    m_totalLatency = 0;
+}
+
+void FrameGrabber::start(const Request &request)
+{
+    m_current = request;
+    m_busy = true;
+    m_timeoutTimer->start();
+
+    QUrl source = QUrl::fromLocalFile(request.filePath);
+    if (m_source == source && request.position == m_lastFramePosition && m_lastFrame.isValid()) {
+        // 播放器已停在这一帧，再次跳转不会送出新帧
+        convert(m_lastFrame);
+        finishCurrent();
+        return;
+    }
+    if (m_source != source) {
+        m_source = source;
+        m_lastFrame = QVideoFrame();
+        m_lastFramePosition = -1;
+        m_waitingFrame = false;
+        // 打开完成后在 onMediaStatusChanged 中跳转
+        FrameDecoder *decoder = m_decoder;
+        quint64 generation = request.generation;
+        QMetaObject::invokeMethod(decoder, [decoder, source, generation]() {
+            decoder->open(source, generation);
+        }, Qt::QueuedConnection);
+        return;
+    }
+    seekCurrent();
+}
+
+void FrameGrabber::seekCurrent()
+{
+    m_waitingFrame = true;
+    FrameDecoder *decoder = m_decoder;
+    qint64 position = m_current.position;
+    quint64 generation = m_current.generation;
+    QMetaObject::invokeMethod(decoder, [decoder, position, generation]() {
+        decoder->seek(position, generation);
+    }, Qt::QueuedConnection);
+}
+
+void FrameGrabber::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
+{
+    if (!m_busy) {
+        return;
+    }
+
+    if (status == QMediaPlayer::LoadedMedia && !m_waitingFrame) {
+        seekCurrent();
+    } else if (status == QMediaPlayer::InvalidMedia) {
+        failCurrent();
+    }
+}
+
+void FrameGrabber::onVideoFrameChanged(const QVideoFrame &frame, quint64 generation)
+{
+    if (!m_busy || !m_waitingFrame || !frame.isValid()) {
+        return;
+    }
+
+    // cancel() 之前发出的跳转送来的帧，位置再接近也不属于当前请求
+    if (generation != m_current.generation) {
+        return;
+    }
+
+    // 连续跳转时可能先收到上一个位置的帧
+    if (frame.startTime() >= 0 && qAbs(frame.startTime() / 1000 - m_current.position) > kFrameTolerance) {
+        return;
+    }
+
+    m_lastFrame = frame;
+    m_lastFramePosition = m_current.position;
+    convert(frame);
+    finishCurrent();
+}
+
+void FrameGrabber::convert(const QVideoFrame &frame)
+{
+    // 转换和缩放在后台线程中进行，同时可以开始解码下一个请求
+    Request request = m_current;
+    QSize maxSize = m_maxSize;
+    m_pool.start([this, frame, request, maxSize]() {
+        QImage image = frame.toImage();
+        if (!image.isNull() && (image.width() > maxSize.width() || image.height() > maxSize.height())) {
+            image = image.scaled(maxSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+        QMetaObject::invokeMethod(this, [this, request, image]() {
+            onConverted(request, image);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void FrameGrabber::onTimeout()
+{
+    failCurrent();
+}
+
+void FrameGrabber::failCurrent()
+{
+    Request request = m_current;
+    finishCurrent();
+    if (request.generation == m_generation) {
+        emit failed(request.filePath, request.position);
+    }
+}
+
+void FrameGrabber::finishCurrent()
+{
+    m_timeoutTimer->stop();
+    m_waitingFrame = false;
+    m_busy = false;
+
+    if (m_hasPending) {
+        m_hasPending = false;
+        start(m_pending);
+    }
+}
+
+void FrameGrabber::onConverted(const Request &request, const QImage &image)
+{
+    if (request.generation != m_generation || image.isNull()) {
+        return;
+    }
+
+    qint64 latency = m_clock.elapsed() - request.requestedAt;
+    ++m_delivered;
+    m_totalLatency += latency;
+    m_worstLatency = qMax(m_worstLatency, latency);
+
+    emit frameReady(request.filePath, request.position, image);
+}
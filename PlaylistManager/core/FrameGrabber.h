@@ -0,0 +1,117 @@
+// FrameGrabber.h
+#ifndef FRAMEGRABBER_H
+#define FRAMEGRABBER_H
+
+#include <QObject>
+#include <QThread>
+#include <QMediaPlayer>
+#include <QVideoSink>
+#include <QVideoFrame>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QImage>
+#include <QSize>
+#include <QUrl>
+
+// 截取用的解码器，运行在低优先级的工作线程中
+// 不带音频输出的 QMediaPlayer 打开、跳转并暂停，送到 QVideoSink 的帧经 frameDecoded 发出，
+// 附带最近一次 open()/seek() 的 generation，截取器据此丢弃已放弃的请求送来的帧
+class FrameDecoder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameDecoder(QObject *parent = nullptr);
+
+public slots:
+    void open(const QUrl &source, quint64 generation);
+    void seek(qint64 position, quint64 generation);
+
+signals:
+    void mediaStatusChanged(QMediaPlayer::MediaStatus status);
+    void frameDecoded(const QVideoFrame &frame, quint64 generation);
+    void errorOccurred();
+
+private:
+    QMediaPlayer *m_player;     // 在工作线程中首次使用时创建
+    QVideoSink *m_sink;
+    quint64 m_generation;
+
+    void ensurePlayer();
+};
+
+// 单帧截取
+// 独立的解码器（FrameDecoder，低优先级线程）跳转到指定位置并暂停，把送来的
+// 那一帧在后台线程中转换、缩小成 QImage。同一时间只处理一个请求，处理中收到的
+// 请求只保留最新的一个（旧的直接丢弃），适合拖动时连续请求的场景。
+// 解码和转换都不与播放争抢 CPU。
+class FrameGrabber : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameGrabber(const QSize &maxSize, QObject *parent = nullptr);
+    ~FrameGrabber();
+
+    void request(const QString &filePath, qint64 position);
+    // 丢弃等待中的请求并放弃正在截取的请求，已在转换的帧完成后不再发出
+    void cancel();
+    bool isBusy() const { return m_busy; }
+
+    // 统计：发出的帧数、被更新请求替换掉的请求数、请求到发出的延迟
+    void resetStats();
+    int deliveredCount() const { return m_delivered; }
+    int droppedCount() const { return m_dropped; }
+    qint64 worstLatency() const { return m_worstLatency; }
+    qint64 averageLatency() const { return m_delivered > 0 ? m_totalLatency / m_delivered : 0; }
+
+signals:
+    void frameReady(const QString &filePath, qint64 position, const QImage &image);
+    // 打开失败或超时没有收到帧
+    void failed(const QString &filePath, qint64 position);
+
+private slots:
+    void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
+    void onVideoFrameChanged(const QVideoFrame &frame, quint64 generation);
+    void onTimeout();
+
+private:
+    struct Request {
+        QString filePath;
+        qint64 position;
+        qint64 requestedAt;
+        quint64 generation;
+    };
+
+    QThread *m_thread;
+    FrameDecoder *m_decoder;
+    QUrl m_source;              // 解码器当前打开的文件
+    QTimer *m_timeoutTimer;
+    QThreadPool m_pool;         // 帧转换，不占用GUI线程
+    QElapsedTimer m_clock;
+    QSize m_maxSize;
+
+    Request m_current;
+    Request m_pending;
+    bool m_busy;
+    bool m_hasPending;
+    bool m_waitingFrame;
+    quint64 m_generation;       // cancel() 后递增，转换完成时据此丢弃旧结果
+    QVideoFrame m_lastFrame;    // 播放器当前停留的帧
+    qint64 m_lastFramePosition;
+
+    int m_delivered;
+    int m_dropped;
+    qint64 m_worstLatency;
+    qint64 m_totalLatency;
+
+    void start(const Request &request);
+    void seekCurrent();
+    void finishCurrent();
+    void failCurrent();
+    void convert(const QVideoFrame &frame);
+    void onConverted(const Request &request, const QImage &image);
+};
+
+#endif // FRAMEGRABBER_H
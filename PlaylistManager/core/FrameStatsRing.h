@@ -0,0 +1,63 @@
+// FrameStatsRing.h
+#ifndef FRAMESTATSRING_H
+#define FRAMESTATSRING_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// 每一帧送达视频输出时记录的数据
+struct FrameSample {
+    qint64 arrivalNs;       // 送达时间（单调时钟，纳秒）
+    qint64 startTime;       // 帧的显示时间戳（微秒），-1 表示未知
+    float frameRate;        // 流的标称帧率，0 表示未知
+};
+
+// 单生产者单消费者的无锁环形缓冲
+// 生产者是送出视频帧的线程（可能不是GUI线程），消费者是性能信息面板的定时器。
+// 写满时丢弃新样本并计数，生产者从不等待。
+class FrameStatsRing
+{
+public:
+    static const quint32 Capacity = 512;     // 必须是2的幂
+
+    FrameStatsRing() : m_head(0), m_tail(0), m_overflow(0), m_costNs(0) {}
+
+    bool push(const FrameSample &sample)
+    {
+        quint32 head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Capacity) {
+            m_overflow.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_samples[head & (Capacity - 1)] = sample;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(FrameSample *sample)
+    {
+        quint32 tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *sample = m_samples[tail & (Capacity - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 读取并清零溢出计数
+    quint32 takeOverflow() { return m_overflow.exchange(0, std::memory_order_relaxed); }
+
+    // 生产者记录每帧的耗时，性能信息面板读取并清零，计入面板自身的开销
+    void addCost(qint64 ns) { m_costNs.fetch_add(ns, std::memory_order_relaxed); }
+    qint64 takeCost() { return m_costNs.exchange(0, std::memory_order_relaxed); }
+
+private:
+    FrameSample m_samples[Capacity];
+    std::atomic<quint32> m_head;
+    std::atomic<quint32> m_tail;
+    std::atomic<quint32> m_overflow;
+    std::atomic<qint64> m_costNs;
+};
+
+#endif // FRAMESTATSRING_H
@@ -0,0 +1,414 @@
+// KeyframeIndex.cpp
+#include "KeyframeIndex.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDir>
+#include <QDateTime>
+#include <QDataStream>
+#include <QByteArrayView>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <algorithm>
+
+namespace {
+const quint32 kMagic = 0x464B5056;              // "VPKF"
+const quint16 kVersion = 2;                     // 2：关键帧时间改为显示时间
+const qint64 kMaxMoovSize = 64 * 1024 * 1024;   // moov 一次读入内存，超过该大小的文件不建索引
+const int kMemoryCacheSize = 16;
+
+constexpr quint32 fourcc(const char (&code)[5])
+{
+    return (quint32(uchar(code[0])) << 24) | (quint32(uchar(code[1])) << 16) |
+           (quint32(uchar(code[2])) << 8) | quint32(uchar(code[3]));
+}
+
+quint32 readU32(QByteArrayView data, qsizetype offset)
+{
+    return qFromBigEndian<quint32>(data.constData() + offset);
+}
+
+// 在 data 的直接子盒子中查找类型为 type 的第一个，返回其内容（不含盒子头）
+bool findBox(QByteArrayView data, quint32 type, QByteArrayView *payload, qsizetype *from = nullptr)
+{
+    qsizetype pos = from ? *from : 0;
+    while (pos + 8 <= data.size()) {
+        quint64 size = readU32(data, pos);
+        quint32 boxType = readU32(data, pos + 4);
+        qsizetype headerSize = 8;
+        if (size == 1) {
+            if (pos + 16 > data.size()) {
+                return false;
+            }
+            size = qFromBigEndian<quint64>(data.constData() + pos + 8);
+            headerSize = 16;
+        } else if (size == 0) {
+            size = quint64(data.size() - pos);
+        }
+        if (size < quint64(headerSize) || size > quint64(data.size() - pos)) {
+            return false;
+        }
+
+        qsizetype next = pos + qsizetype(size);
+        if (boxType == type) {
+            *payload = data.sliced(pos + headerSize, qsizetype(size) - headerSize);
+            if (from) {
+                *from = next;
+            }
+            return true;
+        }
+        pos = next;
+    }
+    return false;
+}
+
+bool findPath(QByteArrayView data, std::initializer_list<quint32> path, QByteArrayView *payload)
+{
+    QByteArrayView current = data;
+    for (quint32 type : path) {
+        if (!findBox(current, type, &current)) {
+            return false;
+        }
+    }
+    *payload = current;
+    return true;
+}
+
+// 读取 mvhd/mdhd 中的时间刻度
+quint32 readTimescale(QByteArrayView header)
+{
+    if (header.size() < 24) {
+        return 0;
+    }
+    return readU32(header, header.at(0) == 1 ? 20 : 12);
+}
+
+// 向上取整换算成毫秒：定位目标不能早于关键帧，否则解码器会退回上一个关键帧
+qint64 ticksToMsCeil(qint64 ticks, quint32 timescale)
+{
+    return ticks <= 0 ? 0 : (ticks * 1000 + timescale - 1) / timescale;
+}
+}
+
+qint64 KeyframeIndex::nearest(qint64 position) const
+{
+    if (m_times.isEmpty()) {
+        return position;
+    }
+
+    auto it = std::lower_bound(m_times.constBegin(), m_times.constEnd(), position);
+    if (it == m_times.constEnd()) {
+        return m_times.last();
+    }
+    if (it == m_times.constBegin()) {
+        return *it;
+    }
+    qint64 after = *it;
+    qint64 before = *(it - 1);
+    return (position - before <= after - position) ? before : after;
+}
+
+KeyframeIndex KeyframeIndex::build(const QString &filePath)
+{
+    KeyframeIndex index;
+    if (!parseMp4(filePath, &index)) {
+        index = KeyframeIndex();
+    }
+    return index;
+}
+
+bool KeyframeIndex::parseMp4(const QString &filePath, KeyframeIndex *index)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    // 顶层盒子逐个跳过（mdat 可能有几个GB），只把 moov 读进内存
+    const qint64 fileSize = file.size();
+    QByteArray moov;
+    qint64 pos = 0;
+    while (pos + 8 <= fileSize) {
+        if (!file.seek(pos)) {
+            return false;
+        }
+        QByteArray header = file.read(16);
+        if (header.size() < 8) {
+            return false;
+        }
+
+        quint64 size = qFromBigEndian<quint32>(header.constData());
+        quint32 type = qFromBigEndian<quint32>(header.constData() + 4);
+        qint64 headerSize = 8;
+        if (size == 1) {
+            if (header.size() < 16) {
+                return false;
+            }
+            size = qFromBigEndian<quint64>(header.constData() + 8);
+            headerSize = 16;
+        } else if (size == 0) {
+            size = quint64(fileSize - pos);
+        }
+
+        // 第一个盒子不认识的，不是 MP4/MOV 系列的文件
+        if (pos == 0 && type != fourcc("ftyp") && type != fourcc("moov") && type != fourcc("wide") &&
+            type != fourcc("free") && type != fourcc("skip") && type != fourcc("mdat")) {
+            return false;
+        }
+        if (size < quint64(headerSize) || size > quint64(fileSize - pos)) {
+            return false;
+        }
+
+        if (type == fourcc("moov")) {
+            if (qint64(size) > kMaxMoovSize || !file.seek(pos + headerSize)) {
+                return false;
+            }
+            moov = file.read(qint64(size) - headerSize);
+            if (moov.size() != qint64(size) - headerSize) {
+                return false;
+            }
+            break;
+        }
+        pos += qint64(size);
+    }
+    if (moov.isEmpty()) {
+        return false;
+    }
+
+    // 取第一条视频轨道
+    QByteArrayView moovView(moov);
+    QByteArrayView trak;
+    qsizetype from = 0;
+    while (findBox(moovView, fourcc("trak"), &trak, &from)) {
+        QByteArrayView hdlr;
+        if (!findPath(trak, {fourcc("mdia"), fourcc("hdlr")}, &hdlr) || hdlr.size() < 12 ||
+            readU32(hdlr, 8) != fourcc("vide")) {
+            continue;
+        }
+
+        QByteArrayView mdhd;
+        if (!findPath(trak, {fourcc("mdia"), fourcc("mdhd")}, &mdhd) || mdhd.size() < 24) {
+            return false;
+        }
+        quint32 timescale = readTimescale(mdhd);
+        if (timescale == 0) {
+            return false;
+        }
+
+        QByteArrayView stbl;
+        QByteArrayView stts;
+        if (!findPath(trak, {fourcc("mdia"), fourcc("minf"), fourcc("stbl")}, &stbl) ||
+            !findBox(stbl, fourcc("stts"), &stts) || stts.size() < 8) {
+            return false;
+        }
+
+        // 没有 stss 表表示每个样本都是同步样本
+        QByteArrayView stss;
+        if (!findBox(stbl, fourcc("stss"), &stss)) {
+            index->m_times.clear();
+            index->m_allKeyframes = true;
+            return true;
+        }
+        if (stss.size() < 8) {
+            return false;
+        }
+
+        quint32 syncCount = readU32(stss, 4);
+        quint32 entryCount = readU32(stts, 4);
+        if (stss.size() < 8 + qsizetype(syncCount) * 4 || stts.size() < 8 + qsizetype(entryCount) * 8) {
+            return false;
+        }
+
+        // 按 stts 累加解码时间，得到每个同步样本（编号从1开始，升序）的解码时间
+        QList<quint32> syncSamples;
+        QList<qint64> ticks;
+        syncSamples.reserve(syncCount);
+        ticks.reserve(syncCount);
+        quint32 k = 0;
+        quint64 sample = 1;
+        quint64 time = 0;
+        for (quint32 i = 0; i < entryCount && k < syncCount; ++i) {
+            quint32 count = readU32(stts, 8 + qsizetype(i) * 8);
+            quint32 delta = readU32(stts, 12 + qsizetype(i) * 8);
+            while (k < syncCount) {
+                quint32 syncSample = readU32(stss, 8 + qsizetype(k) * 4);
+                if (syncSample >= sample + count) {
+                    break;
+                }
+                if (syncSample >= sample) {
+                    syncSamples.append(syncSample);
+                    ticks.append(qint64(time + quint64(syncSample - sample) * delta));
+                }
+                ++k;
+            }
+            sample += count;
+            time += quint64(count) * delta;
+        }
+
+        // 有 B 帧时显示时间 = 解码时间 + ctts 中的合成偏移。偏移按有符号数读取
+        // （版本0规定为无符号，但常见的封装器写入负值时也用版本0）
+        QByteArrayView ctts;
+        if (findBox(stbl, fourcc("ctts"), &ctts)) {
+            quint32 cttsCount = ctts.size() >= 8 ? readU32(ctts, 4) : 0;
+            if (ctts.size() < 8 + qsizetype(cttsCount) * 8) {
+                return false;
+            }
+            quint32 run = 0;
+            quint64 runStart = 1;
+            for (qsizetype j = 0; j < syncSamples.size() && run < cttsCount; ++j) {
+                while (run < cttsCount && syncSamples.at(j) >= runStart + readU32(ctts, 8 + qsizetype(run) * 8)) {
+                    runStart += readU32(ctts, 8 + qsizetype(run) * 8);
+                    ++run;
+                }
+                if (run < cttsCount) {
+                    ticks[j] += qint32(readU32(ctts, 12 + qsizetype(run) * 8));
+                }
+            }
+        }
+
+        // 编辑列表：开头的空编辑把整条轨道向后推（电影时间刻度），第一个正常编辑的
+        // media_time 是显示时间轴的起点（媒体时间刻度，B 帧延迟通常在这里抵消）
+        qint64 mediaStart = 0;
+        qint64 delayMs = 0;
+        QByteArrayView elst;
+        if (findPath(trak, {fourcc("edts"), fourcc("elst")}, &elst) && elst.size() >= 8) {
+            bool version1 = elst.at(0) == 1;
+            qsizetype entrySize = version1 ? 20 : 12;
+            quint32 editCount = readU32(elst, 4);
+            QByteArrayView mvhd;
+            quint32 movieTimescale = findBox(moovView, fourcc("mvhd"), &mvhd) ? readTimescale(mvhd) : 0;
+            quint64 emptyDuration = 0;
+            for (quint32 i = 0; i < editCount && elst.size() >= 8 + qsizetype(i + 1) * entrySize; ++i) {
+                qsizetype entry = 8 + qsizetype(i) * entrySize;
+                quint64 segmentDuration = version1 ? qFromBigEndian<quint64>(elst.constData() + entry)
+                                                   : readU32(elst, entry);
+                qint64 mediaTime = version1 ? qFromBigEndian<qint64>(elst.constData() + entry + 8)
+                                            : qint32(readU32(elst, entry + 4));
+                if (mediaTime == -1) {
+                    emptyDuration += segmentDuration;
+                    continue;
+                }
+                mediaStart = mediaTime;
+                break;
+            }
+            if (movieTimescale > 0) {
+                delayMs = qint64(emptyDuration * 1000 / movieTimescale);
+            }
+        }
+
+        QList<qint64> times;
+        times.reserve(ticks.size());
+        for (qint64 decodeTicks : std::as_const(ticks)) {
+            times.append(ticksToMsCeil(decodeTicks - mediaStart, timescale) + delayMs);
+        }
+        std::sort(times.begin(), times.end());
+        times.erase(std::unique(times.begin(), times.end()), times.end());
+
+        index->m_times = times;
+        index->m_allKeyframes = false;
+        return !times.isEmpty();
+    }
+    return false;
+}
+
+bool KeyframeIndex::save(const QString &cacheFile, qint64 fileSize, qint64 lastModified) const
+{
+    QSaveFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kMagic << kVersion << fileSize << lastModified << m_allKeyframes << m_times;
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+bool KeyframeIndex::load(const QString &cacheFile, qint64 fileSize, qint64 lastModified, KeyframeIndex *index)
+{
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint64 cachedSize = -1;
+    qint64 cachedModified = 0;
+    in >> magic >> version >> cachedSize >> cachedModified;
+    if (magic != kMagic || version != kVersion || cachedSize != fileSize || cachedModified != lastModified) {
+        return false;  // 文件已变化，重新构建后覆盖
+    }
+
+    KeyframeIndex loaded;
+    in >> loaded.m_allKeyframes >> loaded.m_times;
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+    *index = loaded;
+    return true;
+}
+
+KeyframeIndexer::KeyframeIndexer(QObject *parent)
+    : QObject(parent)
+    , m_indexes(kMemoryCacheSize)
+{
+    // 读取索引以I/O为主，一个线程足够，也不与播放争抢磁盘
+    m_pool.setMaxThreadCount(1);
+    m_cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/keyframes";
+}
+
+KeyframeIndexer::~KeyframeIndexer()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void KeyframeIndexer::request(const QString &filePath)
+{
+    if (filePath.isEmpty() || m_indexes.contains(filePath) || m_building.contains(filePath)) {
+        return;
+    }
+
+    m_building.insert(filePath);
+    QString cacheFile = cacheFileName(m_cacheDir, filePath);
+    m_pool.start([this, filePath, cacheFile]() {
+        QFileInfo info(filePath);
+        qint64 fileSize = info.size();
+        qint64 lastModified = info.lastModified().toMSecsSinceEpoch();
+
+        KeyframeIndex index;
+        if (!KeyframeIndex::load(cacheFile, fileSize, lastModified, &index)) {
+            index = KeyframeIndex::build(filePath);
+            if (!index.isEmpty()) {
+                QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+                index.save(cacheFile, fileSize, lastModified);
+            }
+        }
+
+        QMetaObject::invokeMethod(this, [this, filePath, index]() {
+            onBuilt(filePath, index);
+        }, Qt::QueuedConnection);
+    });
+}
+
+const KeyframeIndex *KeyframeIndexer::index(const QString &filePath) const
+{
+    return m_indexes.object(filePath);
+}
+
+void KeyframeIndexer::onBuilt(const QString &filePath, const KeyframeIndex &index)
+{
+    m_building.remove(filePath);
+    m_indexes.insert(filePath, new KeyframeIndex(index));
+    emit indexReady(filePath);
+}
+
+QString KeyframeIndexer::cacheFileName(const QString &cacheDir, const QString &filePath)
+{
+    QByteArray hash = QCryptographicHash::hash(filePath.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return cacheDir + "/" + QString::fromLatin1(hash) + ".kfi";
+}
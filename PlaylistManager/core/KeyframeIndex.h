@@ -0,0 +1,69 @@
+// KeyframeIndex.h
+#ifndef KEYFRAMEINDEX_H
+#define KEYFRAMEINDEX_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QCache>
+#include <QSet>
+#include <QList>
+#include <QString>
+
+// 单个文件的关键帧显示时间表（毫秒，升序，向上取整）
+// 目前从 MP4/MOV 系列容器的 stss/stts/ctts 表和编辑列表中读取；
+// 其他格式或分片 MP4 得到空索引。
+class KeyframeIndex
+{
+public:
+    KeyframeIndex() : m_allKeyframes(false) {}
+
+    bool isEmpty() const { return m_times.isEmpty() && !m_allKeyframes; }
+    // 每一帧都是关键帧（没有 stss 表），任意位置都可以快速定位
+    bool allKeyframes() const { return m_allKeyframes; }
+    int count() const { return m_times.size(); }
+    const QList<qint64> &times() const { return m_times; }
+
+    // 距离 position 最近的关键帧；索引为空或每帧都是关键帧时返回 position 本身
+    qint64 nearest(qint64 position) const;
+
+    static KeyframeIndex build(const QString &filePath);
+
+    bool save(const QString &cacheFile, qint64 fileSize, qint64 lastModified) const;
+    static bool load(const QString &cacheFile, qint64 fileSize, qint64 lastModified, KeyframeIndex *index);
+
+private:
+    QList<qint64> m_times;
+    bool m_allKeyframes;
+
+    static bool parseMp4(const QString &filePath, KeyframeIndex *index);
+};
+
+// 关键帧索引的后台构建和缓存
+// 首次打开文件时在后台线程中读取容器的索引表，结果保存到磁盘缓存目录，
+// 文件大小和修改时间不变时直接读取缓存。内存中只保留最近使用的少量索引。
+class KeyframeIndexer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit KeyframeIndexer(QObject *parent = nullptr);
+    ~KeyframeIndexer();
+
+    void request(const QString &filePath);
+    // 尚未构建完成时返回 nullptr；新索引加入时可能淘汰旧的，不要长期保存返回的指针
+    const KeyframeIndex *index(const QString &filePath) const;
+
+signals:
+    void indexReady(const QString &filePath);
+
+private:
+    QThreadPool m_pool;
+    QCache<QString, KeyframeIndex> m_indexes;
+    QSet<QString> m_building;
+    QString m_cacheDir;
+
+    void onBuilt(const QString &filePath, const KeyframeIndex &index);
+    static QString cacheFileName(const QString &cacheDir, const QString &filePath);
+};
+
+#endif // KEYFRAMEINDEX_H
@@ -0,0 +1,561 @@
+// LibraryWatcher.cpp
+#include "LibraryWatcher.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QDataStream>
+#include <algorithm>
+
+namespace {
+const int kCoalesceInterval = 500;     // 合并变化通知的时间（毫秒）
+const int kPollInterval = 15000;       // 轮询模式的检查间隔（毫秒）
+const quint32 kStateMagic = 0x53575056;    // "VPWS"
+const quint16 kStateVersion = 1;
+
+QString childPath(const QString &directory, const QString &name)
+{
+    return directory.endsWith('/') ? directory + name : directory + '/' + name;
+}
+
+bool isUnder(const QString &path, const QString &root)
+{
+    return path == root || path.startsWith(root.endsWith('/') ? root : root + '/');
+}
+}
+
+LibraryWatcherWorker::LibraryWatcherWorker(const QStringList &extensions, QObject *parent)
+    : QObject(parent)
+{
+    for (const QString &extension : extensions) {
+        m_extensions.insert(extension.toLower());
+    }
+}
+
+void LibraryWatcherWorker::addRoot(const QString &root, bool reportExisting, int epoch)
+{
+    LibraryChanges changes;
+    changes.epoch = epoch;
+
+    // 上次运行保存的快照直接作为现状，随后重新读取，只报告关闭期间的差异
+    QStringList restored;
+    for (auto it = m_restored.begin(); it != m_restored.end();) {
+        if (isUnder(it.key(), root)) {
+            m_directories.insert(it.key(), it.value());
+            restored.append(it.key());
+            it = m_restored.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    changes.addedDirectories = restored;
+
+    // 没有快照的目录（新加入的文件夹或没有保存过状态）照常读取
+    QList<FoundFile> files;
+    walk(root, reportExisting ? &files : nullptr, &changes.addedDirectories);
+    for (const FoundFile &found : std::as_const(files)) {
+        changes.added.append(found.file);
+    }
+
+    if (!changes.addedDirectories.isEmpty()) {
+        emit changesDetected(changes);
+    }
+    if (!restored.isEmpty()) {
+        rescan(restored, epoch);
+    }
+}
+
+void LibraryWatcherWorker::rescan(const QStringList &directories, int epoch)
+{
+    LibraryChanges changes;
+    changes.epoch = epoch;
+    QList<FoundFile> added;
+    QList<FoundFile> removed;
+
+    for (const QString &directory : directories) {
+        auto it = m_directories.constFind(directory);
+        if (it == m_directories.constEnd()) {
+            continue;  // 已随上级目录一起移除
+        }
+
+        DirSnapshot old = it.value();
+        DirSnapshot current;
+        if (!readDirectory(directory, &current)) {
+            removeTree(directory, &removed, &changes.removedDirectories);
+            continue;
+        }
+
+        // 文件：同名但 inode 不同视为删除后新建
+        for (auto o = old.files.constBegin(); o != old.files.constEnd(); ++o) {
+            auto c = current.files.constFind(o.key());
+            if (c == current.files.constEnd() || c->key != o->key) {
+                FoundFile found;
+                found.file.filePath = childPath(directory, o.key());
+                found.key = o->key;
+                removed.append(found);
+            } else if (c->fileSize != o->fileSize || c->lastModified != o->lastModified) {
+                changes.modified.append(childPath(directory, o.key()));
+            }
+        }
+        for (auto c = current.files.constBegin(); c != current.files.constEnd(); ++c) {
+            auto o = old.files.constFind(c.key());
+            if (o == old.files.constEnd() || o->key != c->key) {
+                FoundFile found;
+                found.file.filePath = childPath(directory, c.key());
+                found.file.fileSize = c->fileSize;
+                found.file.lastModified = c->lastModified;
+                found.key = c->key;
+                added.append(found);
+            }
+        }
+
+        m_directories.insert(directory, current);
+
+        // 子目录：消失的整棵移除，新出现的整棵读取
+        for (const QString &name : std::as_const(old.subdirectories)) {
+            if (!current.subdirectories.contains(name)) {
+                removeTree(childPath(directory, name), &removed, &changes.removedDirectories);
+            }
+        }
+        for (const QString &name : std::as_const(current.subdirectories)) {
+            if (!old.subdirectories.contains(name)) {
+                walk(childPath(directory, name), &added, &changes.addedDirectories);
+            }
+        }
+    }
+
+    // 同一批中删除和新增的是同一个 inode，说明是重命名或移动（包括整个目录的移动）
+    QHash<FolderScanner::NodeKey, int> addedByKey;
+    for (int i = 0; i < added.size(); ++i) {
+        addedByKey.insert(added.at(i).key, i);
+    }
+
+    QSet<int> renamedIndexes;
+    for (const FoundFile &found : std::as_const(removed)) {
+        auto match = addedByKey.constFind(found.key);
+        if (match != addedByKey.constEnd() && !renamedIndexes.contains(match.value())) {
+            renamedIndexes.insert(match.value());
+            changes.renamed.append(qMakePair(found.file.filePath, added.at(match.value()).file.filePath));
+        } else {
+            changes.removed.append(found.file.filePath);
+        }
+    }
+    for (int i = 0; i < added.size(); ++i) {
+        if (!renamedIndexes.contains(i)) {
+            changes.added.append(added.at(i).file);
+        }
+    }
+
+    if (changes.hasFileChanges() || !changes.addedDirectories.isEmpty() ||
+        !changes.removedDirectories.isEmpty()) {
+        emit changesDetected(changes);
+    }
+}
+
+void LibraryWatcherWorker::poll(const QStringList &directories, int epoch)
+{
+    // 新增、删除、重命名都会更新目录的修改时间，这些目录整个重新读取；
+    // 原地改写文件不更新目录的修改时间，其余目录逐个检查已知文件的大小和修改时间
+    QStringList changed;
+    for (const QString &directory : directories) {
+        auto it = m_directories.constFind(directory);
+        if (it == m_directories.constEnd()) {
+            continue;
+        }
+
+        QFileInfo info(directory);
+        if (!info.exists() || info.lastModified().toMSecsSinceEpoch() != it->lastModified) {
+            changed.append(directory);
+            continue;
+        }
+
+        for (auto file = it->files.constBegin(); file != it->files.constEnd(); ++file) {
+            QFileInfo fileInfo(childPath(directory, file.key()));
+            if (!fileInfo.exists() || fileInfo.size() != file->fileSize ||
+                fileInfo.lastModified().toMSecsSinceEpoch() != file->lastModified) {
+                changed.append(directory);
+                break;
+            }
+        }
+    }
+
+    if (!changed.isEmpty()) {
+        rescan(changed, epoch);
+    }
+}
+
+void LibraryWatcherWorker::clear()
+{
+    m_directories.clear();
+    m_restored.clear();
+}
+
+bool LibraryWatcherWorker::saveState(const QString &fileName) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out << kStateMagic << kStateVersion << quint32(m_directories.size());
+    for (auto dir = m_directories.constBegin(); dir != m_directories.constEnd(); ++dir) {
+        out << dir.key() << dir->lastModified << dir->subdirectories << quint32(dir->files.size());
+        for (auto entry = dir->files.constBegin(); entry != dir->files.constEnd(); ++entry) {
+            out << entry.key() << entry->fileSize << entry->lastModified << entry->key.first << entry->key.second;
+        }
+    }
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+void LibraryWatcherWorker::restoreState(const QString &fileName)
+{
+    m_restored.clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint32 directoryCount = 0;
+    in >> magic >> version >> directoryCount;
+    if (magic != kStateMagic || version != kStateVersion) {
+        return;
+    }
+
+    QHash<QString, DirSnapshot> restored;
+    for (quint32 i = 0; i < directoryCount && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        DirSnapshot snapshot;
+        quint32 fileCount = 0;
+        in >> path >> snapshot.lastModified >> snapshot.subdirectories >> fileCount;
+        for (quint32 j = 0; j < fileCount && in.status() == QDataStream::Ok; ++j) {
+            QString name;
+            FileEntry entry;
+            in >> name >> entry.fileSize >> entry.lastModified >> entry.key.first >> entry.key.second;
+            snapshot.files.insert(name, entry);
+        }
+        restored.insert(path, snapshot);
+    }
+
+    // 文件损坏时宁可全部不用：不完整的快照会把其余文件当成新增
+    if (in.status() == QDataStream::Ok) {
+        m_restored = restored;
+    }
+}
+
+bool LibraryWatcherWorker::readDirectory(const QString &path, DirSnapshot *snapshot) const
+{
+    QFileInfo directoryInfo(path);
+    if (!directoryInfo.isDir()) {
+        return false;
+    }
+    snapshot->lastModified = directoryInfo.lastModified().toMSecsSinceEpoch();
+
+    QDirIterator it(path, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+        it.next();
+        QFileInfo info = it.fileInfo();
+
+        if (info.isDir()) {
+            // 不跟随目录链接，避免重复监视和链接成环
+            if (!info.isSymLink()) {
+                snapshot->subdirectories.insert(info.fileName());
+            }
+        } else if (m_extensions.contains(info.suffix().toLower())) {
+            FileEntry entry;
+            if (!FolderScanner::nodeKey(info.absoluteFilePath(), &entry.key)) {
+                continue;
+            }
+            entry.fileSize = info.size();
+            entry.lastModified = info.lastModified().toMSecsSinceEpoch();
+            snapshot->files.insert(info.fileName(), entry);
+        }
+    }
+    return true;
+}
+
+void LibraryWatcherWorker::walk(const QString &root, QList<FoundFile> *files, QStringList *directories)
+{
+    QStringList stack;
+    stack.append(root);
+
+    while (!stack.isEmpty()) {
+        QString path = stack.takeLast();
+        if (m_directories.contains(path)) {
+            continue;
+        }
+
+        DirSnapshot snapshot;
+        if (!readDirectory(path, &snapshot)) {
+            continue;
+        }
+
+        if (files) {
+            for (auto it = snapshot.files.constBegin(); it != snapshot.files.constEnd(); ++it) {
+                FoundFile found;
+                found.file.filePath = childPath(path, it.key());
+                found.file.fileSize = it->fileSize;
+                found.file.lastModified = it->lastModified;
+                found.key = it->key;
+                files->append(found);
+            }
+        }
+        for (const QString &name : std::as_const(snapshot.subdirectories)) {
+            stack.append(childPath(path, name));
+        }
+
+        m_directories.insert(path, snapshot);
+        directories->append(path);
+    }
+}
+
+void LibraryWatcherWorker::removeTree(const QString &root, QList<FoundFile> *files, QStringList *directories)
+{
+    for (auto it = m_directories.begin(); it != m_directories.end();) {
+        if (!isUnder(it.key(), root)) {
+            ++it;
+            continue;
+        }
+
+        for (auto file = it->files.constBegin(); file != it->files.constEnd(); ++file) {
+            FoundFile found;
+            found.file.filePath = childPath(it.key(), file.key());
+            found.key = file->key;
+            files->append(found);
+        }
+        directories->append(it.key());
+        it = m_directories.erase(it);
+    }
+}
+
+LibraryWatcher::LibraryWatcher(const QStringList &extensions, int maxWatches, QObject *parent)
+    : QObject(parent)
+    , m_thread(new QThread(this))
+    , m_worker(new LibraryWatcherWorker(extensions))
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_coalesceTimer(new QTimer(this))
+    , m_pollTimer(new QTimer(this))
+    , m_maxWatches(qMax(0, maxWatches))
+    , m_epoch(0)
+{
+    qRegisterMetaType<LibraryChanges>();
+
+    m_thread->setObjectName("LibraryWatcher");
+    m_worker->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_worker, &LibraryWatcherWorker::changesDetected, this, &LibraryWatcher::onWorkerChanges);
+    m_thread->start(QThread::LowPriority);
+
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &LibraryWatcher::onDirectoryChanged);
+
+    // 不重新计时：持续变化时最多延迟一个间隔
+    m_coalesceTimer->setSingleShot(true);
+    m_coalesceTimer->setInterval(kCoalesceInterval);
+    connect(m_coalesceTimer, &QTimer::timeout, this, &LibraryWatcher::flushDirtyDirectories);
+
+    m_pollTimer->setInterval(kPollInterval);
+    connect(m_pollTimer, &QTimer::timeout, this, &LibraryWatcher::pollDirectories);
+}
+
+LibraryWatcher::~LibraryWatcher()
+{
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void LibraryWatcher::addFolder(const QString &folder, bool reportExisting)
+{
+    QString root = QDir::cleanPath(QFileInfo(folder).absoluteFilePath());
+    for (const QString &existing : std::as_const(m_roots)) {
+        if (isUnder(root, existing)) {
+            return;  // 已在监视范围内
+        }
+    }
+
+    // 新目录包含原有的根目录时，原有的并入新的（工作线程会跳过已有快照的目录）
+    m_roots.erase(std::remove_if(m_roots.begin(), m_roots.end(), [&root](const QString &existing) {
+        return isUnder(existing, root);
+    }), m_roots.end());
+    m_roots.append(root);
+
+    LibraryWatcherWorker *worker = m_worker;
+    int epoch = m_epoch;
+    QMetaObject::invokeMethod(worker, [worker, root, reportExisting, epoch]() {
+        worker->addRoot(root, reportExisting, epoch);
+    }, Qt::QueuedConnection);
+}
+
+void LibraryWatcher::clear()
+{
+    // 已发出但尚未处理完的请求结果按代数丢弃
+    ++m_epoch;
+
+    if (!m_watched.isEmpty()) {
+        m_watcher->removePaths(QStringList(m_watched.begin(), m_watched.end()));
+    }
+    m_watched.clear();
+    m_polled.clear();
+    m_dirty.clear();
+    m_roots.clear();
+    m_coalesceTimer->stop();
+    m_pollTimer->stop();
+
+    LibraryWatcherWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker]() {
+        worker->clear();
+    }, Qt::QueuedConnection);
+}
+
+bool LibraryWatcher::saveState(const QString &fileName)
+{
+    // 快照只在工作线程中访问；工作线程不会等待本线程，阻塞调用是安全的
+    bool saved = false;
+    LibraryWatcherWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, fileName, &saved]() {
+        saved = worker->saveState(fileName);
+    }, Qt::BlockingQueuedConnection);
+    return saved;
+}
+
+void LibraryWatcher::restoreState(const QString &fileName)
+{
+    LibraryWatcherWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, fileName]() {
+        worker->restoreState(fileName);
+    }, Qt::QueuedConnection);
+}
+
+void LibraryWatcher::onDirectoryChanged(const QString &path)
+{
+    m_dirty.insert(path);
+    if (!m_coalesceTimer->isActive()) {
+        m_coalesceTimer->start();
+    }
+}
+
+void LibraryWatcher::flushDirtyDirectories()
+{
+    if (m_dirty.isEmpty()) {
+        return;
+    }
+
+    QStringList directories(m_dirty.begin(), m_dirty.end());
+    m_dirty.clear();
+
+    LibraryWatcherWorker *worker = m_worker;
+    int epoch = m_epoch;
+    QMetaObject::invokeMethod(worker, [worker, directories, epoch]() {
+        worker->rescan(directories, epoch);
+    }, Qt::QueuedConnection);
+}
+
+void LibraryWatcher::pollDirectories()
+{
+    if (m_polled.isEmpty()) {
+        m_pollTimer->stop();
+        return;
+    }
+
+    QStringList directories(m_polled.begin(), m_polled.end());
+    LibraryWatcherWorker *worker = m_worker;
+    int epoch = m_epoch;
+    QMetaObject::invokeMethod(worker, [worker, directories, epoch]() {
+        worker->poll(directories, epoch);
+    }, Qt::QueuedConnection);
+}
+
+void LibraryWatcher::onWorkerChanges(const LibraryChanges &changes)
+{
+    if (changes.epoch != m_epoch) {
+        return;
+    }
+
+    if (!changes.removedDirectories.isEmpty()) {
+        QStringList unwatch;
+        for (const QString &directory : changes.removedDirectories) {
+            if (m_watched.remove(directory)) {
+                unwatch.append(directory);
+            }
+            m_polled.remove(directory);
+            m_dirty.remove(directory);
+        }
+        if (!unwatch.isEmpty()) {
+            m_watcher->removePaths(unwatch);
+            retryPolledDirectories();
+        }
+    }
+
+    watchDirectories(changes.addedDirectories);
+
+    if (changes.hasFileChanges()) {
+        emit changesDetected(changes);
+    }
+}
+
+void LibraryWatcher::watchDirectories(const QStringList &directories)
+{
+    if (directories.isEmpty()) {
+        return;
+    }
+
+    // 超过上限的目录直接轮询，不占用系统的监视描述符
+    QStringList toWatch;
+    int room = m_maxWatches - m_watched.size();
+    for (const QString &directory : directories) {
+        if (room > 0) {
+            toWatch.append(directory);
+            --room;
+        } else {
+            m_polled.insert(directory);
+        }
+    }
+
+    if (!toWatch.isEmpty()) {
+        // 系统监视数用尽等原因添加失败的也改为轮询
+        QStringList failedList = m_watcher->addPaths(toWatch);
+        QSet<QString> failed(failedList.begin(), failedList.end());
+        for (const QString &directory : std::as_const(toWatch)) {
+            if (failed.contains(directory)) {
+                m_polled.insert(directory);
+            } else {
+                m_watched.insert(directory);
+            }
+        }
+    }
+
+    if (!m_polled.isEmpty() && !m_pollTimer->isActive()) {
+        m_pollTimer->start();
+    }
+}
+
+void LibraryWatcher::retryPolledDirectories()
+{
+    // 监视数有空余时把轮询中的目录改回系统监视
+    QStringList retry;
+    int room = m_maxWatches - m_watched.size();
+    for (auto it = m_polled.begin(); it != m_polled.end() && retry.size() < room;) {
+        retry.append(*it);
+        it = m_polled.erase(it);
+    }
+    if (retry.isEmpty()) {
+        return;
+    }
+
+    watchDirectories(retry);
+    if (m_polled.isEmpty()) {
+        m_pollTimer->stop();
+    }
+
+    // 上次轮询之后的变化不会再有通知，改回监视时重新读取一次
+    for (const QString &directory : std::as_const(retry)) {
+        m_dirty.insert(directory);
+    }
+    if (!m_coalesceTimer->isActive()) {
+        m_coalesceTimer->start();
+    }
+}
@@ -0,0 +1,137 @@
+// LibraryWatcher.h
+#ifndef LIBRARYWATCHER_H
+#define LIBRARYWATCHER_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QMetaType>
+
+#include "FolderScanner.h"
+
+// 一次汇总后的文件夹变化
+struct LibraryChanges {
+    QList<ScannedFile> added;
+    QStringList removed;
+    QStringList modified;                       // 大小或修改时间变化
+    QList<QPair<QString, QString>> renamed;     // (旧路径, 新路径)
+    QStringList addedDirectories;
+    QStringList removedDirectories;
+    int epoch;                                  // 发起请求时的代数，clear() 之后的旧结果被丢弃
+
+    LibraryChanges() : epoch(0) {}
+
+    bool hasFileChanges() const {
+        return !added.isEmpty() || !removed.isEmpty() || !modified.isEmpty() || !renamed.isEmpty();
+    }
+};
+
+Q_DECLARE_METATYPE(LibraryChanges)
+
+// 工作线程：保存每个目录的快照，重新读取有变化的目录并与快照比较
+class LibraryWatcherWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LibraryWatcherWorker(const QStringList &extensions, QObject *parent = nullptr);
+
+    void addRoot(const QString &root, bool reportExisting, int epoch);
+    void rescan(const QStringList &directories, int epoch);
+    void poll(const QStringList &directories, int epoch);
+    void clear();
+
+    // 目录快照的持久化：恢复的快照在 addRoot() 时作为比较基准
+    bool saveState(const QString &fileName) const;
+    void restoreState(const QString &fileName);
+
+signals:
+    void changesDetected(const LibraryChanges &changes);
+
+private:
+    struct FileEntry {
+        qint64 fileSize;
+        qint64 lastModified;
+        FolderScanner::NodeKey key;
+    };
+
+    struct DirSnapshot {
+        qint64 lastModified;
+        QHash<QString, FileEntry> files;    // 文件名 -> 状态
+        QSet<QString> subdirectories;
+    };
+
+    struct FoundFile {
+        ScannedFile file;
+        FolderScanner::NodeKey key;
+    };
+
+    QSet<QString> m_extensions;
+    QHash<QString, DirSnapshot> m_directories;   // 目录路径 -> 快照
+    QHash<QString, DirSnapshot> m_restored;      // 上次运行保存的快照，尚未被 addRoot() 取用
+
+    bool readDirectory(const QString &path, DirSnapshot *snapshot) const;
+    void walk(const QString &root, QList<FoundFile> *files, QStringList *directories);
+    void removeTree(const QString &root, QList<FoundFile> *files, QStringList *directories);
+};
+
+// 文件夹监视
+// 用 QFileSystemWatcher（Linux 上即 inotify）监视播放列表来源文件夹下的所有目录，
+// 变化通知合并一段时间后交给工作线程只重新读取变化的目录，得到增量的
+// 添加/删除/重命名。监视数量超过上限或添加失败的目录改为定时轮询，
+// 轮询时先比较目录修改时间，未变化的目录只检查已知文件的大小和修改时间；
+// 有目录被删除而空出监视数时，轮询中的目录改回系统监视。
+// 目录快照可以保存下来，下次启动时先 restoreState() 再 addFolder()，
+// 只报告程序关闭期间的变化；用户从播放列表中移除的文件不会再作为新增出现。
+class LibraryWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LibraryWatcher(const QStringList &extensions, int maxWatches = 4096, QObject *parent = nullptr);
+    ~LibraryWatcher();
+
+    // 有恢复的快照时只报告与快照的差异；没有时 reportExisting 为 true 则把已有文件也作为新增报告
+    void addFolder(const QString &folder, bool reportExisting = false);
+    void clear();
+
+    // 保存时等待工作线程写完；恢复须在 addFolder() 之前调用
+    bool saveState(const QString &fileName);
+    void restoreState(const QString &fileName);
+
+    QStringList folders() const { return m_roots; }
+    int watchedCount() const { return m_watched.size(); }
+    int polledCount() const { return m_polled.size(); }
+
+signals:
+    void changesDetected(const LibraryChanges &changes);
+
+private slots:
+    void onDirectoryChanged(const QString &path);
+    void flushDirtyDirectories();
+    void pollDirectories();
+
+private:
+    QThread *m_thread;
+    LibraryWatcherWorker *m_worker;
+    QFileSystemWatcher *m_watcher;
+    QTimer *m_coalesceTimer;
+    QTimer *m_pollTimer;
+    int m_maxWatches;
+    int m_epoch;
+
+    QStringList m_roots;
+    QSet<QString> m_watched;
+    QSet<QString> m_polled;
+    QSet<QString> m_dirty;
+
+    void onWorkerChanges(const LibraryChanges &changes);
+    void watchDirectories(const QStringList &directories);
+    void retryPolledDirectories();
+};
+
+#endif // LIBRARYWATCHER_H
@@ -0,0 +1,131 @@
+// MediaInfo.h
+#ifndef MEDIAINFO_H
+#define MEDIAINFO_H
+
+#include <QString>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QMetaType>
+
+// 媒体项结构
+struct MediaInfo {
+    quint64 id;          // 播放列表内的稳定ID，由 PlaylistStore 分配，不持久化
+    QString filePath;
+    QString title;
+    QString artist;
+    QString album;
+    qint64 duration;
+    QDateTime addTime;
+    int playCount;
+    bool isFavorite;
+
+    // 由后台元数据提取补全
+    QString codec;
+    int width;
+    int height;
+    int bitRate;
+    bool metadataLoaded;
+
+    // 最近一次扫描或探测时的文件状态，用于判断元数据是否过期；-1 表示未知
+    qint64 fileSize;
+    qint64 lastModified;
+
+    // 后台校验发现文件不存在，不持久化
+    bool missing;
+
+    MediaInfo() : id(0), duration(0), playCount(0), isFavorite(false),
+                  width(0), height(0), bitRate(0), metadataLoaded(false),
+                  fileSize(-1), lastModified(0), missing(false) {
+        addTime = QDateTime::currentDateTime();
+    }
+
+    QString displayName() const {
+        if (!title.isEmpty() && !artist.isEmpty()) {
+            return QString("%1 - %2").arg(artist, title);
+        }
+        return title.isEmpty() ? QFileInfo(filePath).baseName() : title;
+    }
+
+    QJsonObject toJson() const {
+        QJsonObject obj;
+        obj["filePath"] = filePath;
+        obj["title"] = title;
+        obj["artist"] = artist;
+        obj["album"] = album;
+        obj["duration"] = duration;
+        obj["addTime"] = addTime.toString(Qt::ISODate);
+        obj["playCount"] = playCount;
+        obj["isFavorite"] = isFavorite;
+        obj["codec"] = codec;
+        obj["width"] = width;
+        obj["height"] = height;
+        obj["bitRate"] = bitRate;
+        obj["metadataLoaded"] = metadataLoaded;
+        obj["fileSize"] = fileSize;
+        obj["lastModified"] = lastModified;
+        return obj;
+    }
+
+    static MediaInfo fromJson(const QJsonObject &obj) {
+        MediaInfo info;
+        info.filePath = obj["filePath"].toString();
+        info.title = obj["title"].toString();
+        info.artist = obj["artist"].toString();
+        info.album = obj["album"].toString();
+        info.duration = obj["duration"].toVariant().toLongLong();
+        info.addTime = QDateTime::fromString(obj["addTime"].toString(), Qt::ISODate);
+        info.playCount = obj["playCount"].toInt();
+        info.isFavorite = obj["isFavorite"].toBool();
+        info.codec = obj["codec"].toString();
+        info.width = obj["width"].toInt();
+        info.height = obj["height"].toInt();
+        info.bitRate = obj["bitRate"].toInt();
+        info.metadataLoaded = obj["metadataLoaded"].toBool();
+        info.fileSize = obj.contains("fileSize") ? obj["fileSize"].toVariant().toLongLong() : -1;
+        info.lastModified = obj["lastModified"].toVariant().toLongLong();
+        return info;
+    }
+};
+
+// 后台提取到的元数据
+struct MediaMetadata {
+    quint64 id;
+    QString filePath;
+    bool valid;
+    qint64 duration;
+    QString title;
+    QString artist;
+    QString album;
+    QString codec;
+    int width;
+    int height;
+    int bitRate;
+    qint64 fileSize;       // 探测时的文件大小和修改时间，作为缓存键
+    qint64 lastModified;
+    bool transient;        // 超时或播放器出错，可能只是暂时读不到，不写入缓存
+
+    MediaMetadata() : id(0), valid(false), duration(0), width(0), height(0), bitRate(0),
+                      fileSize(-1), lastModified(0), transient(false) {}
+
+    // 写入媒体项；标签为空时保留从文件名解析出的标题/艺术家
+    void applyTo(MediaInfo &info) const {
+        if (valid) {
+            if (duration > 0) info.duration = duration;
+            if (!title.isEmpty()) info.title = title;
+            if (!artist.isEmpty()) info.artist = artist;
+            if (!album.isEmpty()) info.album = album;
+            info.codec = codec;
+            info.width = width;
+            info.height = height;
+            info.bitRate = bitRate;
+        }
+        info.fileSize = fileSize;
+        info.lastModified = lastModified;
+        info.metadataLoaded = true;
+    }
+};
+
+Q_DECLARE_METATYPE(MediaMetadata)
+
+#endif // MEDIAINFO_H
@@ -0,0 +1,242 @@
+// MetadataCache.cpp
+#include "MetadataCache.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace {
+const quint32 kMagic = 0x56504D43;          // "VPMC"
+const quint16 kVersion = 1;
+const quint8 kRecordPut = 1;
+const quint8 kRecordRemove = 2;
+const int kFlushThreshold = 256 * 1024;     // 待写入数据超过该大小时立即追加
+const int kCompactMinRecords = 1024;
+
+void writeHeader(QDataStream &out)
+{
+    out << kMagic << kVersion;
+}
+
+void writeRecord(QDataStream &out, quint8 type, const QString &filePath, const MediaMetadata *metadata)
+{
+    out << type << filePath;
+    if (type == kRecordPut) {
+        out << metadata->fileSize << metadata->lastModified << metadata->valid << metadata->duration
+            << metadata->title << metadata->artist << metadata->album << metadata->codec
+            << qint32(metadata->width) << qint32(metadata->height) << qint32(metadata->bitRate);
+    }
+}
+}
+
+MetadataCache::MetadataCache(const QString &fileName)
+    : m_fileName(fileName)
+    , m_recordCount(0)
+    , m_hits(0)
+    , m_misses(0)
+{
+    if (m_fileName.isEmpty()) {
+        m_fileName = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/metadata.cache";
+    }
+    load();
+}
+
+MetadataCache::~MetadataCache()
+{
+    if (needsCompaction()) {
+        compact();
+    } else {
+        flush();
+    }
+}
+
+bool MetadataCache::lookup(const QString &filePath, qint64 fileSize, qint64 lastModified, MediaMetadata *metadata)
+{
+    auto it = m_entries.constFind(filePath);
+    if (it == m_entries.constEnd()) {
+        ++m_misses;
+        return false;
+    }
+
+    if (it->fileSize != fileSize || it->lastModified != lastModified) {
+        // 文件已变化，旧结果作废
+        invalidate(filePath);
+        ++m_misses;
+        return false;
+    }
+
+    quint64 id = metadata->id;
+    *metadata = it.value();
+    metadata->id = id;
+    ++m_hits;
+    return true;
+}
+
+void MetadataCache::insert(const MediaMetadata &metadata)
+{
+    // 超时的结果不能代表文件本身，缓存后文件就再也不会被重新探测
+    if (metadata.filePath.isEmpty() || metadata.fileSize < 0 || metadata.transient) {
+        return;
+    }
+
+    MediaMetadata entry = metadata;
+    entry.id = 0;  // ID 只在本次运行内有效
+    m_entries.insert(entry.filePath, entry);
+    appendRecord(kRecordPut, entry.filePath, &entry);
+}
+
+void MetadataCache::invalidate(const QString &filePath)
+{
+    if (m_entries.remove(filePath)) {
+        appendRecord(kRecordRemove, filePath, nullptr);
+    }
+}
+
+void MetadataCache::clear()
+{
+    m_entries.clear();
+    m_pending.clear();
+    m_recordCount = 0;
+    QFile::remove(m_fileName);
+}
+
+void MetadataCache::flush()
+{
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "无法写入元数据缓存:" << m_fileName;
+        return;
+    }
+
+    if (file.size() == 0) {
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_6_0);
+        writeHeader(out);
+    }
+    file.write(m_pending);
+    m_pending.clear();
+}
+
+bool MetadataCache::compact()
+{
+    QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "无法重写元数据缓存:" << m_fileName;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    writeHeader(out);
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        writeRecord(out, kRecordPut, it.key(), &it.value());
+    }
+
+    if (!file.commit()) {
+        return false;
+    }
+
+    // 重写后全部条目都在文件中，待写入的记录不再需要
+    m_pending.clear();
+    m_recordCount = m_entries.size();
+    return true;
+}
+
+void MetadataCache::load()
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly) || file.size() == 0) {
+        return;
+    }
+
+    // 映射整个文件，避免逐条读取时的系统调用
+    QByteArray buffer;
+    uchar *mapped = file.map(0, file.size());
+    if (mapped) {
+        buffer = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), file.size());
+    } else {
+        buffer = file.readAll();
+    }
+
+    QDataStream in(buffer);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+
+    bool damaged = false;
+    if (in.status() != QDataStream::Ok || magic != kMagic || version != kVersion) {
+        damaged = true;
+    } else {
+        while (!in.atEnd()) {
+            quint8 type = 0;
+            QString filePath;
+            in >> type >> filePath;
+
+            MediaMetadata entry;
+            if (type == kRecordPut) {
+                qint32 width, height, bitRate;
+                in >> entry.fileSize >> entry.lastModified >> entry.valid >> entry.duration
+                   >> entry.title >> entry.artist >> entry.album >> entry.codec
+                   >> width >> height >> bitRate;
+                entry.width = width;
+                entry.height = height;
+                entry.bitRate = bitRate;
+            } else if (type != kRecordRemove) {
+                damaged = true;
+                break;
+            }
+
+            // 末尾记录不完整（写入时被中断），丢弃
+            if (in.status() != QDataStream::Ok) {
+                damaged = true;
+                break;
+            }
+
+            if (type == kRecordPut) {
+                entry.filePath = filePath;
+                m_entries.insert(filePath, entry);
+            } else {
+                m_entries.remove(filePath);
+            }
+            ++m_recordCount;
+        }
+    }
+
+    if (mapped) {
+        file.unmap(mapped);
+    }
+    file.close();
+
+    if (damaged || needsCompaction()) {
+        compact();
+    }
+}
+
+void MetadataCache::appendRecord(quint8 type, const QString &filePath, const MediaMetadata *metadata)
+{
+    QDataStream out(&m_pending, QIODevice::WriteOnly | QIODevice::Append);
+    out.setVersion(QDataStream::Qt_6_0);
+
+    writeRecord(out, type, filePath, metadata);
+    ++m_recordCount;
+
+    if (m_pending.size() >= kFlushThreshold) {
+        flush();
+    }
+}
+
+bool MetadataCache::needsCompaction() const
+{
+    return m_recordCount >= kCompactMinRecords && m_recordCount > 2 * m_entries.size();
+}
@@ -0,0 +1,51 @@
+// MetadataCache.h
+#ifndef METADATACACHE_H
+#define METADATACACHE_H
+
+#include <QString>
+#include <QHash>
+#include <QByteArray>
+
+#include "MediaInfo.h"
+
+// 元数据磁盘缓存
+// 以（路径，文件大小，修改时间）为键保存探测结果，文件未变化时跳过探测。
+// 缓存文件只追加写入：新结果和失效标记依次追加，启动时映射整个文件顺序回放，
+// 后写的记录覆盖先写的；失效记录过多时整体重写（压缩）。
+class MetadataCache
+{
+public:
+    // fileName 为空时使用 CacheLocation/metadata.cache
+    explicit MetadataCache(const QString &fileName = QString());
+    ~MetadataCache();
+
+    // 命中时写入 metadata 并返回 true；文件大小或修改时间不一致视为过期
+    bool lookup(const QString &filePath, qint64 fileSize, qint64 lastModified, MediaMetadata *metadata);
+    void insert(const MediaMetadata &metadata);
+    void invalidate(const QString &filePath);
+    void clear();
+
+    // 把待写入的记录追加到文件
+    void flush();
+    // 只保留有效条目，重写缓存文件
+    bool compact();
+
+    int size() const { return m_entries.size(); }
+    int hits() const { return m_hits; }
+    int misses() const { return m_misses; }
+    void resetCounters() { m_hits = 0; m_misses = 0; }
+
+private:
+    QString m_fileName;
+    QHash<QString, MediaMetadata> m_entries;
+    QByteArray m_pending;     // 尚未写入文件的记录
+    int m_recordCount;        // 文件中的记录数（含已被覆盖或失效的）
+    int m_hits;
+    int m_misses;
+
+    void load();
+    void appendRecord(quint8 type, const QString &filePath, const MediaMetadata *metadata);
+    bool needsCompaction() const;
+};
+
+#endif // METADATACACHE_H
@@ -0,0 +1,281 @@
+// MetadataExtractor.cpp
+#include "MetadataExtractor.h"
+#include <QMediaMetaData>
+#include <QUrl>
+#include <QSize>
+#include <QFileInfo>
+#include <QDateTime>
+#include <algorithm>
+#include <utility>
+
+namespace {
+const int kProbeTimeout = 10000;     // 单个文件最长探测时间（毫秒）
+const int kFlushInterval = 200;      // 结果批量提交间隔（毫秒）
+const int kMaxBatchSize = 256;
+}
+
+MetadataProbe::MetadataProbe(QObject *parent)
+    : QObject(parent)
+    , m_player(nullptr)
+    , m_timeoutTimer(new QTimer(this))
+    , m_busy(false)
+{
+    m_timeoutTimer->setSingleShot(true);
+    m_timeoutTimer->setInterval(kProbeTimeout);
+    connect(m_timeoutTimer, &QTimer::timeout, this, &MetadataProbe::onTimeout);
+}
+
+void MetadataProbe::probe(quint64 id, const QString &filePath)
+{
+    if (!m_player) {
+        m_player = new QMediaPlayer(this);
+        connect(m_player, &QMediaPlayer::mediaStatusChanged, this, &MetadataProbe::onMediaStatusChanged);
+        connect(m_player, &QMediaPlayer::errorOccurred, this, &MetadataProbe::onError);
+    }
+
+    m_current = MediaMetadata();
+    m_current.id = id;
+    m_current.filePath = filePath;
+    m_busy = true;
+
+    // 在工作线程中记录文件状态，供元数据缓存使用
+    QFileInfo fileInfo(filePath);
+    m_current.fileSize = fileInfo.size();
+    m_current.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+    m_timeoutTimer->start();
+    m_player->setSource(QUrl::fromLocalFile(filePath));
+}
+
+void MetadataProbe::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
+{
+    if (!m_busy) {
+        return;
+    }
+
+    if (status == QMediaPlayer::LoadedMedia) {
+        const QMediaMetaData meta = m_player->metaData();
+
+        m_current.duration = m_player->duration();
+        if (m_current.duration <= 0) {
+            m_current.duration = meta.value(QMediaMetaData::Duration).toLongLong();
+        }
+
+        m_current.title = meta.stringValue(QMediaMetaData::Title);
+        m_current.artist = meta.stringValue(QMediaMetaData::ContributingArtist);
+        if (m_current.artist.isEmpty()) {
+            m_current.artist = meta.stringValue(QMediaMetaData::AlbumArtist);
+        }
+        m_current.album = meta.stringValue(QMediaMetaData::AlbumTitle);
+
+        QString videoCodec = meta.stringValue(QMediaMetaData::VideoCodec);
+        QString audioCodec = meta.stringValue(QMediaMetaData::AudioCodec);
+        if (!videoCodec.isEmpty() && !audioCodec.isEmpty()) {
+            m_current.codec = QString("%1/%2").arg(videoCodec, audioCodec);
+        } else {
+            m_current.codec = videoCodec.isEmpty() ? audioCodec : videoCodec;
+        }
+
+        QSize resolution = meta.value(QMediaMetaData::Resolution).toSize();
+        m_current.width = resolution.width();
+        m_current.height = resolution.height();
+        m_current.bitRate = meta.value(QMediaMetaData::VideoBitRate).toInt() +
+                            meta.value(QMediaMetaData::AudioBitRate).toInt();
+
+        finish(true);
+    } else if (status == QMediaPlayer::InvalidMedia) {
+        finish(false);
+    }
+}
+
+void MetadataProbe::onError(QMediaPlayer::Error error, const QString &errorString)
+{
+    Q_UNUSED(errorString);
+    if (m_busy && error != QMediaPlayer::NoError) {
+        finish(false, true);
+    }
+}
+
+void MetadataProbe::onTimeout()
+{
+    if (m_busy) {
+        finish(false, true);
+    }
+}
+
+void MetadataProbe::finish(bool valid, bool transient)
+{
+    m_timeoutTimer->stop();
+    m_busy = false;
+    m_current.valid = valid;
+    m_current.transient = transient;
+
+    MediaMetadata result = m_current;
+
+    // 释放文件句柄和解码器
+    m_player->setSource(QUrl());
+
+    emit probed(result);
+}
+
+MetadataExtractor::MetadataExtractor(int workerCount, int queueCapacity, QObject *parent)
+    : QObject(parent)
+    , m_capacity(qMax(1, queueCapacity))
+    , m_wasFull(false)
+{
+    qRegisterMetaType<MediaMetadata>();
+
+    if (workerCount <= 0) {
+        // 每个探测器持有一个 QMediaPlayer，数量不宜过多
+        workerCount = qBound(1, QThread::idealThreadCount() / 2, 4);
+    }
+
+    for (int i = 0; i < workerCount; ++i) {
+        Worker worker;
+        worker.thread = new QThread(this);
+        worker.thread->setObjectName(QString("MetadataProbe-%1").arg(i));
+        worker.probe = new MetadataProbe();
+        worker.probe->moveToThread(worker.thread);
+        worker.currentId = 0;
+
+        connect(worker.thread, &QThread::finished, worker.probe, &QObject::deleteLater);
+        connect(worker.probe, &MetadataProbe::probed, this, [this, i](const MediaMetadata &metadata) {
+            onProbed(i, metadata);
+        });
+
+        m_workers.append(worker);
+        worker.thread->start(QThread::LowPriority);
+    }
+
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(kFlushInterval);
+    connect(m_flushTimer, &QTimer::timeout, this, &MetadataExtractor::flushResults);
+}
+
+MetadataExtractor::~MetadataExtractor()
+{
+    for (const Worker &worker : std::as_const(m_workers)) {
+        worker.thread->quit();
+    }
+    for (const Worker &worker : std::as_const(m_workers)) {
+        worker.thread->wait();
+    }
+}
+
+bool MetadataExtractor::enqueue(quint64 id, const QString &filePath)
+{
+    if (id == 0 || m_queuedIds.contains(id)) {
+        return true;
+    }
+    for (const Worker &worker : std::as_const(m_workers)) {
+        if (worker.currentId == id && !m_cancelledIds.contains(id)) {
+            return true;  // 正在处理
+        }
+    }
+
+    if (isFull()) {
+        m_wasFull = true;
+        return false;
+    }
+
+    m_cancelledIds.remove(id);
+    m_queue.enqueue(qMakePair(id, filePath));
+    m_queuedIds.insert(id);
+
+    dispatch();
+    return true;
+}
+
+void MetadataExtractor::cancel(quint64 id)
+{
+    if (m_queuedIds.remove(id)) {
+        for (auto it = m_queue.begin(); it != m_queue.end(); ++it) {
+            if (it->first == id) {
+                m_queue.erase(it);
+                break;
+            }
+        }
+        return;
+    }
+
+    for (const Worker &worker : std::as_const(m_workers)) {
+        if (worker.currentId == id) {
+            m_cancelledIds.insert(id);
+            break;
+        }
+    }
+
+    m_results.erase(std::remove_if(m_results.begin(), m_results.end(),
+                                   [id](const MediaMetadata &metadata) { return metadata.id == id; }),
+                    m_results.end());
+}
+
+void MetadataExtractor::cancelAll()
+{
+    m_queue.clear();
+    m_queuedIds.clear();
+    m_results.clear();
+    m_flushTimer->stop();
+
+    for (const Worker &worker : std::as_const(m_workers)) {
+        if (worker.currentId != 0) {
+            m_cancelledIds.insert(worker.currentId);
+        }
+    }
+}
+
+void MetadataExtractor::onProbed(int workerIndex, const MediaMetadata &metadata)
+{
+    m_workers[workerIndex].currentId = 0;
+
+    if (!m_cancelledIds.remove(metadata.id)) {
+        m_results.append(metadata);
+        if (m_results.size() >= kMaxBatchSize) {
+            flushResults();
+        } else if (!m_flushTimer->isActive()) {
+            m_flushTimer->start();
+        }
+    }
+
+    dispatch();
+
+    // 队列降到一半以下时通知调用方继续提交
+    if (m_wasFull && m_queue.size() <= m_capacity / 2) {
+        m_wasFull = false;
+        emit capacityAvailable();
+    }
+}
+
+void MetadataExtractor::flushResults()
+{
+    m_flushTimer->stop();
+    if (m_results.isEmpty()) {
+        return;
+    }
+
+    QList<MediaMetadata> batch;
+    batch.swap(m_results);
+    emit metadataReady(batch);
+}
+
+void MetadataExtractor::dispatch()
+{
+    for (Worker &worker : m_workers) {
+        if (m_queue.isEmpty()) {
+            break;
+        }
+        if (worker.currentId != 0) {
+            continue;
+        }
+
+        QPair<quint64, QString> job = m_queue.dequeue();
+        m_queuedIds.remove(job.first);
+        worker.currentId = job.first;
+
+        MetadataProbe *probe = worker.probe;
+        QMetaObject::invokeMethod(probe, [probe, job]() {
+            probe->probe(job.first, job.second);
+        }, Qt::QueuedConnection);
+    }
+}
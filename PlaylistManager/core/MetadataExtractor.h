@@ -0,0 +1,93 @@
+// MetadataExtractor.h
+#ifndef METADATAEXTRACTOR_H
+#define METADATAEXTRACTOR_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QQueue>
+#include <QPair>
+#include <QSet>
+#include <QList>
+#include <QMediaPlayer>
+
+#include "MediaInfo.h"
+
+// 单个探测器，运行在自己的工作线程中
+// 使用不带输出的 QMediaPlayer 打开文件，读取 QMediaMetaData 后立即释放
+class MetadataProbe : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetadataProbe(QObject *parent = nullptr);
+
+public slots:
+    void probe(quint64 id, const QString &filePath);
+
+signals:
+    void probed(const MediaMetadata &metadata);
+
+private slots:
+    void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
+    void onError(QMediaPlayer::Error error, const QString &errorString);
+    void onTimeout();
+
+private:
+    QMediaPlayer *m_player;   // 在工作线程中首次探测时创建
+    QTimer *m_timeoutTimer;
+    MediaMetadata m_current;
+    bool m_busy;
+
+    // transient：超时或出错，结果不可缓存
+    void finish(bool valid, bool transient = false);
+};
+
+// 元数据提取线程池
+// GUI线程中的调度器：维护有界等待队列，每个工作线程同一时间只处理一个文件，
+// 结果按批次汇总后通过 metadataReady 发出。
+class MetadataExtractor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetadataExtractor(int workerCount = 0, int queueCapacity = 1024, QObject *parent = nullptr);
+    ~MetadataExtractor();
+
+    // 队列已满时返回 false，调用方在 capacityAvailable() 后再提交
+    bool enqueue(quint64 id, const QString &filePath);
+    void cancel(quint64 id);
+    void cancelAll();
+
+    bool isFull() const { return m_queue.size() >= m_capacity; }
+    int pendingCount() const { return m_queue.size(); }
+
+signals:
+    void metadataReady(const QList<MediaMetadata> &batch);
+    void capacityAvailable();
+
+private slots:
+    void flushResults();
+
+private:
+    struct Worker {
+        QThread *thread;
+        MetadataProbe *probe;
+        quint64 currentId;   // 0 表示空闲
+    };
+
+    QList<Worker> m_workers;
+    QQueue<QPair<quint64, QString>> m_queue;
+    QSet<quint64> m_queuedIds;
+    QSet<quint64> m_cancelledIds;   // 已在处理中但被取消的项，结果到达时丢弃
+    int m_capacity;
+    bool m_wasFull;
+
+    QList<MediaMetadata> m_results;
+    QTimer *m_flushTimer;
+
+    void onProbed(int workerIndex, const MediaMetadata &metadata);
+    void dispatch();
+};
+
+#endif // METADATAEXTRACTOR_H
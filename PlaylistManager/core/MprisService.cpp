@@ -0,0 +1,505 @@
+// MprisService.cpp
+#include "MprisService.h"
+#include <QDBusMessage>
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QUrl>
+
+namespace {
+const QString kObjectPath = QStringLiteral("/org/mpris/MediaPlayer2");
+const QString kPlayerInterface = QStringLiteral("org.mpris.MediaPlayer2.Player");
+const QString kServicePrefix = QStringLiteral("org.mpris.MediaPlayer2.PlaylistManager");
+const int kCoalesceInterval = 100;   // PropertiesChanged 合并间隔（毫秒）
+const qint64 kSeekTolerance = 500;   // 位置与推算值相差超过此值（毫秒）视为跳转
+const double kMinimumRate = 0.5;     // 与界面上的速度选项一致
+const double kMaximumRate = 2.0;
+
+bool isStalled(QMediaPlayer::MediaStatus status)
+{
+    return status == QMediaPlayer::BufferingMedia || status == QMediaPlayer::StalledMedia;
+}
+}
+
+MprisService::MprisService(PlaybackEngine *engine, PlaylistController *playlist, QObject *parent)
+    : QObject(parent)
+    , m_engine(engine)
+    , m_playlist(playlist)
+    , m_connection(QString())
+    , m_flushTimer(new QTimer(this))
+    , m_volume(1.0)
+    , m_rate(1.0)
+    , m_lastPosition(0)
+{
+    new MprisRootAdaptor(this);
+    new MprisPlayerAdaptor(this);
+
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(kCoalesceInterval);
+    connect(m_flushTimer, &QTimer::timeout, this, &MprisService::flushChanges);
+
+    connect(m_engine, &PlaybackEngine::playbackStateChanged, this, &MprisService::onPlaybackStateChanged);
+    connect(m_engine, &PlaybackEngine::mediaStatusChanged, this, &MprisService::onMediaStatusChanged);
+    connect(m_engine, &PlaybackEngine::positionChanged, this, &MprisService::onPositionChanged);
+    connect(m_engine, &PlaybackEngine::durationChanged, this, &MprisService::onDurationChanged);
+    connect(m_playlist, &PlaylistController::mediaSelected, this, &MprisService::onMediaSelected);
+    connect(m_playlist, &PlaylistController::playlistChanged, this, &MprisService::onPlaylistChanged);
+    connect(m_playlist, &PlaylistController::playModeChanged, this, &MprisService::onPlayModeChanged);
+}
+
+MprisService::~MprisService()
+{
+    unregister();
+}
+
+bool MprisService::registerOn(const QDBusConnection &connection, QString *errorString)
+{
+    unregister();
+
+    if (!connection.isConnected()) {
+        if (errorString) {
+            *errorString = connection.lastError().message();
+        }
+        return false;
+    }
+
+    // 同时运行多个实例时，后启动的按规范加上实例后缀
+    QString name = kServicePrefix;
+    if (!connection.registerService(name)) {
+        name = QString("%1.instance%2").arg(kServicePrefix).arg(QCoreApplication::applicationPid());
+        if (!connection.registerService(name)) {
+            if (errorString) {
+                *errorString = connection.lastError().message();
+            }
+            return false;
+        }
+    }
+
+    if (!connection.registerObject(kObjectPath, this, QDBusConnection::ExportAdaptors)) {
+        if (errorString) {
+            *errorString = connection.lastError().message();
+        }
+        connection.unregisterService(name);
+        return false;
+    }
+
+    m_connection = connection;
+    m_serviceName = name;
+    return true;
+}
+
+void MprisService::unregister()
+{
+    if (m_serviceName.isEmpty()) {
+        return;
+    }
+    m_flushTimer->stop();
+    m_pendingChanges.clear();
+    m_connection.unregisterObject(kObjectPath);
+    m_connection.unregisterService(m_serviceName);
+    m_connection = QDBusConnection(QString());
+    m_serviceName.clear();
+}
+
+void MprisService::setVolume(double volume)
+{
+    if (m_volume != volume) {
+        m_volume = volume;
+        queueChange("Volume", volume);
+    }
+}
+
+void MprisService::setRate(double rate)
+{
+    if (m_rate != rate) {
+        m_rate = rate;
+        queueChange("Rate", rate);
+    }
+}
+
+QString MprisService::playbackStatus() const
+{
+    switch (m_engine->playbackState()) {
+    case QMediaPlayer::PlayingState:
+        return "Playing";
+    case QMediaPlayer::PausedState:
+        return "Paused";
+    default:
+        return "Stopped";
+    }
+}
+
+QString MprisService::loopStatus() const
+{
+    switch (m_playlist->playMode()) {
+    case PlaySequencer::Loop:
+        return "Playlist";
+    case PlaySequencer::RepeatOne:
+        return "Track";
+    default:
+        return "None";
+    }
+}
+
+void MprisService::setLoopStatus(const QString &status)
+{
+    if (status == "Playlist") {
+        m_playlist->setPlayMode(PlaySequencer::Loop);
+    } else if (status == "Track") {
+        m_playlist->setPlayMode(PlaySequencer::RepeatOne);
+    } else if (status == "None") {
+        m_playlist->setPlayMode(PlaySequencer::Sequential);
+    }
+}
+
+bool MprisService::shuffle() const
+{
+    return m_playlist->playMode() == PlaySequencer::Random;
+}
+
+void MprisService::setShuffle(bool shuffle)
+{
+    if (shuffle) {
+        m_playlist->setPlayMode(PlaySequencer::Random);
+    } else if (m_playlist->playMode() == PlaySequencer::Random) {
+        m_playlist->setPlayMode(PlaySequencer::Sequential);
+    }
+}
+
+QVariantMap MprisService::metadata() const
+{
+    QVariantMap map;
+    int index = m_playlist->currentIndex();
+    if (index < 0) {
+        // 没有当前项时按规范只给出 NoTrack
+        map["mpris:trackid"] = QVariant::fromValue(trackId());
+        return map;
+    }
+
+    const MediaInfo info = m_playlist->mediaAt(index);
+    map["mpris:trackid"] = QVariant::fromValue(trackId());
+    qint64 duration = m_engine->duration() > 0 ? m_engine->duration() : info.duration;
+    if (duration > 0) {
+        map["mpris:length"] = duration * 1000;
+    }
+    map["xesam:title"] = info.displayName();
+    if (!info.artist.isEmpty()) {
+        map["xesam:artist"] = QStringList() << info.artist;
+    }
+    if (!info.album.isEmpty()) {
+        map["xesam:album"] = info.album;
+    }
+    map["xesam:url"] = QUrl::fromLocalFile(info.filePath).toString();
+    return map;
+}
+
+qint64 MprisService::position() const
+{
+    return m_engine->position() * 1000;
+}
+
+bool MprisService::canGoNext() const
+{
+    return m_playlist->nextIndex() >= 0;
+}
+
+bool MprisService::canGoPrevious() const
+{
+    return m_playlist->previousIndex() >= 0;
+}
+
+bool MprisService::canPlay() const
+{
+    return m_playlist->count() > 0;
+}
+
+bool MprisService::canSeek() const
+{
+    return !m_engine->source().isEmpty() && m_engine->duration() > 0;
+}
+
+void MprisService::playPause()
+{
+    if (m_engine->playbackState() == QMediaPlayer::PlayingState) {
+        emit pauseRequested();
+    } else {
+        emit playRequested();
+    }
+}
+
+void MprisService::seek(qint64 offset)
+{
+    if (!canSeek()) {
+        return;
+    }
+
+    // 按规范，跳过结尾等同于下一首
+    qint64 target = m_engine->position() + offset / 1000;
+    if (target >= m_engine->duration()) {
+        emit nextRequested();
+        return;
+    }
+    m_engine->setPosition(qMax<qint64>(0, target));
+}
+
+void MprisService::setPosition(const QDBusObjectPath &trackId, qint64 position)
+{
+    // 轨道已切换时忽略过期的请求
+    if (!canSeek() || trackId != this->trackId()) {
+        return;
+    }
+    position /= 1000;
+    if (position < 0 || position > m_engine->duration()) {
+        return;
+    }
+    m_engine->setPosition(position);
+}
+
+void MprisService::openUri(const QString &uri)
+{
+    QUrl url(uri);
+    if (!url.isLocalFile()) {
+        return;
+    }
+
+    QString filePath = url.toLocalFile();
+    m_playlist->addMedia(filePath);
+    int row = m_playlist->model()->indexOf(filePath);
+    if (row >= 0) {
+        m_playlist->setCurrentIndex(row);
+        emit playRequested();
+    }
+}
+
+void MprisService::onPlaybackStateChanged(QMediaPlayer::PlaybackState state)
+{
+    Q_UNUSED(state);
+    queueChange("PlaybackStatus", playbackStatus());
+    queueChange("CanSeek", canSeek());
+
+    // 暂停期间位置不变，恢复播放时重新开始推算
+    m_lastPosition = m_engine->position();
+    m_positionClock.restart();
+}
+
+void MprisService::onPositionChanged(qint64 position)
+{
+    // 播放中位置随时间推进；只有与推算值相差较大的变化才是跳转
+    // 缓冲或卡顿时状态仍是播放中，但位置不会推进
+    qint64 expected = m_lastPosition;
+    if (m_positionClock.isValid() && m_engine->playbackState() == QMediaPlayer::PlayingState &&
+        !isStalled(m_engine->mediaStatus())) {
+        expected += qRound64(m_positionClock.elapsed() * m_rate);
+    }
+    bool discontinuity = qAbs(position - expected) > kSeekTolerance;
+
+    m_lastPosition = position;
+    m_positionClock.restart();
+
+    if (discontinuity && !m_serviceName.isEmpty()) {
+        // 之前合并中的属性先发出，客户端读到的 Metadata 与跳转后的位置一致
+        flushChanges();
+        emit seeked(position * 1000);
+    }
+}
+
+void MprisService::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
+{
+    // 进入和离开缓冲时都以当前位置重新开始推算，卡顿的时长不会被当成跳转
+    if (isStalled(status) || status == QMediaPlayer::BufferedMedia) {
+        m_lastPosition = m_engine->position();
+        m_positionClock.restart();
+    }
+}
+
+void MprisService::onDurationChanged(qint64 duration)
+{
+    Q_UNUSED(duration);
+    queueChange("Metadata", metadata());
+    queueChange("CanSeek", canSeek());
+}
+
+void MprisService::onMediaSelected(int index)
+{
+    Q_UNUSED(index);
+    // 换曲不是跳转：以新曲目的开头作为推算起点
+    m_lastPosition = 0;
+    m_positionClock.restart();
+
+    queueChange("Metadata", metadata());
+    queueCapabilities();
+}
+
+void MprisService::onPlaylistChanged()
+{
+    queueCapabilities();
+}
+
+void MprisService::onPlayModeChanged()
+{
+    queueChange("LoopStatus", loopStatus());
+    queueChange("Shuffle", shuffle());
+    queueCapabilities();
+}
+
+void MprisService::queueCapabilities()
+{
+    queueChange("CanGoNext", canGoNext());
+    queueChange("CanGoPrevious", canGoPrevious());
+    queueChange("CanPlay", canPlay());
+    queueChange("CanPause", canPlay());
+}
+
+void MprisService::queueChange(const QString &property, const QVariant &value)
+{
+    if (m_serviceName.isEmpty()) {
+        return;
+    }
+
+    // 同一间隔内同一属性只保留最新值
+    m_pendingChanges.insert(property, value);
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void MprisService::flushChanges()
+{
+    m_flushTimer->stop();
+    if (m_pendingChanges.isEmpty() || m_serviceName.isEmpty()) {
+        return;
+    }
+
+    QDBusMessage signal = QDBusMessage::createSignal(kObjectPath, "org.freedesktop.DBus.Properties",
+                                                     "PropertiesChanged");
+    signal << kPlayerInterface << m_pendingChanges << QStringList();
+    m_connection.send(signal);
+    m_pendingChanges.clear();
+}
+
+QDBusObjectPath MprisService::trackId() const
+{
+    int index = m_playlist->currentIndex();
+    if (index < 0) {
+        return QDBusObjectPath("/org/mpris/MediaPlayer2/TrackList/NoTrack");
+    }
+
+    // 以播放列表项的 ID 作为轨道 ID，移动、重命名后不变
+    quint64 id = m_playlist->model()->store().at(index).id;
+    return QDBusObjectPath(QString("/org/mpris/MediaPlayer2/Track/%1").arg(id));
+}
+
+MprisRootAdaptor::MprisRootAdaptor(MprisService *service)
+    : QDBusAbstractAdaptor(service)
+    , m_service(service)
+{
+}
+
+QString MprisRootAdaptor::identity() const
+{
+    return QCoreApplication::applicationName();
+}
+
+QString MprisRootAdaptor::desktopEntry() const
+{
+    return "PlaylistManager";
+}
+
+QStringList MprisRootAdaptor::supportedUriSchemes() const
+{
+    return QStringList() << "file";
+}
+
+QStringList MprisRootAdaptor::supportedMimeTypes() const
+{
+    return QStringList() << "video/mp4" << "video/x-msvideo" << "video/x-matroska" << "video/quicktime"
+                         << "video/x-ms-wmv" << "video/x-flv" << "video/webm" << "video/3gpp" << "video/ogg"
+                         << "audio/mpeg" << "audio/x-wav" << "audio/flac" << "audio/ogg" << "audio/aac"
+                         << "audio/x-ms-wma" << "audio/mp4";
+}
+
+void MprisRootAdaptor::Raise()
+{
+    emit m_service->raiseRequested();
+}
+
+void MprisRootAdaptor::Quit()
+{
+    emit m_service->quitRequested();
+}
+
+MprisPlayerAdaptor::MprisPlayerAdaptor(MprisService *service)
+    : QDBusAbstractAdaptor(service)
+    , m_service(service)
+{
+    connect(m_service, &MprisService::seeked, this, &MprisPlayerAdaptor::Seeked);
+}
+
+void MprisPlayerAdaptor::setRate(double rate)
+{
+    // 按规范 0 等同于暂停；超出范围的值忽略
+    if (qFuzzyIsNull(rate)) {
+        emit m_service->pauseRequested();
+    } else if (rate >= kMinimumRate && rate <= kMaximumRate) {
+        emit m_service->rateRequested(rate);
+    }
+}
+
+void MprisPlayerAdaptor::setVolume(double volume)
+{
+    emit m_service->volumeRequested(qBound(0.0, volume, 1.0));
+}
+
+double MprisPlayerAdaptor::minimumRate() const
+{
+    return kMinimumRate;
+}
+
+double MprisPlayerAdaptor::maximumRate() const
+{
+    return kMaximumRate;
+}
+
+void MprisPlayerAdaptor::Next()
+{
+    emit m_service->nextRequested();
+}
+
+void MprisPlayerAdaptor::Previous()
+{
+    emit m_service->previousRequested();
+}
+
+void MprisPlayerAdaptor::Pause()
+{
+    emit m_service->pauseRequested();
+}
+
+void MprisPlayerAdaptor::PlayPause()
+{
+    m_service->playPause();
+}
+
+void MprisPlayerAdaptor::Stop()
+{
+    emit m_service->stopRequested();
+}
+
+void MprisPlayerAdaptor::Play()
+{
+    emit m_service->playRequested();
+}
+
+void MprisPlayerAdaptor::Seek(qlonglong Offset)
+{
+    m_service->seek(Offset);
+}
+
+void MprisPlayerAdaptor::SetPosition(const QDBusObjectPath &TrackId, qlonglong Position)
+{
+    m_service->setPosition(TrackId, Position);
+}
+
+void MprisPlayerAdaptor::OpenUri(const QString &Uri)
+{
+    m_service->openUri(Uri);
+}
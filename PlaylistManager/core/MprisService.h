@@ -0,0 +1,200 @@
+// MprisService.h
+#ifndef MPRISSERVICE_H
+#define MPRISSERVICE_H
+
+#include <QObject>
+#include <QDBusConnection>
+#include <QDBusAbstractAdaptor>
+#include <QDBusObjectPath>
+#include <QVariantMap>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include "PlaybackEngine.h"
+#include "PlaylistController.h"
+
+// MPRIS（org.mpris.MediaPlayer2）接口，Linux 桌面的媒体键和系统播放控件通过它
+// 控制播放器。
+//
+// 属性变化先合并，每个间隔最多发出一次 PropertiesChanged；按规范 Position 不在
+// PropertiesChanged 中发出（由客户端按需读取），因此播放中的位置通知不会占用总线。
+// Seeked 只在位置不连续时发出：两次位置通知之间的变化与按播放速率推算的值
+// 相差超过容差，才认为发生了跳转（无论跳转来自界面、控制接口还是 MPRIS）；
+// 缓冲和卡顿期间位置不推进，推算起点随之重置。
+//
+// 默认注册在会话总线上；测试时可以传入连接到私有 dbus-daemon 的连接，
+// 或在 dbus-run-session 下运行。
+class MprisService : public QObject
+{
+    Q_OBJECT
+
+public:
+    MprisService(PlaybackEngine *engine, PlaylistController *playlist, QObject *parent = nullptr);
+    ~MprisService();
+
+    bool registerOn(const QDBusConnection &connection = QDBusConnection::sessionBus(),
+                    QString *errorString = nullptr);
+    void unregister();
+    QString serviceName() const { return m_serviceName; }
+
+    // 音量和播放速率由界面控制，变化时通知这里
+    void setVolume(double volume);
+    void setRate(double rate);
+
+    // 供适配器读取和调用
+    QString playbackStatus() const;
+    QString loopStatus() const;
+    void setLoopStatus(const QString &status);
+    bool shuffle() const;
+    void setShuffle(bool shuffle);
+    QVariantMap metadata() const;
+    double volume() const { return m_volume; }
+    double rate() const { return m_rate; }
+    qint64 position() const;    // 微秒
+    bool canGoNext() const;
+    bool canGoPrevious() const;
+    bool canPlay() const;
+    bool canSeek() const;
+    void playPause();
+    void seek(qint64 offset);
+    void setPosition(const QDBusObjectPath &trackId, qint64 position);
+    void openUri(const QString &uri);
+
+signals:
+    void playRequested();
+    void pauseRequested();
+    void stopRequested();
+    void nextRequested();
+    void previousRequested();
+    void volumeRequested(double volume);
+    void rateRequested(double rate);
+    void raiseRequested();
+    void quitRequested();
+
+    // 由播放器适配器转发为 Seeked
+    void seeked(qint64 position);
+
+private slots:
+    void onPlaybackStateChanged(QMediaPlayer::PlaybackState state);
+    void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
+    void onPositionChanged(qint64 position);
+    void onDurationChanged(qint64 duration);
+    void onMediaSelected(int index);
+    void onPlaylistChanged();
+    void onPlayModeChanged();
+    void flushChanges();
+
+private:
+    PlaybackEngine *m_engine;
+    PlaylistController *m_playlist;
+    QDBusConnection m_connection;
+    QString m_serviceName;
+    QVariantMap m_pendingChanges;   // 等待合并发出的属性
+    QTimer *m_flushTimer;
+    double m_volume;
+    double m_rate;
+
+    // 跳转检测：上一次位置通知的位置和时间
+    qint64 m_lastPosition;
+    QElapsedTimer m_positionClock;
+
+    void queueChange(const QString &property, const QVariant &value);
+    void queueCapabilities();
+    QDBusObjectPath trackId() const;
+};
+
+// org.mpris.MediaPlayer2
+class MprisRootAdaptor : public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.mpris.MediaPlayer2")
+    Q_PROPERTY(bool CanQuit READ canQuit)
+    Q_PROPERTY(bool CanRaise READ canRaise)
+    Q_PROPERTY(bool HasTrackList READ hasTrackList)
+    Q_PROPERTY(QString Identity READ identity)
+    Q_PROPERTY(QString DesktopEntry READ desktopEntry)
+    Q_PROPERTY(QStringList SupportedUriSchemes READ supportedUriSchemes)
+    Q_PROPERTY(QStringList SupportedMimeTypes READ supportedMimeTypes)
+
+public:
+    explicit MprisRootAdaptor(MprisService *service);
+
+    bool canQuit() const { return true; }
+    bool canRaise() const { return true; }
+    bool hasTrackList() const { return false; }
+    QString identity() const;
+    QString desktopEntry() const;
+    QStringList supportedUriSchemes() const;
+    QStringList supportedMimeTypes() const;
+
+public slots:
+    void Raise();
+    void Quit();
+
+private:
+    MprisService *m_service;
+};
+
+// org.mpris.MediaPlayer2.Player
+class MprisPlayerAdaptor : public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.mpris.MediaPlayer2.Player")
+    Q_PROPERTY(QString PlaybackStatus READ playbackStatus)
+    Q_PROPERTY(QString LoopStatus READ loopStatus WRITE setLoopStatus)
+    Q_PROPERTY(double Rate READ rate WRITE setRate)
+    Q_PROPERTY(bool Shuffle READ shuffle WRITE setShuffle)
+    Q_PROPERTY(QVariantMap Metadata READ metadata)
+    Q_PROPERTY(double Volume READ volume WRITE setVolume)
+    Q_PROPERTY(qlonglong Position READ position)
+    Q_PROPERTY(double MinimumRate READ minimumRate)
+    Q_PROPERTY(double MaximumRate READ maximumRate)
+    Q_PROPERTY(bool CanGoNext READ canGoNext)
+    Q_PROPERTY(bool CanGoPrevious READ canGoPrevious)
+    Q_PROPERTY(bool CanPlay READ canPlay)
+    Q_PROPERTY(bool CanPause READ canPause)
+    Q_PROPERTY(bool CanSeek READ canSeek)
+    Q_PROPERTY(bool CanControl READ canControl)
+
+public:
+    explicit MprisPlayerAdaptor(MprisService *service);
+
+    QString playbackStatus() const { return m_service->playbackStatus(); }
+    QString loopStatus() const { return m_service->loopStatus(); }
+    void setLoopStatus(const QString &status) { m_service->setLoopStatus(status); }
+    double rate() const { return m_service->rate(); }
+    void setRate(double rate);
+    bool shuffle() const { return m_service->shuffle(); }
+    void setShuffle(bool shuffle) { m_service->setShuffle(shuffle); }
+    QVariantMap metadata() const { return m_service->metadata(); }
+    double volume() const { return m_service->volume(); }
+    void setVolume(double volume);
+    qlonglong position() const { return m_service->position(); }
+    double minimumRate() const;
+    double maximumRate() const;
+    bool canGoNext() const { return m_service->canGoNext(); }
+    bool canGoPrevious() const { return m_service->canGoPrevious(); }
+    bool canPlay() const { return m_service->canPlay(); }
+    bool canPause() const { return m_service->canPlay(); }
+    bool canSeek() const { return m_service->canSeek(); }
+    bool canControl() const { return true; }
+
+public slots:
+    void Next();
+    void Previous();
+    void Pause();
+    void PlayPause();
+    void Stop();
+    void Play();
+    void Seek(qlonglong Offset);
+    void SetPosition(const QDBusObjectPath &TrackId, qlonglong Position);
+    void OpenUri(const QString &Uri);
+
+signals:
+    void Seeked(qlonglong Position);
+
+private:
+    MprisService *m_service;
+};
+
+#endif // MPRISSERVICE_H
@@ -0,0 +1,135 @@
+// PlaySequencer.cpp
+#include "PlaySequencer.h"
+#include <algorithm>
+#include <random>
+
+PlaySequencer::PlaySequencer()
+    : m_mode(Sequential)
+    , m_randomIndex(-1)
+{
+}
+
+void PlaySequencer::setMode(PlayMode mode, int current, int count)
+{
+    m_mode = mode;
+    if (mode == Random) {
+        shuffle(current, count);
+    }
+}
+
+void PlaySequencer::reset(int current, int count)
+{
+    if (m_mode == Random) {
+        shuffle(current, count);
+    }
+}
+
+void PlaySequencer::setCurrent(int current)
+{
+    // 随机模式下同步在随机序列中的位置，否则 next() 总是返回同一项
+    if (m_mode == Random) {
+        int randomIndex = m_randomOrder.indexOf(current);
+        if (randomIndex >= 0) {
+            m_randomIndex = randomIndex;
+        }
+    }
+}
+
+void PlaySequencer::clear()
+{
+    m_randomOrder.clear();
+    m_randomIndex = -1;
+}
+
+int PlaySequencer::next(int current, int count) const
+{
+    if (count == 0) {
+        return -1;
+    }
+
+    switch (m_mode) {
+        case Sequential:
+            return (current + 1 < count) ? current + 1 : -1;
+
+        case Loop:
+            return (current + 1) % count;
+
+        case Random:
+            if (m_randomOrder.isEmpty()) {
+                return -1;
+            }
+            return m_randomOrder[(m_randomIndex + 1) % m_randomOrder.size()];
+
+        case RepeatOne:
+            break;
+    }
+
+    return -1;
+}
+
+int PlaySequencer::previous(int current, int count) const
+{
+    if (count == 0) {
+        return -1;
+    }
+
+    switch (m_mode) {
+    case Sequential:
+        return (current > 0) ? current - 1 : -1;
+
+    case Loop:
+        return (current - 1 + count) % count;
+
+    case Random:
+        if (m_randomOrder.isEmpty()) {
+            return -1;
+        }
+        return m_randomOrder[(m_randomIndex - 1 + m_randomOrder.size()) % m_randomOrder.size()];
+
+    case RepeatOne:
+        break;
+    }
+
+    return -1;
+}
+
+QList<int> PlaySequencer::upcoming(int current, int count, int limit) const
+{
+    QList<int> rows;
+    current = qMax(current, 0);
+    for (int k = 0; k < limit && k < count; ++k) {
+        int row;
+        if (m_mode == Random && !m_randomOrder.isEmpty()) {
+            row = m_randomOrder[(qMax(m_randomIndex, 0) + k) % m_randomOrder.size()];
+        } else if (m_mode == Loop) {
+            row = (current + k) % count;
+        } else if (current + k < count) {
+            row = current + k;
+        } else {
+            break;
+        }
+        if (row >= 0 && row < count) {
+            rows.append(row);
+        }
+    }
+    return rows;
+}
+
+void PlaySequencer::shuffle(int current, int count)
+{
+    m_randomOrder.clear();
+    m_randomOrder.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        m_randomOrder.append(i);
+    }
+
+    std::random_device rd;
+    std::mt19937 g(rd());
+    std::shuffle(m_randomOrder.begin(), m_randomOrder.end(), g);
+
+    // 找到当前播放项在随机序列中的位置
+    m_randomIndex = m_randomOrder.indexOf(current);
+    if (m_randomIndex == -1) {
+        m_randomIndex = 0;
+    }
+}
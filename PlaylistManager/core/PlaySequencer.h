@@ -0,0 +1,45 @@
+// PlaySequencer.h
+#ifndef PLAYSEQUENCER_H
+#define PLAYSEQUENCER_H
+
+#include <QList>
+
+// 播放顺序
+// 根据播放模式、当前行和列表长度决定上一项、下一项；随机模式下保存一份打乱的
+// 行号序列和当前在序列中的位置。只处理行号，不依赖模型或界面。
+class PlaySequencer
+{
+public:
+    enum PlayMode {
+        Sequential = 0,  // 顺序播放
+        Loop,           // 列表循环
+        Random,         // 随机播放
+        RepeatOne       // 单曲循环
+    };
+
+    PlaySequencer();
+
+    PlayMode mode() const { return m_mode; }
+    // 切换到随机模式时按 count 重新打乱
+    void setMode(PlayMode mode, int current, int count);
+
+    // 列表内容变化后行号可能失效，随机模式下重新打乱
+    void reset(int current, int count);
+    // 当前项变化时同步在随机序列中的位置
+    void setCurrent(int current);
+    void clear();
+
+    int next(int current, int count) const;
+    int previous(int current, int count) const;
+    // 从当前项开始接下来将要播放的至多 limit 项（包括当前项）
+    QList<int> upcoming(int current, int count, int limit) const;
+
+private:
+    PlayMode m_mode;
+    QList<int> m_randomOrder;  // 随机播放顺序
+    int m_randomIndex;
+
+    void shuffle(int current, int count);
+};
+
+#endif // PLAYSEQUENCER_H
@@ -0,0 +1,437 @@
+// PlaybackEngine.cpp
+#include "PlaybackEngine.h"
+
+namespace {
+const qint64 kPrepareLead = 20000;      // 淡出点前多久开始解码上一项（毫秒）
+const qint64 kPrepareMargin = 2000;     // 上一项从淡出点前这么多开始保留，容许位置误差
+}
+
+PlaybackEngine::PlaybackEngine(QObject *parent)
+    : QObject(parent)
+    , m_active(nullptr)
+    , m_standby(nullptr)
+    , m_videoSink(nullptr)
+    , m_playbackRate(1.0)
+    , m_volume(1.0f)
+    , m_muted(false)
+    , m_continuePlayback(false)
+    , m_crossfadeDuration(0)
+    , m_crossfadeArmed(false)
+    , m_mixer(new CrossfadeMixer(this))
+    , m_lastFrameAt(-1)
+    , m_transitionStart(-1)
+    , m_awaitingFirstOutput(false)
+    , m_transitionPreloaded(false)
+    , m_lastTransitionGap(-1)
+    , m_frameStatsEnabled(false)
+    , m_traceSerial(0)
+    , m_traceFirstOutput(false)
+    , m_traceSeek(false)
+{
+    m_active = createPlayer();
+    m_standby = createPlayer();
+    m_clock.start();
+
+    connect(m_mixer, &CrossfadeMixer::finished, this, &PlaybackEngine::finishCrossfade);
+}
+
+PlaybackEngine::~PlaybackEngine()
+{
+    m_standby->stop();
+    m_active->stop();
+}
+
+QMediaPlayer *PlaybackEngine::createPlayer()
+{
+    QMediaPlayer *player = new QMediaPlayer(this);
+    player->setAudioOutput(new QAudioOutput(player));
+    connectPlayer(player);
+    return player;
+}
+
+void PlaybackEngine::connectPlayer(QMediaPlayer *player)
+{
+    // 两个播放器的信号都经过这里，只有当前播放器的会转发出去
+    connect(player, &QMediaPlayer::playbackStateChanged, this, [this, player](QMediaPlayer::PlaybackState state) {
+        if (player == m_active) {
+            emit playbackStateChanged(state);
+        }
+    });
+    connect(player, &QMediaPlayer::mediaStatusChanged, this, [this, player](QMediaPlayer::MediaStatus status) {
+        onPlayerStatusChanged(player, status);
+    });
+    connect(player, &QMediaPlayer::positionChanged, this, [this, player](qint64 position) {
+        if (player != m_active) {
+            return;
+        }
+        // 纯音频没有视频帧，以播放位置开始前进作为第一次输出
+        if (position > 0 && !player->hasVideo()) {
+            if (m_awaitingFirstOutput) {
+                finishTransition(m_clock.elapsed());
+            }
+            traceOutput();
+        }
+        checkCrossfadePoint(position);
+        emit positionChanged(position);
+    });
+    connect(player, &QMediaPlayer::durationChanged, this, [this, player](qint64 duration) {
+        if (player == m_active) {
+            emit durationChanged(duration);
+        }
+    });
+    connect(player, &QMediaPlayer::errorOccurred, this, [this, player](QMediaPlayer::Error error, const QString &errorString) {
+        if (player == m_active) {
+            emit errorOccurred(error, errorString);
+        }
+        // 预加载失败不提示，轮到它时由当前播放器重新打开并报告错误
+    });
+}
+
+void PlaybackEngine::onPlayerStatusChanged(QMediaPlayer *player, QMediaPlayer::MediaStatus status)
+{
+    if (player != m_active) {
+        // 备用播放器打开后暂停在第一帧，解码器在切换前就已就绪
+        if (status == QMediaPlayer::LoadedMedia && player->playbackState() == QMediaPlayer::StoppedState) {
+            player->pause();
+        }
+        return;
+    }
+
+    PLAYER_TRACE_INSTANT("mediaStatus", "status", status);
+
+    if (status == QMediaPlayer::EndOfMedia) {
+        // 接收方通常会立即选择下一项并调用 setSource，先记下状态
+        m_continuePlayback = true;
+        m_transitionStart = (player->hasVideo() && m_lastFrameAt >= 0) ? m_lastFrameAt : m_clock.elapsed();
+    }
+
+    emit mediaStatusChanged(status);
+
+    if (isReady(status)) {
+        startPendingPreload();
+    }
+}
+
+void PlaybackEngine::setVideoSink(QVideoSink *sink)
+{
+    if (m_videoSink) {
+        disconnect(m_videoSink, &QVideoSink::videoFrameChanged,
+                   this, &PlaybackEngine::onVideoFrameChanged);
+        disconnect(m_frameStatsConnection);
+    }
+
+    m_videoSink = sink;
+    m_active->setVideoSink(sink);
+
+    if (m_videoSink) {
+        connect(m_videoSink, &QVideoSink::videoFrameChanged,
+                this, &PlaybackEngine::onVideoFrameChanged);
+
+        // 直接在送出帧的线程中记录，不经过GUI线程的事件队列，统计的是帧真正送达的时间
+        m_frameStatsConnection = connect(m_videoSink, &QVideoSink::videoFrameChanged, this,
+                                         [this](const QVideoFrame &frame) {
+            if (!m_frameStatsEnabled.load(std::memory_order_relaxed)) {
+                return;
+            }
+            FrameSample sample;
+            sample.arrivalNs = m_clock.nsecsElapsed();
+            sample.startTime = frame.startTime();
+            sample.frameRate = float(frame.surfaceFormat().streamFrameRate());
+            m_frameStats.push(sample);
+            m_frameStats.addCost(m_clock.nsecsElapsed() - sample.arrivalNs);
+        }, Qt::DirectConnection);
+    }
+}
+
+void PlaybackEngine::setFrameStatsEnabled(bool enabled)
+{
+    m_frameStatsEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void PlaybackEngine::setSource(const QUrl &source)
+{
+    PLAYER_TRACE_SCOPE("PlaybackEngine::setSource");
+    bool resume = m_continuePlayback;
+    bool crossfade = m_crossfadeArmed;
+    m_continuePlayback = false;
+    m_crossfadeArmed = false;
+
+    // 上一次淡出还没结束就又切换，直接结束它
+    if (m_mixer->isActive()) {
+        finishCrossfade();
+    }
+
+    bool swap = !source.isEmpty() && source == m_standby->source() && isReady(m_standby->mediaStatus());
+    crossfade = crossfade && swap && !m_standby->hasVideo() &&
+                m_mixer->isPrepared(m_active->source(), source) && m_mixer->canStart(m_active->position());
+    if (!crossfade) {
+        m_mixer->stop();  // 丢弃提前解码的数据
+    }
+
+    // 切换前就开始等待第一帧，交换视频输出时可能立即送出预加载的帧
+    if (m_transitionStart >= 0) {
+        if (source.isEmpty()) {
+            m_transitionStart = -1;
+        } else {
+            m_awaitingFirstOutput = true;
+            m_transitionPreloaded = swap;
+        }
+    }
+    m_lastFrameAt = -1;
+
+    if (swap) {
+        swapPlayers(crossfade);
+    } else {
+        if (source == m_standby->source() || source == m_pendingPreload) {
+            clearPreload();  // 预加载尚未完成，改由当前播放器打开
+        }
+        m_active->setSource(source);
+    }
+
+    if (resume && !source.isEmpty()) {
+        m_active->play();
+    }
+
+    if (!source.isEmpty()) {
+        if (m_traceFirstOutput) {
+            PLAYER_TRACE_ASYNC_END("firstOutput", m_traceSerial);
+        }
+        m_traceFirstOutput = true;
+        m_traceSeek = false;
+        PLAYER_TRACE_ASYNC_BEGIN("firstOutput", ++m_traceSerial);
+    }
+}
+
+void PlaybackEngine::setPosition(qint64 position)
+{
+    if (!m_traceSeek && !m_traceFirstOutput) {
+        m_traceSeek = true;
+        PLAYER_TRACE_ASYNC_BEGIN("seek", ++m_traceSerial);
+    }
+    // 淡入淡出中跳转：混音器输出的是新项目的开头，直接结束
+    if (m_mixer->isActive()) {
+        finishCrossfade();
+    }
+    m_active->setPosition(position);
+}
+
+void PlaybackEngine::traceOutput()
+{
+    if (m_traceFirstOutput) {
+        m_traceFirstOutput = false;
+        PLAYER_TRACE_ASYNC_END("firstOutput", m_traceSerial);
+    } else if (m_traceSeek) {
+        m_traceSeek = false;
+        PLAYER_TRACE_ASYNC_END("seek", m_traceSerial);
+    }
+}
+
+void PlaybackEngine::swapPlayers(bool crossfade)
+{
+    QMediaPlayer *previous = m_active;
+    qint64 previousPosition = previous->position();
+    m_active = m_standby;
+    m_standby = previous;
+
+    previous->setVideoSink(nullptr);
+    m_active->setPlaybackRate(m_playbackRate);
+    if (m_videoSink) {
+        m_active->setVideoSink(m_videoSink);
+    }
+
+    // 释放上一项的解码器，备用播放器等待下一次预加载
+    previous->stop();
+    previous->setSource(QUrl());
+
+    if (crossfade) {
+        // 上一项的结尾和新项目的开头由混音器输出，新项目的播放器静音，只提供位置
+        m_active->audioOutput()->setVolume(0.0f);
+        m_mixer->setVolume(m_muted ? 0.0f : m_volume);
+        m_mixer->start(previousPosition, m_crossfadeDuration);
+    }
+
+    // 新的当前播放器之前的状态没有转发过，补发一次
+    emit mediaStatusChanged(m_active->mediaStatus());
+    emit durationChanged(m_active->duration());
+    emit positionChanged(m_active->position());
+    emit playbackStateChanged(m_active->playbackState());
+}
+
+void PlaybackEngine::preload(const QUrl &source)
+{
+    if (source.isEmpty() || source == m_active->source()) {
+        clearPreload();
+        return;
+    }
+    if (source == m_pendingPreload || source == m_standby->source()) {
+        return;
+    }
+
+    clearPreload();
+    m_pendingPreload = source;
+    startPendingPreload();
+}
+
+void PlaybackEngine::clearPreload()
+{
+    m_pendingPreload.clear();
+    if (!m_standby->source().isEmpty()) {
+        m_standby->stop();
+        m_standby->setSource(QUrl());
+    }
+}
+
+bool PlaybackEngine::isPreloaded(const QUrl &source) const
+{
+    return !source.isEmpty() && source == m_standby->source() &&
+           isReady(m_standby->mediaStatus());
+}
+
+void PlaybackEngine::startPendingPreload()
+{
+    if (m_pendingPreload.isEmpty()) {
+        return;
+    }
+
+    // 当前项打开完成后再预加载，不与它争抢磁盘读取和解码器初始化
+    QMediaPlayer::MediaStatus status = m_active->mediaStatus();
+    if (status == QMediaPlayer::LoadingMedia || status == QMediaPlayer::StalledMedia) {
+        return;
+    }
+
+    QUrl source = m_pendingPreload;
+    m_pendingPreload.clear();
+    m_standby->setSource(source);
+}
+
+void PlaybackEngine::play()
+{
+    m_active->play();
+    m_mixer->resume();
+}
+
+void PlaybackEngine::pause()
+{
+    m_active->pause();
+    m_mixer->suspend();
+}
+
+void PlaybackEngine::stop()
+{
+    m_continuePlayback = false;
+    m_crossfadeArmed = false;
+    m_transitionStart = -1;
+    m_awaitingFirstOutput = false;
+    if (m_mixer->isActive()) {
+        finishCrossfade();
+    }
+    m_mixer->stop();
+    m_active->stop();
+}
+
+void PlaybackEngine::setPlaybackRate(qreal rate)
+{
+    m_playbackRate = rate;
+    // 混音器按原速输出，变速时结束淡入淡出
+    if (m_mixer->isActive() && rate != 1.0) {
+        finishCrossfade();
+    }
+    m_active->setPlaybackRate(rate);
+}
+
+void PlaybackEngine::setVolume(float volume)
+{
+    m_volume = volume;
+    if (m_mixer->isActive()) {
+        m_mixer->setVolume(m_muted ? 0.0f : volume);
+        m_standby->audioOutput()->setVolume(volume);
+        return;
+    }
+    m_active->audioOutput()->setVolume(volume);
+    m_standby->audioOutput()->setVolume(volume);
+}
+
+void PlaybackEngine::setMuted(bool muted)
+{
+    m_muted = muted;
+    m_mixer->setVolume(muted ? 0.0f : m_volume);
+    m_active->audioOutput()->setMuted(muted);
+    m_standby->audioOutput()->setMuted(muted);
+}
+
+void PlaybackEngine::setCrossfadeDuration(int msecs)
+{
+    m_crossfadeDuration = qMax(0, msecs);
+    if (m_crossfadeDuration == 0) {
+        m_crossfadeArmed = false;
+    }
+}
+
+void PlaybackEngine::checkCrossfadePoint(qint64 position)
+{
+    if (m_crossfadeDuration <= 0 || m_crossfadeArmed || m_mixer->isActive() || m_playbackRate != 1.0 ||
+        m_active->playbackState() != QMediaPlayer::PlayingState || m_active->hasVideo()) {
+        return;
+    }
+
+    // 曲目太短时淡入淡出会占去大半，仍按普通切换处理
+    qint64 duration = m_active->duration();
+    if (duration < 2 * m_crossfadeDuration) {
+        return;
+    }
+
+    // 下一项必须已经预加载好且没有视频
+    if (!isReady(m_standby->mediaStatus()) || m_standby->hasVideo()) {
+        return;
+    }
+
+    // 提前解码上一项的结尾和下一项的开头；解码没跟上时按普通切换处理
+    qint64 fadeStart = duration - m_crossfadeDuration;
+    if (fadeStart - position > kPrepareLead) {
+        return;
+    }
+    m_mixer->prepare(m_active->source(), fadeStart - kPrepareMargin, m_standby->source(), m_crossfadeDuration);
+    if (position < fadeStart || !m_mixer->canStart(position)) {
+        return;
+    }
+
+    m_crossfadeArmed = true;
+    m_continuePlayback = true;
+    emit crossfadeRequested();
+}
+
+void PlaybackEngine::finishCrossfade()
+{
+    m_mixer->stop();
+    m_active->audioOutput()->setVolume(m_volume);
+}
+
+void PlaybackEngine::onVideoFrameChanged(const QVideoFrame &frame)
+{
+    if (!frame.isValid()) {
+        return;
+    }
+
+    qint64 now = m_clock.elapsed();
+    if (m_awaitingFirstOutput) {
+        finishTransition(now);
+    }
+    m_lastFrameAt = now;
+    traceOutput();
+}
+
+void PlaybackEngine::finishTransition(qint64 now)
+{
+    m_awaitingFirstOutput = false;
+    m_lastTransitionGap = now - m_transitionStart;
+    m_transitionStart = -1;
+    PLAYER_TRACE_INSTANT(m_transitionPreloaded ? "transitionPreloaded" : "transitionCold", "gapMs",
+                         m_lastTransitionGap);
+    emit transitionMeasured(m_lastTransitionGap, m_transitionPreloaded);
+}
+
+bool PlaybackEngine::isReady(QMediaPlayer::MediaStatus status)
+{
+    return status == QMediaPlayer::LoadedMedia || status == QMediaPlayer::BufferingMedia ||
+           status == QMediaPlayer::BufferedMedia;
+}
@@ -0,0 +1,137 @@
+// PlaybackEngine.h
+#ifndef PLAYBACKENGINE_H
+#define PLAYBACKENGINE_H
+
+#include <QObject>
+#include <QMediaPlayer>
+#include <QAudioOutput>
+#include <QVideoSink>
+#include <QVideoFrame>
+#include <QElapsedTimer>
+#include <QUrl>
+#include <atomic>
+
+#include "CrossfadeMixer.h"
+#include "FrameStatsRing.h"
+#include "Tracer.h"
+
+// 双缓冲播放引擎
+// 两个 QMediaPlayer 轮流工作：当前播放器播放时，备用播放器提前打开下一项并
+// 暂停在第一帧（完成解封装和解码器初始化）。切换到预加载的项目时只交换两个
+// 播放器和视频输出，不必再等待打开文件。播放器的信号只转发当前播放器的。
+// 前后两项都是纯音频时可以交叉淡入淡出：当前项结束前由 CrossfadeMixer 提前解码
+// 两项的 PCM，切换后上一项的播放器停止，新项目的播放器静音播放（提供位置），
+// 听到的是混音器按采样混合后的输出，淡入淡出结束后恢复新项目的音量。
+class PlaybackEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PlaybackEngine(QObject *parent = nullptr);
+    ~PlaybackEngine();
+
+    // 视频输出到 sink（例如 QVideoWidget::videoSink()），可为空；不依赖任何窗口部件
+    void setVideoSink(QVideoSink *sink);
+
+    // 与预加载的项目相同时直接切换，否则由当前播放器打开；
+    // 上一项自然播放结束后切换的，新项目自动开始播放
+    void setSource(const QUrl &source);
+    QUrl source() const { return m_active->source(); }
+
+    // 在当前项打开完成后于备用播放器中预加载
+    void preload(const QUrl &source);
+    void clearPreload();
+    bool isPreloaded(const QUrl &source) const;
+
+    void play();
+    void pause();
+    void stop();
+
+    void setPosition(qint64 position);
+    qint64 position() const { return m_active->position(); }
+    qint64 duration() const { return m_active->duration(); }
+    bool hasVideo() const { return m_active->hasVideo(); }
+    QMediaPlayer::PlaybackState playbackState() const { return m_active->playbackState(); }
+    QMediaPlayer::MediaStatus mediaStatus() const { return m_active->mediaStatus(); }
+
+    void setPlaybackRate(qreal rate);
+    qreal playbackRate() const { return m_playbackRate; }
+    void setVolume(float volume);
+    void setMuted(bool muted);
+
+    // 淡入淡出时长（毫秒），0 表示关闭；只用于前后两项都是纯音频、正常速度播放的情况
+    void setCrossfadeDuration(int msecs);
+    int crossfadeDuration() const { return m_crossfadeDuration; }
+    bool isCrossfading() const { return m_mixer->isActive(); }
+
+    // 上一次自动切换时，上一项最后一帧到下一项第一帧的间隔（毫秒），-1 表示尚未测量
+    qint64 lastTransitionGap() const { return m_lastTransitionGap; }
+
+    float bufferProgress() const { return m_active->bufferProgress(); }
+
+    // 逐帧统计：开启后每一帧在送出线程中写入环形缓冲，由性能信息面板读取
+    void setFrameStatsEnabled(bool enabled);
+    FrameStatsRing *frameStats() { return &m_frameStats; }
+    // FrameSample::arrivalNs 所用的时钟
+    qint64 clockNsecs() const { return m_clock.nsecsElapsed(); }
+
+signals:
+    void playbackStateChanged(QMediaPlayer::PlaybackState state);
+    void mediaStatusChanged(QMediaPlayer::MediaStatus status);
+    void positionChanged(qint64 position);
+    void durationChanged(qint64 duration);
+    void errorOccurred(QMediaPlayer::Error error, const QString &errorString);
+    void transitionMeasured(qint64 gapMs, bool preloaded);
+    // 当前项即将结束、可以开始淡入淡出，接收方应选择下一项
+    void crossfadeRequested();
+
+private slots:
+    void onVideoFrameChanged(const QVideoFrame &frame);
+
+private:
+    QMediaPlayer *m_active;
+    QMediaPlayer *m_standby;
+    QVideoSink *m_videoSink;
+    QUrl m_pendingPreload;        // 等当前项打开后再交给备用播放器
+    qreal m_playbackRate;
+    float m_volume;
+    bool m_muted;
+    bool m_continuePlayback;      // 当前项播放结束，下一次 setSource 后继续播放
+
+    // 淡入淡出
+    int m_crossfadeDuration;
+    bool m_crossfadeArmed;        // 已请求切换，下一次切换到预加载项时淡入淡出
+    CrossfadeMixer *m_mixer;
+
+    // 切换间隔测量
+    QElapsedTimer m_clock;
+    qint64 m_lastFrameAt;
+    qint64 m_transitionStart;
+    bool m_awaitingFirstOutput;
+    bool m_transitionPreloaded;
+    qint64 m_lastTransitionGap;
+
+    // 逐帧统计
+    FrameStatsRing m_frameStats;
+    std::atomic<bool> m_frameStatsEnabled;
+    QMetaObject::Connection m_frameStatsConnection;
+
+    // 跟踪：打开到第一次输出、跳转到下一次输出，按序号配对
+    quint64 m_traceSerial;
+    bool m_traceFirstOutput;
+    bool m_traceSeek;
+
+    void traceOutput();
+
+    QMediaPlayer *createPlayer();
+    void connectPlayer(QMediaPlayer *player);
+    void onPlayerStatusChanged(QMediaPlayer *player, QMediaPlayer::MediaStatus status);
+    void startPendingPreload();
+    void swapPlayers(bool crossfade);
+    void checkCrossfadePoint(qint64 position);
+    void finishCrossfade();
+    void finishTransition(qint64 now);
+    static bool isReady(QMediaPlayer::MediaStatus status);
+};
+
+#endif // PLAYBACKENGINE_H
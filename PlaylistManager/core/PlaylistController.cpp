@@ -0,0 +1,694 @@
+// PlaylistController.cpp
+#include "PlaylistController.h"
+#include "PlaylistIO.h"
+#include "PlaylistFile.h"
+#include "Tracer.h"
+#include <QFileInfo>
+#include <QSettings>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <algorithm>
+#include <functional>
+
+namespace {
+const int kUpcomingValidation = 8;
+
+// 监视文件夹的目录快照，与播放列表快照放在一起
+QString libraryStateFileName()
+{
+    return QFileInfo(PlaylistFile::defaultFileName()).absolutePath() + "/library.state";
+}
+}
+
+PlaylistController::PlaylistController(QObject *parent)
+    : QObject(parent)
+    , m_model(new PlaylistModel(this))
+    , m_metadataExtractor(new MetadataExtractor(0, 1024, this))
+    , m_journal(new PlaylistJournal(this))
+    , m_fileValidator(new FileValidator(this))
+    , m_folderScanner(nullptr)
+    , m_libraryWatcher(nullptr)
+    , m_supportedFormats(supportedFormats())
+    , m_probeCursor(0)
+    , m_updateDepth(0)
+    , m_changePending(false)
+{
+    m_folderScanner = new FolderScanner(m_supportedFormats, this);
+    m_libraryWatcher = new LibraryWatcher(m_supportedFormats, 4096, this);
+
+    // 拖动排序后顺序变化
+    connect(m_model, &PlaylistModel::rowsMoved,
+            this, &PlaylistController::notifyPlaylistChanged);
+
+    // 后台元数据提取
+    connect(m_metadataExtractor, &MetadataExtractor::metadataReady,
+            this, &PlaylistController::onMetadataReady);
+    connect(m_metadataExtractor, &MetadataExtractor::capacityAvailable,
+            this, &PlaylistController::scheduleMetadataProbes);
+    connect(m_model, &PlaylistModel::rowsAboutToBeRemoved,
+            this, &PlaylistController::onRowsAboutToBeRemoved);
+    connect(m_model, &PlaylistModel::rowsMoved,
+            this, &PlaylistController::onModelReorganized);
+    connect(m_model, &PlaylistModel::modelReset,
+            this, &PlaylistController::onModelReorganized);
+
+    // 结构变化由模型信号写入操作日志（包括视图内拖动排序）
+    connect(m_model, &PlaylistModel::rowsInserted,
+            this, &PlaylistController::onRowsInserted);
+    connect(m_model, &PlaylistModel::rowsMoved,
+            this, &PlaylistController::onRowsMoved);
+    connect(m_journal, &PlaylistJournal::compactionNeeded,
+            this, &PlaylistController::compactJournal);
+
+    // 文件校验
+    connect(m_fileValidator, &FileValidator::validated,
+            this, &PlaylistController::onFilesValidated);
+
+    // 文件夹扫描
+    connect(m_folderScanner, &FolderScanner::filesFound,
+            this, &PlaylistController::onFilesScanned);
+    connect(m_folderScanner, &FolderScanner::progress,
+            this, &PlaylistController::folderScanProgress);
+    connect(m_folderScanner, &FolderScanner::finished,
+            this, &PlaylistController::folderScanFinished);
+    connect(m_libraryWatcher, &LibraryWatcher::changesDetected,
+            this, &PlaylistController::applyLibraryChanges);
+}
+
+QStringList PlaylistController::supportedFormats()
+{
+    return QStringList() << "mp4" << "avi" << "mkv" << "mov" << "wmv"
+                         << "flv" << "webm" << "m4v" << "3gp" << "ogv"
+                         << "mp3" << "wav" << "flac" << "ogg" << "aac"
+                         << "wma" << "m4a";
+}
+
+bool PlaylistController::isMediaFile(const QString &filePath) const
+{
+    QString extension = QFileInfo(filePath).suffix().toLower();
+    return m_supportedFormats.contains(extension);
+}
+
+void PlaylistController::addMedia(const QString &filePath)
+{
+    beginUpdate();
+    appendMedia(filePath);
+    endUpdate();
+}
+
+void PlaylistController::addMediaList(const QStringList &filePaths)
+{
+    PLAYER_TRACE_SCOPE_ARG("PlaylistController::addMediaList", "files", filePaths.size());
+    beginUpdate();
+
+    m_pendingMedia.reserve(m_pendingMedia.size() + filePaths.size());
+    for (const QString &path : filePaths) {
+        appendMedia(path);
+    }
+
+    endUpdate();
+}
+
+void PlaylistController::addFolders(const QStringList &folders)
+{
+    m_folderScanner->scan(folders);
+    for (const QString &folder : folders) {
+        m_libraryWatcher->addFolder(folder);
+    }
+}
+
+void PlaylistController::cancelFolderScan()
+{
+    m_folderScanner->cancel();
+}
+
+void PlaylistController::onFilesScanned(const QList<ScannedFile> &files)
+{
+    beginUpdate();
+
+    m_pendingMedia.reserve(m_pendingMedia.size() + files.size());
+    for (const ScannedFile &file : files) {
+        appendMedia(file.filePath, &file);
+    }
+
+    endUpdate();
+}
+
+void PlaylistController::applyLibraryChanges(const LibraryChanges &changes)
+{
+    PLAYER_TRACE_SCOPE("PlaylistController::applyLibraryChanges");
+    beginUpdate();
+
+    // 重命名/移动只更新路径，保留播放次数、收藏和已提取的元数据
+    for (const auto &rename : changes.renamed) {
+        int row = m_model->indexOf(rename.first);
+        if (row >= 0 && m_model->renameMedia(row, rename.second)) {
+            m_journal->recordRename(rename.first, rename.second);
+        }
+    }
+
+    removeMediaList(changes.removed);
+
+    bool stale = false;
+    for (const QString &path : changes.modified) {
+        int row = m_model->indexOf(path);
+        if (row >= 0 && m_model->mediaAt(row).metadataLoaded) {
+            m_model->invalidateMetadata(row);
+            m_probeCursor = qMin(m_probeCursor, row);
+            stale = true;
+        }
+    }
+
+    m_pendingMedia.reserve(m_pendingMedia.size() + changes.added.size());
+    for (const ScannedFile &file : changes.added) {
+        appendMedia(file.filePath, &file);
+    }
+
+    endUpdate();
+
+    if (stale) {
+        scheduleMetadataProbes();
+    }
+}
+
+void PlaylistController::beginUpdate()
+{
+    if (m_updateDepth++ == 0) {
+        emit batchStarted();
+    }
+}
+
+void PlaylistController::endUpdate()
+{
+    if (m_updateDepth == 0 || --m_updateDepth > 0) {
+        return;
+    }
+
+    flushPendingMedia();
+
+    emit batchFinished();
+    if (m_changePending) {
+        m_changePending = false;
+        notifyPlaylistChanged();
+    }
+}
+
+bool PlaylistController::appendMedia(const QString &filePath, const ScannedFile *scanned)
+{
+    // 检查是否已存在（哈希索引，O(1)），重复的项不必 stat
+    if (m_model->contains(filePath) || m_pendingPaths.contains(filePath)) {
+        return false;
+    }
+
+    MediaInfo mediaInfo;
+    mediaInfo.filePath = filePath;
+    if (scanned) {
+        // 扫描器已确认存在并按扩展名过滤过，不必再次 stat
+        mediaInfo.fileSize = scanned->fileSize;
+        mediaInfo.lastModified = scanned->lastModified;
+    } else {
+        if (!isMediaFile(filePath)) {
+            return false;
+        }
+        // 只 stat 一次：查元数据缓存用的大小和修改时间也取自这里
+        QFileInfo fileInfo(filePath);
+        if (!fileInfo.exists()) {
+            return false;
+        }
+        mediaInfo.fileSize = fileInfo.size();
+        mediaInfo.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    }
+    mediaInfo.title = QFileInfo(filePath).baseName();
+
+    // 先从文件名解析，完整元数据由后台线程池补全
+    extractMediaInfo(mediaInfo);
+
+    m_pendingMedia.append(mediaInfo);
+    m_pendingPaths.insert(filePath);
+    return true;
+}
+
+void PlaylistController::flushPendingMedia()
+{
+    if (m_pendingMedia.isEmpty()) {
+        return;
+    }
+    PLAYER_TRACE_SCOPE_ARG("PlaylistController::flushPendingMedia", "items", m_pendingMedia.size());
+
+    bool wasEmpty = m_model->rowCount() == 0;
+
+    // 整批只产生一次行插入
+    m_model->appendMedia(m_pendingMedia);
+    m_pendingMedia.clear();
+    m_pendingPaths.clear();
+    m_changePending = true;
+
+    scheduleMetadataProbes();
+
+    // 如果是第一批文件，设置为当前项
+    if (wasEmpty && m_model->rowCount() > 0 && currentIndex() < 0) {
+        setCurrentIndex(0);
+    }
+}
+
+void PlaylistController::notifyPlaylistChanged()
+{
+    // 批量更新期间只记录，endUpdate() 时统一通知一次
+    if (m_updateDepth > 0) {
+        m_changePending = true;
+        return;
+    }
+
+    // 列表变化后随机顺序中的行号可能失效
+    m_sequencer.reset(currentIndex(), m_model->rowCount());
+
+    emit playlistChanged();
+}
+
+void PlaylistController::removeRow(int row)
+{
+    PLAYER_TRACE_SCOPE("PlaylistController::removeRow");
+    if (row < 0 || row >= m_model->rowCount()) {
+        return;
+    }
+
+    bool removingCurrent = row == currentIndex();
+    m_model->removeRows(row, 1);
+
+    // 删除的是当前播放项时，选中原位置上的下一项
+    if (removingCurrent) {
+        int newIndex = qMin(row, m_model->rowCount() - 1);
+        m_model->setCurrentRow(newIndex);
+        emit mediaSelected(newIndex);
+    }
+
+    notifyPlaylistChanged();
+}
+
+void PlaylistController::removeMediaList(const QStringList &filePaths)
+{
+    PLAYER_TRACE_SCOPE_ARG("PlaylistController::removeMediaList", "files", filePaths.size());
+    QList<int> rows;
+    rows.reserve(filePaths.size());
+    for (const QString &path : filePaths) {
+        int row = m_model->indexOf(path);
+        if (row >= 0) {
+            rows.append(row);
+        }
+    }
+    if (rows.isEmpty()) {
+        return;
+    }
+
+    // 从后往前按连续区间删除，前面的行号不受影响
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    // 正在播放的文件被外部删除时不打断播放，只清除当前项
+    int i = 0;
+    while (i < rows.size()) {
+        int last = rows.at(i);
+        int first = last;
+        while (++i < rows.size() && rows.at(i) == first - 1) {
+            first = rows.at(i);
+        }
+        m_model->removeRows(first, last - first + 1);
+    }
+
+    notifyPlaylistChanged();
+}
+
+void PlaylistController::clear()
+{
+    PLAYER_TRACE_SCOPE_ARG("PlaylistController::clear", "items", m_model->rowCount());
+    m_model->clear();
+    m_journal->recordClear();
+    m_libraryWatcher->clear();
+    m_sequencer.clear();
+
+    notifyPlaylistChanged();
+    emit mediaSelected(-1);
+}
+
+void PlaylistController::moveItem(int from, int to)
+{
+    PLAYER_TRACE_SCOPE("PlaylistController::moveItem");
+    if (from < 0 || from >= m_model->rowCount() || to < 0 || to >= m_model->rowCount() || from == to) {
+        return;
+    }
+
+    // moveRows 的目标行是移动前"插入到其之前"的行号
+    m_model->moveRows(QModelIndex(), from, 1, QModelIndex(), to > from ? to + 1 : to);
+}
+
+void PlaylistController::toggleFavorite(int row)
+{
+    if (row >= 0 && row < m_model->rowCount()) {
+        const MediaInfo &info = m_model->mediaAt(row);
+        bool favorite = !info.isFavorite;
+        m_model->setFavorite(row, favorite);
+        m_journal->recordFavorite(info.filePath, favorite);
+    }
+}
+
+void PlaylistController::setCurrentIndex(int index)
+{
+    PLAYER_TRACE_SCOPE_ARG("PlaylistController::setCurrentIndex", "index", index);
+    if (index < -1 || index >= m_model->rowCount()) {
+        return;
+    }
+
+    // 高亮由模型根据当前项ID提供
+    m_model->setCurrentRow(index);
+
+    if (index >= 0) {
+        // 更新播放统计
+        m_model->incrementPlayCount(index);
+        const MediaInfo &info = m_model->mediaAt(index);
+        m_journal->recordPlayCount(info.filePath, info.playCount);
+
+        // 随机模式下同步在随机序列中的位置，否则 nextIndex() 总是返回同一项
+        m_sequencer.setCurrent(index);
+    }
+
+    prioritizeValidation();
+
+    emit mediaSelected(index);
+}
+
+MediaInfo PlaylistController::currentMedia() const
+{
+    return mediaAt(currentIndex());
+}
+
+MediaInfo PlaylistController::mediaAt(int index) const
+{
+    if (index >= 0 && index < m_model->rowCount()) {
+        return m_model->mediaAt(index);
+    }
+    return MediaInfo();
+}
+
+void PlaylistController::setPlayMode(PlaySequencer::PlayMode mode)
+{
+    if (m_sequencer.mode() != mode) {
+        m_sequencer.setMode(mode, currentIndex(), m_model->rowCount());
+        emit playModeChanged(mode);
+    }
+}
+
+int PlaylistController::nextIndex() const
+{
+    return m_sequencer.next(currentIndex(), m_model->rowCount());
+}
+
+int PlaylistController::previousIndex() const
+{
+    return m_sequencer.previous(currentIndex(), m_model->rowCount());
+}
+
+void PlaylistController::prioritizeValidation(const QList<int> &visibleRows)
+{
+    if (m_fileValidator->isIdle()) {
+        return;
+    }
+
+    const int count = m_model->rowCount();
+    QList<quint64> ids;
+
+    // 当前项和接下来将要播放的项，然后是视图中可见的行
+    const QList<int> upcoming = m_sequencer.upcoming(qMax(currentIndex(), 0), count, kUpcomingValidation);
+    for (int row : upcoming) {
+        ids.append(m_model->mediaAt(row).id);
+    }
+    for (int row : visibleRows) {
+        if (row >= 0 && row < count) {
+            ids.append(m_model->mediaAt(row).id);
+        }
+    }
+
+    m_fileValidator->prioritize(ids);
+}
+
+void PlaylistController::scheduleMetadataProbes()
+{
+    // 从游标处继续提交，直到队列满；满了等 capacityAvailable 再继续。
+    // 提交前先查缓存，文件大小和修改时间都没变的直接使用缓存结果。
+    QList<MediaMetadata> cached;
+    int lookups = 0;
+
+    while (m_probeCursor < m_model->rowCount()) {
+        const MediaInfo &info = m_model->mediaAt(m_probeCursor);
+        if (!info.metadataLoaded) {
+            // 添加时已取得文件状态的不再 stat（只有从旧播放列表载入的项没有）
+            qint64 fileSize = info.fileSize;
+            qint64 lastModified = info.lastModified;
+            if (fileSize < 0) {
+                QFileInfo fileInfo(info.filePath);
+                fileSize = fileInfo.size();
+                lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+            }
+
+            MediaMetadata metadata;
+            metadata.id = info.id;
+            ++lookups;
+            if (m_metadataCache.lookup(info.filePath, fileSize, lastModified, &metadata)) {
+                cached.append(metadata);
+            } else if (!m_metadataExtractor->enqueue(info.id, info.filePath)) {
+                break;
+            }
+        }
+        ++m_probeCursor;
+    }
+
+    // 放在循环外统一写入，applyMetadata 不会在遍历过程中改动行
+    if (!cached.isEmpty()) {
+        m_model->applyMetadata(cached);
+    }
+    if (lookups > 0) {
+        emit metadataCacheStatsChanged(m_metadataCache.hits(), m_metadataCache.misses());
+    }
+}
+
+void PlaylistController::onMetadataReady(const QList<MediaMetadata> &batch)
+{
+    PLAYER_TRACE_SCOPE_ARG("PlaylistController::onMetadataReady", "items", batch.size());
+    for (const MediaMetadata &metadata : batch) {
+        m_metadataCache.insert(metadata);
+    }
+    m_model->applyMetadata(batch);
+}
+
+void PlaylistController::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    // 取消已移除项的排队和进行中的探测，并记入操作日志
+    for (int row = first; row <= last; ++row) {
+        const MediaInfo &info = m_model->mediaAt(row);
+        m_metadataExtractor->cancel(info.id);
+        m_fileValidator->cancel(info.id);
+        m_journal->recordRemove(info.filePath);
+    }
+    m_probeCursor = qMin(m_probeCursor, first);
+}
+
+void PlaylistController::onModelReorganized()
+{
+    // 行号整体变化，从头重新扫描（已加载的项会被跳过）
+    if (m_model->rowCount() == 0) {
+        m_metadataExtractor->cancelAll();
+        m_fileValidator->cancelAll();
+    }
+    m_probeCursor = 0;
+    scheduleMetadataProbes();
+}
+
+void PlaylistController::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    for (int row = first; row <= last; ++row) {
+        m_journal->recordAdd(m_model->mediaAt(row));
+    }
+}
+
+void PlaylistController::onRowsMoved(const QModelIndex &parent, int start, int end,
+                                     const QModelIndex &destination, int row)
+{
+    Q_UNUSED(parent);
+    Q_UNUSED(destination);
+    m_journal->recordMove(start, end - start + 1, row);
+}
+
+void PlaylistController::compactJournal()
+{
+    m_journal->compact(m_model->store().items());
+}
+
+void PlaylistController::onFilesValidated(const QList<FileStatus> &results)
+{
+    bool stale = false;
+
+    for (const FileStatus &status : results) {
+        int row = m_model->store().indexOfId(status.id);
+        if (row < 0) {
+            continue;  // 校验期间已被移除
+        }
+
+        // 不存在的文件只做标记，不从列表中删除（可能是网络存储暂时不可用）
+        m_model->setMissing(row, !status.exists);
+
+        // 文件大小或修改时间变化，说明之前的元数据已过期
+        const MediaInfo &info = m_model->mediaAt(row);
+        if (status.exists && info.metadataLoaded && info.fileSize >= 0 &&
+            (info.fileSize != status.fileSize || info.lastModified != status.lastModified)) {
+            m_model->invalidateMetadata(row);
+            m_probeCursor = qMin(m_probeCursor, row);
+            stale = true;
+        }
+    }
+
+    if (stale) {
+        scheduleMetadataProbes();
+    }
+    if (m_fileValidator->isIdle()) {
+        emit validationFinished();
+    }
+}
+
+void PlaylistController::extractMediaInfo(MediaInfo &info)
+{
+    // 这里可以使用更复杂的媒体信息提取逻辑
+    // 简化实现：从文件名尝试解析信息
+    QString baseName = QFileInfo(info.filePath).baseName();
+
+    // 尝试解析 "艺术家 - 标题" 格式
+    if (baseName.contains(" - ")) {
+        QStringList parts = baseName.split(" - ");
+        if (parts.size() >= 2) {
+            info.artist = parts[0].trimmed();
+            info.title = parts[1].trimmed();
+        }
+    }
+
+    if (info.title.isEmpty()) {
+        info.title = baseName;
+    }
+}
+
+void PlaylistController::save()
+{
+    PLAYER_TRACE_SCOPE("PlaylistController::save");
+    // 列表的修改已逐条写入操作日志，这里只需提交尚未落盘的记录；
+    // QSettings 只保存少量状态
+    m_journal->flush();
+
+    QSettings settings;
+    settings.beginGroup("Playlist");
+
+    // 旧版本保存在设置中的 JSON 列表已迁移，不再保留
+    settings.remove("mediaList");
+    settings.setValue("currentIndex", currentIndex());
+    settings.setValue("playMode", static_cast<int>(m_sequencer.mode()));
+    settings.setValue("watchedFolders", m_libraryWatcher->folders());
+    if (!m_libraryWatcher->saveState(libraryStateFileName())) {
+        qWarning("Cannot save library watcher state");
+    }
+
+    settings.endGroup();
+}
+
+void PlaylistController::load()
+{
+    PLAYER_TRACE_SCOPE("PlaylistController::load");
+    QSettings settings;
+    settings.beginGroup("Playlist");
+
+    // 快照 + 回放操作日志
+    QList<MediaInfo> stored;
+    bool found = m_journal->load(&stored);
+    bool migrated = false;
+    if (!found) {
+        // 旧版本把整个列表以 JSON 保存在设置中，首次启动时迁移
+        QByteArray data = settings.value("mediaList").toByteArray();
+        if (!data.isEmpty()) {
+            found = true;
+            migrated = true;
+            stored = PlaylistIO::mediaListFromJson(QJsonDocument::fromJson(data).array());
+        }
+    }
+
+    if (found) {
+        // 直接显示保存的数据，文件是否存在由后台校验后再标记
+        m_model->resetMedia(stored);
+        if (migrated) {
+            compactJournal();
+        }
+
+        for (const MediaInfo &info : m_model->store()) {
+            m_fileValidator->enqueue(info.id, info.filePath);
+        }
+
+        int savedIndex = settings.value("currentIndex", -1).toInt();
+        if (savedIndex >= m_model->rowCount()) {
+            savedIndex = -1;
+        }
+
+        auto mode = static_cast<PlaySequencer::PlayMode>(settings.value("playMode", 0).toInt());
+        setPlayMode(mode);
+
+        if (savedIndex >= 0) {
+            setCurrentIndex(savedIndex);
+        }
+    }
+
+    // 恢复监视：与上次保存的目录快照比较，只同步程序关闭期间的增删和重命名，
+    // 用户移除过的文件不会回来。没有快照时（首次升级）已有文件作为新增报告
+    const QStringList watchedFolders = settings.value("watchedFolders").toStringList();
+    m_libraryWatcher->restoreState(libraryStateFileName());
+    for (const QString &folder : watchedFolders) {
+        m_libraryWatcher->addFolder(folder, true);
+    }
+
+    settings.endGroup();
+    scheduleMetadataProbes();
+}
+
+bool PlaylistController::exportPlaylist(const QString &fileName, const QString &format, QString *errorString)
+{
+    return PlaylistIO::exportPlaylist(fileName, format, m_model->store().items(), errorString);
+}
+
+int PlaylistController::importPlaylist(const QString &fileName, QString *errorString)
+{
+    QList<MediaInfo> items;
+    bool detailed = false;
+    if (!PlaylistIO::importPlaylist(fileName, &items, &detailed, errorString)) {
+        return -1;
+    }
+
+    int imported = 0;
+    beginUpdate();
+    for (const MediaInfo &item : std::as_const(items)) {
+        if (!QFileInfo::exists(item.filePath) || !isMediaFile(item.filePath) ||
+            m_model->contains(item.filePath) || m_pendingPaths.contains(item.filePath)) {
+            continue;
+        }
+        // JSON 保留收藏、播放次数等信息，M3U/PLS 只有路径，按新文件加入
+        if (detailed) {
+            m_pendingPaths.insert(item.filePath);
+            m_pendingMedia.append(item);
+        } else {
+            appendMedia(item.filePath);
+        }
+        ++imported;
+    }
+    endUpdate();
+
+    return imported;
+}
@@ -0,0 +1,133 @@
+// PlaylistController.h
+#ifndef PLAYLISTCONTROLLER_H
+#define PLAYLISTCONTROLLER_H
+
+#include <QObject>
+#include <QList>
+#include <QSet>
+#include <QStringList>
+
+#include "MediaInfo.h"
+#include "PlaylistModel.h"
+#include "PlaySequencer.h"
+#include "MetadataExtractor.h"
+#include "MetadataCache.h"
+#include "PlaylistJournal.h"
+#include "FileValidator.h"
+#include "FolderScanner.h"
+#include "LibraryWatcher.h"
+
+// 播放列表的全部逻辑：内容与当前项、播放顺序、持久化、导入导出、后台元数据
+// 提取、文件校验和文件夹同步。不依赖任何窗口部件，PlaylistWidget 只是它的
+// 视图；批处理任务和基准测试可以直接使用。
+class PlaylistController : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PlaylistController(QObject *parent = nullptr);
+
+    PlaylistModel *model() const { return m_model; }
+    static QStringList supportedFormats();
+    bool isMediaFile(const QString &filePath) const;
+
+    // 播放列表操作
+    void addMedia(const QString &filePath);
+    void addMediaList(const QStringList &filePaths);
+    // 在后台递归扫描文件夹，结果分批加入列表；之后文件夹中的变化自动同步到列表
+    void addFolders(const QStringList &folders);
+    void cancelFolderScan();
+    bool isScanningFolders() const { return m_folderScanner->isScanning(); }
+    // 删除的是当前播放项时，选中原位置上的下一项
+    void removeRow(int row);
+    void removeMediaList(const QStringList &filePaths);
+    void clear();
+    void moveItem(int from, int to);
+    void toggleFavorite(int row);
+
+    // 批量更新：可嵌套，最外层 endUpdate() 时只发出一次 playlistChanged
+    void beginUpdate();
+    void endUpdate();
+
+    // 当前项
+    int currentIndex() const { return m_model->currentRow(); }
+    void setCurrentIndex(int index);
+    MediaInfo currentMedia() const;
+    MediaInfo mediaAt(int index) const;
+    int count() const { return m_model->rowCount(); }
+    const MetadataCache &metadataCache() const { return m_metadataCache; }
+
+    // 播放模式
+    PlaySequencer::PlayMode playMode() const { return m_sequencer.mode(); }
+    void setPlayMode(PlaySequencer::PlayMode mode);
+    int nextIndex() const;
+    int previousIndex() const;
+
+    // 文件校验优先检查当前项、接下来将要播放的项和 visibleRows
+    void prioritizeValidation(const QList<int> &visibleRows = QList<int>());
+
+    // 数据持久化
+    void save();
+    void load();
+    // 等待操作日志在后台写盘完成
+    void waitForPendingWrites() { m_journal->waitForDone(); }
+    bool exportPlaylist(const QString &fileName, const QString &format, QString *errorString = nullptr);
+    // 返回加入的条目数，文件无法读取时返回 -1
+    int importPlaylist(const QString &fileName, QString *errorString = nullptr);
+
+signals:
+    void mediaSelected(int index);
+    void playModeChanged(PlaySequencer::PlayMode mode);
+    void playlistChanged();
+    // 最外层批量更新的开始和结束，视图可以据此暂停重绘
+    void batchStarted();
+    void batchFinished();
+    void metadataCacheStatsChanged(int hits, int misses);
+    void folderScanProgress(int directories, int files);
+    void folderScanFinished(int files, bool cancelled);
+    // 加载后的后台文件校验全部完成
+    void validationFinished();
+
+private slots:
+    // 后台元数据提取
+    void scheduleMetadataProbes();
+    void onMetadataReady(const QList<MediaMetadata> &batch);
+    void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onModelReorganized();
+
+    // 操作日志
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsMoved(const QModelIndex &parent, int start, int end,
+                     const QModelIndex &destination, int row);
+    void compactJournal();
+
+    // 后台文件校验
+    void onFilesValidated(const QList<FileStatus> &results);
+
+    // 文件夹扫描
+    void onFilesScanned(const QList<ScannedFile> &files);
+    void applyLibraryChanges(const LibraryChanges &changes);
+
+private:
+    PlaylistModel *m_model;
+    PlaySequencer m_sequencer;
+    QList<MediaInfo> m_pendingMedia;  // 批量更新期间待插入的项
+    QSet<QString> m_pendingPaths;
+    MetadataExtractor *m_metadataExtractor;
+    MetadataCache m_metadataCache;    // 文件未变化时直接复用上次的探测结果
+    PlaylistJournal *m_journal;       // 每次修改追加一条记录，后台批量落盘
+    FileValidator *m_fileValidator;   // 加载后在后台检查文件是否存在、是否变化
+    FolderScanner *m_folderScanner;
+    LibraryWatcher *m_libraryWatcher; // 监视已导入的文件夹，增量同步增删和重命名
+    QStringList m_supportedFormats;
+    int m_probeCursor;                // 下一个待提交探测的行
+    int m_updateDepth;
+    bool m_changePending;
+
+    bool appendMedia(const QString &filePath, const ScannedFile *scanned = nullptr);
+    void flushPendingMedia();
+    void notifyPlaylistChanged();
+    static void extractMediaInfo(MediaInfo &info);
+};
+
+#endif // PLAYLISTCONTROLLER_H
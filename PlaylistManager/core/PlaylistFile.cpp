@@ -0,0 +1,294 @@
+// PlaylistFile.cpp
+#include "PlaylistFile.h"
+#include <QSaveFile>
+#include <QDir>
+#include <QHash>
+#include <QPair>
+#include <QStandardPaths>
+#include <QtEndian>
+
+namespace {
+const int kHeaderSize = 32;
+const int kRecordSize = 96;
+const int kMinRecordSize = 80;              // 第一版记录不含文件状态字段
+
+// 记录内字段偏移
+const int kPathField = 0;
+const int kTitleField = 8;
+const int kArtistField = 16;
+const int kAlbumField = 24;
+const int kCodecField = 32;
+const int kDurationField = 40;
+const int kAddTimeField = 48;
+const int kPlayCountField = 56;
+const int kWidthField = 60;
+const int kHeightField = 64;
+const int kBitRateField = 68;
+const int kFlagsField = 72;
+const int kFileSizeField = 80;
+const int kLastModifiedField = 88;
+
+const quint32 kFlagFavorite = 0x1;
+const quint32 kFlagMetadataLoaded = 0x2;
+
+// 字符串表构建器：相同字符串（艺术家、专辑、编码等）只写一次
+class StringTable
+{
+public:
+    void put(uchar *field, const QString &value)
+    {
+        quint32 offset = 0;
+        quint32 length = 0;
+        if (!value.isEmpty()) {
+            auto it = m_offsets.constFind(value);
+            if (it != m_offsets.constEnd()) {
+                offset = it->first;
+                length = it->second;
+            } else {
+                QByteArray utf8 = value.toUtf8();
+                offset = static_cast<quint32>(m_data.size());
+                length = static_cast<quint32>(utf8.size());
+                m_data.append(utf8);
+                m_offsets.insert(value, qMakePair(offset, length));
+            }
+        }
+        qToLittleEndian<quint32>(offset, field);
+        qToLittleEndian<quint32>(length, field + 4);
+    }
+
+    const QByteArray &data() const { return m_data; }
+
+private:
+    QByteArray m_data;
+    QHash<QString, QPair<quint32, quint32>> m_offsets;
+};
+}
+
+bool PlaylistFile::save(const QString &fileName, const QList<MediaInfo> &items,
+                        quint16 generation, QString *errorString)
+{
+    QByteArray records(items.size() * kRecordSize, '\0');
+    StringTable strings;
+
+    uchar *record = reinterpret_cast<uchar *>(records.data());
+    for (const MediaInfo &info : items) {
+        strings.put(record + kPathField, info.filePath);
+        strings.put(record + kTitleField, info.title);
+        strings.put(record + kArtistField, info.artist);
+        strings.put(record + kAlbumField, info.album);
+        strings.put(record + kCodecField, info.codec);
+
+        qToLittleEndian<qint64>(info.duration, record + kDurationField);
+        qToLittleEndian<qint64>(info.addTime.isValid() ? info.addTime.toMSecsSinceEpoch() : 0,
+                                record + kAddTimeField);
+        qToLittleEndian<qint32>(info.playCount, record + kPlayCountField);
+        qToLittleEndian<qint32>(info.width, record + kWidthField);
+        qToLittleEndian<qint32>(info.height, record + kHeightField);
+        qToLittleEndian<qint32>(info.bitRate, record + kBitRateField);
+
+        quint32 flags = 0;
+        if (info.isFavorite) flags |= kFlagFavorite;
+        if (info.metadataLoaded) flags |= kFlagMetadataLoaded;
+        qToLittleEndian<quint32>(flags, record + kFlagsField);
+        qToLittleEndian<qint64>(info.fileSize, record + kFileSizeField);
+        qToLittleEndian<qint64>(info.lastModified, record + kLastModifiedField);
+
+        record += kRecordSize;
+    }
+
+    uchar header[kHeaderSize] = {};
+    qToLittleEndian<quint32>(Magic, header);
+    qToLittleEndian<quint16>(Version, header + 4);
+    qToLittleEndian<quint16>(generation, header + 6);
+    qToLittleEndian<quint32>(static_cast<quint32>(items.size()), header + 8);
+    qToLittleEndian<quint32>(kRecordSize, header + 12);
+    qToLittleEndian<quint64>(kHeaderSize + records.size(), header + 16);
+    qToLittleEndian<quint64>(strings.data().size(), header + 24);
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorString) *errorString = file.errorString();
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(header), kHeaderSize);
+    file.write(records);
+    file.write(strings.data());
+
+    if (!file.commit()) {
+        if (errorString) *errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QList<MediaInfo> PlaylistFile::load(const QString &fileName, quint16 *generation, QString *errorString)
+{
+    QList<MediaInfo> items;
+
+    PlaylistFileReader reader;
+    if (!reader.open(fileName)) {
+        if (errorString) *errorString = reader.errorString();
+        return items;
+    }
+
+    if (generation) *generation = reader.generation();
+
+    items.reserve(reader.count());
+    for (int i = 0; i < reader.count(); ++i) {
+        items.append(reader.at(i));
+    }
+    return items;
+}
+
+QString PlaylistFile::defaultFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/playlist.vpl";
+}
+
+PlaylistFileReader::PlaylistFileReader()
+    : m_data(nullptr)
+    , m_base(nullptr)
+    , m_size(0)
+    , m_count(0)
+    , m_generation(0)
+    , m_recordSize(0)
+    , m_strings(nullptr)
+    , m_stringsSize(0)
+{
+}
+
+PlaylistFileReader::~PlaylistFileReader()
+{
+    close();
+}
+
+bool PlaylistFileReader::open(const QString &fileName)
+{
+    close();
+    m_errorString.clear();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return fail(m_file.errorString());
+    }
+
+    m_size = m_file.size();
+    if (m_size < kHeaderSize) {
+        return fail("文件过短");
+    }
+
+    m_data = m_file.map(0, m_size);
+    if (m_data) {
+        m_base = m_data;
+    } else {
+        m_buffer = m_file.readAll();
+        m_base = reinterpret_cast<const uchar *>(m_buffer.constData());
+        m_data = const_cast<uchar *>(m_base);
+    }
+
+    if (qFromLittleEndian<quint32>(m_base) != PlaylistFile::Magic) {
+        return fail("不是播放列表文件");
+    }
+    if (qFromLittleEndian<quint16>(m_base + 4) > PlaylistFile::Version) {
+        return fail("播放列表文件版本过新");
+    }
+
+    m_generation = qFromLittleEndian<quint16>(m_base + 6);
+    m_count = qFromLittleEndian<quint32>(m_base + 8);
+    m_recordSize = qFromLittleEndian<quint32>(m_base + 12);
+    quint64 stringsOffset = qFromLittleEndian<quint64>(m_base + 16);
+    m_stringsSize = qFromLittleEndian<quint64>(m_base + 24);
+
+    // 校验各区域都在文件范围内，之后按记录访问时无需再检查
+    quint64 recordsEnd = kHeaderSize + quint64(m_count) * m_recordSize;
+    if (m_recordSize < kMinRecordSize || recordsEnd > stringsOffset ||
+        stringsOffset > quint64(m_size) || m_stringsSize > quint64(m_size) - stringsOffset) {
+        return fail("播放列表文件已损坏");
+    }
+
+    m_strings = m_base + stringsOffset;
+    return true;
+}
+
+void PlaylistFileReader::close()
+{
+    if (m_data && m_buffer.isEmpty()) {
+        m_file.unmap(m_data);
+    }
+    m_file.close();
+    m_buffer.clear();
+    m_data = nullptr;
+    m_base = nullptr;
+    m_size = 0;
+    m_count = 0;
+    m_generation = 0;
+    m_recordSize = 0;
+    m_strings = nullptr;
+    m_stringsSize = 0;
+}
+
+MediaInfo PlaylistFileReader::at(int index) const
+{
+    MediaInfo info;
+    const uchar *rec = record(index);
+    if (!rec) {
+        return info;
+    }
+
+    info.filePath = stringAt(rec + kPathField);
+    info.title = stringAt(rec + kTitleField);
+    info.artist = stringAt(rec + kArtistField);
+    info.album = stringAt(rec + kAlbumField);
+    info.codec = stringAt(rec + kCodecField);
+
+    info.duration = qFromLittleEndian<qint64>(rec + kDurationField);
+    qint64 addTime = qFromLittleEndian<qint64>(rec + kAddTimeField);
+    info.addTime = addTime != 0 ? QDateTime::fromMSecsSinceEpoch(addTime) : QDateTime();
+    info.playCount = qFromLittleEndian<qint32>(rec + kPlayCountField);
+    info.width = qFromLittleEndian<qint32>(rec + kWidthField);
+    info.height = qFromLittleEndian<qint32>(rec + kHeightField);
+    info.bitRate = qFromLittleEndian<qint32>(rec + kBitRateField);
+
+    quint32 flags = qFromLittleEndian<quint32>(rec + kFlagsField);
+    info.isFavorite = flags & kFlagFavorite;
+    info.metadataLoaded = flags & kFlagMetadataLoaded;
+
+    if (m_recordSize >= kRecordSize) {
+        info.fileSize = qFromLittleEndian<qint64>(rec + kFileSizeField);
+        info.lastModified = qFromLittleEndian<qint64>(rec + kLastModifiedField);
+    }
+    return info;
+}
+
+QString PlaylistFileReader::filePathAt(int index) const
+{
+    const uchar *rec = record(index);
+    return rec ? stringAt(rec + kPathField) : QString();
+}
+
+const uchar *PlaylistFileReader::record(int index) const
+{
+    if (!m_base || index < 0 || quint32(index) >= m_count) {
+        return nullptr;
+    }
+    return m_base + kHeaderSize + quint64(index) * m_recordSize;
+}
+
+QString PlaylistFileReader::stringAt(const uchar *field) const
+{
+    quint32 offset = qFromLittleEndian<quint32>(field);
+    quint32 length = qFromLittleEndian<quint32>(field + 4);
+    if (length == 0 || quint64(offset) + length > m_stringsSize) {
+        return QString();
+    }
+    return QString::fromUtf8(reinterpret_cast<const char *>(m_strings + offset), length);
+}
+
+bool PlaylistFileReader::fail(const QString &message)
+{
+    close();
+    m_errorString = message;
+    return false;
+}
@@ -0,0 +1,73 @@
+// PlaylistFile.h
+#ifndef PLAYLISTFILE_H
+#define PLAYLISTFILE_H
+
+#include <QString>
+#include <QList>
+#include <QFile>
+
+#include "MediaInfo.h"
+
+// 二进制播放列表文件 (.vpl)
+//
+// 布局（小端）：
+//   文件头   32 字节：magic "VPPL"、版本、快照代数、记录数、记录长度、字符串表偏移和长度
+//   记录区   定长记录，字符串字段保存为 (偏移, 长度) 指向字符串表
+//   字符串表 UTF-8 字节，相同字符串只存一份
+//
+// 记录长度写在文件头中，新版本在记录末尾追加字段时旧版本仍可读取。
+class PlaylistFile
+{
+public:
+    static const quint32 Magic = 0x4C505056;   // "VPPL"
+    static const quint16 Version = 1;
+
+    // 写入临时文件后原子替换，写入失败时原文件保持不变
+    // generation 为快照代数，操作日志据此判断自己是否基于该快照
+    static bool save(const QString &fileName, const QList<MediaInfo> &items,
+                     quint16 generation = 0, QString *errorString = nullptr);
+    // 一次解码全部条目，供需要完整列表的播放列表模型使用；
+    // 只访问部分条目时用 PlaylistFileReader 映射后按需解码
+    static QList<MediaInfo> load(const QString &fileName, quint16 *generation = nullptr,
+                                 QString *errorString = nullptr);
+
+    // AppDataLocation/playlist.vpl
+    static QString defaultFileName();
+};
+
+// 映射文件后按需解码记录，打开时不解析任何条目
+class PlaylistFileReader
+{
+public:
+    PlaylistFileReader();
+    ~PlaylistFileReader();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    QString errorString() const { return m_errorString; }
+
+    int count() const { return static_cast<int>(m_count); }
+    quint16 generation() const { return m_generation; }
+    MediaInfo at(int index) const;
+    QString filePathAt(int index) const;
+
+private:
+    QFile m_file;
+    uchar *m_data;
+    QByteArray m_buffer;       // 无法映射时退回到整体读取
+    const uchar *m_base;
+    qint64 m_size;
+    quint32 m_count;
+    quint16 m_generation;
+    quint32 m_recordSize;
+    const uchar *m_strings;
+    quint64 m_stringsSize;
+    QString m_errorString;
+
+    const uchar *record(int index) const;
+    QString stringAt(const uchar *field) const;
+    bool fail(const QString &message);
+};
+
+#endif // PLAYLISTFILE_H
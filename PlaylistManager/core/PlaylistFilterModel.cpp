@@ -0,0 +1,133 @@
+// PlaylistFilterModel.cpp
+#include "PlaylistFilterModel.h"
+
+PlaylistFilterModel::PlaylistFilterModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+    , m_playlistModel(nullptr)
+    , m_favoritesOnly(false)
+{
+}
+
+void PlaylistFilterModel::setPlaylistModel(PlaylistModel *model)
+{
+    if (m_playlistModel) {
+        disconnect(m_playlistModel, nullptr, this, nullptr);
+    }
+
+    m_playlistModel = model;
+
+    // 必须在 setSourceModel 之前连接：同一信号按连接顺序调用，
+    // 保证代理重新过滤新行时索引已经更新
+    if (m_playlistModel) {
+        connect(m_playlistModel, &PlaylistModel::rowsInserted,
+                this, &PlaylistFilterModel::onRowsInserted);
+        connect(m_playlistModel, &PlaylistModel::rowsAboutToBeRemoved,
+                this, &PlaylistFilterModel::onRowsAboutToBeRemoved);
+        connect(m_playlistModel, &PlaylistModel::dataChanged,
+                this, &PlaylistFilterModel::onDataChanged);
+        connect(m_playlistModel, &PlaylistModel::modelReset,
+                this, &PlaylistFilterModel::onModelReset);
+    }
+
+    onModelReset();
+    setSourceModel(m_playlistModel);
+}
+
+void PlaylistFilterModel::setSearchKeyword(const QString &keyword)
+{
+    QString oldQuery = m_searchIndex.currentQuery();
+    m_searchIndex.search(keyword);
+    if (m_searchIndex.currentQuery() != oldQuery) {
+        invalidateFilter();
+    }
+}
+
+void PlaylistFilterModel::setFavoritesOnly(bool favoritesOnly)
+{
+    if (m_favoritesOnly != favoritesOnly) {
+        m_favoritesOnly = favoritesOnly;
+        invalidateFilter();
+    }
+}
+
+bool PlaylistFilterModel::isFiltering() const
+{
+    return m_favoritesOnly || !m_searchIndex.currentQuery().isEmpty();
+}
+
+bool PlaylistFilterModel::moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
+                                   const QModelIndex &destinationParent, int destinationChild)
+{
+    // 视图中的拖动排序：把代理行号换算成源模型行号后转发
+    if (!m_playlistModel || sourceParent.isValid() || destinationParent.isValid() ||
+        count != 1 || sourceRow < 0 || sourceRow >= rowCount() ||
+        destinationChild < 0 || destinationChild > rowCount()) {
+        return false;
+    }
+
+    int from = mapToSource(index(sourceRow, 0)).row();
+    int to = destinationChild < rowCount()
+                 ? mapToSource(index(destinationChild, 0)).row()
+                 : mapToSource(index(rowCount() - 1, 0)).row() + 1;
+
+    return m_playlistModel->moveRows(QModelIndex(), from, 1, QModelIndex(), to);
+}
+
+bool PlaylistFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (sourceParent.isValid() || !m_playlistModel || sourceRow >= m_playlistModel->rowCount()) {
+        return false;
+    }
+
+    const MediaInfo &info = m_playlistModel->mediaAt(sourceRow);
+    if (m_favoritesOnly && !info.isFavorite) {
+        return false;
+    }
+
+    return m_searchIndex.matches(info);
+}
+
+void PlaylistFilterModel::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    for (int row = first; row <= last; ++row) {
+        m_searchIndex.addItem(m_playlistModel->mediaAt(row));
+    }
+}
+
+void PlaylistFilterModel::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    for (int row = first; row <= last; ++row) {
+        m_searchIndex.removeItem(m_playlistModel->mediaAt(row).id);
+    }
+}
+
+void PlaylistFilterModel::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        m_searchIndex.updateItem(m_playlistModel->mediaAt(row));
+    }
+}
+
+void PlaylistFilterModel::onModelReset()
+{
+    QString query = m_searchIndex.currentQuery();
+
+    m_searchIndex.clear();
+    m_searchIndex.search(QString());
+
+    if (m_playlistModel) {
+        for (int row = 0; row < m_playlistModel->rowCount(); ++row) {
+            m_searchIndex.addItem(m_playlistModel->mediaAt(row));
+        }
+    }
+
+    m_searchIndex.search(query);
+}
@@ -0,0 +1,45 @@
+// PlaylistFilterModel.h
+#ifndef PLAYLISTFILTERMODEL_H
+#define PLAYLISTFILTERMODEL_H
+
+#include <QSortFilterProxyModel>
+
+#include "PlaylistModel.h"
+#include "PlaylistSearchIndex.h"
+
+// 播放列表过滤模型
+// 在 PlaylistModel 之上按搜索关键字和"只看收藏"过滤，不复制任何数据。
+// 搜索索引随源模型的增删改同步维护。
+class PlaylistFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit PlaylistFilterModel(QObject *parent = nullptr);
+
+    void setPlaylistModel(PlaylistModel *model);
+    PlaylistModel *playlistModel() const { return m_playlistModel; }
+
+    void setSearchKeyword(const QString &keyword);
+    void setFavoritesOnly(bool favoritesOnly);
+    bool isFiltering() const;
+
+    bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
+                  const QModelIndex &destinationParent, int destinationChild) override;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private slots:
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void onModelReset();
+
+private:
+    PlaylistModel *m_playlistModel;
+    PlaylistSearchIndex m_searchIndex;
+    bool m_favoritesOnly;
+};
+
+#endif // PLAYLISTFILTERMODEL_H
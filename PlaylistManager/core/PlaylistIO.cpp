@@ -0,0 +1,131 @@
+// PlaylistIO.cpp
+#include "PlaylistIO.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+bool PlaylistIO::exportPlaylist(const QString &fileName, const QString &format,
+                                const QList<MediaInfo> &items, QString *errorString)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+
+    QTextStream out(&file);
+
+    if (format.toLower() == "m3u") {
+        out << "#EXTM3U" << Qt::endl;
+        for (const MediaInfo &info : items) {
+            out << QString("#EXTINF:%1,%2 - %3")
+            .arg(info.duration / 1000)
+                    .arg(info.artist.isEmpty() ? "Unknown" : info.artist)
+                    .arg(info.title.isEmpty() ? QFileInfo(info.filePath).baseName() : info.title)
+                << Qt::endl;
+            out << info.filePath << Qt::endl;
+        }
+    } else if (format.toLower() == "pls") {
+        out << "[playlist]" << Qt::endl;
+        for (int i = 0; i < items.size(); ++i) {
+            const MediaInfo &info = items.at(i);
+            out << QString("File%1=%2").arg(i + 1).arg(info.filePath) << Qt::endl;
+            out << QString("Title%1=%2").arg(i + 1).arg(info.displayName()) << Qt::endl;
+            out << QString("Length%1=%2").arg(i + 1).arg(info.duration / 1000) << Qt::endl;
+        }
+        out << QString("NumberOfEntries=%1").arg(items.size()) << Qt::endl;
+        out << "Version=2" << Qt::endl;
+    } else if (format.toLower() == "json") {
+        // 与旧版本兼容的 JSON 格式，保留收藏、播放次数等信息
+        QJsonArray jsonArray;
+        for (const MediaInfo &info : items) {
+            jsonArray.append(info.toJson());
+        }
+        out << QJsonDocument(jsonArray).toJson(QJsonDocument::Indented);
+    }
+
+    out.flush();
+    if (out.status() != QTextStream::Ok) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+bool PlaylistIO::importPlaylist(const QString &fileName, QList<MediaInfo> *items,
+                                bool *detailed, QString *errorString)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+
+    QFileInfo fileInfo(fileName);
+    QString extension = fileInfo.suffix().toLower();
+
+    if (extension == "json") {
+        *items = mediaListFromJson(QJsonDocument::fromJson(file.readAll()).array());
+        if (detailed) {
+            *detailed = true;
+        }
+        return true;
+    }
+
+    if (detailed) {
+        *detailed = false;
+    }
+
+    auto appendPath = [&](QString filePath) {
+        // 处理相对路径
+        if (QFileInfo(filePath).isRelative()) {
+            filePath = fileInfo.absoluteDir().absoluteFilePath(filePath);
+        }
+        MediaInfo info;
+        info.filePath = filePath;
+        items->append(info);
+    };
+
+    QTextStream in(&file);
+    if (extension == "m3u" || extension == "m3u8") {
+        while (!in.atEnd()) {
+            QString line = in.readLine().trimmed();
+            if (!line.startsWith("#") && !line.isEmpty()) {
+                appendPath(line);
+            }
+        }
+    } else if (extension == "pls") {
+        while (!in.atEnd()) {
+            QString line = in.readLine().trimmed();
+            if (line.startsWith("File")) {
+                QStringList parts = line.split("=", Qt::SkipEmptyParts);
+                if (parts.size() >= 2) {
+                    appendPath(parts[1]);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+QList<MediaInfo> PlaylistIO::mediaListFromJson(const QJsonArray &jsonArray)
+{
+    QList<MediaInfo> items;
+    items.reserve(jsonArray.size());
+    for (const QJsonValue &value : jsonArray) {
+        MediaInfo info = MediaInfo::fromJson(value.toObject());
+        if (!info.filePath.isEmpty()) {
+            items.append(info);
+        }
+    }
+    return items;
+}
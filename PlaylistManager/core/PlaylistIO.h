@@ -0,0 +1,29 @@
+// PlaylistIO.h
+#ifndef PLAYLISTIO_H
+#define PLAYLISTIO_H
+
+#include <QString>
+#include <QList>
+#include <QJsonArray>
+
+#include "MediaInfo.h"
+
+// 播放列表的导入导出（M3U、PLS、JSON）
+// 只负责文件格式：导出写入给定的条目，导入返回文件中列出的条目，
+// 是否存在、是否为媒体文件、是否重复由调用方判断。
+class PlaylistIO
+{
+public:
+    // format 为 m3u、pls 或 json
+    static bool exportPlaylist(const QString &fileName, const QString &format,
+                               const QList<MediaInfo> &items, QString *errorString = nullptr);
+
+    // 按扩展名识别格式。JSON 保留收藏、播放次数等全部字段（*detailed 为 true），
+    // M3U/PLS 只有文件路径，相对路径按播放列表文件所在目录解析
+    static bool importPlaylist(const QString &fileName, QList<MediaInfo> *items,
+                               bool *detailed = nullptr, QString *errorString = nullptr);
+
+    static QList<MediaInfo> mediaListFromJson(const QJsonArray &jsonArray);
+};
+
+#endif // PLAYLISTIO_H
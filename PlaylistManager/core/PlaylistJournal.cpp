@@ -0,0 +1,476 @@
+// PlaylistJournal.cpp
+#include "PlaylistJournal.h"
+#include "PlaylistFile.h"
+#include "PlaylistStore.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDataStream>
+#include <QStandardPaths>
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+const quint32 kMagic = 0x4C4A5056;          // "VPJL"
+const quint16 kVersion = 1;
+const int kHeaderSize = 8;
+const int kRecordHeaderSize = 6;            // 长度 + 校验和
+const int kFlushInterval = 500;             // 批量落盘间隔（毫秒）
+const int kFlushThreshold = 64 * 1024;
+const qint64 kCompactThreshold = 4 * 1024 * 1024;
+
+QByteArray journalHeader(quint16 generation)
+{
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out << kMagic << kVersion << generation;
+    return header;
+}
+
+void syncFile(QFile &file)
+{
+    file.flush();
+#ifdef Q_OS_WIN
+    _commit(file.handle());
+#else
+    ::fsync(file.handle());
+#endif
+}
+
+// 以下函数在写入线程中执行
+void appendToJournal(const QString &fileName, quint16 generation, const QByteArray &data)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadWrite)) {
+        qWarning() << "无法写入播放列表日志:" << file.errorString();
+        return;
+    }
+
+    // 快照已替换但日志没能重置时，日志头仍是旧代数，其中的记录已包含在快照里；
+    // 先重置再追加，否则新记录接在旧日志后面，加载时会随旧日志一起被忽略
+    if (file.size() > 0 && file.read(kHeaderSize) != journalHeader(generation)) {
+        file.resize(0);
+    }
+    if (file.size() == 0) {
+        file.write(journalHeader(generation));
+    }
+    file.seek(file.size());
+    file.write(data);
+    syncFile(file);
+}
+
+// 返回快照是否已写成；日志重置失败不影响结果，下次追加时会补上
+bool writeSnapshot(const QString &snapshotFileName, const QString &journalFileName,
+                   const QList<MediaInfo> &items, quint16 generation)
+{
+    QString errorString;
+    if (!PlaylistFile::save(snapshotFileName, items, generation, &errorString)) {
+        qWarning() << "保存播放列表快照失败:" << errorString;
+        return false;
+    }
+
+    // 快照已原子替换，此后旧日志即使残留也会因代数不一致被忽略
+    QFile file(journalFileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "无法重置播放列表日志:" << file.errorString();
+        return true;
+    }
+    file.write(journalHeader(generation));
+    syncFile(file);
+    return true;
+}
+
+void writeMediaInfo(QDataStream &out, const MediaInfo &info)
+{
+    out << info.filePath << info.title << info.artist << info.album
+        << info.duration << info.addTime << qint32(info.playCount) << info.isFavorite
+        << info.codec << qint32(info.width) << qint32(info.height) << qint32(info.bitRate)
+        << info.metadataLoaded << info.fileSize << info.lastModified;
+}
+
+void readMediaInfo(QDataStream &in, MediaInfo &info)
+{
+    qint32 playCount, width, height, bitRate;
+    in >> info.filePath >> info.title >> info.artist >> info.album
+       >> info.duration >> info.addTime >> playCount >> info.isFavorite
+       >> info.codec >> width >> height >> bitRate
+       >> info.metadataLoaded >> info.fileSize >> info.lastModified;
+    info.playCount = playCount;
+    info.width = width;
+    info.height = height;
+    info.bitRate = bitRate;
+}
+}
+
+PlaylistJournal::PlaylistJournal(QObject *parent)
+    : QObject(parent)
+    , m_generation(0)
+    , m_journalBytes(0)
+    , m_compactAt(kCompactThreshold)
+    , m_replayed(0)
+    , m_compactionRequested(false)
+    , m_compacting(false)
+    , m_snapshotResult(SnapshotPending)
+{
+    m_snapshotFileName = PlaylistFile::defaultFileName();
+    m_journalFileName = QFileInfo(m_snapshotFileName).absolutePath() + "/playlist.journal";
+    QDir().mkpath(QFileInfo(m_journalFileName).absolutePath());
+
+    m_writer.setMaxThreadCount(1);
+    m_writer.setExpiryTimeout(-1);
+
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(kFlushInterval);
+    connect(m_flushTimer, &QTimer::timeout, this, &PlaylistJournal::flush);
+}
+
+PlaylistJournal::~PlaylistJournal()
+{
+    flush();
+    waitForDone();
+}
+
+bool PlaylistJournal::load(QList<MediaInfo> *items)
+{
+    bool found = false;
+    m_replayed = 0;
+    m_generation = 0;
+    items->clear();
+
+    if (QFileInfo::exists(m_snapshotFileName)) {
+        QString errorString;
+        *items = PlaylistFile::load(m_snapshotFileName, &m_generation, &errorString);
+        if (!errorString.isEmpty()) {
+            qWarning() << "读取播放列表快照失败:" << errorString;
+        }
+        found = true;
+    }
+
+    QFile journal(m_journalFileName);
+    bool clean = true;
+    m_journalBytes = 0;
+    if (journal.open(QIODevice::ReadOnly)) {
+        m_journalBytes = journal.size();
+        if (m_journalBytes > kHeaderSize) {
+            QByteArray data;
+            uchar *mapped = journal.map(0, m_journalBytes);
+            if (mapped) {
+                data = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), m_journalBytes);
+            } else {
+                data = journal.readAll();
+            }
+
+            if (replay(data, items, &clean)) {
+                found = true;
+            }
+
+            if (mapped) {
+                journal.unmap(mapped);
+            }
+        }
+        journal.close();
+    }
+
+    // 日志已过期、末尾损坏或已经很长时合并成新快照，之后从干净的日志开始追加；
+    // 否则新记录直接接在原日志后面
+    if (!clean || m_journalBytes >= kCompactThreshold) {
+        compact(*items);
+    }
+
+    return found;
+}
+
+void PlaylistJournal::recordAdd(const MediaInfo &info)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint8(AddOp);
+    writeMediaInfo(out, info);
+    append(payload);
+}
+
+void PlaylistJournal::recordRemove(const QString &filePath)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint8(RemoveOp) << filePath;
+    append(payload);
+}
+
+void PlaylistJournal::recordMove(int from, int count, int to)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint8(MoveOp) << qint32(from) << qint32(count) << qint32(to);
+    append(payload);
+}
+
+void PlaylistJournal::recordFavorite(const QString &filePath, bool favorite)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint8(FavoriteOp) << filePath << favorite;
+    append(payload);
+}
+
+void PlaylistJournal::recordPlayCount(const QString &filePath, int playCount)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint8(PlayCountOp) << filePath << qint32(playCount);
+    append(payload);
+}
+
+void PlaylistJournal::recordRename(const QString &oldPath, const QString &newPath)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint8(RenameOp) << oldPath << newPath;
+    append(payload);
+}
+
+void PlaylistJournal::recordClear()
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint8(ClearOp);
+    append(payload);
+}
+
+void PlaylistJournal::compact(const QList<MediaInfo> &items)
+{
+    // 同一时刻只写一个快照
+    if (m_compacting) {
+        m_writer.waitForDone();
+        finishCompaction();
+    }
+    m_flushTimer->stop();
+
+    // 缓冲区中的修改已包含在 items 里，但要等快照写成后才能丢弃：
+    // 写入失败时它们仍需追加到旧日志。合并期间的新记录同样留在内存中，
+    // 等结果确定后再决定写入新日志还是旧日志
+    m_compactedBuffer.swap(m_buffer);
+    m_compacting = true;
+    m_snapshotResult.storeRelaxed(SnapshotPending);
+
+    quint16 generation = m_generation + 1;
+    QString snapshotFileName = m_snapshotFileName;
+    QString journalFileName = m_journalFileName;
+    QAtomicInt *result = &m_snapshotResult;
+    PlaylistJournal *journal = this;
+    m_writer.start([snapshotFileName, journalFileName, items, generation, result, journal]() {
+        bool written = writeSnapshot(snapshotFileName, journalFileName, items, generation);
+        result->storeRelease(written ? SnapshotWritten : SnapshotFailed);
+        QMetaObject::invokeMethod(journal, [journal]() {
+            journal->finishCompaction();
+        }, Qt::QueuedConnection);
+    });
+}
+
+void PlaylistJournal::finishCompaction()
+{
+    int result = m_snapshotResult.loadAcquire();
+    if (!m_compacting || result == SnapshotPending) {
+        return;
+    }
+    m_compacting = false;
+    m_compactionRequested = false;
+
+    if (result == SnapshotWritten) {
+        ++m_generation;
+        m_compactedBuffer.clear();
+        m_journalBytes = kHeaderSize + m_buffer.size();
+        m_compactAt = kCompactThreshold;
+    } else {
+        // 代数保持不变：合并前的记录和之后的新记录按原顺序接到旧日志后面，
+        // 日志再增长一个阈值后才重试，避免磁盘故障时每条操作都重写一次快照
+        m_buffer.prepend(m_compactedBuffer);
+        m_compactedBuffer.clear();
+        m_compactAt = m_journalBytes + kCompactThreshold;
+    }
+
+    if (!m_buffer.isEmpty()) {
+        flush();
+    }
+}
+
+void PlaylistJournal::flush()
+{
+    m_flushTimer->stop();
+    if (m_buffer.isEmpty() || m_compacting) {
+        return;
+    }
+
+    QByteArray data;
+    data.swap(m_buffer);
+
+    QString fileName = m_journalFileName;
+    quint16 generation = m_generation;
+    m_writer.start([fileName, generation, data]() {
+        appendToJournal(fileName, generation, data);
+    });
+}
+
+void PlaylistJournal::waitForDone()
+{
+    m_writer.waitForDone();
+
+    // 合并结束后缓冲的记录可能刚提交
+    if (m_compacting) {
+        finishCompaction();
+        m_writer.waitForDone();
+    }
+}
+
+void PlaylistJournal::append(const QByteArray &payload)
+{
+    QDataStream out(&m_buffer, QIODevice::WriteOnly | QIODevice::Append);
+    out << quint32(payload.size()) << qChecksum(payload);
+    out.writeRawData(payload.constData(), payload.size());
+    m_journalBytes += kRecordHeaderSize + payload.size();
+
+    if (m_buffer.size() >= kFlushThreshold) {
+        flush();
+    } else if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+
+    if (m_journalBytes >= m_compactAt && !m_compactionRequested) {
+        m_compactionRequested = true;
+        emit compactionNeeded();
+    }
+}
+
+bool PlaylistJournal::replay(const QByteArray &journal, QList<MediaInfo> *items, bool *clean)
+{
+    *clean = false;
+
+    QDataStream in(journal);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint16 generation = 0;
+    in >> magic >> version >> generation;
+    if (in.status() != QDataStream::Ok || magic != kMagic || version != kVersion) {
+        qWarning() << "播放列表日志格式无效，已忽略";
+        return false;
+    }
+    if (generation != m_generation) {
+        // 基于更早的快照，其中的操作已经包含在当前快照里
+        return false;
+    }
+
+    // 回放在带路径索引的存储上进行，按路径定位为 O(1)
+    PlaylistStore store;
+    store.reserve(items->size());
+    for (const MediaInfo &info : std::as_const(*items)) {
+        store.append(info);
+    }
+
+    QIODevice *device = in.device();
+    bool truncated = false;
+    while (!in.atEnd()) {
+        quint32 size = 0;
+        quint16 checksum = 0;
+        in >> size >> checksum;
+        if (in.status() != QDataStream::Ok || size > quint64(device->bytesAvailable())) {
+            truncated = true;  // 末尾记录写入时被中断
+            break;
+        }
+
+        QByteArray payload(size, Qt::Uninitialized);
+        if (in.readRawData(payload.data(), size) != int(size) || qChecksum(payload) != checksum) {
+            truncated = true;
+            break;
+        }
+
+        QDataStream op(payload);
+        op.setVersion(QDataStream::Qt_6_0);
+        quint8 type = 0;
+        op >> type;
+
+        switch (type) {
+        case AddOp: {
+            MediaInfo info;
+            readMediaInfo(op, info);
+            store.append(info);
+            break;
+        }
+        case RemoveOp: {
+            QString filePath;
+            op >> filePath;
+            store.remove(filePath);
+            break;
+        }
+        case MoveOp: {
+            qint32 from, count, to;
+            op >> from >> count >> to;
+            // 与 PlaylistModel::moveRows 的语义一致
+            if (count > 0 && from >= 0 && from + count <= store.size() && to >= 0 && to <= store.size() &&
+                (to < from || to > from + count)) {
+                if (to > from) {
+                    for (int i = 0; i < count; ++i) {
+                        store.move(from, to - 1);
+                    }
+                } else {
+                    for (int i = 0; i < count; ++i) {
+                        store.move(from + i, to + i);
+                    }
+                }
+            }
+            break;
+        }
+        case FavoriteOp: {
+            QString filePath;
+            bool favorite = false;
+            op >> filePath >> favorite;
+            int row = store.indexOf(filePath);
+            if (row >= 0) {
+                store.setFavorite(row, favorite);
+            }
+            break;
+        }
+        case PlayCountOp: {
+            QString filePath;
+            qint32 playCount = 0;
+            op >> filePath >> playCount;
+            int row = store.indexOf(filePath);
+            if (row >= 0) {
+                store.setPlayCount(row, playCount);
+            }
+            break;
+        }
+        case ClearOp:
+            store.clear();
+            break;
+        case RenameOp: {
+            QString oldPath, newPath;
+            op >> oldPath >> newPath;
+            store.rename(store.indexOf(oldPath), newPath);
+            break;
+        }
+        default:
+            break;
+        }
+
+        ++m_replayed;
+    }
+
+    *items = store.items();
+    *clean = !truncated;
+    return true;
+}
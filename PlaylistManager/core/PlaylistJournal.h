@@ -0,0 +1,92 @@
+// PlaylistJournal.h
+#ifndef PLAYLISTJOURNAL_H
+#define PLAYLISTJOURNAL_H
+
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+#include <QTimer>
+#include <QThreadPool>
+#include <QAtomicInt>
+
+#include "MediaInfo.h"
+
+// 播放列表持久化：快照 + 只追加的操作日志
+//
+// 每次修改只向日志追加一条记录，由后台单线程按批写入并 fsync，
+// 保存代价与修改量成正比。日志超过阈值时把当前列表写成新快照（PlaylistFile），
+// 并清空日志。日志头记录它所基于的快照代数，快照写完、日志尚未清空时
+// 崩溃，代数不一致的旧日志会被忽略而不会重复回放。快照写入失败时
+// 代数不变，合并期间的记录仍追加到旧日志，不会丢失。
+class PlaylistJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PlaylistJournal(QObject *parent = nullptr);
+    ~PlaylistJournal();
+
+    // 读取快照并回放日志；快照和日志都不存在时返回 false
+    bool load(QList<MediaInfo> *items);
+    int replayedCount() const { return m_replayed; }
+
+    // 记录操作（只写入内存缓冲区，稍后批量落盘）
+    void recordAdd(const MediaInfo &info);
+    void recordRemove(const QString &filePath);
+    void recordMove(int from, int count, int to);
+    void recordFavorite(const QString &filePath, bool favorite);
+    void recordPlayCount(const QString &filePath, int playCount);
+    void recordRename(const QString &oldPath, const QString &newPath);
+    void recordClear();
+
+    // 把当前列表写成新快照并清空日志（后台执行，items 隐式共享，复制代价很小）
+    void compact(const QList<MediaInfo> &items);
+    // 立即提交缓冲区中的记录
+    void flush();
+    // 等待所有后台写入完成
+    void waitForDone();
+
+    QString snapshotFileName() const { return m_snapshotFileName; }
+    QString journalFileName() const { return m_journalFileName; }
+
+signals:
+    // 日志已经足够长，调用方应尽快调用 compact()
+    void compactionNeeded();
+
+private:
+    enum Operation : quint8 {
+        AddOp = 1,
+        RemoveOp,
+        MoveOp,
+        FavoriteOp,
+        PlayCountOp,
+        ClearOp,
+        RenameOp
+    };
+
+    enum SnapshotResult {
+        SnapshotPending,
+        SnapshotWritten,
+        SnapshotFailed
+    };
+
+    QString m_snapshotFileName;
+    QString m_journalFileName;
+    quint16 m_generation;       // 已写成的快照代数
+    QByteArray m_buffer;        // 尚未提交的记录
+    QByteArray m_compactedBuffer;   // 合并开始时尚未提交的记录，快照写成后丢弃
+    qint64 m_journalBytes;      // 日志文件（含已提交未写完的部分）大小
+    qint64 m_compactAt;         // 日志达到该大小时请求合并
+    int m_replayed;
+    bool m_compactionRequested;
+    bool m_compacting;          // 快照正在写入，期间的记录暂不提交
+    QAtomicInt m_snapshotResult;
+    QTimer *m_flushTimer;
+    QThreadPool m_writer;       // 单线程，保证写入按提交顺序进行
+
+    void append(const QByteArray &payload);
+    void finishCompaction();
+    bool replay(const QByteArray &journal, QList<MediaInfo> *items, bool *clean);
+};
+
+#endif // PLAYLISTJOURNAL_H
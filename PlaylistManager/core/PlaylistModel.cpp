@@ -0,0 +1,257 @@
+// PlaylistModel.cpp
+#include "PlaylistModel.h"
+#include <QSet>
+#include <algorithm>
+
+PlaylistModel::PlaylistModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_currentId(0)
+{
+}
+
+int PlaylistModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_store.size();
+}
+
+QVariant PlaylistModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_store.size()) {
+        return QVariant();
+    }
+
+    const MediaInfo &info = m_store.at(index.row());
+    bool isCurrent = m_currentId != 0 && info.id == m_currentId;
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return info.displayName();
+    case Qt::ToolTipRole:
+        return info.missing ? QString("%1\n（文件不存在）").arg(info.filePath) : info.filePath;
+    case FilePathRole:
+        return info.filePath;
+    case ItemIdRole:
+        return QVariant::fromValue(info.id);
+    case FavoriteRole:
+        return info.isFavorite;
+    case IsCurrentRole:
+        return isCurrent;
+    case MissingRole:
+        return info.missing;
+    case HasVideoRole:
+        return info.metadataLoaded && info.width > 0;
+    case DurationRole:
+        return info.duration;
+    default:
+        break;
+    }
+
+    return QVariant();
+}
+
+Qt::ItemFlags PlaylistModel::flags(const QModelIndex &index) const
+{
+    // 只允许拖放到行之间（根节点），避免把一项"放到"另一项上
+    if (!index.isValid()) {
+        return Qt::ItemIsDropEnabled;
+    }
+    return QAbstractListModel::flags(index) | Qt::ItemIsDragEnabled;
+}
+
+Qt::DropActions PlaylistModel::supportedDropActions() const
+{
+    return Qt::MoveAction;
+}
+
+bool PlaylistModel::moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
+                             const QModelIndex &destinationParent, int destinationChild)
+{
+    if (sourceParent.isValid() || destinationParent.isValid() || count <= 0 ||
+        sourceRow < 0 || sourceRow + count > m_store.size() ||
+        destinationChild < 0 || destinationChild > m_store.size()) {
+        return false;
+    }
+
+    if (!beginMoveRows(QModelIndex(), sourceRow, sourceRow + count - 1,
+                       QModelIndex(), destinationChild)) {
+        return false;
+    }
+
+    if (destinationChild > sourceRow) {
+        for (int i = 0; i < count; ++i) {
+            m_store.move(sourceRow, destinationChild - 1);
+        }
+    } else {
+        for (int i = 0; i < count; ++i) {
+            m_store.move(sourceRow + i, destinationChild + i);
+        }
+    }
+
+    endMoveRows();
+    return true;
+}
+
+bool PlaylistModel::removeRows(int row, int count, const QModelIndex &parent)
+{
+    if (parent.isValid() || count <= 0 || row < 0 || row + count > m_store.size()) {
+        return false;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    for (int i = row + count - 1; i >= row; --i) {
+        if (m_store.at(i).id == m_currentId) {
+            m_currentId = 0;
+        }
+        m_store.removeAt(i);
+    }
+    endRemoveRows();
+    return true;
+}
+
+int PlaylistModel::appendMedia(const QList<MediaInfo> &items)
+{
+    // 先过滤重复项，保证插入通知的行数准确
+    QList<MediaInfo> accepted;
+    accepted.reserve(items.size());
+    QSet<QString> batchPaths;
+    for (const MediaInfo &info : items) {
+        if (m_store.contains(info.filePath) || batchPaths.contains(info.filePath)) {
+            continue;
+        }
+        batchPaths.insert(info.filePath);
+        accepted.append(info);
+    }
+
+    if (accepted.isEmpty()) {
+        return 0;
+    }
+
+    int first = m_store.size();
+    beginInsertRows(QModelIndex(), first, first + accepted.size() - 1);
+    m_store.reserve(first + accepted.size());
+    for (const MediaInfo &info : accepted) {
+        m_store.append(info);
+    }
+    endInsertRows();
+
+    return accepted.size();
+}
+
+void PlaylistModel::resetMedia(const QList<MediaInfo> &items)
+{
+    beginResetModel();
+    m_store.clear();
+    m_store.reserve(items.size());
+    for (const MediaInfo &info : items) {
+        m_store.append(info);
+    }
+    m_currentId = 0;
+    endResetModel();
+}
+
+void PlaylistModel::clear()
+{
+    beginResetModel();
+    m_store.clear();
+    m_currentId = 0;
+    endResetModel();
+}
+
+void PlaylistModel::setFavorite(int row, bool favorite)
+{
+    if (row < 0 || row >= m_store.size() || m_store.at(row).isFavorite == favorite) {
+        return;
+    }
+
+    m_store.setFavorite(row, favorite);
+    emitRowChanged(row);
+}
+
+void PlaylistModel::incrementPlayCount(int row)
+{
+    if (row >= 0 && row < m_store.size()) {
+        m_store.setPlayCount(row, m_store.at(row).playCount + 1);
+    }
+}
+
+void PlaylistModel::setMissing(int row, bool missing)
+{
+    if (row < 0 || row >= m_store.size() || m_store.at(row).missing == missing) {
+        return;
+    }
+
+    m_store.setMissing(row, missing);
+    emitRowChanged(row);
+}
+
+bool PlaylistModel::renameMedia(int row, const QString &newPath)
+{
+    if (!m_store.rename(row, newPath)) {
+        return false;
+    }
+
+    m_store.setMissing(row, false);
+    emitRowChanged(row);
+    return true;
+}
+
+void PlaylistModel::invalidateMetadata(int row)
+{
+    if (row >= 0 && row < m_store.size()) {
+        m_store.invalidateMetadata(row);
+    }
+}
+
+void PlaylistModel::applyMetadata(const QList<MediaMetadata> &batch)
+{
+    QList<int> rows;
+    rows.reserve(batch.size());
+
+    for (const MediaMetadata &metadata : batch) {
+        int row = m_store.indexOfId(metadata.id);
+        if (row < 0) {
+            continue;  // 已被移除
+        }
+
+        m_store.applyMetadata(row, metadata);
+        rows.append(row);
+    }
+
+    // 按连续区间通知，避免一个跨度很大的区间让视图和代理重新处理无关的行
+    std::sort(rows.begin(), rows.end());
+    int i = 0;
+    while (i < rows.size()) {
+        int j = i;
+        while (j + 1 < rows.size() && rows[j + 1] <= rows[j] + 1) {
+            ++j;
+        }
+        emit dataChanged(index(rows[i]), index(rows[j]));
+        i = j + 1;
+    }
+}
+
+int PlaylistModel::currentRow() const
+{
+    return m_currentId ? m_store.indexOfId(m_currentId) : -1;
+}
+
+void PlaylistModel::setCurrentRow(int row)
+{
+    int oldRow = currentRow();
+    if (oldRow == row) {
+        return;
+    }
+
+    m_currentId = (row >= 0 && row < m_store.size()) ? m_store.at(row).id : 0;
+
+    emitRowChanged(oldRow);
+    emitRowChanged(row);
+}
+
+void PlaylistModel::emitRowChanged(int row)
+{
+    if (row >= 0 && row < m_store.size()) {
+        QModelIndex modelIndex = index(row);
+        emit dataChanged(modelIndex, modelIndex);
+    }
+}
@@ -0,0 +1,71 @@
+// PlaylistModel.h
+#ifndef PLAYLISTMODEL_H
+#define PLAYLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+
+#include "PlaylistStore.h"
+
+// 播放列表模型
+// 唯一持有媒体数据（PlaylistStore），视图只按需读取可见行，
+// 不再为每一项额外分配 QListWidgetItem。
+class PlaylistModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        FilePathRole = Qt::UserRole + 1,
+        ItemIdRole,
+        FavoriteRole,
+        IsCurrentRole,
+        MissingRole,
+        HasVideoRole,       // 元数据已加载且有视频流
+        DurationRole
+    };
+
+    explicit PlaylistModel(QObject *parent = nullptr);
+
+    // QAbstractListModel 接口
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    Qt::DropActions supportedDropActions() const override;
+    bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
+                  const QModelIndex &destinationParent, int destinationChild) override;
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+
+    // 数据访问
+    const PlaylistStore &store() const { return m_store; }
+    const MediaInfo &mediaAt(int row) const { return m_store.at(row); }
+    bool contains(const QString &filePath) const { return m_store.contains(filePath); }
+    int indexOf(const QString &filePath) const { return m_store.indexOf(filePath); }
+
+    // 修改（每次调用只产生一次插入/重置通知）
+    int appendMedia(const QList<MediaInfo> &items);
+    void resetMedia(const QList<MediaInfo> &items);
+    void clear();
+    void setFavorite(int row, bool favorite);
+    void incrementPlayCount(int row);
+    void setMissing(int row, bool missing);
+    // 文件被移动或重命名，保留收藏、播放次数和元数据
+    bool renameMedia(int row, const QString &newPath);
+    // 文件已变化，清除已加载标记以便重新探测
+    void invalidateMetadata(int row);
+
+    // 批量写入后台提取的元数据，只发出一次 dataChanged
+    void applyMetadata(const QList<MediaMetadata> &batch);
+
+    // 当前播放项按ID跟踪，移动/删除其它行时保持不变
+    int currentRow() const;
+    void setCurrentRow(int row);
+
+private:
+    PlaylistStore m_store;
+    PlaylistStore::ItemId m_currentId;
+
+    void emitRowChanged(int row);
+};
+
+#endif // PLAYLISTMODEL_H
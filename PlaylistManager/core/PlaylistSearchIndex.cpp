@@ -0,0 +1,213 @@
+// PlaylistSearchIndex.cpp
+#include "PlaylistSearchIndex.h"
+#include <utility>
+
+PlaylistSearchIndex::PlaylistSearchIndex()
+{
+}
+
+void PlaylistSearchIndex::clear()
+{
+    m_texts.clear();
+    m_postedTexts.clear();
+    m_postings.clear();
+    m_results.clear();
+}
+
+void PlaylistSearchIndex::addItem(const MediaInfo &info)
+{
+    QString text = searchText(info);
+    if (!m_query.isEmpty() && text.contains(m_query)) {
+        m_results.insert(info.id);
+    }
+
+    m_texts.insert(info.id, text);
+    indexText(info.id, text);
+}
+
+void PlaylistSearchIndex::updateItem(const MediaInfo &info)
+{
+    auto it = m_texts.find(info.id);
+    if (it == m_texts.end()) {
+        addItem(info);
+        return;
+    }
+
+    QString text = searchText(info);
+    if (it.value() == text) {
+        return;
+    }
+
+    // 倒排表立即按新旧文本的差异更新，查询时不再建索引
+    it.value() = text;
+    indexText(info.id, text);
+
+    if (!m_query.isEmpty()) {
+        if (text.contains(m_query)) {
+            m_results.insert(info.id);
+        } else {
+            m_results.remove(info.id);
+        }
+    }
+}
+
+void PlaylistSearchIndex::removeItem(ItemId id)
+{
+    m_texts.remove(id);
+    m_results.remove(id);
+
+    auto it = m_postedTexts.find(id);
+    if (it != m_postedTexts.end()) {
+        unindexText(id, trigrams(it.value()));
+        m_postedTexts.erase(it);
+    }
+}
+
+const QSet<PlaylistSearchIndex::ItemId> &PlaylistSearchIndex::search(const QString &keyword)
+{
+    QString query = keyword.toLower();
+    if (query == m_query) {
+        return m_results;
+    }
+
+    if (!m_query.isEmpty() && query.contains(m_query)) {
+        // 继续输入：结果只会变少，直接从上次结果中剔除，不重建集合
+        for (auto it = m_results.begin(); it != m_results.end();) {
+            if (m_texts.value(*it).contains(query)) {
+                ++it;
+            } else {
+                it = m_results.erase(it);
+            }
+        }
+        m_query = query;
+        return m_results;
+    }
+
+    QSet<ItemId> results;
+
+    if (query.isEmpty()) {
+        // 无关键字，不过滤
+    } else if (query.size() >= 3) {
+        // 选出最短的倒排表作为候选集
+        const QSet<ItemId> *candidates = nullptr;
+        bool noMatch = false;
+        for (int i = 0; i + 3 <= query.size(); ++i) {
+            auto it = m_postings.constFind(trigramKey(query.constData() + i));
+            if (it == m_postings.constEnd()) {
+                noMatch = true;
+                break;
+            }
+            if (!candidates || it.value().size() < candidates->size()) {
+                candidates = &it.value();
+            }
+        }
+
+        if (!noMatch && candidates) {
+            for (ItemId id : *candidates) {
+                if (m_texts.value(id).contains(query)) {
+                    results.insert(id);
+                }
+            }
+        }
+    } else {
+        // 一两个字符无法使用三元组，直接扫描预先转好小写的文本
+        for (auto it = m_texts.constBegin(); it != m_texts.constEnd(); ++it) {
+            if (it.value().contains(query)) {
+                results.insert(it.key());
+            }
+        }
+    }
+
+    m_query = query;
+    m_results = results;
+    return m_results;
+}
+
+bool PlaylistSearchIndex::matches(const MediaInfo &info) const
+{
+    if (m_query.isEmpty() || m_results.contains(info.id)) {
+        return true;
+    }
+
+    // 已索引但不在结果中
+    if (m_texts.contains(info.id)) {
+        return false;
+    }
+
+    // 尚未进入索引的新行（例如模型刚插入），直接校验
+    return searchText(info).contains(m_query);
+}
+
+QString PlaylistSearchIndex::searchText(const MediaInfo &info)
+{
+    // 字段之间用换行分隔，避免跨字段误匹配
+    return QString("%1\n%2\n%3\n%4\n%5")
+        .arg(info.displayName(), info.title, info.artist, info.album, info.filePath)
+        .toLower();
+}
+
+quint64 PlaylistSearchIndex::trigramKey(const QChar *chars)
+{
+    return (quint64(chars[0].unicode()) << 32) |
+           (quint64(chars[1].unicode()) << 16) |
+           quint64(chars[2].unicode());
+}
+
+QSet<quint64> PlaylistSearchIndex::trigrams(const QString &text)
+{
+    QSet<quint64> result;
+    result.reserve(text.size());
+    for (int i = 0; i + 3 <= text.size(); ++i) {
+        result.insert(trigramKey(text.constData() + i));
+    }
+    return result;
+}
+
+qsizetype PlaylistSearchIndex::postingCount() const
+{
+    qsizetype count = 0;
+    for (auto it = m_postings.constBegin(); it != m_postings.constEnd(); ++it) {
+        count += it.value().size();
+    }
+    return count;
+}
+
+void PlaylistSearchIndex::indexText(ItemId id, const QString &text)
+{
+    // 只增删新旧文本之间不同的三元组；元数据补全通常只改动其中一部分。
+    // 写入时的文本与 m_texts 共享数据，不额外占用内存
+    QSet<quint64> added = trigrams(text);
+    auto posted = m_postedTexts.find(id);
+    if (posted != m_postedTexts.end()) {
+        QSet<quint64> removed = trigrams(posted.value());
+        for (auto it = removed.begin(); it != removed.end();) {
+            if (added.remove(*it)) {
+                it = removed.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        unindexText(id, removed);
+        posted.value() = text;
+    } else {
+        m_postedTexts.insert(id, text);
+    }
+
+    for (quint64 trigram : std::as_const(added)) {
+        m_postings[trigram].insert(id);
+    }
+}
+
+void PlaylistSearchIndex::unindexText(ItemId id, const QSet<quint64> &trigrams)
+{
+    for (quint64 trigram : trigrams) {
+        auto it = m_postings.find(trigram);
+        if (it == m_postings.end()) {
+            continue;
+        }
+        it.value().remove(id);
+        if (it.value().isEmpty()) {
+            m_postings.erase(it);
+        }
+    }
+}
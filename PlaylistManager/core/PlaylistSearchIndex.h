@@ -0,0 +1,55 @@
+// PlaylistSearchIndex.h
+#ifndef PLAYLISTSEARCHINDEX_H
+#define PLAYLISTSEARCHINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+#include "PlaylistStore.h"
+
+// 播放列表搜索索引
+// 对 标题/艺术家/专辑/路径 的小写文本建立三元组倒排索引，添加和更新时立即写入，
+// 按键时只查询，不补建索引。
+// 查询时先取最短的倒排表作为候选，再逐个做子串校验；
+// 若新关键字包含上一次的关键字（继续输入），只在上次结果中筛选。
+class PlaylistSearchIndex
+{
+public:
+    typedef PlaylistStore::ItemId ItemId;
+
+    PlaylistSearchIndex();
+
+    void clear();
+    void addItem(const MediaInfo &info);
+    void updateItem(const MediaInfo &info);
+    void removeItem(ItemId id);
+
+    // 执行查询并缓存结果，关键字为空时返回空集合
+    const QSet<ItemId> &search(const QString &keyword);
+
+    // 判断某一项是否匹配当前（最近一次）查询
+    bool matches(const MediaInfo &info) const;
+
+    const QString &currentQuery() const { return m_query; }
+
+    // 倒排表中的条目总数（诊断用）：每项的每个不同三元组计一次
+    qsizetype postingCount() const;
+
+private:
+    QHash<ItemId, QString> m_texts;           // ID -> 小写检索文本
+    QHash<ItemId, QString> m_postedTexts;     // ID -> 写入倒排表时的文本，更新时据此撤下旧三元组
+    QHash<quint64, QSet<ItemId>> m_postings;  // 三元组 -> ID 集合，只含现有项的当前文本
+
+    QString m_query;                          // 最近一次查询（小写）
+    QSet<ItemId> m_results;
+
+    static QString searchText(const MediaInfo &info);
+    static quint64 trigramKey(const QChar *chars);
+    static QSet<quint64> trigrams(const QString &text);
+    void indexText(ItemId id, const QString &text);
+    void unindexText(ItemId id, const QSet<quint64> &trigrams);
+};
+
+#endif // PLAYLISTSEARCHINDEX_H
@@ -0,0 +1,132 @@
+// PlaylistStore.cpp
+#include "PlaylistStore.h"
+
+PlaylistStore::PlaylistStore()
+    : m_validRows(0)
+    , m_nextId(1)
+{
+}
+
+void PlaylistStore::reserve(int size)
+{
+    m_items.reserve(size);
+    m_idByPath.reserve(size);
+    m_rowById.reserve(size);
+}
+
+int PlaylistStore::indexOf(const QString &filePath) const
+{
+    ItemId id = m_idByPath.value(filePath, 0);
+    return id ? indexOfId(id) : -1;
+}
+
+int PlaylistStore::indexOfId(ItemId id) const
+{
+    auto it = m_rowById.constFind(id);
+    if (it == m_rowById.constEnd()) {
+        return -1;
+    }
+
+    int row = it.value();
+    if (row < m_validRows) {
+        return row;
+    }
+
+    // 行号可能已过期，重建失效部分
+    rebuildRowIndex();
+    return m_rowById.value(id, -1);
+}
+
+PlaylistStore::ItemId PlaylistStore::append(MediaInfo info)
+{
+    if (m_idByPath.contains(info.filePath)) {
+        return 0;
+    }
+
+    info.id = m_nextId++;
+    int row = m_items.size();
+    m_idByPath.insert(info.filePath, info.id);
+    m_rowById.insert(info.id, row);
+    if (m_validRows == row) {
+        m_validRows = row + 1;
+    }
+    m_items.append(info);
+
+    return info.id;
+}
+
+void PlaylistStore::removeAt(int row)
+{
+    if (row < 0 || row >= m_items.size()) {
+        return;
+    }
+
+    const MediaInfo &info = m_items.at(row);
+    m_idByPath.remove(info.filePath);
+    m_rowById.remove(info.id);
+    m_items.removeAt(row);
+    invalidateRowsFrom(row);
+}
+
+bool PlaylistStore::remove(const QString &filePath)
+{
+    int row = indexOf(filePath);
+    if (row < 0) {
+        return false;
+    }
+    removeAt(row);
+    return true;
+}
+
+void PlaylistStore::move(int from, int to)
+{
+    if (from < 0 || from >= m_items.size() || to < 0 || to >= m_items.size() || from == to) {
+        return;
+    }
+
+    m_items.move(from, to);
+    invalidateRowsFrom(qMin(from, to));
+}
+
+bool PlaylistStore::rename(int row, const QString &newPath)
+{
+    if (row < 0 || row >= m_items.size() || m_idByPath.contains(newPath)) {
+        return false;
+    }
+
+    MediaInfo &info = m_items[row];
+    m_idByPath.remove(info.filePath);
+    m_idByPath.insert(newPath, info.id);
+    info.filePath = newPath;
+    return true;
+}
+
+void PlaylistStore::clear()
+{
+    m_items.clear();
+    m_idByPath.clear();
+    m_rowById.clear();
+    m_validRows = 0;
+}
+
+void PlaylistStore::invalidateMetadata(int row)
+{
+    // 文件内容变化后下次需要时重新探测
+    m_items[row].metadataLoaded = false;
+    m_items[row].fileSize = -1;
+}
+
+void PlaylistStore::invalidateRowsFrom(int row)
+{
+    if (row < m_validRows) {
+        m_validRows = row;
+    }
+}
+
+void PlaylistStore::rebuildRowIndex() const
+{
+    for (int row = m_validRows; row < m_items.size(); ++row) {
+        m_rowById.insert(m_items.at(row).id, row);
+    }
+    m_validRows = m_items.size();
+}
@@ -0,0 +1,69 @@
+// PlaylistStore.h
+#ifndef PLAYLISTSTORE_H
+#define PLAYLISTSTORE_H
+
+#include <QList>
+#include <QHash>
+#include <QString>
+
+#include "MediaInfo.h"
+
+// 播放列表数据存储
+// 按顺序保存媒体项，并维护 路径->ID 的哈希索引，
+// 使按路径查重、查找、删除均为 O(1) 均摊，批量添加为线性时间。
+class PlaylistStore
+{
+public:
+    typedef quint64 ItemId;
+    typedef QList<MediaInfo>::const_iterator const_iterator;
+
+    PlaylistStore();
+
+    int size() const { return m_items.size(); }
+    bool isEmpty() const { return m_items.isEmpty(); }
+    void reserve(int size);
+
+    // 访问：只读，路径和 ID 只能通过下面的修改接口改变，索引不会失效
+    const MediaInfo &at(int row) const { return m_items.at(row); }
+    const MediaInfo &operator[](int row) const { return m_items.at(row); }
+    const QList<MediaInfo> &items() const { return m_items; }
+
+    const_iterator begin() const { return m_items.cbegin(); }
+    const_iterator end() const { return m_items.cend(); }
+
+    // 查找
+    bool contains(const QString &filePath) const { return m_idByPath.contains(filePath); }
+    ItemId idOf(const QString &filePath) const { return m_idByPath.value(filePath, 0); }
+    int indexOf(const QString &filePath) const;
+    int indexOfId(ItemId id) const;
+
+    // 修改
+    ItemId append(MediaInfo info);  // 路径已存在时返回0
+    void removeAt(int row);
+    bool remove(const QString &filePath);
+    void move(int from, int to);
+    bool rename(int row, const QString &newPath);  // 新路径已存在时返回 false，ID 不变
+    void clear();
+
+    // 修改单个字段，不涉及路径和 ID
+    void setFavorite(int row, bool favorite) { m_items[row].isFavorite = favorite; }
+    void setPlayCount(int row, int playCount) { m_items[row].playCount = playCount; }
+    void setMissing(int row, bool missing) { m_items[row].missing = missing; }
+    void invalidateMetadata(int row);
+    void applyMetadata(int row, const MediaMetadata &metadata) { metadata.applyTo(m_items[row]); }
+
+private:
+    QList<MediaInfo> m_items;
+    QHash<QString, ItemId> m_idByPath;
+
+    // ID->行号 缓存：删除/移动后只使受影响的后缀失效，查询时惰性重建
+    mutable QHash<ItemId, int> m_rowById;
+    mutable int m_validRows;
+
+    ItemId m_nextId;
+
+    void invalidateRowsFrom(int row);
+    void rebuildRowIndex() const;
+};
+
+#endif // PLAYLISTSTORE_H
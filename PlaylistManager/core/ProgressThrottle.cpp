@@ -0,0 +1,51 @@
+// ProgressThrottle.cpp
+#include "ProgressThrottle.h"
+
+namespace {
+const int kDefaultInterval = 16;
+}
+
+ProgressThrottle::ProgressThrottle(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_interval(kDefaultInterval)
+    , m_position(0)
+    , m_dirty(false)
+    , m_suspended(false)
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &ProgressThrottle::flush);
+}
+
+void ProgressThrottle::setSuspended(bool suspended)
+{
+    if (m_suspended == suspended) {
+        return;
+    }
+    m_suspended = suspended;
+    if (m_suspended) {
+        m_timer->stop();
+    } else {
+        flush();
+    }
+}
+
+void ProgressThrottle::post(qint64 position)
+{
+    m_position = position;
+    m_dirty = true;
+    if (!m_suspended && !m_timer->isActive()) {
+        m_timer->start(m_interval);
+    }
+}
+
+void ProgressThrottle::flush()
+{
+    m_timer->stop();
+    if (!m_dirty) {
+        return;
+    }
+    m_dirty = false;
+    emit progressChanged(m_position);
+}
@@ -0,0 +1,42 @@
+// ProgressThrottle.h
+#ifndef PROGRESSTHROTTLE_H
+#define PROGRESSTHROTTLE_H
+
+#include <QObject>
+#include <QTimer>
+
+// 播放进度的合并刷新
+// 同一刷新间隔内的多次位置通知只送出最后一个位置。定时器只由新的通知启动，
+// 暂停、停止时没有通知，也就没有任何唤醒；挂起（窗口最小化）期间只记下位置，
+// 恢复时补送一次。
+class ProgressThrottle : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProgressThrottle(QObject *parent = nullptr);
+
+    // 刷新间隔（毫秒），通常取屏幕刷新间隔
+    void setInterval(int msecs) { m_interval = qMax(1, msecs); }
+    int interval() const { return m_interval; }
+
+    void setSuspended(bool suspended);
+    bool isSuspended() const { return m_suspended; }
+
+    void post(qint64 position);
+    // 有未送出的位置时立即送出
+    void flush();
+    bool isPending() const { return m_dirty; }
+
+signals:
+    void progressChanged(qint64 position);
+
+private:
+    QTimer *m_timer;
+    int m_interval;
+    qint64 m_position;
+    bool m_dirty;
+    bool m_suspended;
+};
+
+#endif // PROGRESSTHROTTLE_H
@@ -0,0 +1,196 @@
+// RowThumbnailCache.cpp
+#include "RowThumbnailCache.h"
+#include <QFileInfo>
+#include <QDir>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+
+namespace {
+const qint64 kDefaultPosition = 5000;       // 时长未知时截取的位置（毫秒）
+const qint64 kMaxPosition = 30000;          // 截取位置不超过30秒，避开片头又不必跳得太远
+}
+
+RowThumbnailCache::RowThumbnailCache(const QSize &size, qint64 memoryBudget, QObject *parent)
+    : QObject(parent)
+    , m_size(size)
+    , m_grabber(new FrameGrabber(size, this))
+    , m_memory(memoryBudget)
+    , m_busy(false)
+    , m_generation(0)
+{
+    m_pool.setMaxThreadCount(1);
+    m_cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/rowthumbs";
+
+    connect(m_grabber, &FrameGrabber::frameReady, this, &RowThumbnailCache::onFrameReady);
+    connect(m_grabber, &FrameGrabber::failed, this, &RowThumbnailCache::onFrameFailed);
+}
+
+RowThumbnailCache::~RowThumbnailCache()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+QImage RowThumbnailCache::thumbnail(const QString &filePath) const
+{
+    const QImage *image = m_memory.object(filePath);
+    return image ? *image : QImage();
+}
+
+void RowThumbnailCache::request(const QString &filePath, qint64 duration)
+{
+    if (filePath.isEmpty() || m_memory.contains(filePath) || m_queued.contains(filePath) ||
+        m_failed.contains(filePath) || (m_busy && m_current.filePath == filePath)) {
+        return;
+    }
+
+    Request request;
+    request.filePath = filePath;
+    request.position = duration > 0 ? qMin(duration / 10, kMaxPosition) : kDefaultPosition;
+    m_queue.append(request);
+    m_queued.insert(filePath);
+    dispatch();
+}
+
+void RowThumbnailCache::retain(const QSet<QString> &filePaths)
+{
+    for (int i = m_queue.size() - 1; i >= 0; --i) {
+        if (!filePaths.contains(m_queue.at(i).filePath)) {
+            m_queued.remove(m_queue.at(i).filePath);
+            m_queue.removeAt(i);
+        }
+    }
+
+    // 正在读盘或截取的行也已滚出视图：放弃它，立即处理可见行
+    if (m_busy && !filePaths.contains(m_current.filePath)) {
+        ++m_generation;
+        m_grabber->cancel();
+        m_busy = false;
+        dispatch();
+    }
+}
+
+void RowThumbnailCache::clear()
+{
+    ++m_generation;
+    m_queue.clear();
+    m_queued.clear();
+    m_failed.clear();
+    m_memory.clear();
+    if (m_busy) {
+        m_grabber->cancel();
+        m_busy = false;
+    }
+}
+
+void RowThumbnailCache::setMemoryBudget(qint64 bytes)
+{
+    m_memory.setMaxCost(bytes);
+}
+
+void RowThumbnailCache::dispatch()
+{
+    if (m_busy || m_queue.isEmpty()) {
+        return;
+    }
+
+    // 后进先出：最近滚动到的行最先出图
+    m_current = m_queue.takeLast();
+    m_queued.remove(m_current.filePath);
+    m_busy = true;
+
+    quint64 generation = m_generation;
+    QString filePath = m_current.filePath;
+    m_pool.start([this, generation, filePath]() {
+        QString cacheFile = this->cacheFile(filePath);
+        QImage image;
+        if (!cacheFile.isEmpty() && QFileInfo::exists(cacheFile)) {
+            image.load(cacheFile, "JPG");
+        }
+        QMetaObject::invokeMethod(this, [this, generation, filePath, cacheFile, image]() {
+            onDiskChecked(generation, filePath, cacheFile, image);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void RowThumbnailCache::onDiskChecked(quint64 generation, const QString &filePath, const QString &cacheFile,
+                                      const QImage &image)
+{
+    if (generation != m_generation || !m_busy || filePath != m_current.filePath) {
+        return;
+    }
+
+    if (!image.isNull()) {
+        finishCurrent(image);
+        return;
+    }
+    if (cacheFile.isEmpty()) {
+        // 文件不可读
+        m_failed.insert(filePath);
+        m_busy = false;
+        dispatch();
+        return;
+    }
+
+    m_currentCacheFile = cacheFile;
+    m_grabber->request(filePath, m_current.position);
+}
+
+void RowThumbnailCache::onFrameReady(const QString &filePath, qint64 position, const QImage &image)
+{
+    Q_UNUSED(position);
+    if (!m_busy || filePath != m_current.filePath) {
+        return;
+    }
+
+    // JPEG 编码和写盘在后台线程中进行
+    QString cacheFile = m_currentCacheFile;
+    m_pool.start([image, cacheFile]() {
+        QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+        image.save(cacheFile, "JPG", 85);
+    });
+    finishCurrent(image);
+}
+
+void RowThumbnailCache::onFrameFailed(const QString &filePath, qint64 position)
+{
+    Q_UNUSED(position);
+    if (!m_busy || filePath != m_current.filePath) {
+        return;
+    }
+
+    // 本次运行内不再重试
+    m_failed.insert(filePath);
+    m_busy = false;
+    dispatch();
+}
+
+void RowThumbnailCache::finishCurrent(const QImage &image)
+{
+    QString filePath = m_current.filePath;
+    m_memory.insert(filePath, new QImage(image), qMax<qsizetype>(1, image.sizeInBytes()));
+    m_busy = false;
+    emit thumbnailReady(filePath);
+    dispatch();
+}
+
+QString RowThumbnailCache::cacheFile(const QString &filePath) const
+{
+    QString key = cacheKey(filePath);
+    return key.isEmpty() ? QString() : m_cacheDir + "/" + key + ".jpg";
+}
+
+QString RowThumbnailCache::cacheKey(const QString &filePath)
+{
+    // 路径 + 大小 + 修改时间：文件被替换后自动失效
+    QFileInfo info(filePath);
+    if (!info.isFile()) {
+        return QString();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(filePath.toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    return QString::fromLatin1(hash.result().toHex());
+}
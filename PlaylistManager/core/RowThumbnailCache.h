@@ -0,0 +1,76 @@
+// RowThumbnailCache.h
+#ifndef ROWTHUMBNAILCACHE_H
+#define ROWTHUMBNAILCACHE_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QCache>
+#include <QImage>
+#include <QList>
+#include <QSet>
+
+#include "FrameGrabber.h"
+
+// 播放列表行缩略图
+// 内存中按字节数限额的 LRU（QCache，cost 为图片字节数），未命中时先查磁盘缓存，
+// 再用独立的 FrameGrabber 截取一帧。只为可见行请求，后请求的先处理；
+// 滚出视图的请求在 retain() 中取消，快速滚动时不会堆积解码任务。
+class RowThumbnailCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    RowThumbnailCache(const QSize &size, qint64 memoryBudget, QObject *parent = nullptr);
+    ~RowThumbnailCache();
+
+    QSize thumbnailSize() const { return m_size; }
+
+    // 只查内存，供绘制时调用；未命中返回空图片
+    QImage thumbnail(const QString &filePath) const;
+    // 已缓存、排队中或曾经失败的文件直接忽略
+    void request(const QString &filePath, qint64 duration);
+    // 取消不在 filePaths 中的请求，包括正在读盘或截取的那一个
+    void retain(const QSet<QString> &filePaths);
+    void clear();
+
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const { return m_memory.maxCost(); }
+    qint64 memoryUsage() const { return m_memory.totalCost(); }
+
+    // 磁盘缓存文件，文件不可读时为空；可在后台线程中调用
+    QString cacheFile(const QString &filePath) const;
+
+signals:
+    void thumbnailReady(const QString &filePath);
+
+private slots:
+    void onFrameReady(const QString &filePath, qint64 position, const QImage &image);
+    void onFrameFailed(const QString &filePath, qint64 position);
+
+private:
+    struct Request {
+        QString filePath;
+        qint64 position;
+    };
+
+    QSize m_size;
+    FrameGrabber *m_grabber;
+    QThreadPool m_pool;                 // 读写磁盘缓存
+    QCache<QString, QImage> m_memory;
+    QString m_cacheDir;
+
+    QList<Request> m_queue;
+    QSet<QString> m_queued;
+    QSet<QString> m_failed;
+    Request m_current;
+    QString m_currentCacheFile;
+    bool m_busy;
+    quint64 m_generation;               // clear() 或取消当前请求后递增，丢弃旧的磁盘读取结果
+
+    void dispatch();
+    void onDiskChecked(quint64 generation, const QString &filePath, const QString &cacheFile, const QImage &image);
+    void finishCurrent(const QImage &image);
+    static QString cacheKey(const QString &filePath);
+};
+
+#endif // ROWTHUMBNAILCACHE_H
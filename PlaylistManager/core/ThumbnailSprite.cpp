@@ -0,0 +1,301 @@
+// ThumbnailSprite.cpp
+#include "ThumbnailSprite.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDir>
+#include <QBuffer>
+#include <QDataStream>
+#include <QPainter>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+
+namespace {
+const quint32 kMagic = 0x53545056;          // "VPTS"
+const quint16 kVersion = 1;
+const QSize kTileSize(160, 90);
+const int kColumns = 10;
+const int kMinTiles = 10;
+const int kMaxTiles = 100;
+const qint64 kTargetInterval = 10000;       // 每格约间隔10秒
+const int kThrottleDelay = 500;             // 播放时两格之间的间隔（毫秒）
+const qint64 kHashBlock = 64 * 1024;
+}
+
+QImage ThumbnailSprite::tileAt(qint64 position) const
+{
+    if (isNull()) {
+        return QImage();
+    }
+
+    // 第 i 格截取的是区间 [i * interval, (i + 1) * interval) 的中点
+    int i = m_interval > 0 ? int(position / m_interval) : 0;
+    i = qBound(0, i, m_count - 1);
+    return m_atlas.copy((i % m_columns) * m_tileSize.width(), (i / m_columns) * m_tileSize.height(),
+                        m_tileSize.width(), m_tileSize.height());
+}
+
+bool ThumbnailSprite::save(const QString &fileName) const
+{
+    QByteArray encoded;
+    QBuffer buffer(&encoded);
+    buffer.open(QIODevice::WriteOnly);
+    if (!m_atlas.save(&buffer, "JPG", 80)) {
+        return false;
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kMagic << kVersion << qint32(m_tileSize.width()) << qint32(m_tileSize.height())
+        << qint32(m_columns) << qint32(m_count) << m_interval << encoded;
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+bool ThumbnailSprite::load(const QString &fileName, ThumbnailSprite *sprite)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint32 tileWidth = 0;
+    qint32 tileHeight = 0;
+    qint32 columns = 0;
+    qint32 count = 0;
+    qint64 interval = 0;
+    QByteArray encoded;
+    in >> magic >> version >> tileWidth >> tileHeight >> columns >> count >> interval >> encoded;
+    if (in.status() != QDataStream::Ok || magic != kMagic || version != kVersion ||
+        tileWidth <= 0 || tileHeight <= 0 || columns <= 0 || count <= 0) {
+        return false;
+    }
+
+    QImage atlas = QImage::fromData(encoded, "JPG");
+    if (atlas.width() < tileWidth * qMin(columns, count) ||
+        atlas.height() < tileHeight * ((count + columns - 1) / columns)) {
+        return false;
+    }
+
+    sprite->m_atlas = atlas;
+    sprite->m_tileSize = QSize(tileWidth, tileHeight);
+    sprite->m_columns = columns;
+    sprite->m_count = count;
+    sprite->m_interval = interval;
+    return true;
+}
+
+ThumbnailSpriteGenerator::ThumbnailSpriteGenerator(KeyframeIndexer *keyframeIndexer, QObject *parent)
+    : QObject(parent)
+    , m_keyframeIndexer(keyframeIndexer)
+    , m_grabber(new FrameGrabber(kTileSize, this))
+    , m_sprites(4)
+    , m_throttleTimer(new QTimer(this))
+    , m_active(false)
+    , m_throttled(false)
+    , m_generation(0)
+{
+    m_pool.setMaxThreadCount(1);
+
+    m_throttleTimer->setSingleShot(true);
+    connect(m_throttleTimer, &QTimer::timeout, this, &ThumbnailSpriteGenerator::requestNextTile);
+
+    connect(m_grabber, &FrameGrabber::frameReady, this, &ThumbnailSpriteGenerator::onFrameReady);
+    connect(m_grabber, &FrameGrabber::failed, this, &ThumbnailSpriteGenerator::onFrameFailed);
+}
+
+ThumbnailSpriteGenerator::~ThumbnailSpriteGenerator()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void ThumbnailSpriteGenerator::generate(const QString &filePath, qint64 duration)
+{
+    if (filePath.isEmpty() || duration <= 0 || m_sprites.contains(filePath) ||
+        (m_active && m_job.filePath == filePath)) {
+        return;
+    }
+
+    cancel();
+    m_active = true;
+    m_job = Job();
+    m_job.filePath = filePath;
+    quint64 generation = m_generation;
+
+    // 哈希只读取文件首尾各一块，在后台线程中计算并顺便查缓存
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+    m_pool.start([this, generation, filePath, duration, cacheDir]() {
+        QString hash = contentHash(filePath);
+        QString cacheFile = hash.isEmpty() ? QString() : cacheDir + "/" + hash + ".sprite";
+        ThumbnailSprite cached;
+        if (!cacheFile.isEmpty()) {
+            ThumbnailSprite::load(cacheFile, &cached);
+        }
+        QMetaObject::invokeMethod(this, [this, generation, filePath, duration, cacheFile, cached]() {
+            onCacheChecked(generation, filePath, duration, cacheFile, cached);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ThumbnailSpriteGenerator::cancel()
+{
+    ++m_generation;
+    m_active = false;
+    m_throttleTimer->stop();
+    m_grabber->cancel();
+}
+
+void ThumbnailSpriteGenerator::setThrottled(bool throttled)
+{
+    if (m_throttled == throttled) {
+        return;
+    }
+    m_throttled = throttled;
+
+    // 暂停后立即继续，不必等完播放时的间隔
+    if (!m_throttled && m_throttleTimer->isActive()) {
+        m_throttleTimer->stop();
+        requestNextTile();
+    }
+}
+
+const ThumbnailSprite *ThumbnailSpriteGenerator::sprite(const QString &filePath) const
+{
+    return m_sprites.object(filePath);
+}
+
+void ThumbnailSpriteGenerator::onCacheChecked(quint64 generation, const QString &filePath, qint64 duration,
+                                              const QString &cacheFile, const ThumbnailSprite &cached)
+{
+    if (generation != m_generation) {
+        return;
+    }
+
+    if (!cached.isNull()) {
+        m_active = false;
+        m_sprites.insert(filePath, new ThumbnailSprite(cached));
+        emit spriteReady(filePath, true);
+        return;
+    }
+
+    // 每格取区间中点，对齐到关键帧后只需解码一帧
+    int count = int(qBound<qint64>(kMinTiles, duration / kTargetInterval, kMaxTiles));
+    qint64 interval = duration / count;
+    const KeyframeIndex *index = m_keyframeIndexer->index(filePath);
+    for (int i = 0; i < count; ++i) {
+        qint64 position = i * interval + interval / 2;
+        m_job.positions.append(index ? index->nearest(position) : position);
+    }
+
+    int rows = (count + kColumns - 1) / kColumns;
+    m_job.cacheFile = cacheFile;
+    m_job.next = 0;
+    m_job.sprite.m_tileSize = kTileSize;
+    m_job.sprite.m_columns = kColumns;
+    m_job.sprite.m_count = count;
+    m_job.sprite.m_interval = interval;
+    m_job.sprite.m_atlas = QImage(kTileSize.width() * kColumns, kTileSize.height() * rows, QImage::Format_RGB32);
+    m_job.sprite.m_atlas.fill(Qt::black);
+
+    requestNextTile();
+}
+
+void ThumbnailSpriteGenerator::requestNextTile()
+{
+    if (!m_active || m_job.positions.isEmpty()) {
+        return;
+    }
+    if (m_job.next >= m_job.positions.size()) {
+        finishJob();
+        return;
+    }
+    m_grabber->request(m_job.filePath, m_job.positions.at(m_job.next));
+}
+
+void ThumbnailSpriteGenerator::onFrameReady(const QString &filePath, qint64 position, const QImage &image)
+{
+    Q_UNUSED(position);
+    if (!m_active || filePath != m_job.filePath) {
+        return;
+    }
+
+    placeTile(image);
+}
+
+void ThumbnailSpriteGenerator::onFrameFailed(const QString &filePath, qint64 position)
+{
+    Q_UNUSED(position);
+    if (!m_active || filePath != m_job.filePath) {
+        return;
+    }
+
+    // 这一格保持黑色
+    placeTile(QImage());
+}
+
+void ThumbnailSpriteGenerator::placeTile(const QImage &image)
+{
+    if (!image.isNull()) {
+        int i = m_job.next;
+        QRect cell((i % kColumns) * kTileSize.width(), (i / kColumns) * kTileSize.height(),
+                   kTileSize.width(), kTileSize.height());
+        QRect target(QPoint(0, 0), image.size().scaled(kTileSize, Qt::KeepAspectRatio));
+        target.moveCenter(cell.center());
+
+        QPainter painter(&m_job.sprite.m_atlas);
+        painter.drawImage(target, image);
+    }
+
+    ++m_job.next;
+    if (m_throttled) {
+        m_throttleTimer->start(kThrottleDelay);
+    } else {
+        requestNextTile();
+    }
+}
+
+void ThumbnailSpriteGenerator::finishJob()
+{
+    m_active = false;
+
+    m_sprites.insert(m_job.filePath, new ThumbnailSprite(m_job.sprite));
+    emit spriteReady(m_job.filePath, false);
+
+    // JPEG 编码和写盘在后台线程中进行
+    if (!m_job.cacheFile.isEmpty()) {
+        ThumbnailSprite sprite = m_job.sprite;
+        QString cacheFile = m_job.cacheFile;
+        m_pool.start([sprite, cacheFile]() {
+            QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+            sprite.save(cacheFile);
+        });
+    }
+    m_job = Job();
+}
+
+QString ThumbnailSpriteGenerator::contentHash(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    // 大小 + 首尾各64KB：足以区分不同的媒体文件，又不必读完整个文件
+    qint64 size = file.size();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(size));
+    hash.addData(file.read(kHashBlock));
+    if (size > 2 * kHashBlock && file.seek(size - kHashBlock)) {
+        hash.addData(file.read(kHashBlock));
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
@@ -0,0 +1,94 @@
+// ThumbnailSprite.h
+#ifndef THUMBNAILSPRITE_H
+#define THUMBNAILSPRITE_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QCache>
+#include <QTimer>
+#include <QImage>
+#include <QList>
+
+#include "FrameGrabber.h"
+#include "KeyframeIndex.h"
+
+// 进度条缩略图拼图：等间隔截取的帧按行排列在一张图片中
+class ThumbnailSprite
+{
+public:
+    ThumbnailSprite() : m_columns(0), m_count(0), m_interval(0) {}
+
+    bool isNull() const { return m_atlas.isNull() || m_count == 0; }
+    int count() const { return m_count; }
+    QSize tileSize() const { return m_tileSize; }
+
+    // 覆盖 position 所在区间的一格
+    QImage tileAt(qint64 position) const;
+
+    bool save(const QString &fileName) const;
+    static bool load(const QString &fileName, ThumbnailSprite *sprite);
+
+private:
+    friend class ThumbnailSpriteGenerator;
+
+    QImage m_atlas;
+    QSize m_tileSize;
+    int m_columns;
+    int m_count;
+    qint64 m_interval;      // 相邻两格的时间间隔（毫秒）
+};
+
+// 缩略图拼图的后台生成
+// 用独立的 FrameGrabber 逐格截取（位置对齐到关键帧），全部完成后编码保存到
+// 缓存目录，以文件内容的哈希命名，文件移动或改名后仍可命中。正在播放时每格
+// 之间留出间隔，不与播放争抢解码；暂停或停止时全速生成。
+class ThumbnailSpriteGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ThumbnailSpriteGenerator(KeyframeIndexer *keyframeIndexer, QObject *parent = nullptr);
+    ~ThumbnailSpriteGenerator();
+
+    // 新的请求取代正在进行的生成
+    void generate(const QString &filePath, qint64 duration);
+    void cancel();
+    void setThrottled(bool throttled);
+
+    const ThumbnailSprite *sprite(const QString &filePath) const;
+
+signals:
+    void spriteReady(const QString &filePath, bool fromCache);
+
+private slots:
+    void onFrameReady(const QString &filePath, qint64 position, const QImage &image);
+    void onFrameFailed(const QString &filePath, qint64 position);
+    void requestNextTile();
+
+private:
+    struct Job {
+        QString filePath;
+        QString cacheFile;
+        QList<qint64> positions;
+        int next;
+        ThumbnailSprite sprite;
+    };
+
+    KeyframeIndexer *m_keyframeIndexer;
+    FrameGrabber *m_grabber;
+    QThreadPool m_pool;             // 计算哈希、读写缓存
+    QCache<QString, ThumbnailSprite> m_sprites;
+    QTimer *m_throttleTimer;
+    Job m_job;
+    bool m_active;
+    bool m_throttled;
+    quint64 m_generation;
+
+    void onCacheChecked(quint64 generation, const QString &filePath, qint64 duration,
+                        const QString &cacheFile, const ThumbnailSprite &cached);
+    void placeTile(const QImage &image);
+    void finishJob();
+    static QString contentHash(const QString &filePath);
+};
+
+#endif // THUMBNAILSPRITE_H
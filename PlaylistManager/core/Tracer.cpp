@@ -0,0 +1,233 @@
+// Tracer.cpp
+#include "Tracer.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QCoreApplication>
+#include <QThread>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <memory>
+#include <vector>
+
+namespace {
+const quint64 kCapacity = 8192;             // 每个线程保留的事件数，必须是2的幂
+
+// 环形缓冲中的一格。所属线程写入时导出线程可能同时在读，字段都用 relaxed 原子量
+// （在 x86 和 ARM 上与普通读写相同），读到写了一半的事件由导出时重新检查 head 丢弃
+struct Slot {
+    std::atomic<const char *> name{nullptr};
+    std::atomic<const char *> argName{nullptr};
+    std::atomic<qint64> timestamp{0};
+    std::atomic<qint64> duration{0};
+    std::atomic<qint64> argValue{0};
+    std::atomic<quint64> id{0};
+    std::atomic<Tracer::EventType> type{Tracer::EventType::Instant};
+};
+
+struct ThreadRing {
+    Slot events[kCapacity];
+    std::atomic<quint64> head{0};           // 只由所属线程写入
+    std::atomic<quint64> floor{0};          // clear() 时的 head，导出时忽略之前的事件
+    std::atomic<const char *> name{nullptr};
+    int tid = 0;
+    bool inUse = false;                     // 受 Registry::mutex 保护
+};
+
+struct Registry {
+    QMutex mutex;
+    // 线程退出后缓冲保留（导出时仍可读取），由之后新建的线程接着使用，
+    // 线程池反复创建线程时缓冲数量不会无限增长。接着使用时换一个新的 tid，
+    // 并从当前 head 开始，退出的线程留下的事件不会算到新线程头上
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    int nextTid = 1;
+    QElapsedTimer clock;
+
+    Registry() { clock.start(); }
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+// 线程退出时把缓冲交还给 Registry
+struct RingHandle {
+    ThreadRing *ring = nullptr;
+
+    ~RingHandle()
+    {
+        if (ring) {
+            Registry &reg = registry();
+            QMutexLocker locker(&reg.mutex);
+            ring->inUse = false;
+        }
+    }
+};
+
+thread_local RingHandle t_handle;
+
+ThreadRing *threadRing()
+{
+    if (!t_handle.ring) {
+        Registry &reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        ThreadRing *ring = nullptr;
+        for (const std::unique_ptr<ThreadRing> &candidate : reg.rings) {
+            if (!candidate->inUse) {
+                ring = candidate.get();
+                break;
+            }
+        }
+        if (!ring) {
+            reg.rings.push_back(std::make_unique<ThreadRing>());
+            ring = reg.rings.back().get();
+        }
+        // head 只由所属线程写入，此时没有线程在写
+        ring->floor.store(ring->head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        ring->tid = reg.nextTid++;
+        ring->inUse = true;
+        ring->name.store(nullptr, std::memory_order_relaxed);
+        if (QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread()) {
+            ring->name.store("GUI", std::memory_order_relaxed);
+        }
+        t_handle.ring = ring;
+    }
+    return t_handle.ring;
+}
+}
+
+namespace Tracer
+{
+qint64 now()
+{
+    return registry().clock.nsecsElapsed();
+}
+
+void record(EventType type, const char *name, qint64 timestamp, qint64 duration,
+            const char *argName, qint64 argValue, quint64 id)
+{
+    ThreadRing *ring = threadRing();
+    quint64 head = ring->head.load(std::memory_order_relaxed);
+    // 覆盖 head - kCapacity 号事件之前的屏障：导出线程只要读到了新写入的字段，
+    // 重新读 head 时就至少能看到上一次发布的 head，从而丢弃这一格
+    std::atomic_thread_fence(std::memory_order_release);
+    Slot &slot = ring->events[head & (kCapacity - 1)];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.argName.store(argName, std::memory_order_relaxed);
+    slot.timestamp.store(timestamp, std::memory_order_relaxed);
+    slot.duration.store(duration, std::memory_order_relaxed);
+    slot.argValue.store(argValue, std::memory_order_relaxed);
+    slot.id.store(id, std::memory_order_relaxed);
+    slot.type.store(type, std::memory_order_relaxed);
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void setThreadName(const char *name)
+{
+    threadRing()->name.store(name, std::memory_order_relaxed);
+}
+
+void clear()
+{
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (const std::unique_ptr<ThreadRing> &ring : reg.rings) {
+        ring->floor.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+bool exportChromeTrace(const QString &fileName, QString *errorString)
+{
+    QJsonArray traceEvents;
+    qint64 pid = QCoreApplication::applicationPid();
+
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (const std::unique_ptr<ThreadRing> &ring : reg.rings) {
+        // 先复制再检查：复制期间被所属线程覆盖的事件丢弃，不会用到写了一半的数据
+        quint64 head = ring->head.load(std::memory_order_acquire);
+        quint64 first = qMax(ring->floor.load(std::memory_order_relaxed), head > kCapacity ? head - kCapacity : 0);
+        std::vector<Event> events;
+        events.reserve(head - first);
+        for (quint64 i = first; i < head; ++i) {
+            const Slot &slot = ring->events[i & (kCapacity - 1)];
+            Event event;
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.argName = slot.argName.load(std::memory_order_relaxed);
+            event.timestamp = slot.timestamp.load(std::memory_order_relaxed);
+            event.duration = slot.duration.load(std::memory_order_relaxed);
+            event.argValue = slot.argValue.load(std::memory_order_relaxed);
+            event.id = slot.id.load(std::memory_order_relaxed);
+            event.type = slot.type.load(std::memory_order_relaxed);
+            events.push_back(event);
+        }
+        // 与 record() 中的屏障配对。所属线程发布 headAfter 之后可能正在写 headAfter 号
+        // 事件，它覆盖的是 headAfter + 1 - kCapacity 之前的那一格，也要丢弃
+        std::atomic_thread_fence(std::memory_order_acquire);
+        quint64 headAfter = ring->head.load(std::memory_order_relaxed);
+        quint64 valid = headAfter + 1 > kCapacity ? headAfter + 1 - kCapacity : 0;
+
+        const char *threadName = ring->name.load(std::memory_order_relaxed);
+        QJsonObject meta;
+        meta["name"] = "thread_name";
+        meta["ph"] = "M";
+        meta["pid"] = pid;
+        meta["tid"] = ring->tid;
+        meta["args"] = QJsonObject{{"name", threadName ? QString::fromUtf8(threadName)
+                                                       : QString("Worker %1").arg(ring->tid)}};
+        traceEvents.append(meta);
+
+        for (quint64 i = qMax(first, valid); i < head; ++i) {
+            const Event &event = events[i - first];
+            QJsonObject object;
+            object["name"] = QString::fromUtf8(event.name);
+            object["cat"] = "player";
+            object["ph"] = QString(QChar(char(event.type)));
+            object["ts"] = event.timestamp / 1000.0;
+            object["pid"] = pid;
+            object["tid"] = ring->tid;
+            switch (event.type) {
+            case EventType::Complete:
+                object["dur"] = event.duration / 1000.0;
+                break;
+            case EventType::Instant:
+                object["s"] = "t";
+                break;
+            case EventType::AsyncBegin:
+            case EventType::AsyncEnd:
+                object["id"] = QString("0x%1").arg(event.id, 0, 16);
+                break;
+            }
+            if (event.argName) {
+                object["args"] = QJsonObject{{QString::fromUtf8(event.argName), event.argValue}};
+            }
+            traceEvents.append(object);
+        }
+    }
+    locker.unlock();
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+}
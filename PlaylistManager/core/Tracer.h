@@ -0,0 +1,93 @@
+// Tracer.h
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QtGlobal>
+#include <QString>
+#include <atomic>
+
+// 进程内跟踪
+// 每个线程第一次记录时分配自己的环形缓冲，记录时不加锁、不分配内存；事件名和
+// 参数名必须是字符串字面量（只保存指针）。缓冲写满后覆盖最旧的事件。导出时
+// 汇总所有线程的缓冲，写成 Chrome trace 格式（chrome://tracing、Perfetto 可直接打开）。
+// 未定义 PLAYER_TRACING 时下面的宏展开为空，不产生任何代码。
+namespace Tracer
+{
+enum class EventType : char {
+    Complete = 'X',     // 带时长的区间
+    Instant = 'i',
+    AsyncBegin = 'b',   // 跨函数、跨线程的区间，按 id 配对
+    AsyncEnd = 'e'
+};
+
+struct Event {
+    const char *name;
+    const char *argName;    // 可为空
+    qint64 timestamp;       // 纳秒
+    qint64 duration;        // 纳秒，只用于 Complete
+    qint64 argValue;
+    quint64 id;             // 只用于 Async
+    EventType type;
+};
+
+qint64 now();
+void record(EventType type, const char *name, qint64 timestamp, qint64 duration = 0,
+            const char *argName = nullptr, qint64 argValue = 0, quint64 id = 0);
+void setThreadName(const char *name);
+
+// 清空所有线程的缓冲
+void clear();
+bool exportChromeTrace(const QString &fileName, QString *errorString = nullptr);
+
+constexpr bool isEnabled()
+{
+#ifdef PLAYER_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+// 作用域区间：构造时记下开始时间，析构时写入一个 Complete 事件
+class Scope
+{
+public:
+    explicit Scope(const char *name, const char *argName = nullptr, qint64 argValue = 0)
+        : m_name(name), m_argName(argName), m_argValue(argValue), m_start(now()) {}
+    ~Scope() { record(EventType::Complete, m_name, m_start, now() - m_start, m_argName, m_argValue); }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    const char *m_name;
+    const char *m_argName;
+    qint64 m_argValue;
+    qint64 m_start;
+};
+}
+
+#ifdef PLAYER_TRACING
+#define PLAYER_TRACE_CONCAT_(a, b) a##b
+#define PLAYER_TRACE_CONCAT(a, b) PLAYER_TRACE_CONCAT_(a, b)
+#define PLAYER_TRACE_SCOPE(name) \
+    Tracer::Scope PLAYER_TRACE_CONCAT(playerTraceScope_, __LINE__)(name)
+#define PLAYER_TRACE_SCOPE_ARG(name, argName, value) \
+    Tracer::Scope PLAYER_TRACE_CONCAT(playerTraceScope_, __LINE__)(name, argName, qint64(value))
+#define PLAYER_TRACE_INSTANT(name, argName, value) \
+    Tracer::record(Tracer::EventType::Instant, name, Tracer::now(), 0, argName, qint64(value))
+#define PLAYER_TRACE_ASYNC_BEGIN(name, id) \
+    Tracer::record(Tracer::EventType::AsyncBegin, name, Tracer::now(), 0, nullptr, 0, quint64(id))
+#define PLAYER_TRACE_ASYNC_END(name, id) \
+    Tracer::record(Tracer::EventType::AsyncEnd, name, Tracer::now(), 0, nullptr, 0, quint64(id))
+#define PLAYER_TRACE_THREAD_NAME(name) Tracer::setThreadName(name)
+#else
+#define PLAYER_TRACE_SCOPE(name) do {} while (0)
+#define PLAYER_TRACE_SCOPE_ARG(name, argName, value) do {} while (0)
+#define PLAYER_TRACE_INSTANT(name, argName, value) do {} while (0)
+#define PLAYER_TRACE_ASYNC_BEGIN(name, id) do {} while (0)
+#define PLAYER_TRACE_ASYNC_END(name, id) do {} while (0)
+#define PLAYER_TRACE_THREAD_NAME(name) do {} while (0)
+#endif
+
+#endif // TRACER_H
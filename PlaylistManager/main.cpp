@@ -1,4 +1,5 @@
 #include <QApplication>
+#include <QCommandLineParser>
 #include "AdvancedVideoPlayer.h"
 int main(int argc, char *argv[])
 {
@@ -8,8 +9,25 @@ int main(int argc, char *argv[])
     app.setApplicationVersion("1.0");
     app.setOrganizationName("Qt6教程");
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption controlOption("control", "开启本机控制接口，供脚本遥控播放。");
+    QCommandLineOption controlNameOption("control-name", "控制接口的名称（默认按用户区分）。", "name",
+                                         ControlServer::defaultServerName());
+    parser.addOption(controlOption);
+    parser.addOption(controlNameOption);
+    parser.process(app);
+
     AdvancedVideoPlayer player;
     player.show();
 
+    if (parser.isSet(controlOption) || parser.isSet(controlNameOption)) {
+        QString error;
+        if (!player.startControlServer(parser.value(controlNameOption), &error)) {
+            qWarning("Cannot start control server: %s", qPrintable(error));
+        }
+    }
+
     return app.exec();
 }
@@ -3,23 +3,22 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QApplication>
-#include <QMimeDatabase>
 #include <QStandardPaths>
-#include <QDir>
-#include <QDebug>
-#include <QTextStream>
-#include <QHeaderView>
-#include <algorithm>
-#include <random>
+#include <QScrollBar>
+#include <QTimer>
+#include "PlaylistItemDelegate.h"
+#include "Tracer.h"
 
 PlaylistWidget::PlaylistWidget(QWidget *parent)
     : QWidget(parent)
-    , m_currentIndex(-1)
-    , m_playMode(Sequential)
-    , m_randomIndex(-1)
+    , m_controller(new PlaylistController(this))
+    , m_model(m_controller->model())
+    , m_filterModel(new PlaylistFilterModel(this))
+    , m_rowThumbnails(nullptr)
     , m_showingFavorites(false)
 {
-    m_supportedFormats = getSupportedFormats();
+    qint64 thumbnailBudget = QSettings().value("Playlist/thumbnailCacheMB", 32).toLongLong();
+    m_rowThumbnails = new RowThumbnailCache(QSize(64, 36), thumbnailBudget * 1024 * 1024, this);
     setupUI();
     setupConnections();
     setAcceptDrops(true);
@@ -72,18 +71,24 @@ void PlaylistWidget::setupUI()
     m_buttonLayout->addStretch();
     m_buttonLayout->addWidget(m_countLabel);
 
-    // 列表组件
-    m_listWidget = new QListWidget();
-    m_listWidget->setAlternatingRowColors(true);
-    m_listWidget->setSelectionMode(QAbstractItemView::ExtendedSelection);
-    m_listWidget->setContextMenuPolicy(Qt::CustomContextMenu);
-    m_listWidget->setDragDropMode(QAbstractItemView::InternalMove);
+    // 列表组件（统一行高，只布局和绘制可见行）
+    m_filterModel->setPlaylistModel(m_model);
+
+    m_listView = new QListView();
+    m_listView->setModel(m_filterModel);
+    m_listView->setUniformItemSizes(true);
+    m_listView->setAlternatingRowColors(true);
+    m_listView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_listView->setContextMenuPolicy(Qt::CustomContextMenu);
+    m_listView->setDragDropMode(QAbstractItemView::InternalMove);
+    m_listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_listView->setItemDelegate(new PlaylistItemDelegate(m_rowThumbnails, m_listView));
 
     // 创建右键菜单
     m_contextMenu = new QMenu(this);
     m_contextMenu->addAction("播放", this, [this]() {
-        if (m_listWidget->currentRow() >= 0) {
-            setCurrentIndex(m_listWidget->currentRow());
+        if (selectedRow() >= 0) {
+            setCurrentIndex(selectedRow());
             emit requestPlay();
         }
     });
@@ -96,7 +101,7 @@ void PlaylistWidget::setupUI()
     // 布局组装
     m_mainLayout->addLayout(m_controlLayout);
     m_mainLayout->addLayout(m_buttonLayout);
-    m_mainLayout->addWidget(m_listWidget, 1);
+    m_mainLayout->addWidget(m_listView, 1);
 
     updateUI();
 }
@@ -104,11 +109,47 @@ void PlaylistWidget::setupUI()
 void PlaylistWidget::setupConnections()
 {
     // 列表事件
-    connect(m_listWidget, &QListWidget::itemDoubleClicked,
+    connect(m_listView, &QListView::doubleClicked,
             this, &PlaylistWidget::onItemDoubleClicked);
-    connect(m_listWidget, &QListWidget::customContextMenuRequested,
+    connect(m_listView, &QListView::customContextMenuRequested,
             this, &PlaylistWidget::showContextMenu);
 
+    // 播放列表逻辑
+    connect(m_controller, &PlaylistController::mediaSelected,
+            this, &PlaylistWidget::onMediaSelected);
+    connect(m_controller, &PlaylistController::playlistChanged,
+            this, &PlaylistWidget::onPlaylistChanged);
+    connect(m_controller, &PlaylistController::playModeChanged,
+            this, &PlaylistWidget::onPlayModeChanged);
+    connect(m_controller, &PlaylistController::metadataCacheStatsChanged,
+            this, &PlaylistWidget::metadataCacheStatsChanged);
+
+    // 批量更新期间暂停重绘
+    connect(m_controller, &PlaylistController::batchStarted, this, [this]() {
+        m_listView->setUpdatesEnabled(false);
+    });
+    connect(m_controller, &PlaylistController::batchFinished, this, [this]() {
+        m_listView->setUpdatesEnabled(true);
+    });
+
+    // 文件校验：滚动时优先检查屏幕上的行
+    connect(m_listView->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &PlaylistWidget::updateValidationPriority);
+
+    // 行缩略图：滚出视图的请求立即取消
+    connect(m_rowThumbnails, &RowThumbnailCache::thumbnailReady,
+            this, &PlaylistWidget::onRowThumbnailReady);
+    connect(m_listView->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &PlaylistWidget::retainVisibleThumbnails);
+    connect(m_filterModel, &QAbstractItemModel::modelReset,
+            this, &PlaylistWidget::retainVisibleThumbnails);
+
+    // 文件夹扫描
+    connect(m_controller, &PlaylistController::folderScanProgress,
+            this, &PlaylistWidget::folderScanProgress);
+    connect(m_controller, &PlaylistController::folderScanFinished,
+            this, &PlaylistWidget::folderScanFinished);
+
     // 控制按钮
     connect(m_searchEdit, &QLineEdit::textChanged,
             this, &PlaylistWidget::onSearchTextChanged);
@@ -124,81 +165,9 @@ void PlaylistWidget::setupConnections()
             this, &PlaylistWidget::onClearPlaylistClicked);
 }
 
-void PlaylistWidget::addMedia(const QString &filePath)
-{
-    if (!QFileInfo::exists(filePath) || !isMediaFile(filePath)) {
-        return;
-    }
-
-    // 检查是否已存在
-    for (const MediaInfo &info : m_mediaList) {
-        if (info.filePath == filePath) {
-            return;
-        }
-    }
-
-    MediaInfo mediaInfo;
-    mediaInfo.filePath = filePath;
-    mediaInfo.title = QFileInfo(filePath).baseName();
-
-    // 异步提取媒体信息
-    extractMediaInfo(mediaInfo);
-
-    m_mediaList.append(mediaInfo);
-
-    // 更新UI
-    QListWidgetItem *item = new QListWidgetItem(mediaInfo.displayName());
-    item->setToolTip(filePath);
-    if (mediaInfo.isFavorite) {
-        item->setIcon(QIcon("⭐"));
-    }
-    m_listWidget->addItem(item);
-
-    // 如果是第一个文件，设置为当前项
-    if (m_mediaList.size() == 1) {
-        setCurrentIndex(0);
-    }
-
-    updateUI();
-    emit playlistChanged();
-}
-
-void PlaylistWidget::addMediaList(const QStringList &filePaths)
-{
-    for (const QString &path : filePaths) {
-        addMedia(path);
-    }
-
-    // 生成新的随机顺序
-    if (m_playMode == Random) {
-        generateRandomOrder();
-    }
-}
-
 void PlaylistWidget::removeCurrentItem()
 {
-    int currentRow = m_listWidget->currentRow();
-    if (currentRow < 0 || currentRow >= m_mediaList.size()) {
-        return;
-    }
-
-    m_mediaList.removeAt(currentRow);
-    delete m_listWidget->takeItem(currentRow);
-
-    // 调整当前索引
-    if (m_currentIndex == currentRow) {
-        if (m_mediaList.isEmpty()) {
-            m_currentIndex = -1;
-        } else if (m_currentIndex >= m_mediaList.size()) {
-            m_currentIndex = m_mediaList.size() - 1;
-        }
-        emit mediaSelected(m_currentIndex);
-    } else if (m_currentIndex > currentRow) {
-        m_currentIndex--;
-    }
-
-    updateUI();
-    emit playlistChanged();
+    m_controller->removeRow(selectedRow());
 }
 
 void PlaylistWidget::clearPlaylist()
@@ -208,184 +177,57 @@ void PlaylistWidget::clearPlaylist()
         QMessageBox::Yes | QMessageBox::No);
 
     if (reply == QMessageBox::Yes) {
-        m_mediaList.clear();
-        m_listWidget->clear();
-        m_currentIndex = -1;
-        m_randomOrder.clear();
-        m_randomIndex = -1;
-
-        updateUI();
-        emit playlistChanged();
-        emit mediaSelected(-1);
+        m_rowThumbnails->clear();
+        m_controller->clear();
     }
 }
 
 void PlaylistWidget::setCurrentIndex(int index)
 {
-    if (index < -1 || index >= m_mediaList.size()) {
-        return;
-    }
-
-    // 清除之前的高亮
-    if (m_currentIndex >= 0 && m_currentIndex < m_listWidget->count()) {
-        QListWidgetItem *oldItem = m_listWidget->item(m_currentIndex);
-        if (oldItem) {
-            QFont font = oldItem->font();
-            font.setBold(false);
-            oldItem->setFont(font);
-            oldItem->setBackground(QBrush());
-        }
-    }
-
-    m_currentIndex = index;
-
-    // 设置新的高亮
-    if (m_currentIndex >= 0) {
-        QListWidgetItem *newItem = m_listWidget->item(m_currentIndex);
-        if (newItem) {
-            QFont font = newItem->font();
-            font.setBold(true);
-            newItem->setFont(font);
-            newItem->setBackground(QColor(100, 149, 237, 50));
-            m_listWidget->setCurrentItem(newItem);
-            m_listWidget->scrollToItem(newItem);
-        }
-
-        // 更新播放统计
-        m_mediaList[m_currentIndex].playCount++;
-    }
-
-    emit mediaSelected(m_currentIndex);
+    m_controller->setCurrentIndex(index);
 }
 
-void PlaylistWidget::setPlayMode(PlayMode mode)
+void PlaylistWidget::onMediaSelected(int index)
 {
-    if (m_playMode != mode) {
-        m_playMode = mode;
-        updatePlayModeDisplay();
-
-        if (mode == Random) {
-            generateRandomOrder();
+    if (index >= 0) {
+        // 当前项可能被搜索过滤掉，此时只更新数据不滚动
+        QModelIndex viewIndex = m_filterModel->mapFromSource(m_model->index(index));
+        if (viewIndex.isValid()) {
+            m_listView->setCurrentIndex(viewIndex);
+            m_listView->scrollTo(viewIndex);
         }
-
-        emit playModeChanged(mode);
     }
-}
-
-int PlaylistWidget::getNextIndex() const
-{
-    if (m_mediaList.isEmpty()) {
-        return -1;
-    }
-
-    switch (m_playMode) {
-        case Sequential:
-            return (m_currentIndex + 1 < m_mediaList.size()) ? m_currentIndex + 1 : -1;
 
-        case Loop:
-            return (m_currentIndex + 1) % m_mediaList.size();
+    updateValidationPriority();
 
-        case Random:
-            if (m_randomOrder.isEmpty()) {
-                return -1;
-            }
-            int nextRandomIndex = (m_randomIndex + 1) % m_randomOrder.size();
-            return m_randomOrder[nextRandomIndex];
-
-        // case RepeatOne:
-        //     return m_currentIndex;
-
-        // default:
-        //     break;
-    }
-
-    return -1;
+    emit mediaSelected(index);
 }
 
-int PlaylistWidget::getPreviousIndex() const
+void PlaylistWidget::onPlaylistChanged()
 {
-    if (m_mediaList.isEmpty()) {
-        return -1;
-    }
-
-    switch (m_playMode) {
-    case Sequential:
-        return (m_currentIndex > 0) ? m_currentIndex - 1 : -1;
-
-    case Loop:
-        return (m_currentIndex - 1 + m_mediaList.size()) % m_mediaList.size();
-
-    case Random:
-        if (m_randomOrder.isEmpty()) {
-            return -1;
-        }
-        int prevRandomIndex = (m_randomIndex - 1 + m_randomOrder.size()) % m_randomOrder.size();
-        return m_randomOrder[prevRandomIndex];
-
-    // case RepeatOne:
-    //     return m_currentIndex;
-    // default:
-    //     break;
-    }
-
-
-    return -1;
+    updateUI();
+    emit playlistChanged();
 }
 
-void PlaylistWidget::searchMedia(const QString &keyword)
+void PlaylistWidget::onPlayModeChanged(PlaySequencer::PlayMode mode)
 {
-    if (keyword.isEmpty()) {
-        // 恢复原始列表
-        if (!m_originalList.isEmpty()) {
-            m_mediaList = m_originalList;
-            m_originalList.clear();
-        }
-    } else {
-        // 保存原始列表
-        if (m_originalList.isEmpty()) {
-            m_originalList = m_mediaList;
-        }
-
-        // 过滤列表
-        QList<MediaInfo> filteredList;
-        for (const MediaInfo &info : m_originalList) {
-            if (info.displayName().contains(keyword, Qt::CaseInsensitive) ||
-                info.filePath.contains(keyword, Qt::CaseInsensitive)) {
-                filteredList.append(info);
-            }
-        }
-        m_mediaList = filteredList;
-    }
-
-    // 重建列表显示
-    m_listWidget->clear();
-    for (int i = 0; i < m_mediaList.size(); ++i) {
-        const MediaInfo &info = m_mediaList[i];
-        QListWidgetItem *item = new QListWidgetItem(info.displayName());
-        item->setToolTip(info.filePath);
-        if (info.isFavorite) {
-            item->setIcon(QIcon("⭐"));
-        }
-        m_listWidget->addItem(item);
-    }
-
-    updateUI();
+    updatePlayModeDisplay();
+    emit playModeChanged(mode);
 }
 
-MediaInfo PlaylistWidget::getCurrentMedia() const
+void PlaylistWidget::searchMedia(const QString &keyword)
 {
-    if (m_currentIndex >= 0 && m_currentIndex < m_mediaList.size()) {
-        return m_mediaList[m_currentIndex];
-    }
-    return MediaInfo();
+    PLAYER_TRACE_SCOPE("PlaylistWidget::searchMedia");
+    // 由索引计算结果，代理模型只切换可见行，不重建列表
+    m_filterModel->setSearchKeyword(keyword);
+    updateUI();
 }
 
-MediaInfo PlaylistWidget::getMediaAt(int index) const
+void PlaylistWidget::showFavoritesOnly(bool favOnly)
 {
-    if (index >= 0 && index < m_mediaList.size()) {
-        return m_mediaList[index];
-    }
-    return MediaInfo();
+    m_showingFavorites = favOnly;
+    m_filterModel->setFavoritesOnly(favOnly);
+    updateUI();
 }
 
 // 事件处理
@@ -399,48 +241,44 @@ void PlaylistWidget::dragEnterEvent(QDragEnterEvent *event)
 void PlaylistWidget::dropEvent(QDropEvent *event)
 {
     QStringList filePaths;
+    QStringList folders;
     foreach (const QUrl &url, event->mimeData()->urls()) {
         if (url.isLocalFile()) {
             QString path = url.toLocalFile();
             QFileInfo fileInfo(path);
 
             if (fileInfo.isFile()) {
-                if (isMediaFile(path)) {
+                if (m_controller->isMediaFile(path)) {
                     filePaths.append(path);
                 }
             } else if (fileInfo.isDir()) {
-                // 扫描目录中的媒体文件
-                QDir dir(path);
-                QStringList filters;
-                for (const QString &format : m_supportedFormats) {
-                    filters << QString("*.%1").arg(format);
-                }
-
-                QFileInfoList files = dir.entryInfoList(filters, QDir::Files, QDir::Name);
-                for (const QFileInfo &file : files) {
-                    filePaths.append(file.absoluteFilePath());
-                }
+                // 目录交给后台扫描（包括子目录）
+                folders.append(path);
             }
         }
     }
 
     if (!filePaths.isEmpty()) {
         addMediaList(filePaths);
+    }
+    if (!folders.isEmpty()) {
+        addFolders(folders);
+    }
+    if (!filePaths.isEmpty() || !folders.isEmpty()) {
         event->acceptProposedAction();
     }
 }
 
 // 槽函数实现
-void PlaylistWidget::onItemDoubleClicked(QListWidgetItem *item)
+void PlaylistWidget::onItemDoubleClicked(const QModelIndex &index)
 {
-    int index = m_listWidget->row(item);
-    setCurrentIndex(index);
+    setCurrentIndex(m_filterModel->mapToSource(index).row());
     emit requestPlay();
 }
 
 void PlaylistWidget::onPlayModeButtonClicked()
 {
-    PlayMode newMode = static_cast<PlayMode>((m_playMode + 1) % 4);
+    PlayMode newMode = static_cast<PlayMode>((getPlayMode() + 1) % 4);
     setPlayMode(newMode);
 }
 
@@ -455,7 +293,7 @@ void PlaylistWidget::onAddFilesClicked()
                                         QStandardPaths::writableLocation(QStandardPaths::MusicLocation)).toString();
 
     QStringList filters;
-    for (const QString &format : m_supportedFormats) {
+    for (const QString &format : getSupportedFormats()) {
         filters << QString("*.%1").arg(format);
     }
     QString filter = QString("媒体文件 (%1);;所有文件 (*.*)").arg(filters.join(" "));
@@ -480,31 +318,21 @@ void PlaylistWidget::onClearPlaylistClicked()
 
 void PlaylistWidget::showContextMenu(const QPoint &pos)
 {
-    if (m_listWidget->itemAt(pos)) {
-        m_contextMenu->exec(m_listWidget->mapToGlobal(pos));
+    if (m_listView->indexAt(pos).isValid()) {
+        m_contextMenu->exec(m_listView->viewport()->mapToGlobal(pos));
     }
 }
 
 void PlaylistWidget::toggleFavorite()
 {
-    int currentRow = m_listWidget->currentRow();
-    if (currentRow >= 0 && currentRow < m_mediaList.size()) {
-        m_mediaList[currentRow].isFavorite = !m_mediaList[currentRow].isFavorite;
-
-        QListWidgetItem *item = m_listWidget->item(currentRow);
-        if (m_mediaList[currentRow].isFavorite) {
-            item->setIcon(QIcon("⭐"));
-        } else {
-            item->setIcon(QIcon());
-        }
-    }
+    m_controller->toggleFavorite(selectedRow());
 }
 
 void PlaylistWidget::showItemProperties()
 {
-    int currentRow = m_listWidget->currentRow();
-    if (currentRow >= 0 && currentRow < m_mediaList.size()) {
-        const MediaInfo &info = m_mediaList[currentRow];
+    int currentRow = selectedRow();
+    if (currentRow >= 0 && currentRow < m_model->rowCount()) {
+        const MediaInfo &info = m_model->mediaAt(currentRow);
 
         QString message = QString(
                               "文件路径: %1\n"
@@ -513,92 +341,115 @@ void PlaylistWidget::showItemProperties()
                               "专辑: %4\n"
                               "时长: %5\n"
                               "添加时间: %6\n"
-                              "播放次数: %7"
+                              "播放次数: %7\n"
+                              "编码: %8\n"
+                              "分辨率: %9\n"
+                              "码率: %10"
                               ).arg(info.filePath)
                               .arg(info.title.isEmpty() ? "未知" : info.title)
                               .arg(info.artist.isEmpty() ? "未知" : info.artist)
                               .arg(info.album.isEmpty() ? "未知" : info.album)
                               .arg(formatDuration(info.duration))
                               .arg(info.addTime.toString("yyyy-MM-dd hh:mm:ss"))
-                              .arg(info.playCount);
+                              .arg(info.playCount)
+                              .arg(info.codec.isEmpty() ? "未知" : info.codec)
+                              .arg(info.width > 0 ? QString("%1x%2").arg(info.width).arg(info.height) : QString("未知"))
+                              .arg(info.bitRate > 0 ? QString("%1 kbps").arg(info.bitRate / 1000) : QString("未知"));
 
         QMessageBox::information(this, "媒体文件属性", message);
     }
 }
 
-// 辅助方法
-void PlaylistWidget::updateUI()
+void PlaylistWidget::updateValidationPriority()
 {
-    m_countLabel->setText(QString("%1 个文件").arg(m_mediaList.size()));
-
-    m_removeButton->setEnabled(m_listWidget->currentRow() >= 0);
-    m_clearButton->setEnabled(!m_mediaList.isEmpty());
-
-    updatePlayModeDisplay();
-}
-
-void PlaylistWidget::updatePlayModeDisplay()
-{
-    static const QString modeIcons[] = {"▶", "🔄", "🔀", "🔂"};
-    static const QString modeNames[] = {"顺序播放", "列表循环", "随机播放", "单曲循环"};
-
-    m_playModeButton->setText(modeIcons[m_playMode]);
-    m_playModeLabel->setText(modeNames[m_playMode]);
-
-    QString tooltip = QString("当前播放模式: %1\n点击切换到下一种模式").arg(modeNames[m_playMode]);
-    m_playModeButton->setToolTip(tooltip);
+    m_controller->prioritizeValidation(visibleRows());
 }
 
-void PlaylistWidget::generateRandomOrder()
+void PlaylistWidget::onRowThumbnailReady(const QString &filePath)
 {
-    m_randomOrder.clear();
-    for (int i = 0; i < m_mediaList.size(); ++i) {
-        m_randomOrder.append(i);
+    int row = m_model->indexOf(filePath);
+    if (row < 0) {
+        return;
     }
-
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::shuffle(m_randomOrder.begin(), m_randomOrder.end(), g);
-
-    // 找到当前播放项在随机序列中的位置
-    m_randomIndex = m_randomOrder.indexOf(m_currentIndex);
-    if (m_randomIndex == -1) {
-        m_randomIndex = 0;
+    QModelIndex viewIndex = m_filterModel->mapFromSource(m_model->index(row, 0));
+    if (viewIndex.isValid()) {
+        m_listView->update(viewIndex);
     }
 }
 
-QStringList PlaylistWidget::getSupportedFormats() const
+void PlaylistWidget::retainVisibleThumbnails()
 {
-    return QStringList() << "mp4" << "avi" << "mkv" << "mov" << "wmv"
-                         << "flv" << "webm" << "m4v" << "3gp" << "ogv"
-                         << "mp3" << "wav" << "flac" << "ogg" << "aac"
-                         << "wma" << "m4a";
+    QSet<QString> visible;
+    for (int row : visibleRows()) {
+        visible.insert(m_model->mediaAt(row).filePath);
+    }
+    m_rowThumbnails->retain(visible);
 }
 
-bool PlaylistWidget::isMediaFile(const QString &filePath) const
+void PlaylistWidget::setThumbnailMemoryBudget(int megabytes)
 {
-    QString extension = QFileInfo(filePath).suffix().toLower();
-    return m_supportedFormats.contains(extension);
+    megabytes = qMax(1, megabytes);
+    m_rowThumbnails->setMemoryBudget(qint64(megabytes) * 1024 * 1024);
+    QSettings().setValue("Playlist/thumbnailCacheMB", megabytes);
 }
 
-void PlaylistWidget::extractMediaInfo(MediaInfo &info)
+int PlaylistWidget::thumbnailMemoryBudget() const
 {
-    // 这里可以使用更复杂的媒体信息提取逻辑
-    // 简化实现：从文件名尝试解析信息
-    QString baseName = QFileInfo(info.filePath).baseName();
+    return int(m_rowThumbnails->memoryBudget() / (1024 * 1024));
+}
 
-    // 尝试解析 "艺术家 - 标题" 格式
-    if (baseName.contains(" - ")) {
-        QStringList parts = baseName.split(" - ");
-        if (parts.size() >= 2) {
-            info.artist = parts[0].trimmed();
-            info.title = parts[1].trimmed();
+// 辅助方法
+int PlaylistWidget::selectedRow() const
+{
+    // 视图中的当前行（代理行号）换算为播放列表行号
+    QModelIndex viewIndex = m_listView->currentIndex();
+    return viewIndex.isValid() ? m_filterModel->mapToSource(viewIndex).row() : -1;
+}
+
+QList<int> PlaylistWidget::visibleRows() const
+{
+    // 视图中可见的行（播放列表行号）
+    QList<int> rows;
+    QRect viewportRect = m_listView->viewport()->rect();
+    QModelIndex top = m_listView->indexAt(viewportRect.topLeft());
+    if (top.isValid()) {
+        QModelIndex bottom = m_listView->indexAt(viewportRect.bottomLeft());
+        int last = bottom.isValid() ? bottom.row() : m_filterModel->rowCount() - 1;
+        for (int proxyRow = top.row(); proxyRow <= last; ++proxyRow) {
+            int row = m_filterModel->mapToSource(m_filterModel->index(proxyRow, 0)).row();
+            if (row >= 0) {
+                rows.append(row);
+            }
         }
     }
+    return rows;
+}
 
-    if (info.title.isEmpty()) {
-        info.title = baseName;
+void PlaylistWidget::updateUI()
+{
+    if (m_filterModel->isFiltering()) {
+        m_countLabel->setText(QString("%1 / %2 个文件").arg(m_filterModel->rowCount()).arg(m_model->rowCount()));
+    } else {
+        m_countLabel->setText(QString("%1 个文件").arg(m_model->rowCount()));
     }
+
+    m_removeButton->setEnabled(m_listView->currentIndex().isValid());
+    m_clearButton->setEnabled(m_model->rowCount() > 0);
+
+    updatePlayModeDisplay();
+}
+
+void PlaylistWidget::updatePlayModeDisplay()
+{
+    static const QString modeIcons[] = {"▶", "🔄", "🔀", "🔂"};
+    static const QString modeNames[] = {"顺序播放", "列表循环", "随机播放", "单曲循环"};
+
+    const PlayMode mode = getPlayMode();
+    m_playModeButton->setText(modeIcons[mode]);
+    m_playModeLabel->setText(modeNames[mode]);
+
+    QString tooltip = QString("当前播放模式: %1\n点击切换到下一种模式").arg(modeNames[mode]);
+    m_playModeButton->setToolTip(tooltip);
 }
 
 QString PlaylistWidget::formatDuration(qint64 duration) const
@@ -624,153 +475,29 @@ QString PlaylistWidget::formatDuration(qint64 duration) const
     }
 }
 
-void PlaylistWidget::savePlaylist()
-{
-    QSettings settings;
-    settings.beginGroup("Playlist");
-
-    QJsonArray jsonArray;
-    for (const MediaInfo &info : m_mediaList) {
-        jsonArray.append(info.toJson());
-    }
-
-    QJsonDocument doc(jsonArray);
-    settings.setValue("mediaList", doc.toJson(QJsonDocument::Compact));
-    settings.setValue("currentIndex", m_currentIndex);
-    settings.setValue("playMode", static_cast<int>(m_playMode));
-
-    settings.endGroup();
-}
-
 void PlaylistWidget::loadPlaylist()
 {
-    QSettings settings;
-    settings.beginGroup("Playlist");
-
-    QByteArray data = settings.value("mediaList").toByteArray();
-    if (!data.isEmpty()) {
-        QJsonDocument doc = QJsonDocument::fromJson(data);
-        QJsonArray jsonArray = doc.array();
-
-        m_mediaList.clear();
-        m_listWidget->clear();
-
-        for (const QJsonValue &value : jsonArray) {
-            MediaInfo info = MediaInfo::fromJson(value.toObject());
-            // 检查文件是否仍然存在
-            if (QFileInfo::exists(info.filePath)) {
-                m_mediaList.append(info);
-
-                QListWidgetItem *item = new QListWidgetItem(info.displayName());
-                item->setToolTip(info.filePath);
-                if (info.isFavorite) {
-                    item->setIcon(QIcon("⭐"));
-                }
-                m_listWidget->addItem(item);
-            }
-        }
-
-        m_currentIndex = settings.value("currentIndex", -1).toInt();
-        if (m_currentIndex >= m_mediaList.size()) {
-            m_currentIndex = -1;
-        }
-
-        PlayMode mode = static_cast<PlayMode>(settings.value("playMode", 0).toInt());
-        setPlayMode(mode);
-
-        if (m_currentIndex >= 0) {
-            setCurrentIndex(m_currentIndex);
-        }
-    }
-
-    settings.endGroup();
+    m_controller->load();
+    // 视图布局完成后再按可见行调整校验顺序
+    QTimer::singleShot(0, this, &PlaylistWidget::updateValidationPriority);
     updateUI();
 }
 
 void PlaylistWidget::exportPlaylist(const QString &fileName, const QString &format)
 {
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    if (!m_controller->exportPlaylist(fileName, format)) {
         QMessageBox::warning(this, "导出失败", "无法创建文件：" + fileName);
-        return;
     }
-
-    QTextStream out(&file);
-
-    if (format.toLower() == "m3u") {
-        out << "#EXTM3U" << Qt::endl;
-        for (const MediaInfo &info : m_mediaList) {
-            out << QString("#EXTINF:%1,%2 - %3")
-            .arg(info.duration / 1000)
-                    .arg(info.artist.isEmpty() ? "Unknown" : info.artist)
-                    .arg(info.title.isEmpty() ? QFileInfo(info.filePath).baseName() : info.title)
-                << Qt::endl;
-            out << info.filePath << Qt::endl;
-        }
-    } else if (format.toLower() == "pls") {
-        out << "[playlist]" << Qt::endl;
-        for (int i = 0; i < m_mediaList.size(); ++i) {
-            const MediaInfo &info = m_mediaList[i];
-            out << QString("File%1=%2").arg(i + 1).arg(info.filePath) << Qt::endl;
-            out << QString("Title%1=%2").arg(i + 1).arg(info.displayName()) << Qt::endl;
-            out << QString("Length%1=%2").arg(i + 1).arg(info.duration / 1000) << Qt::endl;
-        }
-        out << QString("NumberOfEntries=%1").arg(m_mediaList.size()) << Qt::endl;
-        out << "Version=2" << Qt::endl;
-    }
-
-    file.close();
 }
 
 void PlaylistWidget::importPlaylist(const QString &fileName)
 {
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    int imported = m_controller->importPlaylist(fileName);
+    if (imported < 0) {
         QMessageBox::warning(this, "导入失败", "无法打开文件：" + fileName);
-        return;
-    }
-
-    QTextStream in(&file);
-    QStringList filesToAdd;
-
-    QFileInfo fileInfo(fileName);
-    QString extension = fileInfo.suffix().toLower();
-
-    if (extension == "m3u" || extension == "m3u8") {
-        while (!in.atEnd()) {
-            QString line = in.readLine().trimmed();
-            if (!line.startsWith("#") && !line.isEmpty()) {
-                // 处理相对路径
-                if (QFileInfo(line).isRelative()) {
-                    line = fileInfo.absoluteDir().absoluteFilePath(line);
-                }
-                if (QFileInfo::exists(line) && isMediaFile(line)) {
-                    filesToAdd.append(line);
-                }
-            }
-        }
-    } else if (extension == "pls") {
-        while (!in.atEnd()) {
-            QString line = in.readLine().trimmed();
-            if (line.startsWith("File")) {
-                QString filePath = line.split("=", Qt::SkipEmptyParts)[1];
-                if (QFileInfo(filePath).isRelative()) {
-                    filePath = fileInfo.absoluteDir().absoluteFilePath(filePath);
-                }
-                if (QFileInfo::exists(filePath) && isMediaFile(filePath)) {
-                    filesToAdd.append(filePath);
-                }
-            }
-        }
-    }
-
-    file.close();
-
-    if (!filesToAdd.isEmpty()) {
-        addMediaList(filesToAdd);
-        QMessageBox::information(this, "导入成功", QString("成功导入 %1 个文件").arg(filesToAdd.size()));
+    } else if (imported > 0) {
+        QMessageBox::information(this, "导入成功", QString("成功导入 %1 个文件").arg(imported));
     } else {
         QMessageBox::warning(this, "导入失败", "未找到有效的媒体文件");
     }
 }
-
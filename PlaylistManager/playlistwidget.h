@@ -3,7 +3,7 @@
 #define PLAYLISTWIDGET_H
 
 #include <QWidget>
-#include <QListWidget>
+#include <QListView>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QPushButton>
@@ -17,118 +17,88 @@
 #include <QUrl>
 #include <QFileInfo>
 #include <QSettings>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-
-// 媒体项结构
-struct MediaInfo {
-    QString filePath;
-    QString title;
-    QString artist;
-    QString album;
-    qint64 duration;
-    QDateTime addTime;
-    int playCount;
-    bool isFavorite;
-
-    MediaInfo() : duration(0), playCount(0), isFavorite(false) {
-        addTime = QDateTime::currentDateTime();
-    }
-
-    QString displayName() const {
-        if (!title.isEmpty() && !artist.isEmpty()) {
-            return QString("%1 - %2").arg(artist, title);
-        }
-        return title.isEmpty() ? QFileInfo(filePath).baseName() : title;
-    }
-
-    QJsonObject toJson() const {
-        QJsonObject obj;
-        obj["filePath"] = filePath;
-        obj["title"] = title;
-        obj["artist"] = artist;
-        obj["album"] = album;
-        obj["duration"] = duration;
-        obj["addTime"] = addTime.toString(Qt::ISODate);
-        obj["playCount"] = playCount;
-        obj["isFavorite"] = isFavorite;
-        return obj;
-    }
-
-    static MediaInfo fromJson(const QJsonObject &obj) {
-        MediaInfo info;
-        info.filePath = obj["filePath"].toString();
-        info.title = obj["title"].toString();
-        info.artist = obj["artist"].toString();
-        info.album = obj["album"].toString();
-        info.duration = obj["duration"].toVariant().toLongLong();
-        info.addTime = QDateTime::fromString(obj["addTime"].toString(), Qt::ISODate);
-        info.playCount = obj["playCount"].toInt();
-        info.isFavorite = obj["isFavorite"].toBool();
-        return info;
-    }
-};
 
+#include "MediaInfo.h"
+#include "PlaylistController.h"
+#include "PlaylistFilterModel.h"
+#include "RowThumbnailCache.h"
+
+// 播放列表视图：列表、搜索、按钮和对话框。播放列表的内容、播放顺序和持久化
+// 都在 PlaylistController 中，这里的同名方法只是转发。
 class PlaylistWidget : public QWidget
 {
     Q_OBJECT
 
 public:
-    enum PlayMode {
-        Sequential = 0,  // 顺序播放
-        Loop,           // 列表循环
-        Random,         // 随机播放
-        RepeatOne       // 单曲循环
-    };
+    using PlayMode = PlaySequencer::PlayMode;
 
     explicit PlaylistWidget(QWidget *parent = nullptr);
     ~PlaylistWidget();
-    QStringList getSupportedFormats() const;
+    PlaylistController *controller() const { return m_controller; }
+    QStringList getSupportedFormats() const { return PlaylistController::supportedFormats(); }
     // 播放列表操作
-    void addMedia(const QString &filePath);
-    void addMediaList(const QStringList &filePaths);
+    void addMedia(const QString &filePath) { m_controller->addMedia(filePath); }
+    void addMediaList(const QStringList &filePaths) { m_controller->addMediaList(filePaths); }
+    // 在后台递归扫描文件夹，结果分批加入列表；之后文件夹中的变化自动同步到列表
+    void addFolders(const QStringList &folders) { m_controller->addFolders(folders); }
+    void cancelFolderScan() { m_controller->cancelFolderScan(); }
+    bool isScanningFolders() const { return m_controller->isScanningFolders(); }
     void removeCurrentItem();
+    void removeMediaList(const QStringList &filePaths) { m_controller->removeMediaList(filePaths); }
     void clearPlaylist();
-    void moveItem(int from, int to);
+    void moveItem(int from, int to) { m_controller->moveItem(from, to); }
+
+    // 批量更新：可嵌套，最外层 endUpdate() 时只发出一次 playlistChanged
+    void beginUpdate() { m_controller->beginUpdate(); }
+    void endUpdate() { m_controller->endUpdate(); }
 
     // 播放控制
-    int currentIndex() const { return m_currentIndex; }
+    int currentIndex() const { return m_controller->currentIndex(); }
     void setCurrentIndex(int index);
-    MediaInfo getCurrentMedia() const;
-    MediaInfo getMediaAt(int index) const;
-    int getMediaCount() const { return m_mediaList.size(); }
+    MediaInfo getCurrentMedia() const { return m_controller->currentMedia(); }
+    MediaInfo getMediaAt(int index) const { return m_controller->mediaAt(index); }
+    const MetadataCache &metadataCache() const { return m_controller->metadataCache(); }
+    int getMediaCount() const { return m_controller->count(); }
 
     // 播放模式
-    PlayMode getPlayMode() const { return m_playMode; }
-    void setPlayMode(PlayMode mode);
-    int getNextIndex() const;
-    int getPreviousIndex() const;
+    PlayMode getPlayMode() const { return m_controller->playMode(); }
+    void setPlayMode(PlayMode mode) { m_controller->setPlayMode(mode); }
+    int getNextIndex() const { return m_controller->nextIndex(); }
+    int getPreviousIndex() const { return m_controller->previousIndex(); }
 
     // 搜索和过滤
     void searchMedia(const QString &keyword);
     void showFavoritesOnly(bool favOnly);
 
+    // 行缩略图内存缓存上限（MB），保存到设置中
+    void setThumbnailMemoryBudget(int megabytes);
+    int thumbnailMemoryBudget() const;
+
     // 数据持久化
-    void savePlaylist();
+    void savePlaylist() { m_controller->save(); }
     void loadPlaylist();
+    // 等待操作日志在后台写盘完成
+    void waitForPendingWrites() { m_controller->waitForPendingWrites(); }
     void exportPlaylist(const QString &fileName, const QString &format = "m3u");
     void importPlaylist(const QString &fileName);
 
 signals:
     void mediaSelected(int index);
-    void playModeChanged(PlayMode mode);
+    void playModeChanged(PlaySequencer::PlayMode mode);
     void playlistChanged();
     void requestPlay();
     void requestNext();
     void requestPrevious();
+    void metadataCacheStatsChanged(int hits, int misses);
+    void folderScanProgress(int directories, int files);
+    void folderScanFinished(int files, bool cancelled);
 
 protected:
     void dragEnterEvent(QDragEnterEvent *event) override;
     void dropEvent(QDropEvent *event) override;
 
 private slots:
-    void onItemDoubleClicked(QListWidgetItem *item);
+    void onItemDoubleClicked(const QModelIndex &index);
     void onPlayModeButtonClicked();
     void onSearchTextChanged(const QString &text);
     void onAddFilesClicked();
@@ -137,6 +107,16 @@ private slots:
     void showContextMenu(const QPoint &pos);
     void toggleFavorite();
     void showItemProperties();
+    void onPlaylistChanged();
+    void onPlayModeChanged(PlaySequencer::PlayMode mode);
+    void onMediaSelected(int index);
+
+    // 后台文件校验：优先检查接下来播放的项和屏幕上的行
+    void updateValidationPriority();
+
+    // 行缩略图
+    void onRowThumbnailReady(const QString &filePath);
+    void retainVisibleThumbnails();
 
 private:
     // UI组件
@@ -153,31 +133,23 @@ private:
     QPushButton *m_removeButton;
     QPushButton *m_clearButton;
 
-    QListWidget *m_listWidget;
+    QListView *m_listView;
     QMenu *m_contextMenu;
 
     // 数据成员
-    QList<MediaInfo> m_mediaList;
-    QList<MediaInfo> m_originalList;  // 搜索前的原始列表
-    int m_currentIndex;
-    PlayMode m_playMode;
-    QList<int> m_randomOrder;  // 随机播放顺序
-    int m_randomIndex;
+    PlaylistController *m_controller;
+    PlaylistModel *m_model;              // m_controller 的模型
+    PlaylistFilterModel *m_filterModel;  // 搜索/收藏过滤，视图显示的是它
+    RowThumbnailCache *m_rowThumbnails;
     bool m_showingFavorites;
 
-    // 支持的格式
-    QStringList m_supportedFormats;
-
     // 私有方法
     void setupUI();
     void setupConnections();
     void updateUI();
+    int selectedRow() const;
+    QList<int> visibleRows() const;
     void updatePlayModeDisplay();
-    void updateItemDisplay(int index);
-    void generateRandomOrder();
-
-    bool isMediaFile(const QString &filePath) const;
-    void extractMediaInfo(MediaInfo &info);
     QString formatDuration(qint64 duration) const;
 };
 
@@ -0,0 +1,194 @@
+// ControlLatency.cpp
+#include "ControlLatency.h"
+#include <QElapsedTimer>
+#include <algorithm>
+
+ControlLatency::ControlLatency(const Options &options)
+    : m_options(options)
+    , m_out(stdout)
+    , m_events(0)
+{
+}
+
+int ControlLatency::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+    m_socket.connectToServer(m_options.serverName);
+    if (!m_socket.waitForConnected(3000)) {
+        qWarning("Cannot connect to %s: %s", qPrintable(m_options.serverName), qPrintable(m_socket.errorString()));
+        return 2;
+    }
+    m_out << QString("Connected to %1 in %2 us").arg(m_options.serverName).arg(timer.nsecsElapsed() / 1000) << Qt::endl;
+
+    m_socket.write("0 state\n");
+    QByteArray state = waitForReply("0");
+    if (state.isEmpty()) {
+        qWarning("No reply to state request");
+        return 1;
+    }
+    m_out << "Player: " << state << Qt::endl;
+
+    bool ok = measureRoundTrip() && measurePipelined();
+    if (ok && m_options.eventSeconds > 0) {
+        ok = measureEvents();
+    }
+    m_socket.disconnectFromServer();
+    return ok ? 0 : 1;
+}
+
+bool ControlLatency::measureRoundTrip()
+{
+    // 一次只有一条请求在途，测的是完整的往返延迟
+    QList<qint64> samples;
+    samples.reserve(m_options.count);
+    QElapsedTimer timer;
+    for (int i = 0; i < m_options.count; ++i) {
+        QByteArray id = "r" + QByteArray::number(i);
+        timer.start();
+        m_socket.write(id + " ping\n");
+        m_socket.flush();
+        if (waitForReply(id).isEmpty()) {
+            qWarning("Round trip %d timed out", i);
+            return false;
+        }
+        samples.append(timer.nsecsElapsed());
+    }
+    printStats("Round trip", samples);
+    return true;
+}
+
+bool ControlLatency::measurePipelined()
+{
+    // 全部请求一次写出，服务端逐条处理并合并应答
+    QByteArray batch;
+    for (int i = 0; i < m_options.count; ++i) {
+        batch += "p" + QByteArray::number(i) + " ping\n";
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    m_socket.write(batch);
+    m_socket.flush();
+    if (waitForReply("p" + QByteArray::number(m_options.count - 1), 30000).isEmpty()) {
+        qWarning("Pipelined requests timed out");
+        return false;
+    }
+    qint64 elapsed = timer.nsecsElapsed();
+    m_out << QString("Pipelined:  %1 requests in %2 ms, %3 us each, %4 requests/s")
+                 .arg(m_options.count)
+                 .arg(elapsed / 1e6, 0, 'f', 2)
+                 .arg(elapsed / 1e3 / m_options.count, 0, 'f', 2)
+                 .arg(m_options.count * 1e9 / qMax<qint64>(1, elapsed), 0, 'f', 0)
+          << Qt::endl;
+    return true;
+}
+
+bool ControlLatency::measureEvents()
+{
+    m_socket.write("s subscribe " + QByteArray::number(m_options.eventInterval) + "\n");
+    if (waitForReply("s").isEmpty()) {
+        qWarning("Subscribe failed");
+        return false;
+    }
+
+    // 按读到的数据块计数，看出服务端把多少条事件合并为一次写入
+    int events = m_events;
+    int positions = 0;
+    int reads = 0;
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 duration = qint64(m_options.eventSeconds) * 1000;
+    while (timer.elapsed() < duration) {
+        if (!m_socket.waitForReadyRead(int(duration - timer.elapsed()))) {
+            if (m_socket.state() != QLocalSocket::ConnectedState) {
+                break;
+            }
+            continue;
+        }
+        ++reads;
+        m_buffer += m_socket.readAll();
+        int end;
+        while ((end = m_buffer.indexOf('\n')) >= 0) {
+            QByteArray line = m_buffer.left(end);
+            m_buffer.remove(0, end + 1);
+            if (line.startsWith("! ")) {
+                ++events;
+                if (line.startsWith("! position")) {
+                    ++positions;
+                }
+            }
+        }
+    }
+    qint64 elapsed = qMax<qint64>(1, timer.elapsed());
+
+    m_socket.write("u unsubscribe\n");
+    waitForReply("u");
+
+    m_out << QString("Events:     %1 in %2 s (%3/s, %4 position), %5 reads, %6 events per read")
+                 .arg(events)
+                 .arg(elapsed / 1000.0, 0, 'f', 1)
+                 .arg(events * 1000.0 / elapsed, 0, 'f', 1)
+                 .arg(positions)
+                 .arg(reads)
+                 .arg(reads > 0 ? double(events) / reads : 0.0, 0, 'f', 1)
+          << Qt::endl;
+    if (positions == 0) {
+        m_out << "            (no position events; start playback to measure event throughput)" << Qt::endl;
+    }
+    return true;
+}
+
+QByteArray ControlLatency::waitForReply(const QByteArray &id, int timeout)
+{
+    QElapsedTimer timer;
+    timer.start();
+    const QByteArray prefix = id + ' ';
+    QByteArray line;
+    while (readLine(&line, int(qMax<qint64>(0, timeout - timer.elapsed())))) {
+        if (line.startsWith("! ")) {
+            ++m_events;
+        } else if (line.startsWith(prefix)) {
+            QByteArray reply = line.mid(prefix.size());
+            if (reply.startsWith("error")) {
+                qWarning("%s", reply.constData());
+            }
+            return reply;
+        }
+    }
+    return QByteArray();
+}
+
+bool ControlLatency::readLine(QByteArray *line, int timeout)
+{
+    int end;
+    while ((end = m_buffer.indexOf('\n')) < 0) {
+        if (timeout <= 0 || !m_socket.waitForReadyRead(timeout)) {
+            return false;
+        }
+        m_buffer += m_socket.readAll();
+    }
+    *line = m_buffer.left(end);
+    m_buffer.remove(0, end + 1);
+    return true;
+}
+
+void ControlLatency::printStats(const char *name, QList<qint64> samples)
+{
+    if (samples.isEmpty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        return samples.at(qMin<qsizetype>(samples.size() - 1, qsizetype(p * samples.size()))) / 1000.0;
+    };
+
+    m_out << QString("%1 %2 requests, min %3 us, median %4 us, p99 %5 us, max %6 us")
+                 .arg(QString("%1:").arg(QString::fromLatin1(name)), -11)
+                 .arg(samples.size())
+                 .arg(samples.first() / 1000.0, 0, 'f', 1)
+                 .arg(percentile(0.5), 0, 'f', 1)
+                 .arg(percentile(0.99), 0, 'f', 1)
+                 .arg(samples.last() / 1000.0, 0, 'f', 1)
+          << Qt::endl;
+}
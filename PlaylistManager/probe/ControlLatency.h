@@ -0,0 +1,45 @@
+// ControlLatency.h
+#ifndef CONTROLLATENCY_H
+#define CONTROLLATENCY_H
+
+#include <QLocalSocket>
+#include <QList>
+#include <QTextStream>
+
+// 控制接口的测试客户端
+// 连接正在运行的播放器（PlaylistManager --control），依次测量：
+// 逐条发送的往返延迟、一次写入多条请求时每条的平均耗时，以及订阅后的事件吞吐量。
+class ControlLatency
+{
+public:
+    struct Options {
+        QString serverName;
+        int count;              // 每项测量的请求数
+        int eventSeconds;       // 事件吞吐量的测量时长，0 表示跳过
+        int eventInterval;      // 订阅时请求的事件合并间隔（毫秒）
+
+        Options() : count(1000), eventSeconds(5), eventInterval(0) {}
+    };
+
+    explicit ControlLatency(const Options &options);
+
+    // 返回进程退出码
+    int run();
+
+private:
+    Options m_options;
+    QLocalSocket m_socket;
+    QTextStream m_out;
+    QByteArray m_buffer;    // 已读入但尚未处理的数据
+    int m_events;           // 等待应答期间收到的事件
+
+    bool measureRoundTrip();
+    bool measurePipelined();
+    bool measureEvents();
+    // 读到 id 对应的应答为止，返回应答内容；超时或出错时返回空
+    QByteArray waitForReply(const QByteArray &id, int timeout = 5000);
+    bool readLine(QByteArray *line, int timeout);
+    void printStats(const char *name, QList<qint64> samples);
+};
+
+#endif // CONTROLLATENCY_H
@@ -0,0 +1,208 @@
+// DecodeCheck.cpp
+#include "DecodeCheck.h"
+#include <QMediaMetaData>
+#include <QAudioBuffer>
+#include <QSize>
+
+namespace {
+// QMediaPlayer 没有不受时钟限制的解码模式，用可设置的最高速率代替。
+// 跟不上这个速率时播放器会跳帧，所以计数的是送达的帧，结果中与标称帧数比较
+const qreal kVideoDecodeRate = 16.0;
+}
+
+DecodeCheck::DecodeCheck(int stallTimeout, QObject *parent)
+    : QObject(parent)
+    , m_player(nullptr)
+    , m_videoSink(nullptr)
+    , m_audioDecoder(nullptr)
+    , m_watchdog(new QTimer(this))
+    , m_stage(Idle)
+    , m_fullDecode(false)
+    , m_videoPending(false)
+    , m_audioPending(false)
+{
+    m_watchdog->setSingleShot(true);
+    m_watchdog->setInterval(stallTimeout);
+    connect(m_watchdog, &QTimer::timeout, this, &DecodeCheck::onStalled);
+}
+
+void DecodeCheck::createDecoders()
+{
+    m_player = new QMediaPlayer(this);
+    m_videoSink = new QVideoSink(this);
+    m_audioDecoder = new QAudioDecoder(this);
+
+    connect(m_player, &QMediaPlayer::mediaStatusChanged, this, &DecodeCheck::onMediaStatusChanged);
+    connect(m_player, &QMediaPlayer::errorOccurred, this, &DecodeCheck::onPlayerError);
+    connect(m_videoSink, &QVideoSink::videoFrameChanged, this, &DecodeCheck::onVideoFrame);
+    connect(m_audioDecoder, &QAudioDecoder::bufferReady, this, &DecodeCheck::onAudioBufferReady);
+    connect(m_audioDecoder, &QAudioDecoder::finished, this, &DecodeCheck::onAudioFinished);
+    connect(m_audioDecoder, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error),
+            this, &DecodeCheck::onAudioError);
+}
+
+void DecodeCheck::check(int index, const QString &filePath, bool fullDecode)
+{
+    if (!m_player) {
+        createDecoders();
+    }
+
+    m_result = DecodeResult();
+    m_result.index = index;
+    m_result.filePath = filePath;
+    m_fullDecode = fullDecode;
+    m_videoPending = false;
+    m_audioPending = false;
+    m_stage = Probing;
+
+    m_timer.start();
+    m_watchdog->start();
+    m_player->setSource(QUrl::fromLocalFile(filePath));
+}
+
+void DecodeCheck::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
+{
+    if (m_stage == Probing) {
+        if (status == QMediaPlayer::LoadedMedia) {
+            readMetadata();
+            if (!m_result.hasVideo && !m_result.hasAudio) {
+                finish("no audio or video stream");
+            } else if (m_fullDecode) {
+                startDecoding();
+            } else {
+                finish();
+            }
+        } else if (status == QMediaPlayer::InvalidMedia) {
+            finish(m_player->errorString().isEmpty() ? QString("invalid media") : m_player->errorString());
+        }
+    } else if (m_stage == Decoding && m_videoPending) {
+        if (status == QMediaPlayer::EndOfMedia) {
+            m_videoPending = false;
+            finishStream();
+        } else if (status == QMediaPlayer::InvalidMedia) {
+            finish("video decoding failed");
+        }
+    }
+}
+
+void DecodeCheck::onPlayerError(QMediaPlayer::Error error, const QString &errorString)
+{
+    if (m_stage != Idle && error != QMediaPlayer::NoError) {
+        finish(errorString);
+    }
+}
+
+void DecodeCheck::readMetadata()
+{
+    const QMediaMetaData meta = m_player->metaData();
+
+    m_result.duration = m_player->duration();
+    if (m_result.duration <= 0) {
+        m_result.duration = meta.value(QMediaMetaData::Duration).toLongLong();
+    }
+    m_result.hasVideo = m_player->hasVideo();
+    m_result.hasAudio = m_player->hasAudio();
+
+    QString videoCodec = meta.stringValue(QMediaMetaData::VideoCodec);
+    QString audioCodec = meta.stringValue(QMediaMetaData::AudioCodec);
+    if (!videoCodec.isEmpty() && !audioCodec.isEmpty()) {
+        m_result.codec = QString("%1/%2").arg(videoCodec, audioCodec);
+    } else {
+        m_result.codec = videoCodec.isEmpty() ? audioCodec : videoCodec;
+    }
+
+    QSize resolution = meta.value(QMediaMetaData::Resolution).toSize();
+    m_result.width = resolution.width();
+    m_result.height = resolution.height();
+    m_result.frameRate = meta.value(QMediaMetaData::VideoFrameRate).toReal();
+}
+
+void DecodeCheck::startDecoding()
+{
+    m_stage = Decoding;
+    m_watchdog->start();
+
+    if (m_result.hasAudio) {
+        m_audioPending = true;
+        m_audioDecoder->setSource(QUrl::fromLocalFile(m_result.filePath));
+        m_audioDecoder->start();
+    }
+
+    if (m_result.hasVideo) {
+        // 没有音频输出，视频只受播放速率限制
+        m_videoPending = true;
+        m_player->setVideoSink(m_videoSink);
+        m_player->setPlaybackRate(kVideoDecodeRate);
+        m_player->play();
+    }
+}
+
+void DecodeCheck::onVideoFrame()
+{
+    if (m_stage == Decoding && m_videoPending) {
+        ++m_result.videoFrames;
+        m_watchdog->start();
+    }
+}
+
+void DecodeCheck::onAudioBufferReady()
+{
+    // 读出缓冲区，解码器才会继续
+    QAudioBuffer buffer = m_audioDecoder->read();
+    if (m_stage == Decoding && m_audioPending) {
+        m_result.audioDecoded += buffer.duration() / 1000;
+        m_watchdog->start();
+    }
+}
+
+void DecodeCheck::onAudioFinished()
+{
+    if (m_stage == Decoding && m_audioPending) {
+        m_audioPending = false;
+        finishStream();
+    }
+}
+
+void DecodeCheck::onAudioError(QAudioDecoder::Error error)
+{
+    if (m_stage == Decoding && m_audioPending && error != QAudioDecoder::NoError) {
+        finish(m_audioDecoder->errorString());
+    }
+}
+
+void DecodeCheck::onStalled()
+{
+    if (m_stage == Probing) {
+        finish("timed out while opening");
+    } else if (m_stage == Decoding) {
+        finish("decoding stalled");
+    }
+}
+
+void DecodeCheck::finishStream()
+{
+    if (!m_videoPending && !m_audioPending) {
+        m_result.decoded = true;
+        finish();
+    }
+}
+
+void DecodeCheck::finish(const QString &error)
+{
+    m_watchdog->stop();
+    m_stage = Idle;
+    m_result.ok = error.isEmpty();
+    m_result.error = error;
+    m_result.elapsed = m_timer.elapsed();
+
+    DecodeResult result = m_result;
+
+    // 释放文件句柄和解码器
+    m_audioDecoder->stop();
+    m_player->stop();
+    m_player->setVideoSink(nullptr);
+    m_player->setPlaybackRate(1.0);
+    m_player->setSource(QUrl());
+
+    emit checked(result);
+}
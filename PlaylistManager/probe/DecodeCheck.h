@@ -0,0 +1,101 @@
+// DecodeCheck.h
+#ifndef DECODECHECK_H
+#define DECODECHECK_H
+
+#include <QObject>
+#include <QMediaPlayer>
+#include <QAudioDecoder>
+#include <QVideoSink>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QUrl>
+
+// 单个文件的检查结果
+struct DecodeResult {
+    int index;
+    QString filePath;
+    bool ok;
+    QString error;
+
+    // 探测
+    qint64 duration;        // 毫秒
+    bool hasVideo;
+    bool hasAudio;
+    QString codec;
+    int width;
+    int height;
+    double frameRate;       // 标称帧率，0 表示未知
+
+    // 完整解码
+    bool decoded;
+    qint64 videoFrames;     // 实际送到视频输出的帧数，高速率播放时播放器可能跳帧
+    qint64 audioDecoded;    // 已解码的音频时长（毫秒）
+    qint64 elapsed;         // 探测加解码的总耗时（毫秒）
+
+    DecodeResult() : index(-1), ok(false), duration(0), hasVideo(false), hasAudio(false),
+                     width(0), height(0), frameRate(0), decoded(false), videoFrames(0), audioDecoded(0), elapsed(0) {}
+
+    // 每秒送到视频输出的帧数（不是解码速度：跳过的帧不计）
+    double deliveredFramesPerSecond() const { return elapsed > 0 ? videoFrames * 1000.0 / elapsed : 0.0; }
+    // 按时长和标称帧率应有的帧数，帧率未知时为 0
+    qint64 expectedFrames() const { return frameRate > 0 ? qRound64(duration * frameRate / 1000.0) : 0; }
+    // 送达的帧数少于应有的 90%：播放器跳了帧，或者文件中缺帧
+    bool framesShort() const { return expectedFrames() > 0 && videoFrames * 10 < expectedFrames() * 9; }
+    // 解码速度相对实时播放的倍数
+    double speed() const { return elapsed > 0 ? double(duration) / elapsed : 0.0; }
+};
+
+Q_DECLARE_METATYPE(DecodeResult)
+
+// 可播放性检查，运行在自己的工作线程中
+// 先用不带输出的 QMediaPlayer 打开文件读取流信息；需要完整解码时，音频由
+// QAudioDecoder 不受时钟限制地解码到结尾，视频由静音的 QMediaPlayer 以最高
+// 播放速率送到 QVideoSink 并计数，两者同时进行。一段时间内没有任何进展视为卡死。
+class DecodeCheck : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DecodeCheck(int stallTimeout, QObject *parent = nullptr);
+
+    // 同一时间只检查一个文件，完成后发出 checked；fullDecode 为 false 时只探测
+    void check(int index, const QString &filePath, bool fullDecode);
+
+signals:
+    void checked(const DecodeResult &result);
+
+private slots:
+    void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
+    void onPlayerError(QMediaPlayer::Error error, const QString &errorString);
+    void onVideoFrame();
+    void onAudioBufferReady();
+    void onAudioFinished();
+    void onAudioError(QAudioDecoder::Error error);
+    void onStalled();
+
+private:
+    enum Stage {
+        Idle,
+        Probing,
+        Decoding
+    };
+
+    QMediaPlayer *m_player;         // 在工作线程中首次检查时创建
+    QVideoSink *m_videoSink;
+    QAudioDecoder *m_audioDecoder;
+    QTimer *m_watchdog;
+    QElapsedTimer m_timer;
+    DecodeResult m_result;
+    Stage m_stage;
+    bool m_fullDecode;
+    bool m_videoPending;
+    bool m_audioPending;
+
+    void createDecoders();
+    void readMetadata();
+    void startDecoding();
+    void finishStream();
+    void finish(const QString &error = QString());
+};
+
+#endif // DECODECHECK_H
@@ -0,0 +1,241 @@
+// ProbeRunner.cpp
+#include "ProbeRunner.h"
+#include <QCoreApplication>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QMetaObject>
+#include <algorithm>
+#include <utility>
+
+namespace {
+// 每个工作线程持有一个 QMediaPlayer 和一个 QAudioDecoder，数量不宜超过核数
+const int kMaxJobs = 64;
+}
+
+ProbeRunner::ProbeRunner(const QStringList &files, const Options &options, QObject *parent)
+    : QObject(parent)
+    , m_files(files)
+    , m_options(options)
+    , m_nextFile(0)
+    , m_completed(0)
+    , m_failed(0)
+    , m_out(stdout)
+{
+    qRegisterMetaType<DecodeResult>();
+
+    int jobs = m_options.jobs;
+    if (jobs <= 0) {
+        jobs = qMax(1, QThread::idealThreadCount() / 2);
+    }
+    jobs = qBound(1, qMin(jobs, int(m_files.size())), kMaxJobs);
+
+    for (int i = 0; i < jobs; ++i) {
+        Worker worker;
+        worker.thread = new QThread(this);
+        worker.thread->setObjectName(QString("DecodeCheck-%1").arg(i));
+        worker.check = new DecodeCheck(m_options.stallTimeout);
+        worker.check->moveToThread(worker.thread);
+        worker.busy = false;
+
+        connect(worker.thread, &QThread::finished, worker.check, &QObject::deleteLater);
+        connect(worker.check, &DecodeCheck::checked, this, [this, i](const DecodeResult &result) {
+            onChecked(i, result);
+        });
+
+        m_workers.append(worker);
+        worker.thread->start();
+    }
+    m_results.resize(m_files.size());
+}
+
+ProbeRunner::~ProbeRunner()
+{
+    for (const Worker &worker : std::as_const(m_workers)) {
+        worker.thread->quit();
+    }
+    for (const Worker &worker : std::as_const(m_workers)) {
+        worker.thread->wait();
+    }
+}
+
+void ProbeRunner::start()
+{
+    m_out << QString("Checking %1 files with %2 workers (%3)")
+                 .arg(m_files.size())
+                 .arg(m_workers.size())
+                 .arg(m_options.fullDecode ? "full decode" : "probe only")
+          << Qt::endl;
+
+    m_timer.start();
+    if (m_files.isEmpty()) {
+        finish();
+        return;
+    }
+    dispatch();
+}
+
+void ProbeRunner::dispatch()
+{
+    for (int i = 0; i < m_workers.size() && m_nextFile < m_files.size(); ++i) {
+        Worker &worker = m_workers[i];
+        if (worker.busy) {
+            continue;
+        }
+
+        worker.busy = true;
+        int index = m_nextFile++;
+        DecodeCheck *check = worker.check;
+        QString filePath = m_files.at(index);
+        bool fullDecode = m_options.fullDecode;
+        QMetaObject::invokeMethod(check, [check, index, filePath, fullDecode]() {
+            check->check(index, filePath, fullDecode);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void ProbeRunner::onChecked(int workerIndex, const DecodeResult &result)
+{
+    m_workers[workerIndex].busy = false;
+
+    m_results[result.index] = result;
+    ++m_completed;
+    if (!result.ok) {
+        ++m_failed;
+    }
+    printResult(result);
+
+    if (m_completed == m_files.size()) {
+        finish();
+    } else {
+        dispatch();
+    }
+}
+
+void ProbeRunner::printResult(const DecodeResult &result)
+{
+    if (m_options.quiet && result.ok) {
+        return;
+    }
+
+    QString progress = QString("[%1/%2]").arg(m_completed, QString::number(m_files.size()).size()).arg(m_files.size());
+    if (!result.ok) {
+        m_out << progress << " FAIL " << result.filePath << ": " << result.error << Qt::endl;
+        return;
+    }
+
+    QString details;
+    if (result.decoded) {
+        details = QString("%1 ms, %2x realtime").arg(result.elapsed).arg(result.speed(), 0, 'f', 1);
+        if (result.hasVideo) {
+            details += QString(", %1 frames delivered").arg(result.videoFrames);
+            if (result.expectedFrames() > 0) {
+                details += QString(" of %1 expected").arg(result.expectedFrames());
+            }
+            details += QString(", %1 delivered fps").arg(result.deliveredFramesPerSecond(), 0, 'f', 1);
+            if (result.framesShort()) {
+                details += ", SHORT";
+            }
+        }
+    } else {
+        details = QString("%1 ms").arg(result.elapsed);
+    }
+    m_out << progress << " OK   " << result.filePath << " (" << details << ")" << Qt::endl;
+}
+
+void ProbeRunner::finish()
+{
+    qint64 elapsed = m_timer.elapsed();
+
+    qint64 mediaDuration = 0;
+    qint64 videoFrames = 0;
+    int shortFiles = 0;
+    for (const DecodeResult &result : std::as_const(m_results)) {
+        if (result.ok) {
+            mediaDuration += result.duration;
+            videoFrames += result.videoFrames;
+            if (result.framesShort()) {
+                ++shortFiles;
+            }
+        }
+    }
+
+    m_out << QString("%1 checked, %2 failed in %3 s")
+                 .arg(m_completed).arg(m_failed).arg(elapsed / 1000.0, 0, 'f', 1);
+    if (m_options.fullDecode && elapsed > 0) {
+        m_out << QString(", %1 h of media, %2 delivered frames/s overall")
+                     .arg(mediaDuration / 3600000.0, 0, 'f', 2)
+                     .arg(videoFrames * 1000.0 / elapsed, 0, 'f', 1);
+        if (shortFiles > 0) {
+            m_out << QString(", %1 with fewer frames than expected").arg(shortFiles);
+        }
+    }
+    m_out << Qt::endl;
+
+    int exitCode = m_failed > 0 ? 1 : 0;
+    if (!m_options.reportFile.isEmpty() && !writeReport(elapsed)) {
+        qWarning("Cannot write report %s", qPrintable(m_options.reportFile));
+        exitCode = 2;
+    }
+    emit finished(exitCode);
+}
+
+bool ProbeRunner::writeReport(qint64 elapsed)
+{
+    QJsonArray results;
+    for (const DecodeResult &result : std::as_const(m_results)) {
+        results.append(resultToJson(result));
+    }
+
+    QJsonObject root;
+    root["tool"] = QCoreApplication::applicationName();
+    root["version"] = 1;
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["mode"] = m_options.fullDecode ? "decode" : "probe";
+    root["jobs"] = int(m_workers.size());
+    root["files"] = int(m_files.size());
+    root["failed"] = m_failed;
+    root["elapsedMs"] = elapsed;
+    root["results"] = results;
+
+    QSaveFile output(m_options.reportFile);
+    if (!output.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    output.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    return output.commit();
+}
+
+QJsonObject ProbeRunner::resultToJson(const DecodeResult &result)
+{
+    QJsonObject obj;
+    obj["filePath"] = result.filePath;
+    obj["ok"] = result.ok;
+    if (!result.ok) {
+        obj["error"] = result.error;
+    }
+    obj["duration"] = result.duration;
+    obj["hasVideo"] = result.hasVideo;
+    obj["hasAudio"] = result.hasAudio;
+    obj["codec"] = result.codec;
+    if (result.width > 0) {
+        obj["width"] = result.width;
+        obj["height"] = result.height;
+    }
+    if (result.frameRate > 0) {
+        obj["frameRate"] = result.frameRate;
+    }
+    obj["elapsedMs"] = result.elapsed;
+    if (result.decoded) {
+        obj["videoFrames"] = result.videoFrames;
+        if (result.expectedFrames() > 0) {
+            obj["expectedFrames"] = result.expectedFrames();
+            obj["framesShort"] = result.framesShort();
+        }
+        obj["audioDecodedMs"] = result.audioDecoded;
+        obj["deliveredFps"] = result.deliveredFramesPerSecond();
+        obj["speed"] = result.speed();
+    }
+    return obj;
+}
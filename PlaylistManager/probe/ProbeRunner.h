@@ -0,0 +1,67 @@
+// ProbeRunner.h
+#ifndef PROBERUNNER_H
+#define PROBERUNNER_H
+
+#include <QObject>
+#include <QThread>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include "DecodeCheck.h"
+
+// 命令行检查工具的调度器
+// 每个工作线程持有一个 DecodeCheck，同一时间只检查一个文件；检查完成后立即
+// 分派下一个，结果逐行输出，全部完成后输出汇总并可写成 JSON 报告。
+class ProbeRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        bool fullDecode;
+        int jobs;
+        int stallTimeout;       // 毫秒
+        QString reportFile;     // 为空时不写 JSON 报告
+        bool quiet;             // 只输出失败的文件和汇总
+
+        Options() : fullDecode(true), jobs(0), stallTimeout(30000), quiet(false) {}
+    };
+
+    ProbeRunner(const QStringList &files, const Options &options, QObject *parent = nullptr);
+    ~ProbeRunner();
+
+    // 开始检查；全部完成后发出 finished，参数为进程退出码
+    void start();
+
+signals:
+    void finished(int exitCode);
+
+private:
+    struct Worker {
+        QThread *thread;
+        DecodeCheck *check;
+        bool busy;
+    };
+
+    QStringList m_files;
+    Options m_options;
+    QList<Worker> m_workers;
+    int m_nextFile;
+    int m_completed;
+    int m_failed;
+    QList<DecodeResult> m_results;
+    QElapsedTimer m_timer;
+    QTextStream m_out;
+
+    void onChecked(int workerIndex, const DecodeResult &result);
+    void dispatch();
+    void printResult(const DecodeResult &result);
+    void finish();
+    bool writeReport(qint64 elapsed);
+    static QJsonObject resultToJson(const DecodeResult &result);
+};
+
+#endif // PROBERUNNER_H
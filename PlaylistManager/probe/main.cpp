@@ -0,0 +1,141 @@
+// main.cpp
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSet>
+#include <QTimer>
+#include "PlaylistController.h"
+#include "PlaylistIO.h"
+#include "ProbeRunner.h"
+#include "ControlLatency.h"
+#include "ControlServer.h"
+
+namespace {
+const QStringList kPlaylistFormats = {"m3u", "m3u8", "pls", "json"};
+
+// 命令行参数可以是媒体文件、目录（递归）或播放列表，展开为去重后的文件列表
+QStringList collectFiles(const QStringList &arguments, bool *ok)
+{
+    const QStringList formats = PlaylistController::supportedFormats();
+
+    QStringList files;
+    QSet<QString> seen;
+    auto append = [&](const QString &filePath) {
+        QString absolutePath = QFileInfo(filePath).absoluteFilePath();
+        if (!seen.contains(absolutePath)) {
+            seen.insert(absolutePath);
+            files.append(absolutePath);
+        }
+    };
+
+    *ok = true;
+    for (const QString &argument : arguments) {
+        QFileInfo fileInfo(argument);
+        if (fileInfo.isDir()) {
+            QDirIterator it(argument, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                QString filePath = it.next();
+                if (formats.contains(it.fileInfo().suffix().toLower())) {
+                    append(filePath);
+                }
+            }
+        } else if (kPlaylistFormats.contains(fileInfo.suffix().toLower())) {
+            // 与播放器共用导入代码；列表中不存在的文件也保留，检查时报告
+            QList<MediaInfo> items;
+            QString errorString;
+            if (!PlaylistIO::importPlaylist(argument, &items, nullptr, &errorString)) {
+                qWarning("Cannot read playlist %s: %s", qPrintable(argument), qPrintable(errorString));
+                *ok = false;
+                continue;
+            }
+            for (const MediaInfo &item : std::as_const(items)) {
+                append(item.filePath);
+            }
+        } else if (fileInfo.isFile()) {
+            append(argument);
+        } else {
+            qWarning("No such file or directory: %s", qPrintable(argument));
+            *ok = false;
+        }
+    }
+    return files;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    // 在无显示器的机器上运行，视频帧不需要窗口系统
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+
+    app.setApplicationName("PlayerProbe");
+    app.setApplicationVersion("1.0");
+    app.setOrganizationName("Qt6教程");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("检查媒体文件能否播放：探测流信息，并以最快速度完整解码。");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("inputs", "媒体文件、目录（递归）或播放列表（M3U/PLS/JSON）。", "inputs...");
+    QCommandLineOption probeOption("probe", "只探测流信息，不完整解码。");
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", "并行检查的文件数（默认为核数的一半）。", "n", "0");
+    QCommandLineOption timeoutOption("timeout", "多少秒没有解码进展视为卡死（默认 30）。", "seconds", "30");
+    QCommandLineOption reportOption("report", "把每个文件的结果写入 <file>（JSON）。", "file");
+    QCommandLineOption quietOption(QStringList() << "q" << "quiet", "只输出失败的文件和汇总。");
+    QCommandLineOption latencyOption("control-latency",
+                                     "连接正在运行的播放器（PlaylistManager --control），测量控制接口的延迟和事件吞吐量。");
+    QCommandLineOption serverOption("server", "控制接口的名称（默认按用户区分）。", "name",
+                                    ControlServer::defaultServerName());
+    QCommandLineOption countOption("count", "延迟测量的请求数（默认 1000）。", "n", "1000");
+    QCommandLineOption eventSecondsOption("event-seconds", "事件吞吐量的测量时长（默认 5 秒，0 跳过）。", "seconds", "5");
+    QCommandLineOption eventIntervalOption("event-interval", "订阅时请求的事件合并间隔（毫秒，默认 0）。", "ms", "0");
+    parser.addOption(probeOption);
+    parser.addOption(jobsOption);
+    parser.addOption(timeoutOption);
+    parser.addOption(reportOption);
+    parser.addOption(quietOption);
+    parser.addOption(latencyOption);
+    parser.addOption(serverOption);
+    parser.addOption(countOption);
+    parser.addOption(eventSecondsOption);
+    parser.addOption(eventIntervalOption);
+    parser.process(app);
+
+    if (parser.isSet(latencyOption)) {
+        ControlLatency::Options options;
+        options.serverName = parser.value(serverOption);
+        options.count = qMax(1, parser.value(countOption).toInt());
+        options.eventSeconds = qMax(0, parser.value(eventSecondsOption).toInt());
+        options.eventInterval = qMax(0, parser.value(eventIntervalOption).toInt());
+        return ControlLatency(options).run();
+    }
+
+    if (parser.positionalArguments().isEmpty()) {
+        parser.showHelp(2);
+    }
+
+    bool inputsOk = false;
+    const QStringList files = collectFiles(parser.positionalArguments(), &inputsOk);
+
+    ProbeRunner::Options options;
+    options.fullDecode = !parser.isSet(probeOption);
+    options.jobs = parser.value(jobsOption).toInt();
+    options.stallTimeout = qMax(1, parser.value(timeoutOption).toInt()) * 1000;
+    options.reportFile = parser.value(reportOption);
+    options.quiet = parser.isSet(quietOption);
+
+    ProbeRunner runner(files, options);
+    int exitCode = 0;
+    QObject::connect(&runner, &ProbeRunner::finished, &app, [&](int code) {
+        exitCode = code;
+        app.quit();
+    });
+    QTimer::singleShot(0, &runner, &ProbeRunner::start);
+    app.exec();
+
+    // 无法读取的输入也算失败
+    return (exitCode == 0 && !inputsOk) ? 1 : exitCode;
+}
@@ -0,0 +1,88 @@
+// tst_controlserver.cpp
+#include <QtTest>
+#include <QLocalSocket>
+#include <QStandardPaths>
+#include "ControlServer.h"
+
+namespace {
+const int kInterval = 200;
+const int kBurstMsecs = 1000;
+const int kPositionStep = 5;
+const int kTimeout = 5000;
+}
+
+class TestControlServer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void positionEventsCoalesced();
+
+private:
+    QStringList readLines(QLocalSocket *socket);
+    QByteArray m_buffer;
+};
+
+void TestControlServer::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+QStringList TestControlServer::readLines(QLocalSocket *socket)
+{
+    m_buffer += socket->readAll();
+    QStringList lines;
+    int end;
+    while ((end = m_buffer.indexOf('\n')) >= 0) {
+        lines.append(QString::fromUtf8(m_buffer.left(end)));
+        m_buffer.remove(0, end + 1);
+    }
+    return lines;
+}
+
+void TestControlServer::positionEventsCoalesced()
+{
+    PlaybackEngine engine;
+    PlaylistController playlist;
+    ControlServer server(&engine, &playlist);
+    QString name = QString("tst_controlserver-%1").arg(QCoreApplication::applicationPid());
+    QString errorString;
+    QVERIFY2(server.listen(name, &errorString), qPrintable(errorString));
+
+    QLocalSocket socket;
+    socket.connectToServer(name);
+    QVERIFY(socket.waitForConnected(kTimeout));
+    socket.write("1 subscribe " + QByteArray::number(kInterval) + "\n");
+
+    // 应答在前，订阅时的初始状态和位置紧随其后
+    QStringList lines;
+    QTRY_VERIFY_WITH_TIMEOUT((lines += readLines(&socket), lines.size() >= 3), kTimeout);
+    QCOMPARE(lines.at(0), QString("1 ok"));
+    QVERIFY(lines.at(1).startsWith("! state "));
+    QVERIFY(lines.at(2).startsWith("! position "));
+
+    // 每 5ms 一次位置变化，持续 1 秒：按 200ms 的订阅间隔合并成五六个事件
+    QElapsedTimer timer;
+    timer.start();
+    int positions = 0;
+    while (timer.elapsed() < kBurstMsecs) {
+        emit engine.positionChanged(timer.elapsed());
+        QTest::qWait(kPositionStep);
+        for (const QString &line : readLines(&socket)) {
+            positions += line.startsWith("! position ") ? 1 : 0;
+        }
+    }
+    QTest::qWait(kInterval * 2);
+    for (const QString &line : readLines(&socket)) {
+        positions += line.startsWith("! position ") ? 1 : 0;
+    }
+
+    const int expected = kBurstMsecs / kInterval;
+    QVERIFY2(positions >= expected - 2 && positions <= expected + 2,
+             qPrintable(QString("%1 position events").arg(positions)));
+}
+
+// PlaybackEngine 中的 QMediaPlayer 需要 QGuiApplication
+QTEST_MAIN(TestControlServer)
+#include "tst_controlserver.moc"
@@ -0,0 +1,132 @@
+// tst_crossfademixer.cpp
+#include <QtTest>
+#include <QtMath>
+#include <vector>
+#include "CrossfadeMixer.h"
+
+namespace {
+const float kEpsilon = 1e-5f;
+const int kChannels = 2;
+const qint64 kRampFrames = 48000;       // 1 秒
+}
+
+class TestCrossfadeMixer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void gain_data();
+    void gain();
+    void rampSamples_data();
+    void rampSamples();
+    void blocksMatchSingleCall();
+    void pastRampIsIncomingOnly();
+};
+
+void TestCrossfadeMixer::gain_data()
+{
+    QTest::addColumn<qreal>("progress");
+    QTest::addColumn<float>("in");
+    QTest::addColumn<float>("out");
+
+    QTest::newRow("start") << qreal(0.0) << 0.0f << 1.0f;
+    QTest::newRow("one third") << qreal(1.0 / 3) << 0.5f << 0.8660254f;
+    QTest::newRow("midpoint") << qreal(0.5) << 0.7071068f << 0.7071068f;
+    QTest::newRow("two thirds") << qreal(2.0 / 3) << 0.8660254f << 0.5f;
+    QTest::newRow("end") << qreal(1.0) << 1.0f << 0.0f;
+    QTest::newRow("before start") << qreal(-0.5) << 0.0f << 1.0f;
+    QTest::newRow("past end") << qreal(1.5) << 1.0f << 0.0f;
+}
+
+void TestCrossfadeMixer::gain()
+{
+    QFETCH(qreal, progress);
+    QFETCH(float, in);
+    QFETCH(float, out);
+
+    CrossfadeMixer::Gain gain = CrossfadeMixer::gain(progress);
+    QVERIFY(qAbs(gain.in - in) < kEpsilon);
+    QVERIFY(qAbs(gain.out - out) < kEpsilon);
+    // 等功率：任何位置两路功率之和都是 1
+    QVERIFY(qAbs(gain.in * gain.in + gain.out * gain.out - 1.0f) < kEpsilon);
+}
+
+void TestCrossfadeMixer::rampSamples_data()
+{
+    QTest::addColumn<qint64>("frame");
+
+    QTest::newRow("first") << qint64(0);
+    QTest::newRow("second") << qint64(1);
+    QTest::newRow("block boundary") << qint64(255);
+    QTest::newRow("one third") << kRampFrames / 3;
+    QTest::newRow("midpoint") << kRampFrames / 2;
+    QTest::newRow("last") << kRampFrames - 1;
+}
+
+void TestCrossfadeMixer::rampSamples()
+{
+    QFETCH(qint64, frame);
+
+    // 上一项左右声道为 1 和 -1，下一项为 0.5 和 0.25，逐个采样核对增益
+    std::vector<float> out(kRampFrames * kChannels);
+    std::vector<float> in(kRampFrames * kChannels);
+    std::vector<float> mixed(kRampFrames * kChannels);
+    for (qint64 i = 0; i < kRampFrames; ++i) {
+        out[i * 2] = 1.0f;
+        out[i * 2 + 1] = -1.0f;
+        in[i * 2] = 0.5f;
+        in[i * 2 + 1] = 0.25f;
+    }
+    CrossfadeMixer::mix(out.data(), in.data(), mixed.data(), int(kRampFrames), kChannels, 0, kRampFrames);
+
+    double t = double(frame) / kRampFrames;
+    float gainOut = float(qCos(t * M_PI_2));
+    float gainIn = float(qSin(t * M_PI_2));
+    QVERIFY(qAbs(mixed[frame * 2] - (gainOut + 0.5f * gainIn)) < kEpsilon);
+    QVERIFY(qAbs(mixed[frame * 2 + 1] - (-gainOut + 0.25f * gainIn)) < kEpsilon);
+}
+
+void TestCrossfadeMixer::blocksMatchSingleCall()
+{
+    // 音频输出每次取的长度不定，分块混合必须与一次混合逐采样一致（向量和标量路径只差舍入）
+    const int frames = 10007;
+    std::vector<float> out(frames * kChannels);
+    std::vector<float> in(frames * kChannels);
+    for (int i = 0; i < frames * kChannels; ++i) {
+        out[i] = float(qSin(i * 0.01));
+        in[i] = float(qCos(i * 0.013));
+    }
+
+    std::vector<float> whole(frames * kChannels);
+    CrossfadeMixer::mix(out.data(), in.data(), whole.data(), frames, kChannels, 1000, kRampFrames);
+
+    std::vector<float> pieces(frames * kChannels);
+    const int sizes[] = {1, 3, 255, 256, 257, 1023, 4096};
+    int done = 0;
+    for (int i = 0; done < frames; ++i) {
+        int count = qMin(sizes[i % 7], frames - done);
+        int offset = done * kChannels;
+        CrossfadeMixer::mix(out.data() + offset, in.data() + offset, pieces.data() + offset, count, kChannels,
+                            1000 + done, kRampFrames);
+        done += count;
+    }
+
+    for (int i = 0; i < frames * kChannels; ++i) {
+        QVERIFY(qAbs(pieces[i] - whole[i]) < kEpsilon);
+    }
+}
+
+void TestCrossfadeMixer::pastRampIsIncomingOnly()
+{
+    const int frames = 64;
+    std::vector<float> out(frames * kChannels, 1.0f);
+    std::vector<float> in(frames * kChannels, 0.5f);
+    std::vector<float> mixed(frames * kChannels);
+    CrossfadeMixer::mix(out.data(), in.data(), mixed.data(), frames, kChannels, kRampFrames, kRampFrames);
+    for (float sample : mixed) {
+        QVERIFY(qAbs(sample - 0.5f) < kEpsilon);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestCrossfadeMixer)
+#include "tst_crossfademixer.moc"
@@ -0,0 +1,120 @@
+// tst_folderscanner.cpp
+#include <QtTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "FolderScanner.h"
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+namespace {
+const int kRuns = 3;
+const int kScanTimeout = 10000;
+
+bool touch(const QString &fileName)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly);
+}
+
+QList<ScannedFile> scanFiles(const QString &folder)
+{
+    FolderScanner scanner(QStringList() << "mp3");
+    QList<ScannedFile> found;
+    QObject::connect(&scanner, &FolderScanner::filesFound, [&found](const QList<ScannedFile> &files) {
+        found.append(files);
+    });
+    QSignalSpy finished(&scanner, &FolderScanner::finished);
+    scanner.scan(QStringList() << folder);
+    if (!finished.wait(kScanTimeout)) {
+        return QList<ScannedFile>();
+    }
+    return found;
+}
+
+QStringList scanPaths(const QString &folder)
+{
+    QStringList paths;
+    for (const ScannedFile &file : scanFiles(folder)) {
+        paths.append(file.filePath);
+    }
+    return paths;
+}
+}
+
+class TestFolderScanner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void deterministicOrder();
+    void hardLinks();
+};
+
+void TestFolderScanner::deterministicOrder()
+{
+    QTemporaryDir library;
+    QTemporaryDir outside;
+    QVERIFY(library.isValid() && outside.isValid());
+    const QString root = QDir::cleanPath(library.path());
+    QVERIFY(QDir(root).mkpath("z"));
+    QVERIFY(QDir(root).mkpath("m/n"));
+    // 创建顺序与名称顺序相反，读取目录的顺序不能决定结果
+    for (const QString &name : {"z/c.mp3", "m/n/e.mp3", "m/d.mp3", "m/a2.mp3", "b.mp3", "a.mp3", "notes.txt"}) {
+        QVERIFY(touch(root + "/" + name));
+    }
+
+    QStringList expected;
+    expected << root + "/a.mp3" << root + "/b.mp3" << root + "/m/a2.mp3" << root + "/m/d.mp3";
+#ifdef Q_OS_UNIX
+    // 指向范围内的文件和目录的链接跳过；指向范围外同一文件的两个链接只保留先序中的第一个
+    QVERIFY(touch(outside.filePath("x.mp3")));
+    QVERIFY(QFile::link(root + "/a.mp3", root + "/alias.mp3"));
+    QVERIFY(QFile::link(root, root + "/m/loop"));
+    QVERIFY(QFile::link(outside.filePath("x.mp3"), root + "/m/ext.mp3"));
+    QVERIFY(QFile::link(outside.filePath("x.mp3"), root + "/z/ext.mp3"));
+    expected << root + "/m/ext.mp3";
+#endif
+    expected << root + "/m/n/e.mp3" << root + "/z/c.mp3";
+
+    for (int run = 0; run < kRuns; ++run) {
+        QCOMPARE(scanPaths(root), expected);
+    }
+}
+
+void TestFolderScanner::hardLinks()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("Hard links are only created on Unix");
+#else
+    QTemporaryDir library;
+    QVERIFY(library.isValid());
+    const QString root = QDir::cleanPath(library.path());
+    QVERIFY(QDir(root).mkpath("b"));
+    QFile file(root + "/a.mp3");
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QVERIFY(file.write(QByteArray(1234, 'x')) == 1234);
+    file.close();
+
+    // 同一个文件的三个硬链接路径不同，只保留先序中的第一个
+    QCOMPARE(::link(QFile::encodeName(root + "/a.mp3").constData(),
+                    QFile::encodeName(root + "/b/copy.mp3").constData()), 0);
+    QCOMPARE(::link(QFile::encodeName(root + "/a.mp3").constData(),
+                    QFile::encodeName(root + "/c.mp3").constData()), 0);
+    QVERIFY(touch(root + "/d.mp3"));
+
+    QList<ScannedFile> files = scanFiles(root);
+    QCOMPARE(files.size(), 2);
+    QCOMPARE(files.at(0).filePath, root + "/a.mp3");
+    QCOMPARE(files.at(1).filePath, root + "/d.mp3");
+
+    // 大小和修改时间来自同一次 stat，与 QFileInfo 一致
+    QFileInfo info(root + "/a.mp3");
+    QCOMPARE(files.at(0).fileSize, qint64(1234));
+    QCOMPARE(files.at(0).lastModified, info.lastModified().toMSecsSinceEpoch());
+#endif
+}
+
+QTEST_GUILESS_MAIN(TestFolderScanner)
+#include "tst_folderscanner.moc"
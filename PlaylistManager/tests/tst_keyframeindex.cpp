@@ -0,0 +1,177 @@
+// tst_keyframeindex.cpp
+#include <QtTest>
+#include <QtEndian>
+#include <QTemporaryDir>
+#include "KeyframeIndex.h"
+
+namespace {
+const quint32 kMovieTimescale = 1000;
+
+QByteArray u32(quint32 value)
+{
+    QByteArray data(4, Qt::Uninitialized);
+    qToBigEndian(value, data.data());
+    return data;
+}
+
+QByteArray box(const char *type, const QByteArray &payload)
+{
+    return u32(quint32(8 + payload.size())) + QByteArray(type, 4) + payload;
+}
+
+// 版本0的完整盒子：版本和标志位全为0
+QByteArray fullBox(const char *type, const QByteArray &payload)
+{
+    return box(type, u32(0) + payload);
+}
+
+// (count, value) 成对的表：stts 和 ctts
+QByteArray runTable(const char *type, const QList<QPair<quint32, qint32>> &runs)
+{
+    QByteArray payload = u32(quint32(runs.size()));
+    for (const auto &run : runs) {
+        payload += u32(run.first) + u32(quint32(run.second));
+    }
+    return fullBox(type, payload);
+}
+
+// mvhd/mdhd 版本0：创建时间、修改时间、时间刻度、时长，其余填0
+QByteArray header(const char *type, quint32 timescale, int size)
+{
+    QByteArray payload = u32(0) + u32(0) + u32(timescale) + u32(0);
+    payload.append(size - payload.size(), '\0');
+    return fullBox(type, payload);
+}
+
+struct Track {
+    quint32 timescale;
+    QList<QPair<quint32, qint32>> stts;
+    QList<QPair<quint32, qint32>> ctts;
+    QList<quint32> syncSamples;
+    QList<QPair<quint32, qint32>> edits;    // (segment_duration, media_time)
+
+    Track() : timescale(1000) {}
+};
+
+bool writeMp4(const QString &fileName, const Track &track)
+{
+    QByteArray stss = u32(quint32(track.syncSamples.size()));
+    for (quint32 sample : track.syncSamples) {
+        stss += u32(sample);
+    }
+    QByteArray stbl = runTable("stts", track.stts) + fullBox("stss", stss);
+    if (!track.ctts.isEmpty()) {
+        stbl += runTable("ctts", track.ctts);
+    }
+
+    QByteArray hdlr = u32(0) + QByteArray("vide") + QByteArray(12, '\0') + QByteArray(1, '\0');
+    QByteArray mdia = header("mdhd", track.timescale, 20) + fullBox("hdlr", hdlr) +
+                      box("minf", box("stbl", stbl));
+
+    QByteArray trak;
+    if (!track.edits.isEmpty()) {
+        QByteArray elst = u32(quint32(track.edits.size()));
+        for (const auto &edit : track.edits) {
+            elst += u32(edit.first) + u32(quint32(edit.second)) + u32(0x00010000);
+        }
+        trak += box("edts", fullBox("elst", elst));
+    }
+    trak += box("mdia", mdia);
+
+    QByteArray moov = header("mvhd", kMovieTimescale, 96) + box("trak", trak);
+    QByteArray ftyp = QByteArray("isom") + u32(0x200) + QByteArray("isomavc1");
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QByteArray data = box("ftyp", ftyp) + box("moov", moov);
+    return file.write(data) == data.size();
+}
+
+// 25 fps、两个 B 帧的 GOP：解码顺序 I P B B P B B ...，I 和 P 帧的合成偏移比 B 帧大
+Track longGopTrack()
+{
+    Track track;
+    track.stts = {{10, 40}};
+    track.ctts = {{1, 80}, {4, 40}, {1, 120}, {4, 40}};
+    track.syncSamples = {1, 6};
+    return track;
+}
+}
+
+Q_DECLARE_METATYPE(Track)
+
+class TestKeyframeIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void presentationTimes_data();
+    void presentationTimes();
+    void nearest();
+};
+
+void TestKeyframeIndex::presentationTimes_data()
+{
+    QTest::addColumn<Track>("track");
+    QTest::addColumn<QList<qint64>>("times");
+
+    Track plain;
+    plain.stts = {{10, 40}};
+    plain.syncSamples = {1, 6};
+    QTest::newRow("decode times only") << plain << QList<qint64>{0, 200};
+
+    // 关键帧的显示时间 = 解码时间 + 合成偏移
+    QTest::newRow("composition offsets") << longGopTrack() << QList<qint64>{80, 320};
+
+    // 编辑列表从 media_time 开始显示，抵消 B 帧延迟
+    Track shifted = longGopTrack();
+    shifted.edits = {{400, 80}};
+    QTest::newRow("edit list shift") << shifted << QList<qint64>{0, 240};
+
+    // 开头的空编辑把整条轨道向后推
+    Track delayed = longGopTrack();
+    delayed.edits = {{500, -1}, {400, 80}};
+    QTest::newRow("empty edit") << delayed << QList<qint64>{500, 740};
+
+    // 29.97 fps：第4帧在 100.1ms，向上取整，定位目标不会落在关键帧之前
+    Track ntsc;
+    ntsc.timescale = 30000;
+    ntsc.stts = {{10, 1001}};
+    ntsc.syncSamples = {1, 4};
+    QTest::newRow("rounded up") << ntsc << QList<qint64>{0, 101};
+}
+
+void TestKeyframeIndex::presentationTimes()
+{
+    QFETCH(Track, track);
+    QFETCH(QList<qint64>, times);
+
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("test.mp4");
+    QVERIFY(writeMp4(fileName, track));
+
+    KeyframeIndex index = KeyframeIndex::build(fileName);
+    QVERIFY(!index.isEmpty());
+    QVERIFY(!index.allKeyframes());
+    QCOMPARE(index.times(), times);
+}
+
+void TestKeyframeIndex::nearest()
+{
+    Track track = longGopTrack();
+    track.edits = {{400, 80}};
+
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("test.mp4");
+    QVERIFY(writeMp4(fileName, track));
+
+    KeyframeIndex index = KeyframeIndex::build(fileName);
+    QCOMPARE(index.nearest(100), qint64(0));
+    QCOMPARE(index.nearest(130), qint64(240));
+    QCOMPARE(index.nearest(1000), qint64(240));
+}
+
+QTEST_GUILESS_MAIN(TestKeyframeIndex)
+#include "tst_keyframeindex.moc"
@@ -0,0 +1,115 @@
+// tst_librarywatcher.cpp
+#include <QtTest>
+#include <QTemporaryDir>
+#include "LibraryWatcher.h"
+
+namespace {
+bool touch(const QString &fileName)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly);
+}
+
+QStringList addedPaths(const LibraryChanges &changes)
+{
+    QStringList paths;
+    for (const ScannedFile &file : changes.added) {
+        paths.append(file.filePath);
+    }
+    paths.sort();
+    return paths;
+}
+}
+
+class TestLibraryWatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void restoreReportsOnlyOfflineChanges();
+    void freedWatchesRetryPolled();
+};
+
+void TestLibraryWatcher::restoreReportsOnlyOfflineChanges()
+{
+    QTemporaryDir library;
+    QTemporaryDir data;
+    QVERIFY(library.isValid() && data.isValid());
+    const QString root = QDir::cleanPath(library.path());
+    const QString stateFile = data.filePath("library.state");
+    QVERIFY(QDir(root).mkdir("sub"));
+    QVERIFY(touch(root + "/a.mp3"));
+    QVERIFY(touch(root + "/b.mp3"));
+    QVERIFY(touch(root + "/sub/c.mp3"));
+    QVERIFY(touch(root + "/notes.txt"));
+
+    {
+        // 第一次运行：没有快照，已有文件作为新增报告
+        LibraryWatcher watcher(QStringList() << "mp3");
+        QSignalSpy spy(&watcher, &LibraryWatcher::changesDetected);
+        watcher.addFolder(root, true);
+        QVERIFY(spy.wait());
+        QCOMPARE(addedPaths(spy.first().first().value<LibraryChanges>()),
+                 QStringList() << root + "/a.mp3" << root + "/b.mp3" << root + "/sub/c.mp3");
+        QVERIFY(watcher.saveState(stateFile));
+    }
+
+    // 程序关闭期间新增一个文件、删除一个文件（先新增，避免新文件复用被删文件的 inode 而被当成重命名）
+    QVERIFY(touch(root + "/sub/d.mp3"));
+    QVERIFY(QFile::remove(root + "/a.mp3"));
+
+    {
+        // 再次启动：只报告关闭期间的变化；其余已有文件（包括用户从列表中移除的）不再作为新增
+        LibraryWatcher watcher(QStringList() << "mp3");
+        QSignalSpy spy(&watcher, &LibraryWatcher::changesDetected);
+        watcher.restoreState(stateFile);
+        watcher.addFolder(root, true);
+        QVERIFY(spy.wait());
+        LibraryChanges changes = spy.first().first().value<LibraryChanges>();
+        QCOMPARE(addedPaths(changes), QStringList() << root + "/sub/d.mp3");
+        QCOMPARE(changes.removed, QStringList() << root + "/a.mp3");
+        QVERIFY(!spy.wait(500));
+        QCOMPARE(watcher.watchedCount() + watcher.polledCount(), 2);
+    }
+
+    {
+        // 没有变化时什么都不报告
+        LibraryWatcher watcher(QStringList() << "mp3");
+        watcher.addFolder(root, false);
+        QTRY_COMPARE(watcher.watchedCount() + watcher.polledCount(), 2);
+        QVERIFY(watcher.saveState(stateFile));
+    }
+    {
+        LibraryWatcher watcher(QStringList() << "mp3");
+        QSignalSpy spy(&watcher, &LibraryWatcher::changesDetected);
+        watcher.restoreState(stateFile);
+        watcher.addFolder(root, true);
+        QVERIFY(!spy.wait(500));
+    }
+}
+
+void TestLibraryWatcher::freedWatchesRetryPolled()
+{
+    QTemporaryDir library;
+    QVERIFY(library.isValid());
+    const QString root = QDir::cleanPath(library.path());
+    for (const QString &name : {QString("a"), QString("b"), QString("c")}) {
+        QVERIFY(QDir(root).mkdir(name));
+        QVERIFY(touch(root + "/" + name + "/x.mp3"));
+    }
+
+    // 根目录最先添加，总在监视中；三个子目录只有两个能被监视
+    LibraryWatcher watcher(QStringList() << "mp3", 3);
+    watcher.addFolder(root, false);
+    QTRY_COMPARE(watcher.watchedCount(), 3);
+    QCOMPARE(watcher.polledCount(), 1);
+
+    // 删掉两个子目录后至少空出一个监视数，剩下的子目录不论原来是否在轮询都应被监视
+    QVERIFY(QDir(root + "/a").removeRecursively());
+    QVERIFY(QDir(root + "/b").removeRecursively());
+    QTRY_COMPARE(watcher.watchedCount(), 2);
+    QCOMPARE(watcher.polledCount(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestLibraryWatcher)
+#include "tst_librarywatcher.moc"
@@ -0,0 +1,83 @@
+// tst_metadatacache.cpp
+#include <QtTest>
+#include <QTemporaryDir>
+#include "MetadataCache.h"
+
+namespace {
+MediaMetadata probeResult(const QString &filePath, bool valid, bool transient)
+{
+    MediaMetadata metadata;
+    metadata.filePath = filePath;
+    metadata.valid = valid;
+    metadata.transient = transient;
+    metadata.duration = valid ? 180000 : 0;
+    metadata.fileSize = 1024;
+    metadata.lastModified = 1700000000000;
+    return metadata;
+}
+}
+
+class TestMetadataCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cachesProbeResults_data();
+    void cachesProbeResults();
+    void staleEntryMisses();
+};
+
+void TestMetadataCache::cachesProbeResults_data()
+{
+    QTest::addColumn<bool>("valid");
+    QTest::addColumn<bool>("transient");
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("probed") << true << false << true;
+    // 确实无法播放的文件也缓存，不必每次启动都重新探测
+    QTest::newRow("invalid media") << false << false << true;
+    // 超时或出错可能只是暂时读不到，必须下次重新探测
+    QTest::newRow("timed out") << false << true << false;
+}
+
+void TestMetadataCache::cachesProbeResults()
+{
+    QFETCH(bool, valid);
+    QFETCH(bool, transient);
+    QFETCH(bool, cached);
+
+    QTemporaryDir dir;
+    QString cacheFile = dir.filePath("metadata.cache");
+    const QString filePath = "/music/song.mp3";
+    {
+        MetadataCache cache(cacheFile);
+        cache.insert(probeResult(filePath, valid, transient));
+    }
+
+    // 重新打开，确认写入了文件
+    MetadataCache cache(cacheFile);
+    MediaMetadata metadata;
+    metadata.id = 7;
+    QCOMPARE(cache.lookup(filePath, 1024, 1700000000000, &metadata), cached);
+    if (cached) {
+        QCOMPARE(metadata.id, quint64(7));
+        QCOMPARE(metadata.valid, valid);
+        QCOMPARE(cache.hits(), 1);
+    } else {
+        QCOMPARE(cache.misses(), 1);
+    }
+}
+
+void TestMetadataCache::staleEntryMisses()
+{
+    QTemporaryDir dir;
+    MetadataCache cache(dir.filePath("metadata.cache"));
+    cache.insert(probeResult("/music/song.mp3", true, false));
+
+    MediaMetadata metadata;
+    QVERIFY(!cache.lookup("/music/song.mp3", 2048, 1700000000000, &metadata));
+    QCOMPARE(cache.size(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestMetadataCache)
+#include "tst_metadatacache.moc"
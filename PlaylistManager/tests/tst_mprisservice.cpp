@@ -0,0 +1,175 @@
+// tst_mprisservice.cpp
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QStandardPaths>
+#include <QDBusConnection>
+#include "MprisService.h"
+#include "TestMedia.h"
+
+namespace {
+const QString kServiceConnection = QStringLiteral("tst_mprisservice");
+const QString kClientConnection = QStringLiteral("tst_mprisservice_client");
+const QString kObjectPath = QStringLiteral("/org/mpris/MediaPlayer2");
+const int kClipMsecs = 5000;
+const int kOpenTimeout = 10000;
+const int kSettleMsecs = 500;           // 打开媒体时的属性变化全部发出
+const int kPlaybackMsecs = 2000;
+const qint64 kSeekTarget = 3000;
+const qint64 kSeekTolerance = 250;      // Seeked 报告的位置与目标的差（毫秒）
+}
+
+// 在客户端连接上接收播放器发出的信号
+class SignalRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    QList<QVariantMap> changes;
+    QList<qlonglong> seeks;
+
+public slots:
+    void propertiesChanged(const QString &interface, const QVariantMap &changed, const QStringList &invalidated)
+    {
+        Q_UNUSED(interface);
+        Q_UNUSED(invalidated);
+        changes.append(changed);
+    }
+
+    void seeked(qlonglong position)
+    {
+        seeks.append(position);
+    }
+};
+
+class TestMprisService : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanup();
+    void coalescedWithoutSeeks();
+    void seekEmitsOneSeeked();
+};
+
+void TestMprisService::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestMprisService::cleanup()
+{
+    QDBusConnection::disconnectFromBus(kServiceConnection);
+    QDBusConnection::disconnectFromBus(kClientConnection);
+    QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).removeRecursively();
+    QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).removeRecursively();
+}
+
+void TestMprisService::coalescedWithoutSeeks()
+{
+    // 服务和客户端各用一条连接，信号经过总线送达
+    QDBusConnection connection = QDBusConnection::connectToBus(QDBusConnection::SessionBus, kServiceConnection);
+    QDBusConnection client = QDBusConnection::connectToBus(QDBusConnection::SessionBus, kClientConnection);
+    if (!connection.isConnected() || !client.isConnected()) {
+        QSKIP("No D-Bus session bus available");
+    }
+
+    QTemporaryDir dir;
+    QString clip = dir.filePath("clip.wav");
+    QVERIFY(TestMedia::writeSineWave(clip, kClipMsecs, 440));
+
+    PlaybackEngine engine;
+    engine.setVolume(0.0f);
+    PlaylistController playlist;
+    MprisService service(&engine, &playlist);
+    QString errorString;
+    QVERIFY2(service.registerOn(connection, &errorString), qPrintable(errorString));
+
+    SignalRecorder recorder;
+    QVERIFY(client.connect(service.serviceName(), kObjectPath, "org.freedesktop.DBus.Properties",
+                           "PropertiesChanged", &recorder,
+                           SLOT(propertiesChanged(QString,QVariantMap,QStringList))));
+    QVERIFY(client.connect(service.serviceName(), kObjectPath, "org.mpris.MediaPlayer2.Player", "Seeked",
+                           &recorder, SLOT(seeked(qlonglong))));
+
+    playlist.addMedia(clip);
+    playlist.setCurrentIndex(0);
+    engine.setSource(QUrl::fromLocalFile(clip));
+    engine.play();
+    if (!QTest::qWaitFor([&]() { return engine.position() > 0; }, kOpenTimeout)) {
+        QSKIP("No multimedia backend or audio output available");
+    }
+    QTest::qWait(kSettleMsecs);
+    recorder.changes.clear();
+    recorder.seeks.clear();
+
+    // 一个合并间隔内的多次变化只发出一次，每个属性取最新值
+    service.setVolume(0.5);
+    service.setVolume(0.6);
+    service.setRate(1.0);
+    playlist.setPlayMode(PlaySequencer::Loop);
+    QTRY_COMPARE(recorder.changes.size(), 1);
+    const QVariantMap changed = recorder.changes.first();
+    QCOMPARE(changed.value("Volume").toDouble(), 0.6);
+    QCOMPARE(changed.value("LoopStatus").toString(), QString("Playlist"));
+    QVERIFY(!changed.contains("Position"));
+
+    // 正常播放时位置持续推进，既不发出 PropertiesChanged 也不发出 Seeked
+    QTest::qWait(kPlaybackMsecs);
+    QCOMPARE(engine.playbackState(), QMediaPlayer::PlayingState);
+    QCOMPARE(recorder.changes.size(), 1);
+    QCOMPARE(recorder.seeks.size(), 0);
+
+    service.unregister();
+    playlist.waitForPendingWrites();
+}
+
+void TestMprisService::seekEmitsOneSeeked()
+{
+    QDBusConnection connection = QDBusConnection::connectToBus(QDBusConnection::SessionBus, kServiceConnection);
+    QDBusConnection client = QDBusConnection::connectToBus(QDBusConnection::SessionBus, kClientConnection);
+    if (!connection.isConnected() || !client.isConnected()) {
+        QSKIP("No D-Bus session bus available");
+    }
+
+    QTemporaryDir dir;
+    QString clip = dir.filePath("clip.wav");
+    QVERIFY(TestMedia::writeSineWave(clip, kClipMsecs, 440));
+
+    PlaybackEngine engine;
+    engine.setVolume(0.0f);
+    PlaylistController playlist;
+    MprisService service(&engine, &playlist);
+    QString errorString;
+    QVERIFY2(service.registerOn(connection, &errorString), qPrintable(errorString));
+
+    SignalRecorder recorder;
+    QVERIFY(client.connect(service.serviceName(), kObjectPath, "org.mpris.MediaPlayer2.Player", "Seeked",
+                           &recorder, SLOT(seeked(qlonglong))));
+
+    playlist.addMedia(clip);
+    playlist.setCurrentIndex(0);
+    engine.setSource(QUrl::fromLocalFile(clip));
+    engine.play();
+    if (!QTest::qWaitFor([&]() { return engine.position() > 0; }, kOpenTimeout)) {
+        QSKIP("No multimedia backend or audio output available");
+    }
+    QTest::qWait(kSettleMsecs);
+    recorder.seeks.clear();
+
+    // 一次跳转只发出一次 Seeked，携带新位置（微秒）
+    engine.setPosition(kSeekTarget);
+    QTRY_COMPARE(recorder.seeks.size(), 1);
+    QTest::qWait(kSettleMsecs);
+    QCOMPARE(recorder.seeks.size(), 1);
+    qlonglong reported = recorder.seeks.first() / 1000;
+    QVERIFY2(qAbs(reported - kSeekTarget) <= kSeekTolerance,
+             qPrintable(QString("Seeked reported %1 ms").arg(reported)));
+
+    service.unregister();
+    playlist.waitForPendingWrites();
+}
+
+// QMediaPlayer 需要 QGuiApplication
+QTEST_MAIN(TestMprisService)
+#include "tst_mprisservice.moc"
@@ -0,0 +1,89 @@
+// tst_playbackengine.cpp
+#include <QtTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "PlaybackEngine.h"
+#include "TestMedia.h"
+
+namespace {
+const int kClipMsecs = 1500;
+const int kOpenTimeout = 10000;
+const int kPreloadTimeout = 5000;
+const qint64 kMaxPreloadedGap = 150;    // 预加载的项目只交换播放器，间隔应远小于一次打开
+}
+
+class TestPlaybackEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void transition_data();
+    void transition();
+
+private:
+    QTemporaryDir m_dir;
+    QUrl m_first;
+    QUrl m_second;
+};
+
+void TestPlaybackEngine::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    QString first = m_dir.filePath("first.wav");
+    QString second = m_dir.filePath("second.wav");
+    QVERIFY(TestMedia::writeSineWave(first, kClipMsecs, 440));
+    QVERIFY(TestMedia::writeSineWave(second, kClipMsecs, 660));
+    m_first = QUrl::fromLocalFile(first);
+    m_second = QUrl::fromLocalFile(second);
+}
+
+void TestPlaybackEngine::transition_data()
+{
+    QTest::addColumn<bool>("preload");
+
+    QTest::newRow("preloaded") << true;
+    QTest::newRow("cold") << false;
+}
+
+void TestPlaybackEngine::transition()
+{
+    QFETCH(bool, preload);
+
+    PlaybackEngine engine;
+    engine.setVolume(0.0f);
+
+    // 与播放器一样：当前项播放结束时立即切换到下一项
+    connect(&engine, &PlaybackEngine::mediaStatusChanged, this, [&](QMediaPlayer::MediaStatus status) {
+        if (status == QMediaPlayer::EndOfMedia && engine.source() == m_first) {
+            engine.setSource(m_second);
+        }
+    });
+
+    QSignalSpy transitions(&engine, &PlaybackEngine::transitionMeasured);
+    engine.setSource(m_first);
+    engine.play();
+    if (!QTest::qWaitFor([&]() { return engine.position() > 0; }, kOpenTimeout)) {
+        QSKIP("No multimedia backend or audio output available");
+    }
+
+    if (preload) {
+        engine.preload(m_second);
+        QVERIFY(QTest::qWaitFor([&]() { return engine.isPreloaded(m_second); }, kPreloadTimeout));
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(transitions.count(), 1, kClipMsecs + kOpenTimeout);
+    QCOMPARE(engine.source(), m_second);
+    QCOMPARE(transitions.first().at(1).toBool(), preload);
+
+    qint64 gap = transitions.first().at(0).toLongLong();
+    QVERIFY(gap >= 0);
+    if (preload) {
+        QVERIFY2(gap < kMaxPreloadedGap, qPrintable(QString("preloaded transition took %1 ms").arg(gap)));
+    }
+    QCOMPARE(engine.lastTransitionGap(), gap);
+}
+
+// QMediaPlayer 需要 QGuiApplication
+QTEST_MAIN(TestPlaybackEngine)
+#include "tst_playbackengine.moc"
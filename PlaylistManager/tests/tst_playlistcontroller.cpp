@@ -0,0 +1,92 @@
+// tst_playlistcontroller.cpp
+#include <QtTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QStandardPaths>
+#include "PlaylistController.h"
+
+namespace {
+const int kBatchSize = 10000;
+}
+
+class TestPlaylistController : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanup();
+    void batchEmitsOnce();
+    void nestedBatchEmitsOnce();
+
+private:
+    QTemporaryDir m_dir;
+    QStringList m_files;
+};
+
+void TestPlaylistController::initTestCase()
+{
+    // 操作日志和缓存写到测试专用的目录
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_dir.isValid());
+
+    // 空文件即可：添加时只检查存在和扩展名
+    m_files.reserve(kBatchSize);
+    for (int i = 0; i < kBatchSize; ++i) {
+        QString fileName = m_dir.filePath(QString("track_%1.mp3").arg(i, 5, 10, QChar('0')));
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        m_files.append(fileName);
+    }
+}
+
+void TestPlaylistController::cleanup()
+{
+    QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).removeRecursively();
+    QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).removeRecursively();
+}
+
+void TestPlaylistController::batchEmitsOnce()
+{
+    PlaylistController controller;
+    QSignalSpy changed(&controller, &PlaylistController::playlistChanged);
+    QSignalSpy started(&controller, &PlaylistController::batchStarted);
+    QSignalSpy finished(&controller, &PlaylistController::batchFinished);
+    QSignalSpy inserted(controller.model(), &QAbstractItemModel::rowsInserted);
+
+    controller.addMediaList(m_files);
+
+    QCOMPARE(controller.count(), kBatchSize);
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(started.count(), 1);
+    QCOMPARE(finished.count(), 1);
+    // 整批只插入一次行
+    QCOMPARE(inserted.count(), 1);
+    controller.waitForPendingWrites();
+}
+
+void TestPlaylistController::nestedBatchEmitsOnce()
+{
+    PlaylistController controller;
+    QSignalSpy changed(&controller, &PlaylistController::playlistChanged);
+    QSignalSpy finished(&controller, &PlaylistController::batchFinished);
+
+    controller.beginUpdate();
+    controller.beginUpdate();
+    for (const QString &file : std::as_const(m_files)) {
+        controller.addMedia(file);
+    }
+    controller.endUpdate();
+    QCOMPARE(changed.count(), 0);
+    QCOMPARE(finished.count(), 0);
+
+    controller.endUpdate();
+    QCOMPARE(controller.count(), kBatchSize);
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(finished.count(), 1);
+    controller.waitForPendingWrites();
+}
+
+// 元数据探测使用 QMediaPlayer，需要 QGuiApplication
+QTEST_MAIN(TestPlaylistController)
+#include "tst_playlistcontroller.moc"
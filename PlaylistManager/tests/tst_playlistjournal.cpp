@@ -0,0 +1,174 @@
+// tst_playlistjournal.cpp
+#include <QtTest>
+#include <QProcess>
+#include <QDeadlineTimer>
+#include <QStandardPaths>
+#include <QTextStream>
+#include "PlaylistJournal.h"
+
+namespace {
+const char kWriterArgument[] = "--journal-writer";
+const int kCommitEvery = 50;        // 写入进程每提交这么多条报告一次
+const int kCompactEvery = 700;      // 写入进程每这么多条合并一次快照
+const int kKillRounds = 4;
+const int kRecordsPerRound = 1500;  // 每轮至少提交这么多条再杀掉写入进程
+
+MediaInfo makeItem(int index)
+{
+    MediaInfo info;
+    info.filePath = QString("/media/library/clip_%1.mp4").arg(index, 6, 10, QChar('0'));
+    info.title = QString("Clip %1").arg(index);
+    return info;
+}
+
+// 子进程：从已保存的列表继续不停追加，定期提交并报告已落盘的条数，直到被杀掉
+int runWriter()
+{
+    PlaylistJournal journal;
+    QList<MediaInfo> items;
+    journal.load(&items);
+
+    QTextStream out(stdout);
+    for (int i = int(items.size());; ++i) {
+        MediaInfo info = makeItem(i);
+        items.append(info);
+        journal.recordAdd(info);
+
+        if ((i + 1) % kCommitEvery == 0) {
+            journal.flush();
+            journal.waitForDone();
+            out << "committed " << (i + 1) << Qt::endl;
+        }
+        if ((i + 1) % kCompactEvery == 0) {
+            // 快照在后台写入，期间继续追加
+            journal.compact(items);
+        }
+        QCoreApplication::processEvents();
+    }
+}
+}
+
+class TestPlaylistJournal : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void recoversAfterKill();
+    void snapshotFailureKeepsRecords();
+
+private:
+    void verifyPrefix(const QList<MediaInfo> &items);
+};
+
+void TestPlaylistJournal::init()
+{
+    QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).removeRecursively();
+}
+
+void TestPlaylistJournal::verifyPrefix(const QList<MediaInfo> &items)
+{
+    // 恢复的列表必须是写入顺序的前缀：没有缺口、重复或乱序
+    for (int i = 0; i < items.size(); ++i) {
+        if (items.at(i).filePath != makeItem(i).filePath) {
+            QFAIL(qPrintable(QString("item %1 is %2").arg(i).arg(items.at(i).filePath)));
+        }
+    }
+}
+
+void TestPlaylistJournal::recoversAfterKill()
+{
+    int expected = 0;
+    for (int round = 0; round < kKillRounds; ++round) {
+        QProcess writer;
+        writer.setProgram(QCoreApplication::applicationFilePath());
+        writer.setArguments(QStringList() << kWriterArgument);
+        writer.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        writer.start();
+        QVERIFY(writer.waitForStarted());
+
+        int committed = 0;
+        QDeadlineTimer deadline(30000);
+        while (committed < expected + kRecordsPerRound && !deadline.hasExpired()) {
+            if (!writer.canReadLine() && !writer.waitForReadyRead(1000)) {
+                QVERIFY2(writer.state() == QProcess::Running, "writer exited");
+                continue;
+            }
+            while (writer.canReadLine()) {
+                QByteArray line = writer.readLine().trimmed();
+                if (line.startsWith("committed ")) {
+                    committed = line.mid(10).toInt();
+                }
+            }
+        }
+        QVERIFY(committed >= expected + kRecordsPerRound);
+
+        // 等同于 kill -9：不执行析构，缓冲区和写入中的记录都丢失
+        writer.kill();
+        QVERIFY(writer.waitForFinished());
+
+        PlaylistJournal journal;
+        QList<MediaInfo> items;
+        QVERIFY(journal.load(&items));
+        QVERIFY2(items.size() >= committed,
+                 qPrintable(QString("recovered %1 of %2 committed").arg(items.size()).arg(committed)));
+        verifyPrefix(items);
+        journal.waitForDone();
+        expected = items.size();
+    }
+}
+
+void TestPlaylistJournal::snapshotFailureKeepsRecords()
+{
+    QString snapshotFileName;
+    {
+        PlaylistJournal journal;
+        QList<MediaInfo> items;
+        QVERIFY(!journal.load(&items));
+        for (int i = 0; i < 10; ++i) {
+            items.append(makeItem(i));
+            journal.recordAdd(items.last());
+        }
+        journal.flush();
+        journal.waitForDone();
+
+        // 快照路径被目录占用，快照写入必然失败
+        snapshotFileName = journal.snapshotFileName();
+        QVERIFY(QDir().mkpath(snapshotFileName));
+        journal.recordAdd(makeItem(10));
+        items.append(makeItem(10));
+        journal.compact(items);
+
+        // 合并期间的新记录
+        for (int i = 11; i < 15; ++i) {
+            journal.recordAdd(makeItem(i));
+        }
+        journal.waitForDone();
+        journal.flush();
+        journal.waitForDone();
+        QVERIFY(QDir().rmdir(snapshotFileName));
+    }
+
+    PlaylistJournal journal;
+    QList<MediaInfo> items;
+    QVERIFY(journal.load(&items));
+    QCOMPARE(items.size(), 15);
+    verifyPrefix(items);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("tst_playlistjournal");
+    app.setOrganizationName("PlaylistManagerTests");
+    QStandardPaths::setTestModeEnabled(true);
+
+    if (argc > 1 && qstrcmp(argv[1], kWriterArgument) == 0) {
+        return runWriter();
+    }
+
+    TestPlaylistJournal test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_playlistjournal.moc"
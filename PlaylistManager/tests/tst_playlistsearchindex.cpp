@@ -0,0 +1,210 @@
+// tst_playlistsearchindex.cpp
+#include <QtTest>
+#include "PlaylistSearchIndex.h"
+#include "PlaylistFilterModel.h"
+#include "PlaylistModel.h"
+
+namespace {
+const int kLargeScale = 100000;
+// 每次按键的耗时上限（毫秒），不超过半帧；调试构建放宽
+#ifdef QT_NO_DEBUG
+const double kKeystrokeBudget = 8.0;
+#else
+const double kKeystrokeBudget = 50.0;
+#endif
+// 经过过滤模型的首次按键（含 invalidateFilter 重新过滤全部行）的耗时上限（毫秒）
+#ifdef QT_NO_DEBUG
+const double kFilterBudget = 50.0;
+#else
+const double kFilterBudget = 250.0;
+#endif
+
+MediaInfo makeItem(quint64 id, const QString &title, const QString &artist = QString())
+{
+    MediaInfo info;
+    info.id = id;
+    info.title = title;
+    info.artist = artist;
+    info.filePath = QString("/media/library/%1/clip_%2.mp4").arg(id % 200).arg(id, 6, 10, QChar('0'));
+    return info;
+}
+
+int distinctTrigrams(const QString &text)
+{
+    QSet<QString> trigrams;
+    for (int i = 0; i + 3 <= text.size(); ++i) {
+        trigrams.insert(text.mid(i, 3));
+    }
+    return trigrams.size();
+}
+}
+
+class TestPlaylistSearchIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void searchByField();
+    void updateReplacesPostings();
+    void removePrunesPostings();
+    void keystrokeLatency();
+    void coldFirstKeystroke();
+};
+
+void TestPlaylistSearchIndex::searchByField()
+{
+    PlaylistSearchIndex index;
+    index.addItem(makeItem(1, "Blue Train", "John Coltrane"));
+    index.addItem(makeItem(2, "So What", "Miles Davis"));
+
+    QCOMPARE(index.search("coltrane"), QSet<quint64>({1}));
+    QCOMPARE(index.search("DAVIS"), QSet<quint64>({2}));
+    QCOMPARE(index.search("clip_"), QSet<quint64>({1, 2}));
+    QVERIFY(index.search("不存在").isEmpty());
+}
+
+void TestPlaylistSearchIndex::updateReplacesPostings()
+{
+    PlaylistSearchIndex index;
+    MediaInfo info = makeItem(1, "Untitled");
+    index.addItem(info);
+    const qsizetype initial = index.postingCount();
+
+    // 元数据补全后标题变化：旧三元组必须撤下，同一ID不能重复写入
+    for (int i = 0; i < 5; ++i) {
+        info.title = QString("Track %1").arg(i);
+        info.artist = "Someone";
+        index.updateItem(info);
+        QCOMPARE(index.search(QString("track %1").arg(i)), QSet<quint64>({1}));
+    }
+    QVERIFY(index.search("untitled").isEmpty());
+
+    // 检索文本的格式与 PlaylistSearchIndex::searchText 一致
+    QString text = QString("%1\n%2\n%3\n%4\n%5")
+                       .arg(info.displayName(), info.title, info.artist, info.album, info.filePath)
+                       .toLower();
+    QCOMPARE(index.postingCount(), qsizetype(distinctTrigrams(text)));
+    QVERIFY(initial > 0);
+
+    // 内容不变的更新不改变倒排表
+    index.updateItem(info);
+    QCOMPARE(index.postingCount(), qsizetype(distinctTrigrams(text)));
+}
+
+void TestPlaylistSearchIndex::removePrunesPostings()
+{
+    PlaylistSearchIndex index;
+    for (quint64 id = 1; id <= 100; ++id) {
+        index.addItem(makeItem(id, QString("Song %1").arg(id)));
+    }
+    QCOMPARE(index.search("song 42"), QSet<quint64>({42}));
+    QVERIFY(index.postingCount() > 0);
+
+    for (quint64 id = 1; id <= 100; ++id) {
+        index.removeItem(id);
+    }
+    index.search(QString());
+    QVERIFY(index.search("song").isEmpty());
+    QCOMPARE(index.postingCount(), qsizetype(0));
+
+    // 添加后从未被查询过就删除的项也不能留下
+    index.addItem(makeItem(7, "Pending"));
+    index.removeItem(7);
+    QVERIFY(index.search("pending").isEmpty());
+    QCOMPARE(index.postingCount(), qsizetype(0));
+}
+
+void TestPlaylistSearchIndex::keystrokeLatency()
+{
+    PlaylistSearchIndex index;
+    for (int i = 0; i < kLargeScale; ++i) {
+        index.addItem(makeItem(quint64(i + 1), QString("Title %1").arg(i), QString("Artist %1").arg(i % 1000)));
+    }
+
+    // 添加时即已建好倒排表；每项都经历一次元数据补全，倒排表规模不应随之增长
+    QVERIFY(index.postingCount() > 0);
+    const qsizetype posted = index.postingCount();
+    for (int i = 0; i < kLargeScale; ++i) {
+        MediaInfo info = makeItem(quint64(i + 1), QString("Title %1").arg(i), QString("Artist %1").arg(i % 1000));
+        info.album = "Album";
+        index.updateItem(info);
+    }
+    QVERIFY(index.postingCount() <= posted + qsizetype(kLargeScale) * distinctTrigrams("\nalbum\n"));
+
+    // 逐字输入，记录每次按键的耗时：先输入一个少见的词（倒排表），
+    // 再从头输入一个常见的词（继续输入时在上次结果中剔除）
+    double worst = 0;
+    for (const QString &keyword : {QString("title 4242"), QString("artist 424")}) {
+        index.search(QString());
+        for (int length = 1; length <= keyword.size(); ++length) {
+            QElapsedTimer timer;
+            timer.start();
+            int count = index.search(keyword.left(length)).size();
+            double elapsed = timer.nsecsElapsed() / 1e6;
+            qInfo("\"%s\": %d results in %.3f ms", qPrintable(keyword.left(length)), count, elapsed);
+            // 一两个字符时没有三元组可用，只能扫描全部文本，不计入
+            if (length >= 3) {
+                worst = qMax(worst, elapsed);
+            }
+        }
+    }
+    QCOMPARE(index.search("artist 424").size(), kLargeScale / 1000);
+    QVERIFY2(worst < kKeystrokeBudget, qPrintable(QString("worst keystroke %1 ms").arg(worst)));
+
+    // 直接输入整个关键字（粘贴）走倒排表
+    index.search(QString());
+    QElapsedTimer timer;
+    timer.start();
+    QCOMPARE(index.search("title 4242").size(), 11);
+    QVERIFY2(timer.nsecsElapsed() / 1e6 < kKeystrokeBudget, "pasted keyword");
+}
+
+void TestPlaylistSearchIndex::coldFirstKeystroke()
+{
+    // 加载和元数据补全之后的第一次按键不能落到建索引上，也要算上过滤模型重新过滤的开销
+    PlaylistModel model;
+    PlaylistFilterModel filter;
+    filter.setPlaylistModel(&model);
+
+    QList<MediaInfo> items;
+    items.reserve(kLargeScale);
+    for (int i = 0; i < kLargeScale; ++i) {
+        items.append(makeItem(quint64(i + 1), QString("Title %1").arg(i), QString("Artist %1").arg(i % 1000)));
+    }
+    QCOMPARE(model.appendMedia(items), kLargeScale);
+
+    auto firstKeystroke = [&filter](const QString &keyword) {
+        QElapsedTimer timer;
+        timer.start();
+        filter.setSearchKeyword(keyword);
+        double elapsed = timer.nsecsElapsed() / 1e6;
+        qInfo("cold \"%s\": %d rows in %.3f ms", qPrintable(keyword), filter.rowCount(), elapsed);
+        return elapsed;
+    };
+
+    double afterLoad = firstKeystroke("title 4242");
+    QCOMPARE(filter.rowCount(), 11);
+    QVERIFY2(afterLoad < kFilterBudget, qPrintable(QString("first keystroke after load %1 ms").arg(afterLoad)));
+
+    filter.setSearchKeyword(QString());
+
+    // 一批元数据写回所有行之后再次输入
+    QList<MediaMetadata> batch;
+    batch.reserve(kLargeScale);
+    for (int row = 0; row < model.rowCount(); ++row) {
+        MediaMetadata metadata;
+        metadata.id = model.mediaAt(row).id;
+        metadata.valid = true;
+        metadata.album = QString("Album %1").arg(row % 500);
+        batch.append(metadata);
+    }
+    model.applyMetadata(batch);
+
+    double afterMetadata = firstKeystroke("album 123");
+    QCOMPARE(filter.rowCount(), kLargeScale / 500);
+    QVERIFY2(afterMetadata < kFilterBudget,
+             qPrintable(QString("first keystroke after metadata %1 ms").arg(afterMetadata)));
+}
+
+QTEST_GUILESS_MAIN(TestPlaylistSearchIndex)
+#include "tst_playlistsearchindex.moc"
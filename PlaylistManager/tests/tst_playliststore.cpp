@@ -0,0 +1,105 @@
+// tst_playliststore.cpp
+#include <QtTest>
+#include <QElapsedTimer>
+#include "PlaylistStore.h"
+
+namespace {
+const int kLargeCount = 100000;
+const int kSmallCount = kLargeCount / 4;
+const int kRuns = 3;                    // 每个规模取最快的一次，减少抖动
+const double kMaxGrowth = 8.0;          // 线性增长约为 4 倍，平方增长为 16 倍
+
+QStringList syntheticPaths(int count)
+{
+    QStringList paths;
+    paths.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        paths.append(QString("/media/archive/%1/clip_%2.mp4").arg(i % 100).arg(i));
+    }
+    return paths;
+}
+
+// 逐个添加（含查重），再全部按路径查找一遍
+qint64 addAndFind(const QStringList &paths)
+{
+    qint64 best = -1;
+    for (int run = 0; run < kRuns; ++run) {
+        QElapsedTimer timer;
+        timer.start();
+        PlaylistStore store;
+        for (const QString &path : paths) {
+            MediaInfo info;
+            info.filePath = path;
+            store.append(info);
+            store.append(info);
+        }
+        for (const QString &path : paths) {
+            if (store.indexOf(path) < 0) {
+                return -1;
+            }
+        }
+        qint64 elapsed = timer.nsecsElapsed();
+        best = best < 0 ? elapsed : qMin(best, elapsed);
+    }
+    return best;
+}
+}
+
+class TestPlaylistStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void setters();
+    void linearGrowth();
+};
+
+void TestPlaylistStore::setters()
+{
+    PlaylistStore store;
+    MediaInfo info;
+    info.filePath = "/media/a.mp4";
+    PlaylistStore::ItemId id = store.append(info);
+    info.filePath = "/media/b.mp4";
+    store.append(info);
+
+    store.setFavorite(1, true);
+    store.setPlayCount(1, 3);
+    store.setMissing(1, true);
+    QVERIFY(store.at(1).isFavorite);
+    QCOMPARE(store.at(1).playCount, 3);
+    QVERIFY(store.at(1).missing);
+
+    MediaMetadata metadata;
+    metadata.valid = true;
+    metadata.duration = 1234;
+    metadata.fileSize = 42;
+    store.applyMetadata(0, metadata);
+    QCOMPARE(store.at(0).duration, qint64(1234));
+    QVERIFY(store.at(0).metadataLoaded);
+    store.invalidateMetadata(0);
+    QVERIFY(!store.at(0).metadataLoaded);
+    QCOMPARE(store.at(0).fileSize, qint64(-1));
+
+    // 字段修改不影响路径索引
+    QCOMPARE(store.indexOf("/media/a.mp4"), 0);
+    QCOMPARE(store.indexOfId(id), 0);
+    QCOMPARE(store.indexOf("/media/b.mp4"), 1);
+}
+
+void TestPlaylistStore::linearGrowth()
+{
+    QStringList paths = syntheticPaths(kLargeCount);
+    qint64 small = addAndFind(paths.mid(0, kSmallCount));
+    qint64 large = addAndFind(paths);
+    QVERIFY(small > 0);
+    QVERIFY(large > 0);
+
+    double growth = double(large) / small;
+    qInfo("%d items: %.1f ms, %d items: %.1f ms, growth %.2fx",
+          kSmallCount, small / 1e6, kLargeCount, large / 1e6, growth);
+    QVERIFY2(growth < kMaxGrowth, qPrintable(QString("growth %1x").arg(growth)));
+}
+
+QTEST_GUILESS_MAIN(TestPlaylistStore)
+#include "tst_playliststore.moc"
@@ -0,0 +1,102 @@
+// tst_progressthrottle.cpp
+#include <QtTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "PlaybackEngine.h"
+#include "ProgressThrottle.h"
+#include "TestMedia.h"
+
+namespace {
+const int kInterval = 16;
+const int kClipMsecs = 5000;
+const int kOpenTimeout = 10000;
+const int kSettleMsecs = 300;           // 暂停后等待已在队列中的通知送完
+const int kIdleMsecs = 2000;
+}
+
+class TestProgressThrottle : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void coalesces();
+    void suspended();
+    void idleWhilePaused();
+};
+
+void TestProgressThrottle::coalesces()
+{
+    ProgressThrottle throttle;
+    throttle.setInterval(kInterval);
+    QSignalSpy spy(&throttle, &ProgressThrottle::progressChanged);
+
+    // 一个刷新间隔内的多次通知只送出最后一个位置
+    for (qint64 position = 1; position <= 100; ++position) {
+        throttle.post(position);
+    }
+    QCOMPARE(spy.count(), 0);
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().at(0).toLongLong(), qint64(100));
+
+    QTest::qWait(kInterval * 5);
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(!throttle.isPending());
+}
+
+void TestProgressThrottle::suspended()
+{
+    ProgressThrottle throttle;
+    throttle.setInterval(kInterval);
+    QSignalSpy spy(&throttle, &ProgressThrottle::progressChanged);
+
+    throttle.setSuspended(true);
+    throttle.post(10);
+    throttle.post(20);
+    QTest::qWait(kInterval * 5);
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(throttle.isPending());
+
+    // 恢复时补送一次
+    throttle.setSuspended(false);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().at(0).toLongLong(), qint64(20));
+}
+
+void TestProgressThrottle::idleWhilePaused()
+{
+    QTemporaryDir dir;
+    QString clip = dir.filePath("clip.wav");
+    QVERIFY(TestMedia::writeSineWave(clip, kClipMsecs, 440));
+
+    // 与播放器一样，进度只由引擎的位置通知驱动
+    PlaybackEngine engine;
+    engine.setVolume(0.0f);
+    ProgressThrottle throttle;
+    throttle.setInterval(kInterval);
+    connect(&engine, &PlaybackEngine::positionChanged, &throttle, &ProgressThrottle::post);
+    QSignalSpy positions(&engine, &PlaybackEngine::positionChanged);
+    QSignalSpy updates(&throttle, &ProgressThrottle::progressChanged);
+
+    engine.setSource(QUrl::fromLocalFile(clip));
+    engine.play();
+    if (!QTest::qWaitFor([&]() { return engine.position() > 0; }, kOpenTimeout)) {
+        QSKIP("No multimedia backend or audio output available");
+    }
+    QTRY_VERIFY(updates.count() > 0);
+
+    engine.pause();
+    QTRY_COMPARE(engine.playbackState(), QMediaPlayer::PausedState);
+    QTest::qWait(kSettleMsecs);
+    positions.clear();
+    updates.clear();
+
+    // 暂停期间没有位置通知，也没有任何界面刷新
+    QTest::qWait(kIdleMsecs);
+    QCOMPARE(positions.count(), 0);
+    QCOMPARE(updates.count(), 0);
+    QVERIFY(!throttle.isPending());
+}
+
+// QMediaPlayer 需要 QGuiApplication
+QTEST_MAIN(TestProgressThrottle)
+#include "tst_progressthrottle.moc"
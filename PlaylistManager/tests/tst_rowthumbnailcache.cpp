@@ -0,0 +1,122 @@
+// tst_rowthumbnailcache.cpp
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QBuffer>
+#include "RowThumbnailCache.h"
+
+namespace {
+const int kRowCount = 50000;
+const int kVisibleRows = 20;
+const int kScrollStep = 10;             // 每帧滚动的行数
+const int kBudgetThumbnails = 200;      // 内存限额能容纳的缩略图数
+const qint64 kFrameBudget = 16;         // 60 fps 下每帧的时间（毫秒）
+const QSize kThumbnailSize(64, 36);
+}
+
+class TestRowThumbnailCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void scrollLargeList();
+
+private:
+    QTemporaryDir m_dir;
+    QStringList m_files;
+};
+
+void TestRowThumbnailCache::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_dir.isValid());
+
+    QImage image(kThumbnailSize, QImage::Format_RGB32);
+    image.fill(Qt::darkCyan);
+    QByteArray jpeg;
+    QBuffer buffer(&jpeg);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, "JPG")) {
+        QSKIP("No JPEG image format plugin available");
+    }
+
+    // 每个文件都已有磁盘缓存，不必真的解码视频
+    RowThumbnailCache cache(kThumbnailSize, 1);
+    m_files.reserve(kRowCount);
+    for (int i = 0; i < kRowCount; ++i) {
+        QString fileName = m_dir.filePath(QString("clip_%1.mp4").arg(i, 5, 10, QChar('0')));
+        QFile media(fileName);
+        QVERIFY(media.open(QIODevice::WriteOnly));
+        media.close();
+
+        QString cacheFile = cache.cacheFile(fileName);
+        if (i == 0) {
+            QVERIFY(QDir().mkpath(QFileInfo(cacheFile).absolutePath()));
+        }
+        QFile thumbnail(cacheFile);
+        QVERIFY(thumbnail.open(QIODevice::WriteOnly));
+        thumbnail.write(jpeg);
+        m_files.append(fileName);
+    }
+}
+
+void TestRowThumbnailCache::cleanupTestCase()
+{
+    QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).removeRecursively();
+}
+
+void TestRowThumbnailCache::scrollLargeList()
+{
+    qint64 budget = qint64(kBudgetThumbnails) * kThumbnailSize.width() * kThumbnailSize.height() * 4;
+    RowThumbnailCache cache(kThumbnailSize, budget);
+
+    // 滚出视图后才送出的缩略图说明请求没有被取消
+    QSet<QString> visible;
+    int ready = 0;
+    int stale = 0;
+    connect(&cache, &RowThumbnailCache::thumbnailReady, this, [&](const QString &filePath) {
+        ++ready;
+        if (!visible.contains(filePath)) {
+            ++stale;
+        }
+    });
+
+    // 与列表视图一样：每帧请求可见行、取消其余请求，然后处理事件
+    QElapsedTimer clock;
+    qint64 worstFrame = 0;
+    int frames = 0;
+    clock.start();
+    for (int top = 0; top + kVisibleRows <= kRowCount; top += kScrollStep) {
+        QElapsedTimer frame;
+        frame.start();
+        visible.clear();
+        for (int row = top; row < top + kVisibleRows; ++row) {
+            cache.request(m_files.at(row), 0);
+            visible.insert(m_files.at(row));
+        }
+        cache.retain(visible);
+        QCoreApplication::processEvents();
+        worstFrame = qMax(worstFrame, frame.elapsed());
+        ++frames;
+        QVERIFY(cache.memoryUsage() <= cache.memoryBudget());
+    }
+    qint64 averageFrame = clock.elapsed() / frames;
+    qInfo("%d frames, average %lld ms, worst %lld ms, %d thumbnails loaded while scrolling",
+          frames, averageFrame, worstFrame, ready);
+    QVERIFY2(averageFrame < kFrameBudget, qPrintable(QString("average frame %1 ms").arg(averageFrame)));
+
+    // 停下后可见行全部出图，内存不超过限额
+    for (const QString &filePath : std::as_const(visible)) {
+        QTRY_VERIFY(!cache.thumbnail(filePath).isNull());
+    }
+    QCOMPARE(stale, 0);
+    QVERIFY(cache.memoryUsage() <= cache.memoryBudget());
+    QVERIFY(cache.thumbnail(m_files.first()).isNull());
+}
+
+// FrameGrabber 中的 QMediaPlayer 需要 QGuiApplication
+QTEST_MAIN(TestRowThumbnailCache)
+#include "tst_rowthumbnailcache.moc"
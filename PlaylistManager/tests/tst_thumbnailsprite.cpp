@@ -0,0 +1,111 @@
+// tst_thumbnailsprite.cpp
+#include <QtTest>
+#include <QBuffer>
+#include <QPainter>
+#include <QTemporaryDir>
+#include <climits>
+#include "ThumbnailSprite.h"
+
+namespace {
+const QSize kTileSize(16, 9);
+const int kColumns = 4;
+const int kCount = 6;
+const qint64 kInterval = 10000;
+
+// 第 i 格的颜色，JPEG 压缩后仍可区分
+QColor tileColor(int i)
+{
+    return QColor::fromHsv(i * 360 / kCount, 255, 255);
+}
+
+// 按 ThumbnailSprite::save() 的格式写出一张每格纯色的拼图
+bool writeSprite(const QString &fileName)
+{
+    QImage atlas(kTileSize.width() * kColumns, kTileSize.height() * 2, QImage::Format_RGB32);
+    atlas.fill(Qt::black);
+    QPainter painter(&atlas);
+    for (int i = 0; i < kCount; ++i) {
+        painter.fillRect((i % kColumns) * kTileSize.width(), (i / kColumns) * kTileSize.height(),
+                         kTileSize.width(), kTileSize.height(), tileColor(i));
+    }
+    painter.end();
+
+    QByteArray encoded;
+    QBuffer buffer(&encoded);
+    buffer.open(QIODevice::WriteOnly);
+    if (!atlas.save(&buffer, "JPG", 95)) {
+        return false;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint32(0x53545056) << quint16(1) << qint32(kTileSize.width()) << qint32(kTileSize.height())
+        << qint32(kColumns) << qint32(kCount) << kInterval << encoded;
+    return out.status() == QDataStream::Ok;
+}
+
+int tileIndex(const QImage &tile)
+{
+    QColor center = tile.pixelColor(tile.width() / 2, tile.height() / 2);
+    int best = -1;
+    int bestDistance = INT_MAX;
+    for (int i = 0; i < kCount; ++i) {
+        QColor color = tileColor(i);
+        int distance = qAbs(color.red() - center.red()) + qAbs(color.green() - center.green()) +
+                       qAbs(color.blue() - center.blue());
+        if (distance < bestDistance) {
+            best = i;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+}
+
+class TestThumbnailSprite : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void tileAt_data();
+    void tileAt();
+};
+
+void TestThumbnailSprite::tileAt_data()
+{
+    QTest::addColumn<qint64>("position");
+    QTest::addColumn<int>("tile");
+
+    // 第 i 格截取自区间 [i * 10s, (i + 1) * 10s) 的中点，整个区间都显示这一格
+    QTest::newRow("start") << qint64(0) << 0;
+    QTest::newRow("first half of tile 0") << qint64(4000) << 0;
+    QTest::newRow("second half of tile 0") << qint64(9999) << 0;
+    QTest::newRow("start of tile 1") << qint64(10000) << 1;
+    QTest::newRow("middle of tile 3") << qint64(35000) << 3;
+    QTest::newRow("end of tile 3") << qint64(39999) << 3;
+    QTest::newRow("last tile") << qint64(55000) << 5;
+    QTest::newRow("past the end") << qint64(90000) << 5;
+    QTest::newRow("negative") << qint64(-500) << 0;
+}
+
+void TestThumbnailSprite::tileAt()
+{
+    QFETCH(qint64, position);
+    QFETCH(int, tile);
+
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("test.sprite");
+    QVERIFY(writeSprite(fileName));
+
+    ThumbnailSprite sprite;
+    QVERIFY(ThumbnailSprite::load(fileName, &sprite));
+    QCOMPARE(sprite.count(), kCount);
+    QCOMPARE(tileIndex(sprite.tileAt(position)), tile);
+}
+
+QTEST_GUILESS_MAIN(TestThumbnailSprite)
+#include "tst_thumbnailsprite.moc"
@@ -0,0 +1,124 @@
+// tst_tracer.cpp
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QThread>
+#include <atomic>
+#include <thread>
+#include "Tracer.h"
+
+namespace {
+const int kExports = 20;
+
+// 读回导出的事件，检查每个 "tick" 的时间戳与参数一致（没有写了一半的事件）
+bool checkExport(const QString &fileName, int *ticks)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonArray events = QJsonDocument::fromJson(file.readAll()).object().value("traceEvents").toArray();
+    for (const QJsonValue &value : events) {
+        QJsonObject event = value.toObject();
+        if (event.value("name").toString() != "tick") {
+            continue;
+        }
+        qint64 sequence = event.value("args").toObject().value("seq").toInteger(-1);
+        if (qint64(event.value("ts").toDouble()) != sequence) {
+            return false;
+        }
+        ++*ticks;
+    }
+    return true;
+}
+}
+
+class TestTracer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void exportWhileRecording();
+    void reusedRingStartsFresh();
+};
+
+void TestTracer::exportWhileRecording()
+{
+    Tracer::clear();
+
+    // 记录线程不停地覆盖环形缓冲，导出线程同时复制
+    std::atomic<bool> stop{false};
+    QThread *writer = QThread::create([&stop]() {
+        Tracer::setThreadName("writer");
+        for (qint64 i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+            Tracer::record(Tracer::EventType::Instant, "tick", i * 1000, 0, "seq", i);
+        }
+    });
+    writer->start();
+
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("trace.json");
+    int ticks = 0;
+    for (int i = 0; i < kExports; ++i) {
+        QVERIFY(Tracer::exportChromeTrace(fileName));
+        QVERIFY2(checkExport(fileName, &ticks), "exported a torn event");
+    }
+
+    stop.store(true, std::memory_order_relaxed);
+    writer->wait();
+    delete writer;
+    QVERIFY(ticks > 0);
+}
+
+void TestTracer::reusedRingStartsFresh()
+{
+    Tracer::clear();
+
+    // std::thread::join 之后线程局部变量已析构，缓冲已交还，第二个线程会接着使用它
+    std::thread first([]() {
+        Tracer::setThreadName("first");
+        for (int i = 0; i < 100; ++i) {
+            Tracer::record(Tracer::EventType::Instant, "old", i * 1000, 0);
+        }
+    });
+    first.join();
+    std::thread second([]() {
+        Tracer::setThreadName("second");
+        Tracer::record(Tracer::EventType::Instant, "new", 0, 0);
+    });
+    second.join();
+
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("trace.json");
+    QVERIFY(Tracer::exportChromeTrace(fileName));
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QJsonArray events = QJsonDocument::fromJson(file.readAll()).object().value("traceEvents").toArray();
+
+    QHash<int, QString> threadNames;
+    QSet<int> oldTids;
+    QSet<int> newTids;
+    for (const QJsonValue &value : events) {
+        QJsonObject event = value.toObject();
+        int tid = event.value("tid").toInt();
+        QString name = event.value("name").toString();
+        if (name == "thread_name") {
+            threadNames.insert(tid, event.value("args").toObject().value("name").toString());
+        } else if (name == "old") {
+            oldTids.insert(tid);
+        } else if (name == "new") {
+            newTids.insert(tid);
+        }
+    }
+
+    // 退出的线程的事件不能出现在新线程名下
+    QCOMPARE(newTids.size(), 1);
+    const int tid = *newTids.constBegin();
+    QVERIFY(!oldTids.contains(tid));
+    QCOMPARE(threadNames.value(tid), QString("second"));
+}
+
+QTEST_GUILESS_MAIN(TestTracer)
+#include "tst_tracer.moc"
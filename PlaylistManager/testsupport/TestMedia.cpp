@@ -0,0 +1,37 @@
+// TestMedia.cpp
+#include "TestMedia.h"
+#include <QSaveFile>
+#include <QDataStream>
+#include <QtMath>
+
+namespace {
+const int kSampleRate = 44100;
+}
+
+namespace TestMedia
+{
+bool writeSineWave(const QString &fileName, int msecs, int frequency)
+{
+    const quint32 samples = quint32(qint64(kSampleRate) * msecs / 1000);
+    const quint32 dataSize = samples * 2;
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.writeRawData("RIFF", 4);
+    out << quint32(36 + dataSize);
+    out.writeRawData("WAVEfmt ", 8);
+    out << quint32(16) << quint16(1) << quint16(1) << quint32(kSampleRate) << quint32(kSampleRate * 2)
+        << quint16(2) << quint16(16);
+    out.writeRawData("data", 4);
+    out << dataSize;
+    for (quint32 i = 0; i < samples; ++i) {
+        out << qint16(8000 * qSin(2 * M_PI * frequency * i / kSampleRate));
+    }
+    return out.status() == QDataStream::Ok && file.commit();
+}
+}
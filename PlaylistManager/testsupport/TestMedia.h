@@ -0,0 +1,13 @@
+// TestMedia.h
+#ifndef TESTMEDIA_H
+#define TESTMEDIA_H
+
+#include <QString>
+
+// 单元测试和基准测试共用的媒体文件：16位单声道 PCM 正弦波 WAV，任何多媒体后端都能打开
+namespace TestMedia
+{
+bool writeSineWave(const QString &fileName, int msecs, int frequency);
+}
+
+#endif // TESTMEDIA_H